@@ -0,0 +1,87 @@
+"""
+Benchmarks for high channel count conversion (channel-group parallelism).
+
+Converts synthetic 16-64 channel, 96kHz input (10ms chunks, 24-bit packed)
+to 48kHz float32 with 1, 2, 4, ... worker groups and reports the time per
+chunk and the speedup over serial conversion.
+
+Target: a 10ms 64-channel chunk converts in well under 10ms (real time),
+and time per chunk drops with more workers on a multi-core machine.
+
+Usage:
+    python benchmarks/benchmark_wide_channels.py [--iterations N]
+"""
+
+import argparse
+import os
+import time
+
+import numpy as np
+from proctap.backends.converter import AudioConverter, SampleFormat
+
+
+def synthetic_chunk(channels, frames, rate):
+    """Interleaved 24-bit packed PCM, one sine frequency per channel."""
+    t = np.arange(frames) / rate
+    freqs = 100.0 + 50.0 * np.arange(channels)
+    audio = (0.5 * np.sin(2 * np.pi * t[:, None] * freqs)).astype(np.float32)
+    ints = (audio.flatten() * 8388607.0).astype(np.int32)
+    packed = np.empty(ints.size * 3, dtype=np.uint8)
+    packed[0::3] = ints & 0xFF
+    packed[1::3] = (ints >> 8) & 0xFF
+    packed[2::3] = (ints >> 16) & 0xFF
+    return packed.tobytes()
+
+
+def benchmark(channels, workers, iterations, chunk_ms=10.0, src_rate=96000, dst_rate=48000):
+    """Average milliseconds per chunk."""
+    converter = AudioConverter(
+        src_rate=src_rate, src_channels=channels, src_width=3,
+        dst_rate=dst_rate, dst_channels=channels, dst_width=4,
+        src_format=SampleFormat.INT24, dst_format=SampleFormat.FLOAT32,
+        auto_detect_format=False, resample_quality='fast', workers=workers,
+    )
+    pcm = synthetic_chunk(channels, int(src_rate * chunk_ms / 1000), src_rate)
+
+    # Warmup
+    for _ in range(5):
+        converter.convert(pcm)
+
+    start_time = time.perf_counter()
+    for _ in range(iterations):
+        converter.convert(pcm)
+    return (time.perf_counter() - start_time) / iterations * 1000
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n')[1])
+    parser.add_argument('--iterations', type=int, default=200, help='Chunks per measurement')
+    args = parser.parse_args()
+
+    cpus = os.cpu_count() or 1
+    worker_counts = [1]
+    while worker_counts[-1] * 2 <= max(4, min(cpus, 16)):
+        worker_counts.append(worker_counts[-1] * 2)
+
+    print("=" * 70)
+    print("Wide channel conversion: 96kHz int24 -> 48kHz float32, 10ms chunks")
+    print(f"CPUs: {cpus}, iterations: {args.iterations}")
+    print("=" * 70)
+
+    for channels in (16, 32, 64):
+        print(f"\n=== {channels} channels ===")
+        serial = None
+        for workers in worker_counts:
+            time_ms = benchmark(channels, workers, args.iterations)
+            serial = serial or time_ms
+            status = '✅ PASS' if time_ms < 10.0 else '❌ FAIL'
+            print(f"  workers={workers:2d}: {time_ms:.4f} ms/chunk "
+                  f"(speedup {serial / time_ms:.2f}x) - {status}")
+
+    if cpus == 1:
+        print("\nNote: single CPU - channel groups cannot run in parallel here")
+    print("=" * 70)
+
+
+if __name__ == '__main__':
+    main()
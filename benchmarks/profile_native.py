@@ -0,0 +1,580 @@
+"""
+Mixed native/Python sampling profiler harness.
+
+cProfile (see profile_converter.py) only sees Python function calls: time
+spent inside numpy, scipy, libsamplerate or the native extension shows up as
+one opaque call, and its per-call overhead skews small functions. This
+harness runs named pipeline scenarios in a child process under a sampling
+profiler that unwinds both Python and native frames, then emits per scenario:
+
+- stacks.collapsed  Folded stacks (compatible with flamegraph.pl / inferno)
+- flamegraph.svg    Interactive flamegraph (hover for sample counts)
+- hotspots.txt      Top-N self-time table, Python/native split, and native
+                    time grouped by the Python frame that called into it
+
+Profilers:
+    py-spy  py-spy record --native (default, any Python >= 3.10;
+            may need sudo / ptrace permission)
+    perf    Linux perf with Python's perf map support (Python >= 3.12 shows
+            Python frames; on older versions they appear as
+            _PyEval_EvalFrameDefault)
+
+Usage:
+    python benchmarks/profile_native.py --list
+    python benchmarks/profile_native.py [--scenario NAME ...] [--profiler perf|py-spy]
+                                        [--duration SEC] [--rate HZ] [--top N]
+                                        [--output-dir DIR]
+    python benchmarks/profile_native.py --from-collapsed FILE [--output-dir DIR]
+
+Internal:
+    python benchmarks/profile_native.py --run NAME --duration SEC
+        Run a scenario workload without profiling (this is what the
+        profiler launches)
+"""
+
+from __future__ import annotations
+
+import argparse
+import hashlib
+import os
+import platform
+import re
+import shutil
+import subprocess
+import sys
+import time
+from collections import defaultdict
+from dataclasses import dataclass, field
+from pathlib import Path
+from typing import Callable, Dict, List, Tuple
+from xml.sax.saxutils import escape
+
+import numpy as np
+
+
+# =============================================================================
+# Scenarios
+# =============================================================================
+
+CHUNK_MS = 10  # Chunk size used by all streaming scenarios
+
+
+@dataclass
+class Scenario:
+    """Named workload to profile."""
+    name: str
+    description: str
+    setup: Callable[[], Callable[[float], int]]  # returns run(duration) -> iterations
+
+
+SCENARIOS: Dict[str, Scenario] = {}
+
+
+def scenario(name: str, description: str):
+    """Register a scenario setup function."""
+    def decorator(setup: Callable[[], Callable[[float], int]]):
+        SCENARIOS[name] = Scenario(name, description, setup)
+        return setup
+    return decorator
+
+
+def _loop(step: Callable[[], object]) -> Callable[[float], int]:
+    """Turn a single-step workload into run(duration) -> iterations."""
+    def run(duration: float) -> int:
+        iterations = 0
+        deadline = time.perf_counter() + duration
+        while time.perf_counter() < deadline:
+            step()
+            iterations += 1
+        return iterations
+    return run
+
+
+def _sine(rate: int, channels: int, ms: float = CHUNK_MS) -> np.ndarray:
+    """Interleaved float32 sine chunk, shape (N, C)."""
+    n = int(rate * ms / 1000)
+    mono = 0.5 * np.sin(2 * np.pi * 440 * np.arange(n) / rate)
+    return np.tile(mono[:, np.newaxis], (1, channels)).astype(np.float32)
+
+
+def _converter_scenario(
+    src_rate: int, src_channels: int, src_format: str,
+    dst_rate: int, dst_channels: int, dst_format: str,
+) -> Callable[[float], int]:
+    from proctap.backends.converter import AudioConverter, SampleFormat
+
+    widths = {SampleFormat.INT16: 2, SampleFormat.INT32: 4, SampleFormat.FLOAT32: 4}
+    converter = AudioConverter(
+        src_rate=src_rate, src_channels=src_channels, src_width=widths[src_format],
+        dst_rate=dst_rate, dst_channels=dst_channels, dst_width=widths[dst_format],
+        src_format=src_format, dst_format=dst_format,
+        auto_detect_format=False,
+    )
+    chunk = _sine(src_rate, src_channels)
+    if src_format == SampleFormat.INT16:
+        pcm = (chunk * 32767).astype(np.int16).tobytes()
+    elif src_format == SampleFormat.INT32:
+        pcm = (chunk * 2147483647).astype(np.int32).tobytes()
+    else:
+        pcm = chunk.tobytes()
+    return _loop(lambda: converter.convert(pcm))
+
+
+@scenario("converter-s16-44k1-to-f32-48k",
+          "Linux default path: 44.1kHz/2ch/int16 -> 48kHz/2ch/float32 (resample)")
+def _converter_linux_default():
+    return _converter_scenario(44100, 2, 'int16', 48000, 2, 'float32')
+
+
+@scenario("converter-s16-to-f32",
+          "Format only: 48kHz/2ch/int16 -> float32")
+def _converter_format_only():
+    return _converter_scenario(48000, 2, 'int16', 48000, 2, 'float32')
+
+
+@scenario("converter-f32-6ch-to-stereo",
+          "Channel downmix: 48kHz/6ch/float32 -> 2ch")
+def _converter_downmix():
+    return _converter_scenario(48000, 6, 'float32', 48000, 2, 'float32')
+
+
+@scenario("converter-f32-48k-to-s16-16k-mono",
+          "Speech export: 48kHz/2ch/float32 -> 16kHz/1ch/int16")
+def _converter_speech():
+    return _converter_scenario(48000, 2, 'float32', 16000, 1, 'int16')
+
+
+def _voice_chain():
+    from proctap.contrib.filters import (
+        FilterChain, GainNormalizer, HighPassFilter, LowPassFilter, NoiseGate,
+    )
+    return FilterChain([
+        HighPassFilter(sample_rate=48000, cutoff_hz=120.0),
+        NoiseGate(sample_rate=48000, threshold_db=-40.0),
+        GainNormalizer(target_rms=0.1),
+        LowPassFilter(sample_rate=48000, cutoff_hz=8000.0),
+    ])
+
+
+@scenario("filters-voice-chain",
+          "HighPass -> NoiseGate -> GainNormalizer -> LowPass on 48kHz stereo")
+def _filters_voice():
+    chain = _voice_chain()
+    frame = _sine(48000, 2)
+    return _loop(lambda: chain.process(frame))
+
+
+@scenario("filters-mono-vad",
+          "StereoToMono -> EnergyVAD on 48kHz stereo")
+def _filters_vad():
+    from proctap.contrib.filters import EnergyVAD, FilterChain, StereoToMono
+
+    chain = FilterChain([StereoToMono(), EnergyVAD(threshold_db=-45.0)])
+    frame = _sine(48000, 2)
+    return _loop(lambda: chain.process(frame))
+
+
+@scenario("analysis-spectrum",
+          "AudioAnalyzer RMS/peak/FFT update on every chunk")
+def _analysis_spectrum():
+    from proctap.contrib.analysis import AudioAnalyzer
+
+    analyzer = AudioAnalyzer(sample_rate=48000, channels=2, fft_size=2048, update_interval=0.0)
+    pcm = _sine(48000, 2).tobytes()
+    return _loop(lambda: analyzer.process_audio(pcm))
+
+
+@scenario("capture-synthetic",
+          "Full ProcessAudioCapture with a synthetic 44.1kHz/int16 source, "
+          "conversion and voice filter chain in the callback")
+def _capture_synthetic():
+    from proctap import ProcessAudioCapture
+    from proctap.backends.synthetic import SyntheticBackend
+
+    chain = _voice_chain()
+    chunks = [0]
+
+    def on_data(pcm: bytes, _frames: int) -> None:
+        chain.process(np.frombuffer(pcm, dtype=np.float32).reshape(-1, 2))
+        chunks[0] += 1
+
+    def run(duration: float) -> int:
+        chunks[0] = 0  # Count only this run, not the warmup
+        backend = SyntheticBackend(
+            signal='sine', chunk_ms=CHUNK_MS, realtime=False,
+            source_rate=44100, source_channels=2, source_format='int16',
+        )
+        tap = ProcessAudioCapture(pid=0, on_data=on_data, backend=backend)
+        tap.start()
+        try:
+            deadline = time.monotonic() + duration
+            while time.monotonic() < deadline:
+                # Keep the async queue drained like a consumer would
+                tap.read(timeout=0.1)
+        finally:
+            tap.stop()
+        return chunks[0]
+
+    return run
+
+
+def run_scenario(name: str, duration: float) -> int:
+    """Run a scenario workload (no profiling) and return its iteration count."""
+    run = SCENARIOS[name].setup()
+    run(min(0.2, duration))  # Warmup (imports, caches, filter design)
+    return run(duration)
+
+
+# =============================================================================
+# Stack collection
+# =============================================================================
+
+def _clean_perf_symbol(symbol: str, dso: str) -> str:
+    """Normalize a perf script frame to 'function (file)'."""
+    symbol = re.sub(r'\+0x[0-9a-f]+$', '', symbol)
+    if symbol.startswith('py::'):
+        # Python perf trampoline: py::<qualname>:<filename>
+        qualname, _, filename = symbol[4:].rpartition(':')
+        return f"{qualname or filename} ({os.path.basename(filename)})"
+    return f"{symbol} ({os.path.basename(dso)})" if dso else symbol
+
+
+def collapse_perf_script(text: str) -> Dict[str, int]:
+    """
+    Fold `perf script` output into collapsed stacks.
+
+    Args:
+        text: perf script output (samples with call chains)
+
+    Returns:
+        Mapping of "root;...;leaf" -> sample count
+    """
+    stacks: Dict[str, int] = defaultdict(int)
+    frames: List[str] = []
+    in_sample = False
+
+    def flush() -> None:
+        if frames:
+            stacks[';'.join(reversed(frames))] += 1
+        frames.clear()
+
+    frame_re = re.compile(r'^\s+[0-9a-f]+\s+(.*?)\s+\((.*)\)$')
+    for line in text.splitlines():
+        if not line.strip():
+            flush()
+            in_sample = False
+        elif not line[0].isspace():
+            flush()
+            in_sample = True
+        elif in_sample:
+            match = frame_re.match(line)
+            if match:
+                frames.append(_clean_perf_symbol(match.group(1), match.group(2)))
+    flush()
+    return dict(stacks)
+
+
+def read_collapsed(path: Path) -> Dict[str, int]:
+    """Read a collapsed stack file ("a;b;c 42" per line)."""
+    stacks: Dict[str, int] = defaultdict(int)
+    for line in path.read_text(errors='replace').splitlines():
+        stack, _, count = line.rpartition(' ')
+        if stack and count.isdigit():
+            stacks[stack] += int(count)
+    return dict(stacks)
+
+
+def write_collapsed(stacks: Dict[str, int], path: Path) -> None:
+    """Write collapsed stacks sorted by stack."""
+    with open(path, 'w') as f:
+        for stack in sorted(stacks):
+            f.write(f"{stack} {stacks[stack]}\n")
+
+
+def _child_command(name: str, duration: float) -> List[str]:
+    return [sys.executable, str(Path(__file__).resolve()), '--run', name, '--duration', str(duration)]
+
+
+def profile_with_pyspy(name: str, duration: float, rate: int, out_dir: Path) -> Dict[str, int]:
+    """Sample a scenario with py-spy (Python + native frames)."""
+    collapsed = out_dir / 'stacks.collapsed'
+    cmd = [
+        'py-spy', 'record', '--native', '--function',
+        '--rate', str(rate), '--format', 'raw', '-o', str(collapsed),
+        '--', *_child_command(name, duration),
+    ]
+    subprocess.run(cmd, check=True)
+    return read_collapsed(collapsed)
+
+
+def profile_with_perf(name: str, duration: float, rate: int, out_dir: Path) -> Dict[str, int]:
+    """Sample a scenario with perf, using Python's perf map trampolines."""
+    data = out_dir / 'perf.data'
+    env = dict(os.environ, PYTHONPERFSUPPORT='1')
+    subprocess.run(
+        ['perf', 'record', '-F', str(rate), '-g', '-o', str(data), '--', *_child_command(name, duration)],
+        check=True, env=env,
+    )
+    result = subprocess.run(
+        ['perf', 'script', '-i', str(data)],
+        check=True, capture_output=True,
+    )
+    stacks = collapse_perf_script(result.stdout.decode('utf-8', 'replace'))
+    write_collapsed(stacks, out_dir / 'stacks.collapsed')
+    return stacks
+
+
+PROFILERS = {
+    'py-spy': ('py-spy', profile_with_pyspy),
+    'perf': ('perf', profile_with_perf),
+}
+
+
+# =============================================================================
+# Reports
+# =============================================================================
+
+def is_python_frame(frame: str) -> bool:
+    """Heuristic: Python frames reference a .py file."""
+    return re.search(r'\.py[:)]', frame) is not None
+
+
+@dataclass
+class HotspotReport:
+    """Aggregated view of collapsed stacks."""
+    total: int = 0
+    self_samples: Dict[str, int] = field(default_factory=lambda: defaultdict(int))
+    total_samples: Dict[str, int] = field(default_factory=lambda: defaultdict(int))
+    python_self: int = 0
+    native_self: int = 0
+    native_by_caller: Dict[str, int] = field(default_factory=lambda: defaultdict(int))
+
+
+def analyze(stacks: Dict[str, int]) -> HotspotReport:
+    """Compute self/total time per frame and the Python/native split."""
+    report = HotspotReport()
+    for stack, count in stacks.items():
+        frames = stack.split(';')
+        leaf = frames[-1]
+        report.total += count
+        report.self_samples[leaf] += count
+        for frame in set(frames):
+            report.total_samples[frame] += count
+
+        if is_python_frame(leaf):
+            report.python_self += count
+        else:
+            report.native_self += count
+            caller = next((f for f in reversed(frames) if is_python_frame(f)), '<no Python frame>')
+            report.native_by_caller[caller] += count
+    return report
+
+
+def format_hotspots(name: str, report: HotspotReport, top_n: int) -> str:
+    """Render the top-N hotspot table for a scenario."""
+    lines = []
+    lines.append("=" * 100)
+    lines.append(f"Hotspots: {name}")
+    lines.append("=" * 100)
+    if report.total == 0:
+        lines.append("No samples collected")
+        return "\n".join(lines)
+
+    def pct(n: int) -> str:
+        return f"{100.0 * n / report.total:6.2f}%"
+
+    lines.append(f"Samples: {report.total}")
+    lines.append(f"Self time: Python {pct(report.python_self)} | native {pct(report.native_self)}")
+    lines.append("")
+    lines.append(f"Top {top_n} frames by self time:")
+    lines.append(f"{'Self':>8} {'Total':>8} {'Samples':>8}  {'Kind':<6}  Frame")
+    lines.append("-" * 100)
+    top = sorted(report.self_samples.items(), key=lambda kv: kv[1], reverse=True)[:top_n]
+    for frame, count in top:
+        kind = 'py' if is_python_frame(frame) else 'native'
+        lines.append(
+            f"{pct(count):>8} {pct(report.total_samples[frame]):>8} {count:>8}  {kind:<6}  {frame}"
+        )
+
+    if report.native_by_caller:
+        lines.append("")
+        lines.append(f"Native self time by calling Python frame (top {top_n}):")
+        lines.append("-" * 100)
+        callers = sorted(report.native_by_caller.items(), key=lambda kv: kv[1], reverse=True)[:top_n]
+        for caller, count in callers:
+            lines.append(f"{pct(count):>8} {count:>8}  {caller}")
+
+    return "\n".join(lines)
+
+
+def _frame_color(frame: str) -> str:
+    """Stable color: warm for Python frames, cool for native frames."""
+    h = int(hashlib.md5(frame.encode()).hexdigest()[:4], 16)
+    if is_python_frame(frame):
+        return f"rgb(240,{100 + h % 110},{40 + h % 40})"
+    return f"rgb({60 + h % 60},{140 + h % 80},{200 + h % 50})"
+
+
+def render_flamegraph(stacks: Dict[str, int], title: str, width: int = 1200, frame_height: int = 16) -> str:
+    """
+    Render collapsed stacks as a standalone SVG flamegraph.
+
+    Args:
+        stacks: Collapsed stacks
+        title: Title shown above the graph
+        width: Image width in pixels
+        frame_height: Height of each frame row
+
+    Returns:
+        SVG document
+    """
+    tree: dict = {'value': 0, 'children': {}}
+    depth = 0
+    for stack, count in stacks.items():
+        node = tree
+        node['value'] += count
+        frames = stack.split(';')
+        depth = max(depth, len(frames))
+        for frame in frames:
+            node = node['children'].setdefault(frame, {'value': 0, 'children': {}})
+            node['value'] += count
+
+    total = tree['value'] or 1
+    top_margin = 30
+    height = top_margin + (depth + 1) * frame_height + 10
+    scale = (width - 20) / total
+    rects: List[str] = []
+
+    def draw(node: dict, name: str, x: float, level: int) -> None:
+        w = node['value'] * scale
+        if w < 0.1:
+            return
+        y = height - 10 - (level + 1) * frame_height
+        label = escape(name)
+        tooltip = f"{label} ({node['value']} samples, {100.0 * node['value'] / total:.2f}%)"
+        fill = _frame_color(name) if level else "rgb(200,200,200)"
+        text = ""
+        max_chars = int((w - 4) / 7)
+        if max_chars >= 3:
+            shown = name if len(name) <= max_chars else name[:max_chars - 2] + '..'
+            text = f'<text x="{x + 2:.1f}" y="{y + frame_height - 4}">{escape(shown)}</text>'
+        rects.append(
+            f'<g><title>{tooltip}</title>'
+            f'<rect x="{x:.1f}" y="{y}" width="{w:.1f}" height="{frame_height - 1}" fill="{fill}" rx="2"/>'
+            f'{text}</g>'
+        )
+        child_x = x
+        for child_name, child in sorted(node['children'].items()):
+            draw(child, child_name, child_x, level + 1)
+            child_x += child['value'] * scale
+
+    draw(tree, 'all', 10.0, 0)
+
+    return "\n".join([
+        f'<svg xmlns="http://www.w3.org/2000/svg" width="{width}" height="{height}" '
+        f'font-family="monospace" font-size="11">',
+        f'<rect width="100%" height="100%" fill="rgb(250,250,245)"/>',
+        f'<text x="{width // 2}" y="20" text-anchor="middle" font-size="15">{escape(title)}</text>',
+        *rects,
+        '</svg>',
+    ])
+
+
+def write_reports(name: str, stacks: Dict[str, int], out_dir: Path, top_n: int) -> HotspotReport:
+    """Write flamegraph and hotspot table for a scenario."""
+    report = analyze(stacks)
+    table = format_hotspots(name, report, top_n)
+    (out_dir / 'hotspots.txt').write_text(table + "\n")
+    (out_dir / 'flamegraph.svg').write_text(render_flamegraph(stacks, name))
+    print(table)
+    print(f"\nFlamegraph: {out_dir / 'flamegraph.svg'}")
+    return report
+
+
+# =============================================================================
+# Main
+# =============================================================================
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Profile pipeline scenarios with a mixed native/Python sampling profiler",
+        formatter_class=argparse.RawDescriptionHelpFormatter,
+        epilog=__doc__
+    )
+    parser.add_argument('--list', action='store_true', help='List scenarios and exit')
+    parser.add_argument(
+        '--scenario', action='append', choices=sorted(SCENARIOS),
+        help='Scenario to profile (repeatable, default: all)'
+    )
+    parser.add_argument('--profiler', choices=sorted(PROFILERS), default='py-spy', help='Sampling profiler')
+    parser.add_argument('--duration', type=float, default=5.0, help='Seconds to run each scenario')
+    parser.add_argument('--rate', type=int, default=999, help='Sampling rate in Hz')
+    parser.add_argument('--top', type=int, default=25, help='Rows in the hotspot tables')
+    parser.add_argument(
+        '--output-dir', type=Path, default=Path('profiling_results') / 'native',
+        help='Output directory for profiling reports'
+    )
+    parser.add_argument('--from-collapsed', type=Path, help='Render reports for an existing collapsed stack file')
+    parser.add_argument('--run', choices=sorted(SCENARIOS), help=argparse.SUPPRESS)
+
+    args = parser.parse_args()
+
+    if args.list:
+        for s in SCENARIOS.values():
+            print(f"{s.name:<36} {s.description}")
+        return
+
+    if args.run:
+        start = time.perf_counter()
+        iterations = run_scenario(args.run, args.duration)
+        elapsed = time.perf_counter() - start
+        print(f"{args.run}: {iterations} iterations in {elapsed:.2f}s", file=sys.stderr)
+        return
+
+    if args.from_collapsed:
+        args.output_dir.mkdir(parents=True, exist_ok=True)
+        write_reports(args.from_collapsed.stem, read_collapsed(args.from_collapsed), args.output_dir, args.top)
+        return
+
+    executable, profile_fn = PROFILERS[args.profiler]
+    if shutil.which(executable) is None:
+        sys.exit(f"{executable} not found in PATH (install it or choose another --profiler)")
+    if args.profiler == 'perf' and sys.version_info < (3, 12):
+        print("⚠️  Python < 3.12 has no perf map support: Python frames will show as "
+              "_PyEval_EvalFrameDefault. Use --profiler py-spy for mixed stacks.")
+
+    print("=" * 80)
+    print("Mixed Native/Python Profiling")
+    print("=" * 80)
+    print(f"\nPlatform: {platform.system()} {platform.release()}")
+    print(f"Python: {sys.version.split()[0]}")
+    print(f"NumPy: {np.__version__}")
+    print(f"Profiler: {args.profiler} @ {args.rate} Hz, {args.duration}s per scenario")
+    print(f"Output directory: {args.output_dir}")
+
+    summary: List[Tuple[str, HotspotReport]] = []
+    for name in args.scenario or list(SCENARIOS):
+        print(f"\nProfiling: {name} - {SCENARIOS[name].description}")
+        print("-" * 80)
+        out_dir = args.output_dir / name
+        out_dir.mkdir(parents=True, exist_ok=True)
+        try:
+            stacks = profile_fn(name, args.duration, args.rate, out_dir)
+        except subprocess.CalledProcessError as e:
+            print(f"❌ {args.profiler} failed (exit {e.returncode}); skipping {name}")
+            continue
+        summary.append((name, write_reports(name, stacks, out_dir, args.top)))
+
+    print("\n" + "=" * 80)
+    print("PROFILING SUMMARY")
+    print("=" * 80)
+    for name, report in summary:
+        total = report.total or 1
+        print(f"{name:<36} samples={report.total:<7} "
+              f"python={100.0 * report.python_self / total:5.1f}% "
+              f"native={100.0 * report.native_self / total:5.1f}%")
+    print(f"\nAll profiling reports saved to: {args.output_dir}")
+
+
+if __name__ == '__main__':
+    main()
@@ -100,6 +100,18 @@ elif platform.system() == "Linux":
     # Linux: Pure Python backend using PulseAudio (experimental)
     print("Building for Linux with PulseAudio backend (experimental)")
     print("NOTE: Per-process isolation has limitations on Linux")
+    # LD_PRELOAD playback shim (plain shared library, no Python entry point)
+    ext_modules.append(
+        Extension(
+            "proctap._preload",
+            sources=["src/proctap/_preload.cpp"],
+            language="c++",
+            extra_compile_args=["-std=c++17", "-O2"],
+            extra_link_args=["-pthread"],
+            libraries=["dl", "rt"],
+            optional=True,
+        )
+    )
 
 elif platform.system() == "Darwin":  # macOS
     # macOS: ScreenCaptureKit backend via Swift CLI helper (no C extension needed)
@@ -110,6 +122,18 @@ else:
     print(f"WARNING: Platform '{platform.system()}' is not officially supported")
     print("The package will install but audio capture will not work")
 
+# Native pipeline runtime (all platforms, optional: pure-Python install still works)
+ext_modules.append(
+    Extension(
+        "proctap._pipeline",
+        sources=["src/proctap/_pipeline.cpp"],
+        language="c++",
+        extra_compile_args=["/std:c++17", "/EHsc", "/O2", '/utf-8'] if sys.platform == 'win32' else ["-std=c++17", "-O2"],
+        extra_link_args=[] if sys.platform == 'win32' else ["-pthread"],
+        optional=True,
+    )
+)
+
 setup(
     packages=find_packages(where="src"),
     package_dir={"": "src"},
@@ -9,6 +9,12 @@ except PackageNotFoundError:
     from ._version import __version__
 
 from .core import ProcessAudioCapture, ResampleQuality
+from .grid import BlockGrid, GridBlock
+from .switcher import SourceSwitcher
+from .spectral import SpectralBus
+from .latency import LatencyCompensator, LatencyReport
+from .hibernation import HibernationPolicy
+from .poll import CaptureSelector, poll
 from .backends.base import (
     STANDARD_SAMPLE_RATE,
     STANDARD_CHANNELS,
@@ -19,6 +25,15 @@ from .backends.base import (
 __all__ = [
     "ProcessAudioCapture",
     "ResampleQuality",
+    "BlockGrid",
+    "GridBlock",
+    "SourceSwitcher",
+    "SpectralBus",
+    "LatencyCompensator",
+    "LatencyReport",
+    "HibernationPolicy",
+    "CaptureSelector",
+    "poll",
     "STANDARD_SAMPLE_RATE",
     "STANDARD_CHANNELS",
     "STANDARD_FORMAT",
@@ -0,0 +1,1863 @@
+/**
+ * Native pipeline runtime
+ *
+ * Runs a source -> stages -> sinks pipeline, described by a declarative spec
+ * built in Python (see proctap/pipeline.py), entirely on a native thread.
+ * Audio never crosses into the interpreter: Python only builds the spec,
+ * polls control events (started / meter / error / finished) and reads stats.
+ *
+ * The runtime thread never touches Python objects, so it does not need the
+ * GIL; every blocking call made from Python releases it.
+ *
+ * Internal format between stages: interleaved float32, [-1.0, 1.0].
+ * File formats assume a little-endian host.
+ */
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#ifndef _WIN32
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+// Bounds for formats read from file headers
+constexpr int kMaxChannels = 256;
+constexpr uint32_t kMaxRate = 768000;
+
+using Clock = std::chrono::steady_clock;
+
+// ---------------------------------------------------------------------------
+// Spec parsing (called with the GIL held, at construction time only)
+// ---------------------------------------------------------------------------
+
+class SpecError : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
+PyObject* spec_item(PyObject* spec, const char* key) {
+    return PyDict_GetItemString(spec, key);  // borrowed
+}
+
+std::string spec_str(PyObject* spec, const char* key, const char* def) {
+    PyObject* item = spec_item(spec, key);
+    if (item == nullptr || item == Py_None) {
+        if (def == nullptr) {
+            throw SpecError(std::string("missing required key '") + key + "'");
+        }
+        return def;
+    }
+    if (!PyUnicode_Check(item)) {
+        throw SpecError(std::string("'") + key + "' must be a string");
+    }
+    const char* s = PyUnicode_AsUTF8(item);
+    if (s == nullptr) {
+        PyErr_Clear();
+        throw SpecError(std::string("'") + key + "' is not valid UTF-8");
+    }
+    return s;
+}
+
+double spec_double(PyObject* spec, const char* key, double def) {
+    PyObject* item = spec_item(spec, key);
+    if (item == nullptr || item == Py_None) {
+        return def;
+    }
+    double value = PyFloat_AsDouble(item);
+    if (value == -1.0 && PyErr_Occurred()) {
+        PyErr_Clear();
+        throw SpecError(std::string("'") + key + "' must be a number");
+    }
+    return value;
+}
+
+long spec_int(PyObject* spec, const char* key, long def) {
+    PyObject* item = spec_item(spec, key);
+    if (item == nullptr || item == Py_None) {
+        return def;
+    }
+    long value = PyLong_AsLong(item);
+    if (value == -1 && PyErr_Occurred()) {
+        PyErr_Clear();
+        throw SpecError(std::string("'") + key + "' must be an integer");
+    }
+    return value;
+}
+
+bool spec_bool(PyObject* spec, const char* key, bool def) {
+    PyObject* item = spec_item(spec, key);
+    if (item == nullptr || item == Py_None) {
+        return def;
+    }
+    return PyObject_IsTrue(item) == 1;
+}
+
+std::vector<std::string> spec_str_list(PyObject* spec, const char* key) {
+    PyObject* item = spec_item(spec, key);
+    if (item == nullptr || !PyList_Check(item)) {
+        throw SpecError(std::string("'") + key + "' must be a list of strings");
+    }
+    std::vector<std::string> out;
+    for (Py_ssize_t i = 0; i < PyList_Size(item); ++i) {
+        PyObject* s = PyList_GetItem(item, i);
+        if (!PyUnicode_Check(s)) {
+            throw SpecError(std::string("'") + key + "' must be a list of strings");
+        }
+        out.emplace_back(PyUnicode_AsUTF8(s));
+    }
+    return out;
+}
+
+void require_positive(double value, const char* what) {
+    if (!(value > 0)) {
+        throw SpecError(std::string(what) + " must be positive");
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Audio blocks, events
+// ---------------------------------------------------------------------------
+
+struct AudioBlock {
+    std::vector<float> samples;  // Interleaved
+    size_t frames = 0;
+    int channels = 0;
+
+    void resize(size_t num_frames, int num_channels) {
+        frames = num_frames;
+        channels = num_channels;
+        samples.resize(num_frames * static_cast<size_t>(num_channels));
+    }
+};
+
+struct Event {
+    std::string type;
+    std::string stage;
+    std::string message;
+    double time = 0.0;      // Seconds since start()
+    uint64_t frame = 0;     // Source frame position
+    std::vector<std::pair<std::string, std::vector<double>>> values;
+};
+
+class EventQueue {
+public:
+    explicit EventQueue(size_t capacity) : capacity_(capacity) {}
+
+    void push(Event event) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (events_.size() >= capacity_) {
+                // Control events are advisory: drop the oldest, never block audio
+                events_.pop_front();
+                ++dropped_;
+            }
+            events_.push_back(std::move(event));
+        }
+        cv_.notify_all();
+    }
+
+    std::vector<Event> pop_all(double timeout) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (events_.empty() && timeout > 0) {
+            cv_.wait_for(lock, std::chrono::duration<double>(timeout), [this] { return !events_.empty(); });
+        }
+        std::vector<Event> out(std::make_move_iterator(events_.begin()), std::make_move_iterator(events_.end()));
+        events_.clear();
+        return out;
+    }
+
+    uint64_t dropped() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return dropped_;
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<Event> events_;
+    size_t capacity_;
+    uint64_t dropped_ = 0;
+};
+
+struct Context {
+    EventQueue* events = nullptr;
+    Clock::time_point start;
+    uint64_t frame = 0;  // Source frames consumed before the current block
+
+    double now() const {
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    }
+};
+
+// ---------------------------------------------------------------------------
+// Sample encoding
+// ---------------------------------------------------------------------------
+
+enum class SampleFormat { S16, F32 };
+
+SampleFormat parse_format(const std::string& name) {
+    if (name == "s16") return SampleFormat::S16;
+    if (name == "f32") return SampleFormat::F32;
+    throw SpecError("unknown sample format '" + name + "' (use 's16' or 'f32')");
+}
+
+int format_width(SampleFormat format) {
+    return format == SampleFormat::S16 ? 2 : 4;
+}
+
+void encode(const AudioBlock& block, SampleFormat format, std::vector<char>& out) {
+    size_t count = block.frames * static_cast<size_t>(block.channels);
+    out.resize(count * format_width(format));
+    if (format == SampleFormat::F32) {
+        std::memcpy(out.data(), block.samples.data(), count * sizeof(float));
+        return;
+    }
+    auto* dst = reinterpret_cast<int16_t*>(out.data());
+    for (size_t i = 0; i < count; ++i) {
+        float x = std::min(1.0f, std::max(-1.0f, block.samples[i]));
+        dst[i] = static_cast<int16_t>(std::lrintf(x * 32767.0f));
+    }
+}
+
+void decode(const char* data, size_t count, int width, bool is_float, float* out) {
+    if (is_float) {
+        std::memcpy(out, data, count * sizeof(float));
+    } else if (width == 2) {
+        const auto* src = reinterpret_cast<const int16_t*>(data);
+        for (size_t i = 0; i < count; ++i) out[i] = src[i] / 32768.0f;
+    } else if (width == 3) {
+        const auto* src = reinterpret_cast<const uint8_t*>(data);
+        for (size_t i = 0; i < count; ++i) {
+            uint32_t u = static_cast<uint32_t>(src[3 * i]) | (static_cast<uint32_t>(src[3 * i + 1]) << 8) |
+                         (static_cast<uint32_t>(src[3 * i + 2]) << 16);
+            int32_t v = static_cast<int32_t>(u ^ 0x800000u) - 0x800000;  // Sign-extend 24 bits
+            out[i] = v / 8388608.0f;
+        }
+    } else {
+        const auto* src = reinterpret_cast<const int32_t*>(data);
+        for (size_t i = 0; i < count; ++i) out[i] = static_cast<float>(src[i] / 2147483648.0);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Sources
+// ---------------------------------------------------------------------------
+
+class Source {
+public:
+    virtual ~Source() = default;
+    virtual void open() {}
+    // Fill block with the next chunk. Returns false at end of stream.
+    virtual bool read(AudioBlock& block) = 0;
+    // Called from the control thread to unblock a pending read().
+    virtual void interrupt() {}
+    virtual void close() {}
+    // A chunk is only delivered once all of its frames exist
+    double latency_ms() const { return rate > 0 ? 1000.0 * chunk_frames_ / rate : 0.0; }
+
+    std::string type;
+    int rate = 0;
+    int channels = 0;
+
+protected:
+    size_t chunk_frames_ = 0;
+};
+
+class SyntheticSource : public Source {
+public:
+    explicit SyntheticSource(PyObject* spec) {
+        type = "synthetic";
+        signal_ = spec_str(spec, "signal", "sine");
+        if (signal_ != "sine" && signal_ != "noise" && signal_ != "silence" && signal_ != "impulse") {
+            throw SpecError("unknown signal '" + signal_ + "'");
+        }
+        frequency_ = spec_double(spec, "frequency", 440.0);
+        amplitude_ = static_cast<float>(spec_double(spec, "amplitude", 0.5));
+        rate = static_cast<int>(spec_int(spec, "rate", 48000));
+        channels = static_cast<int>(spec_int(spec, "channels", 2));
+        chunk_frames_ = static_cast<size_t>(spec_int(spec, "chunk_frames", rate / 100));
+        realtime_ = spec_bool(spec, "realtime", false);
+        double duration = spec_double(spec, "duration", -1.0);
+        total_frames_ = duration < 0 ? UINT64_MAX : static_cast<uint64_t>(duration * rate);
+        impulse_interval_ = static_cast<uint64_t>(std::max(1.0, std::round(spec_double(spec, "impulse_interval", 1.0) * rate)));
+        rng_.seed(static_cast<uint32_t>(spec_int(spec, "seed", 0)));
+        require_positive(rate, "rate");
+        require_positive(channels, "channels");
+        require_positive(static_cast<double>(chunk_frames_), "chunk_frames");
+    }
+
+    void open() override {
+        position_ = 0;
+        start_ = Clock::now();
+    }
+
+    bool read(AudioBlock& block) override {
+        if (position_ >= total_frames_) {
+            return false;
+        }
+        size_t frames = static_cast<size_t>(std::min<uint64_t>(chunk_frames_, total_frames_ - position_));
+
+        if (realtime_) {
+            auto due = start_ + std::chrono::duration_cast<Clock::duration>(
+                std::chrono::duration<double>(static_cast<double>(position_ + frames) / rate));
+            std::this_thread::sleep_until(due);
+        }
+
+        block.resize(frames, channels);
+        std::uniform_real_distribution<float> noise(-amplitude_, amplitude_);
+        for (size_t i = 0; i < frames; ++i) {
+            uint64_t n = position_ + i;
+            float value = 0.0f;
+            if (signal_ == "sine") {
+                value = amplitude_ * static_cast<float>(std::sin(2.0 * kPi * frequency_ * static_cast<double>(n) / rate));
+            } else if (signal_ == "noise") {
+                value = noise(rng_);
+            } else if (signal_ == "impulse") {
+                value = (n % impulse_interval_ == 0) ? amplitude_ : 0.0f;
+            }
+            std::fill_n(&block.samples[i * channels], channels, value);
+        }
+        position_ += frames;
+        return true;
+    }
+
+private:
+    std::string signal_;
+    double frequency_;
+    float amplitude_;
+    bool realtime_;
+    uint64_t total_frames_;
+    uint64_t impulse_interval_;
+    uint64_t position_ = 0;
+    std::mt19937 rng_;
+    Clock::time_point start_;
+};
+
+class WavSource : public Source {
+public:
+    explicit WavSource(PyObject* spec) {
+        type = "wav";
+        path_ = spec_str(spec, "path", nullptr);
+        chunk_frames_ = static_cast<size_t>(spec_int(spec, "chunk_frames", 480));
+        require_positive(static_cast<double>(chunk_frames_), "chunk_frames");
+        // The header has to be parsed up front so downstream stages know the format
+        open();
+    }
+
+    ~WavSource() override { close(); }
+
+    void open() override {
+        close();
+        file_ = std::fopen(path_.c_str(), "rb");
+        if (file_ == nullptr) {
+            throw std::runtime_error("cannot open '" + path_ + "'");
+        }
+        try {
+            parse_header();
+        } catch (...) {
+            close();
+            throw;
+        }
+    }
+
+    bool read(AudioBlock& block) override {
+        size_t frame_bytes = static_cast<size_t>(width_) * channels;
+        size_t frames = std::min<uint64_t>(chunk_frames_, remaining_ / frame_bytes);
+        if (frames == 0 || file_ == nullptr) {
+            return false;
+        }
+        raw_.resize(frames * frame_bytes);
+        size_t got = std::fread(raw_.data(), 1, raw_.size(), file_) / frame_bytes;
+        if (got == 0) {
+            return false;
+        }
+        remaining_ -= got * frame_bytes;
+        block.resize(got, channels);
+        decode(raw_.data(), got * channels, width_, is_float_, block.samples.data());
+        return true;
+    }
+
+    void close() override {
+        if (file_ != nullptr) {
+            std::fclose(file_);
+            file_ = nullptr;
+        }
+    }
+
+private:
+    // The header is untrusted: anything that would break decoding or the
+    // resampler (no channels, zero rate, odd bit depths) is rejected here
+    void parse_header() {
+        char riff[12];
+        if (std::fread(riff, 1, 12, file_) != 12 || std::memcmp(riff, "RIFF", 4) != 0 || std::memcmp(riff + 8, "WAVE", 4) != 0) {
+            throw std::runtime_error("'" + path_ + "' is not a WAV file");
+        }
+        bool have_fmt = false;
+        while (true) {
+            char id[4];
+            uint32_t size = 0;
+            if (std::fread(id, 1, 4, file_) != 4 || std::fread(&size, 4, 1, file_) != 1) {
+                throw std::runtime_error("'" + path_ + "' has no data chunk");
+            }
+            if (std::memcmp(id, "fmt ", 4) == 0) {
+                // Only the first 40 bytes (WAVE_FORMAT_EXTENSIBLE) matter; the
+                // claimed size is never used to allocate
+                uint8_t fmt[40];
+                size_t want = std::min<size_t>(size, sizeof(fmt));
+                if (size < 16 || std::fread(fmt, 1, want, file_) != want) {
+                    throw std::runtime_error("'" + path_ + "' has a bad fmt chunk");
+                }
+                uint16_t tag, ch, bits;
+                uint32_t sr;
+                std::memcpy(&tag, &fmt[0], 2);
+                std::memcpy(&ch, &fmt[2], 2);
+                std::memcpy(&sr, &fmt[4], 4);
+                std::memcpy(&bits, &fmt[14], 2);
+                if (tag == 0xFFFE && size >= 26) {
+                    std::memcpy(&tag, &fmt[24], 2);  // WAVE_FORMAT_EXTENSIBLE sub-format
+                }
+                is_float_ = (tag == 3);
+                if (!((tag == 1 && (bits == 16 || bits == 24 || bits == 32)) || (tag == 3 && bits == 32))) {
+                    throw std::runtime_error("'" + path_ + "': unsupported WAV encoding");
+                }
+                if (ch == 0 || ch > kMaxChannels) {
+                    throw std::runtime_error("'" + path_ + "': unsupported channel count " + std::to_string(ch));
+                }
+                if (sr == 0 || sr > kMaxRate) {
+                    throw std::runtime_error("'" + path_ + "': unsupported sample rate " + std::to_string(sr));
+                }
+                rate = static_cast<int>(sr);
+                channels = ch;
+                width_ = bits / 8;
+                have_fmt = true;
+                std::fseek(file_, static_cast<long>(size - want + (size % 2)), SEEK_CUR);
+            } else if (std::memcmp(id, "data", 4) == 0) {
+                if (!have_fmt) {
+                    throw std::runtime_error("'" + path_ + "': data chunk before fmt chunk");
+                }
+                remaining_ = size;
+                break;
+            } else {
+                std::fseek(file_, static_cast<long>(size) + (size % 2), SEEK_CUR);
+            }
+        }
+    }
+
+    std::string path_;
+    std::FILE* file_ = nullptr;
+    int width_ = 2;
+    bool is_float_ = false;
+    uint64_t remaining_ = 0;
+    std::vector<char> raw_;
+};
+
+#ifndef _WIN32
+// Raw PCM from a child process' stdout (e.g. pw-record / parec)
+class CommandSource : public Source {
+public:
+    explicit CommandSource(PyObject* spec) {
+        type = "command";
+        argv_ = spec_str_list(spec, "argv");
+        if (argv_.empty()) {
+            throw SpecError("'argv' must not be empty");
+        }
+        rate = static_cast<int>(spec_int(spec, "rate", 48000));
+        channels = static_cast<int>(spec_int(spec, "channels", 2));
+        format_ = parse_format(spec_str(spec, "format", "s16"));
+        chunk_frames_ = static_cast<size_t>(spec_int(spec, "chunk_frames", rate / 100));
+        require_positive(rate, "rate");
+        require_positive(channels, "channels");
+        require_positive(static_cast<double>(chunk_frames_), "chunk_frames");
+        if (pipe(wake_) != 0) {
+            throw std::runtime_error(std::string("pipe() failed: ") + std::strerror(errno));
+        }
+        for (int fd : wake_) {
+            fcntl(fd, F_SETFD, FD_CLOEXEC);
+            fcntl(fd, F_SETFL, O_NONBLOCK);
+        }
+    }
+
+    ~CommandSource() override {
+        close();
+        ::close(wake_[0]);
+        ::close(wake_[1]);
+    }
+
+    void open() override {
+        drain_wake();
+        int fds[2];
+        if (pipe(fds) != 0) {
+            throw std::runtime_error(std::string("pipe() failed: ") + std::strerror(errno));
+        }
+        std::vector<char*> args;
+        for (auto& arg : argv_) args.push_back(const_cast<char*>(arg.c_str()));
+        args.push_back(nullptr);
+
+        pid_ = fork();
+        if (pid_ < 0) {
+            ::close(fds[0]);
+            ::close(fds[1]);
+            throw std::runtime_error(std::string("fork() failed: ") + std::strerror(errno));
+        }
+        if (pid_ == 0) {
+            dup2(fds[1], STDOUT_FILENO);
+            ::close(fds[0]);
+            ::close(fds[1]);
+            execvp(args[0], args.data());
+            _exit(127);
+        }
+        ::close(fds[1]);
+        fd_ = fds[0];
+    }
+
+    bool read(AudioBlock& block) override {
+        size_t frame_bytes = static_cast<size_t>(format_width(format_)) * channels;
+        raw_.resize(chunk_frames_ * frame_bytes);
+        size_t got = 0;
+        while (got < raw_.size()) {
+            pollfd fds[2] = {{fd_, POLLIN, 0}, {wake_[0], POLLIN, 0}};
+            if (poll(fds, 2, -1) < 0) {
+                if (errno == EINTR) continue;
+                break;
+            }
+            if (fds[1].revents != 0) {
+                drain_wake();
+                return false;  // interrupt(): close() stops the child
+            }
+            ssize_t n = ::read(fd_, raw_.data() + got, raw_.size() - got);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) break;
+            got += static_cast<size_t>(n);
+        }
+        size_t frames = got / frame_bytes;
+        if (frames == 0) {
+            return false;
+        }
+        block.resize(frames, channels);
+        decode(raw_.data(), frames * channels, format_width(format_), format_ == SampleFormat::F32, block.samples.data());
+        return true;
+    }
+
+    // Only wakes read(); the child is signalled and reaped by close() on the
+    // pipeline thread, so pid_ is never shared with the control thread and a
+    // reaped (possibly reused) pid is never signalled
+    void interrupt() override {
+        char byte = 1;
+        ssize_t n = ::write(wake_[1], &byte, 1);
+        (void)n;  // A full pipe is already readable
+    }
+
+    void close() override {
+        if (fd_ >= 0) {
+            ::close(fd_);
+            fd_ = -1;
+        }
+        if (pid_ > 0) {
+            // A child that ignores SIGTERM must not hang stop() or dealloc
+            kill(pid_, SIGTERM);
+            auto deadline = Clock::now() + std::chrono::milliseconds(kTermGraceMs);
+            pid_t reaped = 0;
+            while ((reaped = waitpid(pid_, nullptr, WNOHANG)) == 0 && Clock::now() < deadline) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
+            if (reaped == 0) {
+                kill(pid_, SIGKILL);
+                waitpid(pid_, nullptr, 0);
+            }
+            pid_ = -1;
+        }
+    }
+
+private:
+    static constexpr int kTermGraceMs = 1000;
+
+    // Empty the non-blocking wake pipe so a stale interrupt cannot end a later read
+    void drain_wake() {
+        char buf[64];
+        while (::read(wake_[0], buf, sizeof(buf)) > 0) continue;
+    }
+
+    std::vector<std::string> argv_;
+    SampleFormat format_;
+    pid_t pid_ = -1;
+    int fd_ = -1;
+    int wake_[2] = {-1, -1};
+    std::vector<char> raw_;
+};
+#endif
+
+// ---------------------------------------------------------------------------
+// Stages
+// ---------------------------------------------------------------------------
+
+class Stage {
+public:
+    virtual ~Stage() = default;
+    // Receives the input format and updates it to the output format.
+    virtual void configure(int& rate, int& channels) {
+        rate_ = rate;
+        channels_ = channels;
+    }
+    virtual void process(AudioBlock& block, Context& ctx) = 0;
+    // Called once at end of stream with the (possibly empty) flushed output of
+    // the previous stages; stages holding back samples append them here.
+    virtual void flush(AudioBlock& block, Context& ctx) { process(block, ctx); }
+    // Algorithmic latency (lookahead) in milliseconds, valid after configure()
+    virtual double latency_ms() const { return 0.0; }
+
+    std::string type;
+    std::string name;
+    std::atomic<uint64_t> blocks{0};
+    std::atomic<uint64_t> total_ns{0};
+
+protected:
+    int rate_ = 0;
+    int channels_ = 0;
+};
+
+// Same mapping as AudioConverter._convert_channels
+class ChannelStage : public Stage {
+public:
+    explicit ChannelStage(PyObject* spec) {
+        out_channels_ = static_cast<int>(spec_int(spec, "channels", 2));
+        require_positive(out_channels_, "channels");
+    }
+
+    void configure(int& rate, int& channels) override {
+        Stage::configure(rate, channels);
+        channels = out_channels_;
+    }
+
+    void process(AudioBlock& block, Context&) override {
+        const int src = block.channels;
+        const int dst = out_channels_;
+        if (src == dst) return;
+        out_.resize(block.frames * dst);
+        for (size_t i = 0; i < block.frames; ++i) {
+            const float* in = &block.samples[i * src];
+            float* out = &out_[i * dst];
+            if (dst == 1) {
+                float sum = 0.0f;
+                for (int c = 0; c < src; ++c) sum += in[c];
+                out[0] = sum / src;
+            } else if (dst < src) {
+                for (int c = 0; c < dst - 1; ++c) out[c] = in[c];
+                float sum = 0.0f;
+                for (int c = dst - 1; c < src; ++c) sum += in[c];
+                out[dst - 1] = sum / (src - dst + 1);
+            } else {
+                for (int c = 0; c < src; ++c) out[c] = in[c];
+                for (int c = src; c < dst; ++c) out[c] = in[src - 1];
+            }
+        }
+        block.samples.swap(out_);
+        block.channels = dst;
+    }
+
+private:
+    int out_channels_;
+    std::vector<float> out_;
+};
+
+// Arbitrary-ratio windowed-sinc (Kaiser) resampler with a tabulated kernel
+class ResampleStage : public Stage {
+public:
+    explicit ResampleStage(PyObject* spec) {
+        out_rate_ = static_cast<int>(spec_int(spec, "rate", 48000));
+        require_positive(out_rate_, "rate");
+    }
+
+    void configure(int& rate, int& channels) override {
+        Stage::configure(rate, channels);
+        step_ = static_cast<double>(rate) / out_rate_;
+        cutoff_ = std::min(1.0, static_cast<double>(out_rate_) / rate);
+        half_width_ = static_cast<int>(std::ceil(kZeroCrossings / cutoff_));
+
+        table_.resize(kZeroCrossings * kPhases + 2);
+        const double beta = 8.0;
+        for (size_t i = 0; i < table_.size(); ++i) {
+            double x = static_cast<double>(i) / kPhases;
+            double r = x / kZeroCrossings;
+            double window = r < 1.0 ? bessel_i0(beta * std::sqrt(1.0 - r * r)) / bessel_i0(beta) : 0.0;
+            double sinc = x == 0.0 ? 1.0 : std::sin(kPi * x) / (kPi * x);
+            table_[i] = static_cast<float>(sinc * window);
+        }
+
+        // Zero history so the first output sample lines up with the first input sample
+        history_.assign(static_cast<size_t>(half_width_) * channels, 0.0f);
+        time_ = half_width_;
+        rate = out_rate_;
+    }
+
+    void process(AudioBlock& block, Context&) override {
+        if (rate_ == out_rate_) return;
+        const int ch = block.channels;
+        in_frames_ += block.frames;
+        history_.insert(history_.end(), block.samples.begin(), block.samples.end());
+        const size_t total = history_.size() / ch;
+
+        out_.clear();
+        std::vector<double> acc(ch);
+        while (time_ + half_width_ < static_cast<double>(total)) {
+            long n0 = static_cast<long>(std::floor(time_));
+            std::fill(acc.begin(), acc.end(), 0.0);
+            for (long k = n0 - half_width_ + 1; k <= n0 + half_width_; ++k) {
+                double w = kernel(std::fabs(time_ - k) * cutoff_) * cutoff_;
+                if (w == 0.0) continue;
+                const float* x = &history_[static_cast<size_t>(k) * ch];
+                for (int c = 0; c < ch; ++c) acc[c] += x[c] * w;
+            }
+            for (int c = 0; c < ch; ++c) out_.push_back(static_cast<float>(acc[c]));
+            time_ += step_;
+        }
+
+        // Keep only the history the next output samples still need
+        long drop = static_cast<long>(std::floor(time_)) - half_width_ + 1;
+        if (drop > 0) {
+            drop = std::min<long>(drop, static_cast<long>(total));
+            history_.erase(history_.begin(), history_.begin() + drop * ch);
+            time_ -= drop;
+        }
+
+        block.samples.swap(out_);
+        block.frames = block.samples.size() / ch;
+        out_frames_ += block.frames;
+    }
+
+    void flush(AudioBlock& block, Context& ctx) override {
+        if (rate_ == out_rate_) return;
+        // Push the kernel tail out with silence, then trim to the exact length
+        const uint64_t expected = (in_frames_ + block.frames) * out_rate_ / rate_;
+        block.samples.resize((block.frames + 2 * half_width_) * channels_, 0.0f);
+        block.frames += 2 * half_width_;
+        process(block, ctx);
+        in_frames_ -= 2 * half_width_;
+        const uint64_t excess = out_frames_ > expected ? out_frames_ - expected : 0;
+        const size_t keep = block.frames - static_cast<size_t>(std::min<uint64_t>(excess, block.frames));
+        out_frames_ -= block.frames - keep;
+        block.samples.resize(keep * channels_);
+        block.frames = keep;
+    }
+
+    // An output sample needs half_width_ input frames past its position
+    double latency_ms() const override {
+        return rate_ == out_rate_ ? 0.0 : 1000.0 * half_width_ / rate_;
+    }
+
+private:
+    static constexpr int kZeroCrossings = 16;
+    static constexpr int kPhases = 512;
+
+    static double bessel_i0(double x) {
+        double sum = 1.0, term = 1.0;
+        for (int k = 1; k < 50; ++k) {
+            term *= (x / (2.0 * k)) * (x / (2.0 * k));
+            sum += term;
+            if (term < 1e-12 * sum) break;
+        }
+        return sum;
+    }
+
+    double kernel(double x) const {
+        if (x >= kZeroCrossings) return 0.0;
+        double pos = x * kPhases;
+        size_t i = static_cast<size_t>(pos);
+        double f = pos - i;
+        return table_[i] * (1.0 - f) + table_[i + 1] * f;
+    }
+
+    int out_rate_;
+    double step_ = 1.0;
+    double cutoff_ = 1.0;
+    int half_width_ = kZeroCrossings;
+    double time_ = 0.0;
+    uint64_t in_frames_ = 0;
+    uint64_t out_frames_ = 0;
+    std::vector<float> table_;
+    std::vector<float> history_;
+    std::vector<float> out_;
+};
+
+class GainStage : public Stage {
+public:
+    explicit GainStage(PyObject* spec) {
+        gain_ = static_cast<float>(std::pow(10.0, spec_double(spec, "db", 0.0) / 20.0));
+    }
+
+    void process(AudioBlock& block, Context&) override {
+        for (float& x : block.samples) x *= gain_;
+    }
+
+private:
+    float gain_;
+};
+
+// Same first-order IIR as contrib.filters.HighPassFilter
+class HighPassStage : public Stage {
+public:
+    explicit HighPassStage(PyObject* spec) {
+        cutoff_ = spec_double(spec, "cutoff_hz", 120.0);
+        require_positive(cutoff_, "cutoff_hz");
+    }
+
+    void configure(int& rate, int& channels) override {
+        Stage::configure(rate, channels);
+        double rc = 1.0 / (2.0 * kPi * cutoff_);
+        double dt = 1.0 / rate;
+        alpha_ = static_cast<float>(rc / (rc + dt));
+        prev_in_.assign(channels, 0.0f);
+        prev_out_.assign(channels, 0.0f);
+    }
+
+    void process(AudioBlock& block, Context&) override {
+        const int ch = block.channels;
+        for (size_t i = 0; i < block.frames; ++i) {
+            float* x = &block.samples[i * ch];
+            for (int c = 0; c < ch; ++c) {
+                float y = alpha_ * (prev_out_[c] + x[c] - prev_in_[c]);
+                prev_in_[c] = x[c];
+                prev_out_[c] = y;
+                x[c] = y;
+            }
+        }
+    }
+
+private:
+    double cutoff_;
+    float alpha_ = 1.0f;
+    std::vector<float> prev_in_;
+    std::vector<float> prev_out_;
+};
+
+// Same first-order IIR as contrib.filters.LowPassFilter
+class LowPassStage : public Stage {
+public:
+    explicit LowPassStage(PyObject* spec) {
+        cutoff_ = spec_double(spec, "cutoff_hz", 8000.0);
+        require_positive(cutoff_, "cutoff_hz");
+    }
+
+    void configure(int& rate, int& channels) override {
+        Stage::configure(rate, channels);
+        double rc = 1.0 / (2.0 * kPi * cutoff_);
+        double dt = 1.0 / rate;
+        alpha_ = static_cast<float>(dt / (rc + dt));
+        prev_out_.assign(channels, 0.0f);
+    }
+
+    void process(AudioBlock& block, Context&) override {
+        const int ch = block.channels;
+        for (size_t i = 0; i < block.frames; ++i) {
+            float* x = &block.samples[i * ch];
+            for (int c = 0; c < ch; ++c) {
+                prev_out_[c] = alpha_ * x[c] + (1.0f - alpha_) * prev_out_[c];
+                x[c] = prev_out_[c];
+            }
+        }
+    }
+
+private:
+    double cutoff_;
+    float alpha_ = 1.0f;
+    std::vector<float> prev_out_;
+};
+
+// Emits a "meter" event with per-channel RMS / peak (dBFS) every interval
+class MeterStage : public Stage {
+public:
+    explicit MeterStage(PyObject* spec) {
+        interval_ms_ = spec_double(spec, "interval_ms", 100.0);
+        require_positive(interval_ms_, "interval_ms");
+    }
+
+    void configure(int& rate, int& channels) override {
+        Stage::configure(rate, channels);
+        interval_frames_ = std::max<uint64_t>(1, static_cast<uint64_t>(interval_ms_ * rate / 1000.0));
+        sum_sq_.assign(channels, 0.0);
+        peak_.assign(channels, 0.0);
+    }
+
+    void process(AudioBlock& block, Context& ctx) override {
+        const int ch = block.channels;
+        for (size_t i = 0; i < block.frames; ++i) {
+            const float* x = &block.samples[i * ch];
+            for (int c = 0; c < ch; ++c) {
+                double v = x[c];
+                sum_sq_[c] += v * v;
+                peak_[c] = std::max(peak_[c], std::fabs(v));
+            }
+            if (++count_ == interval_frames_) {
+                emit(ctx);
+            }
+        }
+    }
+
+private:
+    static double to_db(double x) { return 20.0 * std::log10(x + 1e-10); }
+
+    void emit(Context& ctx) {
+        Event event;
+        event.type = "meter";
+        event.stage = name;
+        event.time = ctx.now();
+        event.frame = ctx.frame;
+        std::vector<double> rms(sum_sq_.size()), peak(peak_.size());
+        for (size_t c = 0; c < sum_sq_.size(); ++c) {
+            rms[c] = to_db(std::sqrt(sum_sq_[c] / count_));
+            peak[c] = to_db(peak_[c]);
+        }
+        event.values.emplace_back("rms_db", std::move(rms));
+        event.values.emplace_back("peak_db", std::move(peak));
+        ctx.events->push(std::move(event));
+        std::fill(sum_sq_.begin(), sum_sq_.end(), 0.0);
+        std::fill(peak_.begin(), peak_.end(), 0.0);
+        count_ = 0;
+    }
+
+    double interval_ms_;
+    uint64_t interval_frames_ = 1;
+    uint64_t count_ = 0;
+    std::vector<double> sum_sq_;
+    std::vector<double> peak_;
+};
+
+// ---------------------------------------------------------------------------
+// Sinks
+// ---------------------------------------------------------------------------
+
+class Sink {
+public:
+    virtual ~Sink() = default;
+    virtual void open(int rate, int channels) = 0;
+    virtual void write(const AudioBlock& block) = 0;
+    virtual void close() {}
+
+    std::string type;
+    std::string name;
+    std::atomic<uint64_t> frames{0};
+    std::atomic<uint64_t> bytes{0};
+};
+
+class FileSink : public Sink {
+public:
+    FileSink(PyObject* spec, bool wav) : wav_(wav) {
+        type = wav ? "wav" : "raw";
+        path_ = spec_str(spec, "path", nullptr);
+        format_ = parse_format(spec_str(spec, "format", wav ? "s16" : "f32"));
+    }
+
+    ~FileSink() override { close(); }
+
+    void open(int rate, int channels) override {
+        file_ = std::fopen(path_.c_str(), "wb");
+        if (file_ == nullptr) {
+            throw std::runtime_error("cannot open '" + path_ + "' for writing");
+        }
+        rate_ = rate;
+        channels_ = channels;
+        data_bytes_ = 0;
+        if (wav_) write_header();
+    }
+
+    void write(const AudioBlock& block) override {
+        encode(block, format_, buffer_);
+        if (std::fwrite(buffer_.data(), 1, buffer_.size(), file_) != buffer_.size()) {
+            throw std::runtime_error("write to '" + path_ + "' failed");
+        }
+        data_bytes_ += buffer_.size();
+        frames += block.frames;
+        bytes += buffer_.size();
+    }
+
+    void close() override {
+        if (file_ == nullptr) return;
+        if (wav_) {
+            // Patch RIFF/data sizes now that the length is known
+            std::fseek(file_, 0, SEEK_SET);
+            write_header();
+        }
+        std::fclose(file_);
+        file_ = nullptr;
+    }
+
+private:
+    void write_header() {
+        auto u32 = [this](uint32_t v) { std::fwrite(&v, 4, 1, file_); };
+        auto u16 = [this](uint16_t v) { std::fwrite(&v, 2, 1, file_); };
+        const int width = format_width(format_);
+        uint32_t data = static_cast<uint32_t>(std::min<uint64_t>(data_bytes_, 0xFFFFFFFFu - 36));
+        std::fwrite("RIFF", 1, 4, file_);
+        u32(36 + data);
+        std::fwrite("WAVEfmt ", 1, 8, file_);
+        u32(16);
+        u16(format_ == SampleFormat::F32 ? 3 : 1);
+        u16(static_cast<uint16_t>(channels_));
+        u32(static_cast<uint32_t>(rate_));
+        u32(static_cast<uint32_t>(rate_ * channels_ * width));
+        u16(static_cast<uint16_t>(channels_ * width));
+        u16(static_cast<uint16_t>(width * 8));
+        std::fwrite("data", 1, 4, file_);
+        u32(data);
+    }
+
+    bool wav_;
+    std::string path_;
+    SampleFormat format_;
+    std::FILE* file_ = nullptr;
+    int rate_ = 0;
+    int channels_ = 0;
+    uint64_t data_bytes_ = 0;
+    std::vector<char> buffer_;
+};
+
+class NullSink : public Sink {
+public:
+    NullSink() { type = "null"; }
+    void open(int, int) override {}
+    void write(const AudioBlock& block) override { frames += block.frames; }
+};
+
+// ---------------------------------------------------------------------------
+// Pipeline
+// ---------------------------------------------------------------------------
+
+enum class State { Idle, Running, Finished, Stopped, Error };
+
+const char* state_name(State state) {
+    switch (state) {
+        case State::Idle: return "idle";
+        case State::Running: return "running";
+        case State::Finished: return "finished";
+        case State::Stopped: return "stopped";
+        case State::Error: return "error";
+    }
+    return "unknown";
+}
+
+std::unique_ptr<Source> make_source(PyObject* spec) {
+    std::string type = spec_str(spec, "type", nullptr);
+    if (type == "synthetic") return std::make_unique<SyntheticSource>(spec);
+    if (type == "wav") return std::make_unique<WavSource>(spec);
+#ifndef _WIN32
+    if (type == "command") return std::make_unique<CommandSource>(spec);
+#endif
+    throw SpecError("unknown source type '" + type + "'");
+}
+
+std::unique_ptr<Stage> make_stage(PyObject* spec) {
+    std::string type = spec_str(spec, "type", nullptr);
+    std::unique_ptr<Stage> stage;
+    if (type == "channels") stage = std::make_unique<ChannelStage>(spec);
+    else if (type == "resample") stage = std::make_unique<ResampleStage>(spec);
+    else if (type == "gain") stage = std::make_unique<GainStage>(spec);
+    else if (type == "highpass") stage = std::make_unique<HighPassStage>(spec);
+    else if (type == "lowpass") stage = std::make_unique<LowPassStage>(spec);
+    else if (type == "meter") stage = std::make_unique<MeterStage>(spec);
+    else throw SpecError("unknown stage type '" + type + "'");
+    stage->type = type;
+    return stage;
+}
+
+std::unique_ptr<Sink> make_sink(PyObject* spec) {
+    std::string type = spec_str(spec, "type", nullptr);
+    if (type == "wav") return std::make_unique<FileSink>(spec, true);
+    if (type == "raw") return std::make_unique<FileSink>(spec, false);
+    if (type == "null") return std::make_unique<NullSink>();
+    throw SpecError("unknown sink type '" + type + "'");
+}
+
+class Pipeline {
+public:
+    explicit Pipeline(PyObject* spec) : events(static_cast<size_t>(std::max(16L, spec_int(spec, "event_queue", 1024)))) {
+        PyObject* source_spec = spec_item(spec, "source");
+        if (source_spec == nullptr || !PyDict_Check(source_spec)) {
+            throw SpecError("'source' must be a dict");
+        }
+        source = make_source(source_spec);
+
+        int rate = source->rate;
+        int channels = source->channels;
+        PyObject* stage_specs = spec_item(spec, "stages");
+        if (stage_specs != nullptr && stage_specs != Py_None) {
+            if (!PyList_Check(stage_specs)) throw SpecError("'stages' must be a list");
+            for (Py_ssize_t i = 0; i < PyList_Size(stage_specs); ++i) {
+                PyObject* stage_spec = PyList_GetItem(stage_specs, i);
+                if (!PyDict_Check(stage_spec)) throw SpecError("each stage must be a dict");
+                auto stage = make_stage(stage_spec);
+                stage->name = spec_str(stage_spec, "name", (stage->type + std::to_string(i)).c_str());
+                stage->configure(rate, channels);
+                stages.push_back(std::move(stage));
+            }
+        }
+        out_rate = rate;
+        out_channels = channels;
+
+        PyObject* sink_specs = spec_item(spec, "sinks");
+        if (sink_specs == nullptr || !PyList_Check(sink_specs) || PyList_Size(sink_specs) == 0) {
+            throw SpecError("'sinks' must be a non-empty list");
+        }
+        for (Py_ssize_t i = 0; i < PyList_Size(sink_specs); ++i) {
+            PyObject* sink_spec = PyList_GetItem(sink_specs, i);
+            if (!PyDict_Check(sink_spec)) throw SpecError("each sink must be a dict");
+            auto sink = make_sink(sink_spec);
+            sink->name = spec_str(sink_spec, "name", (sink->type + std::to_string(i)).c_str());
+            sinks.push_back(std::move(sink));
+        }
+    }
+
+    ~Pipeline() { stop(); }
+
+    void start() {
+        if (state != State::Idle) {
+            throw std::runtime_error("pipeline can only be started once");
+        }
+        source->open();
+        try {
+            for (auto& sink : sinks) sink->open(out_rate, out_channels);
+        } catch (...) {
+            // Don't leave a command child running until dealloc
+            for (auto& sink : sinks) sink->close();
+            source->close();
+            throw;
+        }
+        context.events = &events;
+        context.start = Clock::now();
+        state = State::Running;
+        thread = std::thread(&Pipeline::run, this);
+    }
+
+    void stop() {
+        stop_requested = true;
+        if (source) source->interrupt();
+        if (thread.joinable()) thread.join();
+    }
+
+    bool wait(double timeout) {
+        std::unique_lock<std::mutex> lock(done_mutex);
+        auto done = [this] { return state != State::Running; };
+        if (timeout < 0) {
+            done_cv.wait(lock, done);
+            return true;
+        }
+        return done_cv.wait_for(lock, std::chrono::duration<double>(timeout), done);
+    }
+
+    std::string error_message() {
+        std::lock_guard<std::mutex> lock(done_mutex);
+        return error;
+    }
+
+    std::unique_ptr<Source> source;
+    std::vector<std::unique_ptr<Stage>> stages;
+    std::vector<std::unique_ptr<Sink>> sinks;
+    EventQueue events;
+    Context context;
+    std::atomic<State> state{State::Idle};
+    std::atomic<bool> stop_requested{false};
+    std::atomic<uint64_t> frames_in{0};
+    std::atomic<uint64_t> frames_out{0};
+    std::atomic<uint64_t> blocks{0};
+    std::atomic<double> elapsed{0.0};
+    int out_rate = 0;
+    int out_channels = 0;
+
+private:
+    void run() {
+        push_event("started", "");
+        State final_state = State::Finished;
+        std::string message;
+        AudioBlock block;
+        try {
+            while (!stop_requested) {
+                if (!source->read(block)) break;
+                uint64_t in_frames = block.frames;
+                for (auto& stage : stages) {
+                    auto t0 = Clock::now();
+                    stage->process(block, context);
+                    stage->total_ns += static_cast<uint64_t>(
+                        std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - t0).count());
+                    ++stage->blocks;
+                }
+                for (auto& sink : sinks) sink->write(block);
+                context.frame += in_frames;
+                frames_in += in_frames;
+                frames_out += block.frames;
+                ++blocks;
+            }
+            if (stop_requested) {
+                final_state = State::Stopped;
+            } else {
+                block.resize(0, source->channels);
+                for (auto& stage : stages) stage->flush(block, context);
+                if (block.frames > 0) {
+                    for (auto& sink : sinks) sink->write(block);
+                    frames_out += block.frames;
+                }
+            }
+        } catch (const std::exception& e) {
+            final_state = State::Error;
+            message = e.what();
+        }
+
+        source->close();
+        for (auto& sink : sinks) {
+            try {
+                sink->close();
+            } catch (const std::exception& e) {
+                final_state = State::Error;
+                message = e.what();
+            }
+        }
+        elapsed = context.now();
+
+        push_event(state_name(final_state), message);
+        {
+            std::lock_guard<std::mutex> lock(done_mutex);
+            error = message;
+            state = final_state;
+        }
+        done_cv.notify_all();
+    }
+
+    void push_event(const char* type, const std::string& message) {
+        Event event;
+        event.type = type;
+        event.message = message;
+        event.time = context.now();
+        event.frame = context.frame;
+        events.push(std::move(event));
+    }
+
+    std::thread thread;
+    std::mutex done_mutex;
+    std::condition_variable done_cv;
+    std::string error;
+};
+
+// ---------------------------------------------------------------------------
+// JACK capture ring
+// ---------------------------------------------------------------------------
+
+// jack_port_get_buffer(), resolved by the caller (ctypes) so this module does
+// not link against libjack
+typedef void* (*PortGetBufferFn)(void* port, uint32_t nframes);
+
+/**
+ * Single-producer/single-consumer ring fed directly by a JACK process
+ * callback (see jack_ring_process).
+ *
+ * The producer runs on JACK's realtime thread: it never takes the GIL,
+ * never allocates and never blocks - the reader is woken with try_lock, the
+ * usual pattern for JACK clients. Positions are monotonic frame counters and
+ * each side only advances its own.
+ */
+class JackRing {
+public:
+    JackRing(std::vector<void*> ports, size_t capacity, PortGetBufferFn get_buffer)
+        : channels(ports.size()),
+          capacity(capacity),
+          ports_(std::move(ports)),
+          inputs_(channels, nullptr),
+          get_buffer_(get_buffer),
+          buffer_(capacity * channels, 0.0f) {}
+
+    // Realtime thread: copy one period from the ports
+    int process(uint32_t nframes) {
+        for (size_t ch = 0; ch < channels; ++ch) {
+            inputs_[ch] = static_cast<const float*>(get_buffer_(ports_[ch], nframes));
+            if (inputs_[ch] == nullptr) return 0;
+        }
+        write(inputs_.data(), nframes);
+        if (mutex_.try_lock()) {
+            ready_.notify_one();
+            mutex_.unlock();
+        }
+        return 0;
+    }
+
+    // Producer: interleave per-channel buffers; frames that do not fit are dropped
+    size_t write(const float* const* inputs, size_t nframes) {
+        uint64_t w = write_pos_.load(std::memory_order_relaxed);
+        uint64_t r = read_pos_.load(std::memory_order_acquire);
+        size_t free = capacity - static_cast<size_t>(w - r);
+        if (nframes > free) {
+            overruns.fetch_add(1, std::memory_order_relaxed);
+            nframes = free;
+        }
+        size_t start = static_cast<size_t>(w % capacity);
+        size_t first = std::min(nframes, capacity - start);
+        for (size_t ch = 0; ch < channels; ++ch) {
+            const float* in = inputs[ch];
+            float* out = buffer_.data() + start * channels + ch;
+            for (size_t i = 0; i < first; ++i) out[i * channels] = in[i];
+            out = buffer_.data() + ch;
+            for (size_t i = first; i < nframes; ++i) out[(i - first) * channels] = in[i];
+        }
+        write_pos_.store(w + nframes, std::memory_order_release);
+        return nframes;
+    }
+
+    size_t available() const {
+        return static_cast<size_t>(
+            write_pos_.load(std::memory_order_acquire) - read_pos_.load(std::memory_order_relaxed));
+    }
+
+    // Consumer: copy up to max_frames interleaved frames to out
+    size_t read(float* out, size_t max_frames) {
+        uint64_t r = read_pos_.load(std::memory_order_relaxed);
+        size_t count = std::min(available(), max_frames);
+        size_t start = static_cast<size_t>(r % capacity);
+        size_t first = std::min(count, capacity - start);
+        std::memcpy(out, buffer_.data() + start * channels, first * channels * sizeof(float));
+        std::memcpy(out + first * channels, buffer_.data(), (count - first) * channels * sizeof(float));
+        read_pos_.store(r + count, std::memory_order_release);
+        return count;
+    }
+
+    // Consumer: wait until frames are available (or wake() was called).
+    // Waits in short slices, since a notification is skipped whenever the
+    // producer's try_lock loses against the waiter.
+    bool wait(double timeout) {
+        using Clock = std::chrono::steady_clock;
+        auto deadline = Clock::now() +
+            std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(std::max(timeout, 0.0)));
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (available() == 0 && !woken_) {
+            auto now = Clock::now();
+            if (now >= deadline) break;
+            ready_.wait_for(lock, std::min<Clock::duration>(deadline - now, std::chrono::milliseconds(5)));
+        }
+        woken_ = false;
+        return available() > 0;
+    }
+
+    // Wake a waiting reader (e.g. on server shutdown); not for the RT thread
+    void wake() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        woken_ = true;
+        ready_.notify_all();
+    }
+
+    const size_t channels;
+    const size_t capacity;
+    std::atomic<uint64_t> overruns{0};
+
+private:
+    const std::vector<void*> ports_;
+    std::vector<const float*> inputs_;  // Scratch, RT thread only
+    PortGetBufferFn get_buffer_;
+    std::vector<float> buffer_;
+    std::atomic<uint64_t> write_pos_{0};
+    std::atomic<uint64_t> read_pos_{0};
+    std::mutex mutex_;
+    std::condition_variable ready_;
+    bool woken_ = false;
+};
+
+// JackProcessCallback: int (*)(jack_nframes_t, void*)
+int jack_ring_process(uint32_t nframes, void* arg) {
+    return static_cast<JackRing*>(arg)->process(nframes);
+}
+
+}  // namespace
+
+// ---------------------------------------------------------------------------
+// Python bindings
+// ---------------------------------------------------------------------------
+
+typedef struct {
+    PyObject_HEAD
+    Pipeline* pipeline;
+} PipelineObject;
+
+static void Pipeline_dealloc(PipelineObject* self) {
+    if (self->pipeline != nullptr) {
+        Py_BEGIN_ALLOW_THREADS
+        delete self->pipeline;
+        Py_END_ALLOW_THREADS
+        self->pipeline = nullptr;
+    }
+    Py_TYPE(self)->tp_free((PyObject*)self);
+}
+
+static PyObject* Pipeline_new(PyTypeObject* type, PyObject* args, PyObject* kwds) {
+    PipelineObject* self = (PipelineObject*)type->tp_alloc(type, 0);
+    if (self != nullptr) {
+        self->pipeline = nullptr;
+    }
+    return (PyObject*)self;
+}
+
+static int Pipeline_init(PipelineObject* self, PyObject* args, PyObject* kwds) {
+    PyObject* spec;
+    if (!PyArg_ParseTuple(args, "O!", &PyDict_Type, &spec)) {
+        return -1;
+    }
+    Pipeline* pipeline;
+    try {
+        pipeline = new Pipeline(spec);
+    } catch (const SpecError& e) {
+        PyErr_Format(PyExc_ValueError, "Invalid pipeline spec: %s", e.what());
+        return -1;
+    } catch (const std::exception& e) {
+        PyErr_SetString(PyExc_RuntimeError, e.what());
+        return -1;
+    }
+    // __init__ called again: release (and stop) the previous pipeline
+    Pipeline* previous = self->pipeline;
+    self->pipeline = pipeline;
+    if (previous != nullptr) {
+        Py_BEGIN_ALLOW_THREADS
+        delete previous;
+        Py_END_ALLOW_THREADS
+    }
+    return 0;
+}
+
+static bool check_pipeline(PipelineObject* self) {
+    if (self->pipeline == nullptr) {
+        PyErr_SetString(PyExc_RuntimeError, "Pipeline is not initialized");
+        return false;
+    }
+    return true;
+}
+
+static PyObject* Pipeline_start(PipelineObject* self, PyObject* Py_UNUSED(ignored)) {
+    if (!check_pipeline(self)) return nullptr;
+    try {
+        self->pipeline->start();
+    } catch (const std::exception& e) {
+        PyErr_Format(PyExc_RuntimeError, "Failed to start pipeline: %s", e.what());
+        return nullptr;
+    }
+    Py_RETURN_NONE;
+}
+
+static PyObject* Pipeline_stop(PipelineObject* self, PyObject* Py_UNUSED(ignored)) {
+    if (!check_pipeline(self)) return nullptr;
+    Py_BEGIN_ALLOW_THREADS
+    self->pipeline->stop();
+    Py_END_ALLOW_THREADS
+    Py_RETURN_NONE;
+}
+
+static PyObject* Pipeline_wait(PipelineObject* self, PyObject* args) {
+    double timeout = -1.0;
+    if (!PyArg_ParseTuple(args, "|d", &timeout)) return nullptr;
+    if (!check_pipeline(self)) return nullptr;
+    bool done;
+    Py_BEGIN_ALLOW_THREADS
+    done = self->pipeline->wait(timeout);
+    Py_END_ALLOW_THREADS
+    return PyBool_FromLong(done ? 1 : 0);
+}
+
+static PyObject* event_to_dict(const Event& event) {
+    PyObject* dict = Py_BuildValue("{s:s,s:d,s:K}",
+        "type", event.type.c_str(),
+        "time", event.time,
+        "frame", (unsigned long long)event.frame);
+    if (dict == nullptr) return nullptr;
+    if (!event.stage.empty()) {
+        PyObject* s = PyUnicode_FromString(event.stage.c_str());
+        PyDict_SetItemString(dict, "stage", s);
+        Py_XDECREF(s);
+    }
+    if (!event.message.empty()) {
+        PyObject* s = PyUnicode_FromString(event.message.c_str());
+        PyDict_SetItemString(dict, "message", s);
+        Py_XDECREF(s);
+    }
+    for (const auto& field : event.values) {
+        PyObject* list = PyList_New((Py_ssize_t)field.second.size());
+        for (size_t i = 0; i < field.second.size(); ++i) {
+            PyList_SET_ITEM(list, (Py_ssize_t)i, PyFloat_FromDouble(field.second[i]));
+        }
+        PyDict_SetItemString(dict, field.first.c_str(), list);
+        Py_DECREF(list);
+    }
+    return dict;
+}
+
+static PyObject* Pipeline_poll_events(PipelineObject* self, PyObject* args) {
+    double timeout = 0.0;
+    if (!PyArg_ParseTuple(args, "|d", &timeout)) return nullptr;
+    if (!check_pipeline(self)) return nullptr;
+
+    std::vector<Event> events;
+    Py_BEGIN_ALLOW_THREADS
+    events = self->pipeline->events.pop_all(timeout);
+    Py_END_ALLOW_THREADS
+
+    PyObject* list = PyList_New((Py_ssize_t)events.size());
+    if (list == nullptr) return nullptr;
+    for (size_t i = 0; i < events.size(); ++i) {
+        PyObject* dict = event_to_dict(events[i]);
+        if (dict == nullptr) {
+            Py_DECREF(list);
+            return nullptr;
+        }
+        PyList_SET_ITEM(list, (Py_ssize_t)i, dict);
+    }
+    return list;
+}
+
+static PyObject* Pipeline_stats(PipelineObject* self, PyObject* Py_UNUSED(ignored)) {
+    if (!check_pipeline(self)) return nullptr;
+    Pipeline* p = self->pipeline;
+
+    State state = p->state;
+    double elapsed = state == State::Running ? p->context.now() : p->elapsed.load();
+    std::string error = p->error_message();
+
+    double latency = p->source->latency_ms();
+    PyObject* stages = PyList_New(0);
+    for (const auto& stage : p->stages) {
+        latency += stage->latency_ms();
+        PyObject* s = Py_BuildValue("{s:s,s:s,s:K,s:K,s:d}",
+            "name", stage->name.c_str(),
+            "type", stage->type.c_str(),
+            "blocks", (unsigned long long)stage->blocks.load(),
+            "total_ns", (unsigned long long)stage->total_ns.load(),
+            "latency_ms", stage->latency_ms());
+        PyList_Append(stages, s);
+        Py_XDECREF(s);
+    }
+    PyObject* sinks = PyList_New(0);
+    for (const auto& sink : p->sinks) {
+        PyObject* s = Py_BuildValue("{s:s,s:s,s:K,s:K}",
+            "name", sink->name.c_str(),
+            "type", sink->type.c_str(),
+            "frames", (unsigned long long)sink->frames.load(),
+            "bytes", (unsigned long long)sink->bytes.load());
+        PyList_Append(sinks, s);
+        Py_XDECREF(s);
+    }
+
+    PyObject* result = Py_BuildValue("{s:s,s:K,s:K,s:K,s:K,s:d,s:i,s:i,s:d,s:d,s:N,s:N}",
+        "state", state_name(state),
+        "frames_in", (unsigned long long)p->frames_in.load(),
+        "frames_out", (unsigned long long)p->frames_out.load(),
+        "blocks", (unsigned long long)p->blocks.load(),
+        "events_dropped", (unsigned long long)p->events.dropped(),
+        "elapsed", elapsed,
+        "output_rate", p->out_rate,
+        "output_channels", p->out_channels,
+        "source_latency_ms", p->source->latency_ms(),
+        "latency_ms", latency,
+        "stages", stages,
+        "sinks", sinks);
+    if (result != nullptr && !error.empty()) {
+        PyObject* s = PyUnicode_FromString(error.c_str());
+        PyDict_SetItemString(result, "error", s);
+        Py_XDECREF(s);
+    }
+    return result;
+}
+
+static PyObject* Pipeline_get_format(PipelineObject* self, PyObject* Py_UNUSED(ignored)) {
+    if (!check_pipeline(self)) return nullptr;
+    return Py_BuildValue("{s:i,s:i,s:i,s:i}",
+        "source_rate", self->pipeline->source->rate,
+        "source_channels", self->pipeline->source->channels,
+        "sample_rate", self->pipeline->out_rate,
+        "channels", self->pipeline->out_channels);
+}
+
+static PyMethodDef Pipeline_methods[] = {
+    {"start", (PyCFunction)Pipeline_start, METH_NOARGS, "Open source and sinks and start the native thread"},
+    {"stop", (PyCFunction)Pipeline_stop, METH_NOARGS, "Stop the native thread and close sinks"},
+    {"wait", (PyCFunction)Pipeline_wait, METH_VARARGS, "Wait until the pipeline is no longer running"},
+    {"poll_events", (PyCFunction)Pipeline_poll_events, METH_VARARGS, "Get pending control events"},
+    {"stats", (PyCFunction)Pipeline_stats, METH_NOARGS, "Get pipeline statistics"},
+    {"get_format", (PyCFunction)Pipeline_get_format, METH_NOARGS, "Get source and output format"},
+    {nullptr}
+};
+
+static PyTypeObject PipelineType = {
+    PyVarObject_HEAD_INIT(nullptr, 0)
+    /* tp_name */ "proctap._pipeline.Pipeline",
+    /* tp_basicsize */ sizeof(PipelineObject),
+    /* tp_itemsize */ 0,
+    /* tp_dealloc */ (destructor)Pipeline_dealloc,
+    /* tp_vectorcall_offset */ 0,
+    /* tp_getattr */ nullptr,
+    /* tp_setattr */ nullptr,
+    /* tp_as_async */ nullptr,
+    /* tp_repr */ nullptr,
+    /* tp_as_number */ nullptr,
+    /* tp_as_sequence */ nullptr,
+    /* tp_as_mapping */ nullptr,
+    /* tp_hash */ nullptr,
+    /* tp_call */ nullptr,
+    /* tp_str */ nullptr,
+    /* tp_getattro */ nullptr,
+    /* tp_setattro */ nullptr,
+    /* tp_as_buffer */ nullptr,
+    /* tp_flags */ Py_TPFLAGS_DEFAULT,
+    /* tp_doc */ "Native audio pipeline built from a spec dict",
+    /* tp_traverse */ nullptr,
+    /* tp_clear */ nullptr,
+    /* tp_richcompare */ nullptr,
+    /* tp_weaklistoffset */ 0,
+    /* tp_iter */ nullptr,
+    /* tp_iternext */ nullptr,
+    /* tp_methods */ Pipeline_methods,
+    /* tp_members */ nullptr,
+    /* tp_getset */ nullptr,
+    /* tp_base */ nullptr,
+    /* tp_dict */ nullptr,
+    /* tp_descr_get */ nullptr,
+    /* tp_descr_set */ nullptr,
+    /* tp_dictoffset */ 0,
+    /* tp_init */ (initproc)Pipeline_init,
+    /* tp_alloc */ nullptr,
+    /* tp_new */ Pipeline_new,
+};
+
+typedef struct {
+    PyObject_HEAD
+    JackRing* ring;
+} JackRingObject;
+
+static void JackRing_dealloc(JackRingObject* self) {
+    delete self->ring;
+    self->ring = nullptr;
+    Py_TYPE(self)->tp_free((PyObject*)self);
+}
+
+static PyObject* JackRing_new(PyTypeObject* type, PyObject* args, PyObject* kwds) {
+    JackRingObject* self = (JackRingObject*)type->tp_alloc(type, 0);
+    if (self != nullptr) {
+        self->ring = nullptr;
+    }
+    return (PyObject*)self;
+}
+
+static int JackRing_init(JackRingObject* self, PyObject* args, PyObject* kwds) {
+    static const char* kwlist[] = {"ports", "capacity_frames", "port_get_buffer", nullptr};
+    PyObject* ports_obj;
+    Py_ssize_t capacity;
+    PyObject* get_buffer_obj;
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "OnO", (char**)kwlist,
+                                     &ports_obj, &capacity, &get_buffer_obj)) {
+        return -1;
+    }
+    if (self->ring != nullptr) {
+        PyErr_SetString(PyExc_RuntimeError, "JackRing is already initialized");
+        return -1;
+    }
+
+    PyObject* seq = PySequence_Fast(ports_obj, "ports must be a sequence of port addresses");
+    if (seq == nullptr) return -1;
+    std::vector<void*> ports;
+    for (Py_ssize_t i = 0; i < PySequence_Fast_GET_SIZE(seq); ++i) {
+        void* port = PyLong_AsVoidPtr(PySequence_Fast_GET_ITEM(seq, i));
+        if (port == nullptr) {
+            Py_DECREF(seq);
+            if (!PyErr_Occurred()) PyErr_SetString(PyExc_ValueError, "Port address must not be 0");
+            return -1;
+        }
+        ports.push_back(port);
+    }
+    Py_DECREF(seq);
+
+    void* get_buffer = PyLong_AsVoidPtr(get_buffer_obj);
+    if (get_buffer == nullptr) {
+        if (!PyErr_Occurred()) PyErr_SetString(PyExc_ValueError, "port_get_buffer must not be 0");
+        return -1;
+    }
+    if (ports.empty() || capacity < 1) {
+        PyErr_SetString(PyExc_ValueError, "JackRing needs at least one port and one frame of capacity");
+        return -1;
+    }
+    self->ring = new JackRing(std::move(ports), (size_t)capacity, (PortGetBufferFn)get_buffer);
+    return 0;
+}
+
+static bool check_ring(JackRingObject* self) {
+    if (self->ring == nullptr) {
+        PyErr_SetString(PyExc_RuntimeError, "JackRing is not initialized");
+        return false;
+    }
+    return true;
+}
+
+static PyObject* JackRing_read(JackRingObject* self, PyObject* args) {
+    Py_ssize_t max_frames = -1;
+    if (!PyArg_ParseTuple(args, "|n", &max_frames)) return nullptr;
+    if (!check_ring(self)) return nullptr;
+
+    JackRing* ring = self->ring;
+    size_t count = ring->available();
+    if (max_frames >= 0) count = std::min(count, (size_t)max_frames);
+    if (count == 0) Py_RETURN_NONE;
+
+    PyObject* data = PyBytes_FromStringAndSize(nullptr, (Py_ssize_t)(count * ring->channels * sizeof(float)));
+    if (data == nullptr) return nullptr;
+    ring->read(reinterpret_cast<float*>(PyBytes_AS_STRING(data)), count);
+    return data;
+}
+
+static PyObject* JackRing_wait(JackRingObject* self, PyObject* args) {
+    double timeout;
+    if (!PyArg_ParseTuple(args, "d", &timeout)) return nullptr;
+    if (!check_ring(self)) return nullptr;
+    bool ready;
+    Py_BEGIN_ALLOW_THREADS
+    ready = self->ring->wait(timeout);
+    Py_END_ALLOW_THREADS
+    return PyBool_FromLong(ready ? 1 : 0);
+}
+
+static PyObject* JackRing_wake(JackRingObject* self, PyObject* Py_UNUSED(ignored)) {
+    if (!check_ring(self)) return nullptr;
+    self->ring->wake();
+    Py_RETURN_NONE;
+}
+
+static PyObject* JackRing_get_available(JackRingObject* self, void* Py_UNUSED(closure)) {
+    if (!check_ring(self)) return nullptr;
+    return PyLong_FromSize_t(self->ring->available());
+}
+
+static PyObject* JackRing_get_overruns(JackRingObject* self, void* Py_UNUSED(closure)) {
+    if (!check_ring(self)) return nullptr;
+    return PyLong_FromUnsignedLongLong(self->ring->overruns.load());
+}
+
+static PyObject* JackRing_get_channels(JackRingObject* self, void* Py_UNUSED(closure)) {
+    if (!check_ring(self)) return nullptr;
+    return PyLong_FromSize_t(self->ring->channels);
+}
+
+static PyObject* JackRing_get_process_callback(JackRingObject* self, void* Py_UNUSED(closure)) {
+    return PyLong_FromVoidPtr((void*)&jack_ring_process);
+}
+
+static PyObject* JackRing_get_process_arg(JackRingObject* self, void* Py_UNUSED(closure)) {
+    if (!check_ring(self)) return nullptr;
+    return PyLong_FromVoidPtr(self->ring);
+}
+
+static PyMethodDef JackRing_methods[] = {
+    {"read", (PyCFunction)JackRing_read, METH_VARARGS, "Read interleaved float32 frames (None if empty)"},
+    {"wait", (PyCFunction)JackRing_wait, METH_VARARGS, "Wait until frames are available"},
+    {"wake", (PyCFunction)JackRing_wake, METH_NOARGS, "Wake a waiting reader"},
+    {nullptr}
+};
+
+static PyGetSetDef JackRing_getset[] = {
+    {"available", (getter)JackRing_get_available, nullptr, "Frames ready to be read", nullptr},
+    {"overruns", (getter)JackRing_get_overruns, nullptr, "Periods that did not fit the ring", nullptr},
+    {"channels", (getter)JackRing_get_channels, nullptr, "Number of interleaved channels", nullptr},
+    {"process_callback", (getter)JackRing_get_process_callback, nullptr, "Address of the JACK process callback", nullptr},
+    {"process_arg", (getter)JackRing_get_process_arg, nullptr, "Address to pass as the callback argument", nullptr},
+    {nullptr}
+};
+
+static PyTypeObject JackRingType = {
+    PyVarObject_HEAD_INIT(nullptr, 0)
+    /* tp_name */ "proctap._pipeline.JackRing",
+    /* tp_basicsize */ sizeof(JackRingObject),
+    /* tp_itemsize */ 0,
+    /* tp_dealloc */ (destructor)JackRing_dealloc,
+    /* tp_vectorcall_offset */ 0,
+    /* tp_getattr */ nullptr,
+    /* tp_setattr */ nullptr,
+    /* tp_as_async */ nullptr,
+    /* tp_repr */ nullptr,
+    /* tp_as_number */ nullptr,
+    /* tp_as_sequence */ nullptr,
+    /* tp_as_mapping */ nullptr,
+    /* tp_hash */ nullptr,
+    /* tp_call */ nullptr,
+    /* tp_str */ nullptr,
+    /* tp_getattro */ nullptr,
+    /* tp_setattro */ nullptr,
+    /* tp_as_buffer */ nullptr,
+    /* tp_flags */ Py_TPFLAGS_DEFAULT,
+    /* tp_doc */ "Lock-free ring fed by a native JACK process callback",
+    /* tp_traverse */ nullptr,
+    /* tp_clear */ nullptr,
+    /* tp_richcompare */ nullptr,
+    /* tp_weaklistoffset */ 0,
+    /* tp_iter */ nullptr,
+    /* tp_iternext */ nullptr,
+    /* tp_methods */ JackRing_methods,
+    /* tp_members */ nullptr,
+    /* tp_getset */ JackRing_getset,
+    /* tp_base */ nullptr,
+    /* tp_dict */ nullptr,
+    /* tp_descr_get */ nullptr,
+    /* tp_descr_set */ nullptr,
+    /* tp_dictoffset */ 0,
+    /* tp_init */ (initproc)JackRing_init,
+    /* tp_alloc */ nullptr,
+    /* tp_new */ JackRing_new,
+};
+
+static struct PyModuleDef pipeline_module = {
+    PyModuleDef_HEAD_INIT,
+    "_pipeline",
+    "Native audio pipeline runtime",
+    -1,
+    nullptr
+};
+
+PyMODINIT_FUNC PyInit__pipeline(void)
+{
+    PyObject* m;
+
+    if (PyType_Ready(&PipelineType) < 0 || PyType_Ready(&JackRingType) < 0) {
+        return nullptr;
+    }
+
+    m = PyModule_Create(&pipeline_module);
+    if (m == nullptr) {
+        return nullptr;
+    }
+
+    Py_INCREF(&PipelineType);
+    if (PyModule_AddObject(m, "Pipeline", (PyObject*)&PipelineType) < 0) {
+        Py_DECREF(&PipelineType);
+        Py_DECREF(m);
+        return nullptr;
+    }
+
+    Py_INCREF(&JackRingType);
+    if (PyModule_AddObject(m, "JackRing", (PyObject*)&JackRingType) < 0) {
+        Py_DECREF(&JackRingType);
+        Py_DECREF(m);
+        return nullptr;
+    }
+
+    return m;
+}
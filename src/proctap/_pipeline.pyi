@@ -0,0 +1,141 @@
+"""Type stubs for _pipeline C++ extension module."""
+
+from typing import Any
+
+class Pipeline:
+    """
+    Native audio pipeline built from a spec dict.
+
+    Runs source -> stages -> sinks on a native thread that never takes the
+    GIL. See proctap.pipeline for the spec format.
+    """
+
+    def __init__(self, spec: dict[str, Any]) -> None:
+        """
+        Build the pipeline.
+
+        Args:
+            spec: Dict with 'source', 'stages', 'sinks' (and optional 'event_queue')
+
+        Raises:
+            ValueError: If the spec is invalid
+            RuntimeError: If a source cannot be opened (e.g. missing WAV file)
+        """
+        ...
+
+    def start(self) -> None:
+        """
+        Open source and sinks and start the native thread.
+
+        Raises:
+            RuntimeError: If opening fails or the pipeline was already started
+        """
+        ...
+
+    def stop(self) -> None:
+        """Stop the native thread and finalize sinks."""
+        ...
+
+    def wait(self, timeout: float = -1.0) -> bool:
+        """
+        Wait until the pipeline is no longer running.
+
+        Args:
+            timeout: Seconds to wait, negative = forever
+
+        Returns:
+            True if the pipeline is no longer running
+        """
+        ...
+
+    def poll_events(self, timeout: float = 0.0) -> list[dict[str, Any]]:
+        """
+        Get pending control events.
+
+        Args:
+            timeout: Seconds to wait for the first event
+
+        Returns:
+            List of event dicts
+        """
+        ...
+
+    def stats(self) -> dict[str, Any]:
+        """
+        Get pipeline statistics.
+
+        Returns:
+            Dictionary with state, counters, per-stage/per-sink stats and
+            declared latency ('source_latency_ms', 'latency_ms')
+        """
+        ...
+
+    def get_format(self) -> dict[str, int]:
+        """
+        Get source and output format.
+
+        Returns:
+            Dictionary with keys 'source_rate', 'source_channels',
+            'sample_rate' and 'channels'
+        """
+        ...
+
+
+class JackRing:
+    """
+    Lock-free ring filled by a native JACK process callback.
+
+    Register process_callback/process_arg with jack_set_process_callback;
+    the realtime thread then copies and interleaves each period without
+    touching the interpreter, and read() drains it on any Python thread.
+    """
+
+    def __init__(self, ports: list[int], capacity_frames: int, port_get_buffer: int) -> None:
+        """
+        Create the ring.
+
+        Args:
+            ports: jack_port_t addresses, one per channel
+            capacity_frames: Ring capacity in frames
+            port_get_buffer: Address of jack_port_get_buffer
+
+        Raises:
+            ValueError: If an address is null, ports is empty or capacity < 1
+        """
+        ...
+
+    def read(self, max_frames: int = -1, /) -> bytes | None:
+        """
+        Drain interleaved float32 frames.
+
+        Args:
+            max_frames: Maximum frames to read, negative = all available
+
+        Returns:
+            PCM bytes, or None if the ring is empty
+        """
+        ...
+
+    def wait(self, timeout: float, /) -> bool:
+        """
+        Wait (without the GIL) until frames are available or wake() is called.
+
+        Returns:
+            True if frames are available
+        """
+        ...
+
+    def wake(self) -> None:
+        """Release any thread blocked in wait()."""
+        ...
+
+    @property
+    def available(self) -> int: ...
+    @property
+    def overruns(self) -> int: ...
+    @property
+    def channels(self) -> int: ...
+    @property
+    def process_callback(self) -> int: ...
+    @property
+    def process_arg(self) -> int: ...
@@ -0,0 +1,734 @@
+/**
+ * Playback interception shim (LD_PRELOAD)
+ *
+ * Injected into a process at launch, this library interposes the playback
+ * write calls of ALSA (snd_pcm_writei/writen), libpulse (pa_stream_write)
+ * and PipeWire (pw_stream_queue_buffer), mirrors the PCM together with its
+ * format into a shared-memory ring read by proctap (see
+ * proctap/backends/preload.py), and then calls the real function unchanged.
+ *
+ * The shim is inert unless PROCTAP_PRELOAD_RING names an existing ring, and
+ * it never blocks or allocates on the application's audio thread: stream
+ * formats are registered on format/connect calls and looked up with a
+ * try-lock, and if the registry or the ring lock is busy (after a short
+ * spin) the mirror copy is dropped and counted.
+ *
+ * No audio headers are needed: only the few ABI-stable structs and constants
+ * used here are declared below. Little-endian host assumed.
+ *
+ * Ring layout (all integers little-endian):
+ *   RingHeader (128 bytes) | data area (capacity bytes)
+ * The data area holds RecordHeader + payload records, each padded to 8
+ * bytes. A record never wraps: if it does not fit before the end, a pad
+ * record (or, if even that does not fit, nothing) fills the remainder and
+ * the record starts at offset 0. Positions are monotonic byte counters;
+ * writers advance reserve_pos before copying and write_pos after, so a
+ * reader can tell whether a record was overwritten while it copied it.
+ */
+
+#include <dlfcn.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+
+namespace {
+
+// ---------------------------------------------------------------------------
+// Shared ring layout (keep in sync with proctap/backends/preload.py)
+// ---------------------------------------------------------------------------
+
+constexpr uint32_t kRingMagic = 0x52505450;    // "PTPR"
+constexpr uint32_t kRingVersion = 1;
+constexpr uint32_t kRecordMagic = 0x43525450;  // "PTRC"
+constexpr uint32_t kPadMagic = 0x44505450;     // "PTPD"
+constexpr int kLockSpins = 256;
+constexpr size_t kScratchBytes = 16384;  // Per-thread interleave buffer (snd_pcm_writen)
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "ring needs address-free 64-bit atomics");
+static_assert(std::atomic<uint32_t>::is_always_lock_free, "ring needs address-free 32-bit atomics");
+
+struct RingHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t capacity;                  // Data area size in bytes (multiple of 8)
+    std::atomic<uint64_t> write_pos;    // End of the last complete record
+    std::atomic<uint64_t> reserve_pos;  // End of the record being written
+    std::atomic<uint32_t> lock;         // 0 = free, else owner pid
+    uint32_t reserved;
+    std::atomic<uint64_t> records;
+    std::atomic<uint64_t> dropped;      // Mirror copies skipped (lock or registry busy)
+    std::atomic<uint64_t> unsupported;  // Writes in a format the ring cannot describe
+    uint8_t pad[64];
+};
+static_assert(sizeof(RingHeader) == 128, "ring header layout");
+
+struct RecordHeader {
+    uint32_t magic;
+    uint32_t size;          // Payload bytes (0: the stream was closed)
+    uint32_t pid;
+    uint32_t stream;        // Stream id, unique within pid
+    uint32_t rate;
+    uint16_t channels;
+    uint8_t format;         // SampleCode
+    uint8_t api;            // Api
+    uint64_t timestamp_ns;  // CLOCK_MONOTONIC when the application wrote the data
+};
+static_assert(sizeof(RecordHeader) == 32, "record header layout");
+
+enum SampleCode : uint8_t {
+    kUnknown = 0,
+    kS16 = 1,
+    kS24 = 2,      // 3-byte packed
+    kS24In32 = 3,  // Low 24 bits of a 32-bit container
+    kS32 = 4,
+    kF32 = 5,
+};
+
+enum Api : uint8_t { kAlsa = 1, kPulse = 2, kPipeWire = 3 };
+
+uint32_t sample_bytes(uint8_t format) {
+    switch (format) {
+        case kS16: return 2;
+        case kS24: return 3;
+        case kS24In32:
+        case kS32:
+        case kF32: return 4;
+        default: return 0;
+    }
+}
+
+uint64_t align8(uint64_t n) { return (n + 7) & ~uint64_t(7); }
+
+uint64_t monotonic_ns() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+struct Stream {
+    uint32_t id = 0;
+    uint32_t rate = 0;
+    uint16_t channels = 0;
+    uint8_t format = kUnknown;
+
+    uint32_t frame_bytes() const { return channels * sample_bytes(format); }
+};
+
+// ---------------------------------------------------------------------------
+// Ring writer
+// ---------------------------------------------------------------------------
+
+class Ring {
+public:
+    explicit Ring(const char* name) {
+        if (name == nullptr || *name == '\0') return;
+        std::string path = name[0] == '/' ? name : std::string("/") + name;
+        int fd = shm_open(path.c_str(), O_RDWR, 0);
+        if (fd < 0) return;
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(RingHeader))) {
+            close(fd);
+            return;
+        }
+        void* map = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+        if (map == MAP_FAILED) return;
+
+        auto* header = static_cast<RingHeader*>(map);
+        if (header->magic != kRingMagic || header->version != kRingVersion ||
+                header->capacity % 8 != 0 || header->capacity < 1024 ||
+                header->capacity + sizeof(RingHeader) > static_cast<uint64_t>(st.st_size)) {
+            munmap(map, static_cast<size_t>(st.st_size));
+            return;
+        }
+        header_ = header;
+        data_ = static_cast<uint8_t*>(map) + sizeof(RingHeader);
+        capacity_ = header->capacity;
+    }
+
+    bool active() const { return header_ != nullptr; }
+
+    void count_unsupported() {
+        if (header_ != nullptr) header_->unsupported.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void count_dropped() {
+        if (header_ != nullptr) header_->dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void write(Api api, const Stream& stream, const void* data, size_t bytes) {
+        if (header_ == nullptr) return;
+        const uint32_t frame_bytes = stream.frame_bytes();
+        if (frame_bytes == 0) {
+            count_unsupported();
+            return;
+        }
+        // Split large writes so one record never takes more than a quarter of the ring
+        const uint64_t max_payload = (capacity_ / 4 - sizeof(RecordHeader)) / frame_bytes * frame_bytes;
+        if (max_payload == 0) {
+            // A single frame does not fit: never loop in the application's audio thread
+            count_unsupported();
+            return;
+        }
+        bytes -= bytes % frame_bytes;
+        const auto* src = static_cast<const uint8_t*>(data);
+
+        RecordHeader record = header_for(api, stream);
+        while (bytes > 0) {
+            const size_t piece = static_cast<size_t>(std::min<uint64_t>(bytes, max_payload));
+            record.size = static_cast<uint32_t>(piece);
+            if (!lock()) {
+                header_->dropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            append(record, src, piece);
+            unlock();
+            src += piece;
+            bytes -= piece;
+        }
+    }
+
+    // Payload-less record telling the reader the stream is gone
+    void write_close(Api api, const Stream& stream) {
+        if (header_ == nullptr) return;
+        RecordHeader record = header_for(api, stream);
+        record.size = 0;
+        if (!lock()) {
+            header_->dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        append(record, nullptr, 0);
+        unlock();
+    }
+
+private:
+    static RecordHeader header_for(Api api, const Stream& stream) {
+        RecordHeader record;
+        record.magic = kRecordMagic;
+        record.pid = static_cast<uint32_t>(getpid());
+        record.stream = stream.id;
+        record.rate = stream.rate;
+        record.channels = stream.channels;
+        record.format = stream.format;
+        record.api = api;
+        record.timestamp_ns = monotonic_ns();
+        return record;
+    }
+
+    bool lock() {
+        const uint32_t self = static_cast<uint32_t>(getpid());
+        for (int spin = 0; spin < kLockSpins; ++spin) {
+            uint32_t owner = 0;
+            if (header_->lock.compare_exchange_weak(owner, self, std::memory_order_acquire)) {
+                return true;
+            }
+            // A writer that died holding the lock would silence every other one
+            if (owner != 0 && owner != self && spin % 64 == 63 &&
+                    kill(static_cast<pid_t>(owner), 0) != 0 && errno == ESRCH) {
+                header_->lock.compare_exchange_strong(owner, 0);
+            }
+            if (spin > 16) sched_yield();
+        }
+        return false;
+    }
+
+    void unlock() { header_->lock.store(0, std::memory_order_release); }
+
+    void append(const RecordHeader& record, const uint8_t* payload, size_t size) {
+        const uint64_t length = sizeof(RecordHeader) + align8(size);
+        uint64_t pos = header_->write_pos.load(std::memory_order_relaxed);
+        uint64_t offset = pos % capacity_;
+        const uint64_t tail = capacity_ - offset;
+        const bool wrap = tail < length;
+        const uint64_t end = (wrap ? pos + tail : pos) + length;
+
+        header_->reserve_pos.store(end, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        if (wrap) {
+            if (tail >= sizeof(RecordHeader)) {
+                RecordHeader pad{};
+                pad.magic = kPadMagic;
+                std::memcpy(data_ + offset, &pad, sizeof(pad));
+            }
+            offset = 0;
+        }
+        std::memcpy(data_ + offset, &record, sizeof(record));
+        if (size > 0) std::memcpy(data_ + offset + sizeof(record), payload, size);
+
+        header_->records.fetch_add(1, std::memory_order_relaxed);
+        header_->write_pos.store(end, std::memory_order_release);
+    }
+
+    RingHeader* header_ = nullptr;
+    uint8_t* data_ = nullptr;
+    uint64_t capacity_ = 0;
+};
+
+Ring& ring() {
+    static Ring instance(std::getenv("PROCTAP_PRELOAD_RING"));
+    return instance;
+}
+
+// ---------------------------------------------------------------------------
+// Stream registry: playback handle -> id and format
+// ---------------------------------------------------------------------------
+
+enum class Lookup { kFound, kMissing, kBusy };
+
+class Streams {
+public:
+    // Format/connect/close calls only, never on the write path
+    void set(const void* handle, uint32_t rate, uint32_t channels, uint8_t format) {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        Stream& stream = map_[handle];
+        if (stream.id == 0) stream.id = next_id_++;
+        stream.rate = rate;
+        stream.channels = static_cast<uint16_t>(channels);
+        stream.format = channels > 0 && channels <= UINT16_MAX ? format : static_cast<uint8_t>(kUnknown);
+    }
+
+    bool remove(const void* handle, Stream& out) {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        auto it = map_.find(handle);
+        if (it == map_.end()) return false;
+        out = it->second;
+        map_.erase(it);
+        return true;
+    }
+
+    // Write path: readers never wait for each other, and a concurrent
+    // set()/remove() makes the lookup fail instead of blocking
+    Lookup find(const void* handle, Stream& out) {
+        std::shared_lock<std::shared_mutex> lock(mutex_, std::try_to_lock);
+        if (!lock.owns_lock()) return Lookup::kBusy;
+        auto it = map_.find(handle);
+        if (it == map_.end()) return Lookup::kMissing;
+        out = it->second;
+        return Lookup::kFound;
+    }
+
+private:
+    std::shared_mutex mutex_;
+    std::unordered_map<const void*, Stream> map_;
+    uint32_t next_id_ = 1;
+};
+
+Streams& streams() {
+    static Streams instance;
+    return instance;
+}
+
+// Stream of a write, counting a dropped mirror if the registry was busy
+bool lookup(const void* handle, Stream& stream) {
+    switch (streams().find(handle, stream)) {
+        case Lookup::kFound: return true;
+        case Lookup::kBusy: ring().count_dropped(); return false;
+        default: return false;
+    }
+}
+
+void mirror(Api api, const Stream& stream, const void* data, size_t bytes) {
+    Ring& r = ring();
+    if (stream.format == kUnknown) {
+        r.count_unsupported();
+        return;
+    }
+    if (data == nullptr || bytes == 0) return;
+    r.write(api, stream, data, bytes);
+}
+
+// Nested calls (e.g. ALSA's pulse plugin calling pa_stream_write from inside
+// snd_pcm_writei) are only mirrored at the outermost, application-facing API
+thread_local int t_depth = 0;
+
+struct Guard {
+    Guard() { ++t_depth; }
+    ~Guard() { --t_depth; }
+    Guard(const Guard&) = delete;
+    Guard& operator=(const Guard&) = delete;
+    bool outermost() const { return t_depth == 1; }
+};
+
+// Unregister a playback handle and tell the reader its stream has ended
+void close_stream(Api api, const void* handle, const Guard& guard) {
+    Stream stream;
+    if (streams().remove(handle, stream) && guard.outermost() && ring().active()) {
+        ring().write_close(api, stream);
+    }
+}
+
+template <typename Fn>
+Fn resolve(const char* name) {
+    return reinterpret_cast<Fn>(dlsym(RTLD_NEXT, name));
+}
+
+// ---------------------------------------------------------------------------
+// ABI declarations (alsa/pcm.h, pulse/sample.h, spa/pod, spa/buffer, pipewire/stream.h)
+// ---------------------------------------------------------------------------
+
+constexpr int kAlsaStreamPlayback = 0;
+constexpr int kAlsaAccessRwNonInterleaved = 4;
+
+uint8_t alsa_code(int format) {
+    switch (format) {
+        case 2: return kS16;        // SND_PCM_FORMAT_S16_LE
+        case 6: return kS24In32;    // SND_PCM_FORMAT_S24_LE
+        case 10: return kS32;       // SND_PCM_FORMAT_S32_LE
+        case 14: return kF32;       // SND_PCM_FORMAT_FLOAT_LE
+        case 32: return kS24;       // SND_PCM_FORMAT_S24_3LE
+        default: return kUnknown;
+    }
+}
+
+uint8_t pulse_code(int format) {
+    switch (format) {
+        case 3: return kS16;        // PA_SAMPLE_S16LE
+        case 5: return kF32;        // PA_SAMPLE_FLOAT32LE
+        case 7: return kS32;        // PA_SAMPLE_S32LE
+        case 9: return kS24;        // PA_SAMPLE_S24LE
+        case 11: return kS24In32;   // PA_SAMPLE_S24_32LE
+        default: return kUnknown;
+    }
+}
+
+uint8_t spa_code(uint32_t format) {
+    switch (format) {
+        case 0x103: return kS16;      // SPA_AUDIO_FORMAT_S16_LE
+        case 0x107: return kS24In32;  // SPA_AUDIO_FORMAT_S24_32_LE
+        case 0x10b: return kS32;      // SPA_AUDIO_FORMAT_S32_LE
+        case 0x10f: return kS24;      // SPA_AUDIO_FORMAT_S24_LE
+        case 0x11b: return kF32;      // SPA_AUDIO_FORMAT_F32_LE
+        default: return kUnknown;
+    }
+}
+
+constexpr uint32_t kSpaTypeId = 3;
+constexpr uint32_t kSpaTypeInt = 4;
+constexpr uint32_t kSpaTypeObject = 15;
+constexpr uint32_t kSpaTypeChoice = 19;
+constexpr uint32_t kSpaParamEnumFormat = 3;
+constexpr uint32_t kSpaParamFormat = 4;
+constexpr uint32_t kSpaFormatMediaType = 0x1;
+constexpr uint32_t kSpaFormatMediaSubtype = 0x2;
+constexpr uint32_t kSpaFormatAudioFormat = 0x10001;
+constexpr uint32_t kSpaFormatAudioRate = 0x10003;
+constexpr uint32_t kSpaFormatAudioChannels = 0x10004;
+constexpr uint32_t kSpaMediaTypeAudio = 1;
+constexpr uint32_t kSpaMediaSubtypeRaw = 1;
+constexpr int kPwDirectionOutput = 1;
+
+struct spa_pod {
+    uint32_t size;  // Body size
+    uint32_t type;
+};
+
+// Property value: a plain pod, or a choice whose first value is the default
+bool pod_u32(const spa_pod* value, uint32_t type, uint32_t& out) {
+    const auto* body = reinterpret_cast<const uint8_t*>(value + 1);
+    if (value->type == kSpaTypeChoice) {
+        // Body: u32 choice type, u32 flags, child pod header, values
+        if (value->size < 8 + sizeof(spa_pod) + 4) return false;
+        const auto* child = reinterpret_cast<const spa_pod*>(body + 8);
+        if (child->type != type || child->size < 4) return false;
+        std::memcpy(&out, body + 8 + sizeof(spa_pod), 4);
+        return true;
+    }
+    if (value->type != type || value->size < 4) return false;
+    std::memcpy(&out, body, 4);
+    return true;
+}
+
+// Reads the raw audio format from an EnumFormat/Format object pod
+bool parse_spa_format(const spa_pod* pod, uint32_t& rate, uint32_t& channels, uint8_t& format) {
+    if (pod == nullptr || pod->type != kSpaTypeObject || pod->size < 8) return false;
+    const auto* body = reinterpret_cast<const uint8_t*>(pod + 1);
+    uint32_t id;
+    std::memcpy(&id, body + 4, 4);
+    if (id != kSpaParamEnumFormat && id != kSpaParamFormat) return false;
+
+    uint32_t media_type = 0, media_subtype = 0, spa_format = 0;
+    rate = channels = 0;
+    size_t offset = 8;
+    // Property: u32 key, u32 flags, value pod (padded to 8 bytes)
+    while (offset + 8 + sizeof(spa_pod) <= pod->size) {
+        uint32_t key;
+        std::memcpy(&key, body + offset, 4);
+        const auto* value = reinterpret_cast<const spa_pod*>(body + offset + 8);
+        const size_t length = 8 + sizeof(spa_pod) + align8(value->size);
+        if (offset + length > pod->size) break;
+        switch (key) {
+            case kSpaFormatMediaType: pod_u32(value, kSpaTypeId, media_type); break;
+            case kSpaFormatMediaSubtype: pod_u32(value, kSpaTypeId, media_subtype); break;
+            case kSpaFormatAudioFormat: pod_u32(value, kSpaTypeId, spa_format); break;
+            case kSpaFormatAudioRate: pod_u32(value, kSpaTypeInt, rate); break;
+            case kSpaFormatAudioChannels: pod_u32(value, kSpaTypeInt, channels); break;
+            default: break;
+        }
+        offset += length;
+    }
+    if (media_type != kSpaMediaTypeAudio || media_subtype != kSpaMediaSubtypeRaw) return false;
+    format = rate > 0 && channels > 0 ? spa_code(spa_format) : static_cast<uint8_t>(kUnknown);
+    return true;
+}
+
+struct spa_chunk {
+    uint32_t offset;
+    uint32_t size;
+    int32_t stride;
+    int32_t flags;
+};
+
+struct spa_data {
+    uint32_t type;
+    uint32_t flags;
+    int64_t fd;
+    uint32_t mapoffset;
+    uint32_t maxsize;
+    void* data;
+    spa_chunk* chunk;
+};
+
+struct spa_buffer {
+    uint32_t n_metas;
+    uint32_t n_datas;
+    void* metas;
+    spa_data* datas;
+};
+
+}  // namespace
+
+extern "C" {
+
+typedef struct _snd_pcm snd_pcm_t;
+typedef struct _snd_pcm_hw_params snd_pcm_hw_params_t;
+typedef unsigned long snd_pcm_uframes_t;
+typedef long snd_pcm_sframes_t;
+
+typedef struct pa_stream pa_stream;
+typedef void (*pa_free_cb_t)(void*);
+struct pa_sample_spec {
+    int format;
+    uint32_t rate;
+    uint8_t channels;
+};
+
+struct pw_stream;
+struct pw_buffer {
+    spa_buffer* buffer;
+    void* user_data;
+    uint64_t size;
+};
+
+// --- ALSA ------------------------------------------------------------------
+
+static void register_alsa(snd_pcm_t* pcm, const snd_pcm_hw_params_t* params) {
+    static auto get_stream = resolve<int (*)(snd_pcm_t*)>("snd_pcm_stream");
+    static auto get_rate = resolve<int (*)(const snd_pcm_hw_params_t*, unsigned int*, int*)>(
+        "snd_pcm_hw_params_get_rate");
+    static auto get_channels = resolve<int (*)(const snd_pcm_hw_params_t*, unsigned int*)>(
+        "snd_pcm_hw_params_get_channels");
+    static auto get_format = resolve<int (*)(const snd_pcm_hw_params_t*, int*)>(
+        "snd_pcm_hw_params_get_format");
+    if (!get_stream || !get_rate || !get_channels || !get_format) return;
+    if (get_stream(pcm) != kAlsaStreamPlayback) return;
+
+    unsigned int rate = 0, channels = 0;
+    int dir = 0, format = -1;
+    if (get_rate(params, &rate, &dir) < 0 || get_channels(params, &channels) < 0 ||
+            get_format(params, &format) < 0) {
+        return;
+    }
+    streams().set(pcm, rate, channels, alsa_code(format));
+}
+
+int snd_pcm_hw_params(snd_pcm_t* pcm, snd_pcm_hw_params_t* params) {
+    static auto real = resolve<int (*)(snd_pcm_t*, snd_pcm_hw_params_t*)>("snd_pcm_hw_params");
+    if (real == nullptr) return -ENOSYS;
+    Guard guard;
+    int ret = real(pcm, params);
+    if (ret == 0) register_alsa(pcm, params);
+    return ret;
+}
+
+int snd_pcm_set_params(snd_pcm_t* pcm, int format, int access, unsigned int channels,
+                       unsigned int rate, int soft_resample, unsigned int latency) {
+    static auto real = resolve<int (*)(snd_pcm_t*, int, int, unsigned int, unsigned int, int, unsigned int)>(
+        "snd_pcm_set_params");
+    static auto get_stream = resolve<int (*)(snd_pcm_t*)>("snd_pcm_stream");
+    if (real == nullptr) return -ENOSYS;
+    Guard guard;
+    int ret = real(pcm, format, access, channels, rate, soft_resample, latency);
+    if (ret == 0 && get_stream != nullptr && get_stream(pcm) == kAlsaStreamPlayback) {
+        streams().set(pcm, rate, channels, alsa_code(format));
+    }
+    return ret;
+}
+
+snd_pcm_sframes_t snd_pcm_writei(snd_pcm_t* pcm, const void* buffer, snd_pcm_uframes_t size) {
+    static auto real = resolve<snd_pcm_sframes_t (*)(snd_pcm_t*, const void*, snd_pcm_uframes_t)>(
+        "snd_pcm_writei");
+    if (real == nullptr) return -ENOSYS;
+    Guard guard;
+    snd_pcm_sframes_t written = real(pcm, buffer, size);
+    Stream stream;
+    if (written > 0 && guard.outermost() && ring().active() && lookup(pcm, stream)) {
+        mirror(kAlsa, stream, buffer, static_cast<size_t>(written) * stream.frame_bytes());
+    }
+    return written;
+}
+
+snd_pcm_sframes_t snd_pcm_writen(snd_pcm_t* pcm, void** bufs, snd_pcm_uframes_t size) {
+    static auto real = resolve<snd_pcm_sframes_t (*)(snd_pcm_t*, void**, snd_pcm_uframes_t)>(
+        "snd_pcm_writen");
+    if (real == nullptr) return -ENOSYS;
+    Guard guard;
+    snd_pcm_sframes_t written = real(pcm, bufs, size);
+    Stream stream;
+    if (written > 0 && guard.outermost() && ring().active() && bufs != nullptr && lookup(pcm, stream)) {
+        if (stream.format == kUnknown) {
+            ring().count_unsupported();
+            return written;
+        }
+        // The ring carries interleaved frames: interleave through a fixed
+        // per-thread buffer, one record per buffer-full
+        thread_local uint8_t scratch[kScratchBytes];
+        const uint32_t width = sample_bytes(stream.format);
+        const size_t frames = static_cast<size_t>(written);
+        const size_t piece_frames = kScratchBytes / stream.frame_bytes();
+        if (piece_frames == 0) {
+            ring().count_dropped();  // Not even one frame fits
+            return written;
+        }
+        for (size_t start = 0; start < frames; start += piece_frames) {
+            const size_t n = std::min(piece_frames, frames - start);
+            for (uint32_t c = 0; c < stream.channels; ++c) {
+                const auto* src = static_cast<const uint8_t*>(bufs[c]);
+                for (size_t i = 0; i < n; ++i) {
+                    uint8_t* dst = &scratch[(i * stream.channels + c) * width];
+                    if (src != nullptr) {
+                        std::memcpy(dst, src + (start + i) * width, width);
+                    } else {
+                        std::memset(dst, 0, width);
+                    }
+                }
+            }
+            mirror(kAlsa, stream, scratch, n * stream.frame_bytes());
+        }
+    }
+    return written;
+}
+
+int snd_pcm_close(snd_pcm_t* pcm) {
+    static auto real = resolve<int (*)(snd_pcm_t*)>("snd_pcm_close");
+    if (real == nullptr) return -ENOSYS;
+    Guard guard;
+    close_stream(kAlsa, pcm, guard);
+    return real(pcm);
+}
+
+// --- PulseAudio -------------------------------------------------------------
+
+// The sample spec is fixed when the stream is created (pa_stream_new*), so
+// it is registered once the stream connects for playback
+int pa_stream_connect_playback(pa_stream* s, const char* dev, const void* attr, int flags,
+                               const void* volume, pa_stream* sync_stream) {
+    static auto real = resolve<int (*)(pa_stream*, const char*, const void*, int, const void*, pa_stream*)>(
+        "pa_stream_connect_playback");
+    static auto get_spec = resolve<const pa_sample_spec* (*)(pa_stream*)>("pa_stream_get_sample_spec");
+    if (real == nullptr) return -1;
+    Guard guard;
+    int ret = real(s, dev, attr, flags, volume, sync_stream);
+    if (ret == 0 && get_spec != nullptr) {
+        const pa_sample_spec* spec = get_spec(s);
+        if (spec != nullptr) streams().set(s, spec->rate, spec->channels, pulse_code(spec->format));
+    }
+    return ret;
+}
+
+int pa_stream_disconnect(pa_stream* s) {
+    static auto real = resolve<int (*)(pa_stream*)>("pa_stream_disconnect");
+    if (real == nullptr) return -1;
+    Guard guard;
+    close_stream(kPulse, s, guard);
+    return real(s);
+}
+
+int pa_stream_write(pa_stream* s, const void* data, size_t nbytes, pa_free_cb_t free_cb,
+                    int64_t offset, int seek) {
+    static auto real = resolve<int (*)(pa_stream*, const void*, size_t, pa_free_cb_t, int64_t, int)>(
+        "pa_stream_write");
+    if (real == nullptr) return -1;
+    Guard guard;
+    // Mirror first: with free_cb set, libpulse may free data before returning
+    Stream stream;
+    if (guard.outermost() && ring().active() && lookup(s, stream)) {
+        mirror(kPulse, stream, data, nbytes);
+    }
+    return real(s, data, nbytes, free_cb, offset, seek);
+}
+
+// --- PipeWire ---------------------------------------------------------------
+
+int pw_stream_connect(pw_stream* stream, int direction, uint32_t target_id, int flags,
+                      const spa_pod** params, uint32_t n_params) {
+    static auto real = resolve<int (*)(pw_stream*, int, uint32_t, int, const spa_pod**, uint32_t)>(
+        "pw_stream_connect");
+    if (real == nullptr) return -ENOSYS;
+    Guard guard;
+    if (direction == kPwDirectionOutput) {
+        uint32_t rate = 0, channels = 0;
+        uint8_t format = kUnknown;
+        for (uint32_t i = 0; params != nullptr && i < n_params; ++i) {
+            if (parse_spa_format(params[i], rate, channels, format)) break;
+        }
+        streams().set(stream, rate, channels, format);
+    }
+    return real(stream, direction, target_id, flags, params, n_params);
+}
+
+int pw_stream_queue_buffer(pw_stream* stream, pw_buffer* buffer) {
+    static auto real = resolve<int (*)(pw_stream*, pw_buffer*)>("pw_stream_queue_buffer");
+    if (real == nullptr) return -ENOSYS;
+    Guard guard;
+    if (guard.outermost() && ring().active() && buffer != nullptr && buffer->buffer != nullptr) {
+        const spa_buffer* b = buffer->buffer;
+        // Interleaved formats carry all channels in the first data plane
+        if (b->n_datas >= 1 && b->datas != nullptr) {
+            const spa_data& d = b->datas[0];
+            if (d.data != nullptr && d.chunk != nullptr && d.maxsize > 0) {
+                const uint32_t offset = d.chunk->offset % d.maxsize;
+                const uint32_t size = std::min(d.chunk->size, d.maxsize - offset);
+                Stream s;
+                if (lookup(stream, s)) {
+                    mirror(kPipeWire, s, static_cast<const uint8_t*>(d.data) + offset, size);
+                }
+            }
+        }
+    }
+    return real(stream, buffer);
+}
+
+void pw_stream_destroy(pw_stream* stream) {
+    static auto real = resolve<void (*)(pw_stream*)>("pw_stream_destroy");
+    Guard guard;
+    close_stream(kPipeWire, stream, guard);
+    if (real != nullptr) real(stream);
+}
+
+}  // extern "C"
@@ -12,9 +12,12 @@ All backends MUST convert audio to this standard format:
 from __future__ import annotations
 
 from abc import ABC, abstractmethod
-from typing import Optional
+from typing import TYPE_CHECKING, Optional
 import numpy as np
 
+if TYPE_CHECKING:
+    from ..hibernation import ActivityDetector
+
 
 # Standard audio format constants for all backends
 STANDARD_SAMPLE_RATE = 48000
@@ -92,3 +95,98 @@ class AudioBackend(ABC):
             - 'sample_format': Format string (e.g., 'float32')
         """
         pass
+
+    def get_latency_ms(self) -> float:
+        """
+        Get the algorithmic latency added by the backend.
+
+        Fixed by configuration: chunk/period size, device buffers and
+        format conversion. Backends that cannot determine it report 0.
+
+        Returns:
+            Latency in milliseconds
+        """
+        return 0.0
+
+    def get_conversion_latency_ms(self) -> float:
+        """
+        Get the part of get_latency_ms() added by format conversion.
+
+        Returns:
+            Resampler delay in milliseconds (0 if nothing is resampled)
+        """
+        return 0.0
+
+    def get_buffered_ms(self) -> float:
+        """
+        Get the audio currently queued inside the backend.
+
+        Returns:
+            Live queue depth in milliseconds (0 if the backend has no queue)
+        """
+        return 0.0
+
+    def is_muted(self) -> Optional[bool]:
+        """
+        Get the stream's mute state from the audio server.
+
+        Returns:
+            True if the stream is muted or at zero volume, False if it is
+            audible, None if the backend cannot tell
+        """
+        return None
+
+    def hibernate(self) -> None:
+        """
+        Release conversion state while the stream is idle.
+
+        Until wake(), read_activity() is called instead of read(). The
+        default has nothing to release.
+        """
+        pass
+
+    def wake(self) -> None:
+        """Restore the state released by hibernate()."""
+        pass
+
+    def park(self) -> bool:
+        """
+        Stop capturing while a hibernated stream is muted.
+
+        Only called while hibernating and after is_muted() returned True;
+        is_muted() must keep working until unpark(). The default cannot
+        park and keeps capturing.
+
+        Returns:
+            True if the capture was stopped, False otherwise
+        """
+        return False
+
+    def unpark(self) -> None:
+        """
+        Restart the capture stopped by park().
+
+        Raises:
+            RuntimeError: If the capture cannot be restarted (e.g. the
+                          stream has gone away)
+        """
+        pass
+
+    def read_activity(self, detector: ActivityDetector) -> Optional[bytes]:
+        """
+        Read one chunk while hibernating and test it for activity.
+
+        The default reads converted audio; backends override this to test
+        their native audio so nothing is converted while idle.
+
+        Args:
+            detector: Activity detector holding the pre-roll
+
+        Returns:
+            PCM audio in standard format (pre-roll followed by the chunk)
+            once a chunk is active, None otherwise
+        """
+        data = self.read()
+        if not data:
+            return None
+        return detector.feed(data)
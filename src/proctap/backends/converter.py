@@ -3,16 +3,25 @@ Audio format converter for PCM data.
 
 Handles:
 - Sample rate conversion (resampling)
-- Channel conversion (mono/stereo)
+- Channel conversion (any channel count, optional explicit channel map)
 - Bit depth conversion (16-bit, 24-bit, 32-bit)
 - Automatic format detection (int16 vs float32)
+
+Wide streams (WIDE_CHANNELS channels or more, e.g. 16-64 channel pro-audio
+interfaces) are converted in channel groups on a shared thread pool: each
+group is decoded, resampled and encoded independently, using cache-blocked
+deinterleave()/interleave() kernels so only one block of frames of a group
+is in flight at a time.
 """
 
 from __future__ import annotations
 import numpy as np
 import logging
+import os
 import struct
-from typing import Optional, cast, Literal
+import threading
+from concurrent.futures import ThreadPoolExecutor
+from typing import Optional, Sequence, Union, cast, Literal
 
 logger = logging.getLogger(__name__)
 
@@ -26,6 +35,21 @@ SAMPLERATE_CONVERTER_TYPES = {
     'fast': 'sinc_fastest',   # Lowest quality, fastest (~0.3-0.5ms estimated)
 }
 
+# Streams with at least this many channels are converted in channel groups
+# on worker threads
+WIDE_CHANNELS = 16
+
+# Smallest channel group handed to a worker thread
+MIN_GROUP_CHANNELS = 4
+
+# Chunks shorter than this are converted serially (thread handoff would
+# cost more than it saves)
+MIN_PARALLEL_FRAMES = 256
+
+# Working set of one block in the interleave/deinterleave kernels; small
+# enough to stay in L1/L2 while it is scaled and converted
+BLOCK_BYTES = 32 * 1024
+
 try:
     from scipy import signal  # type: ignore[import-untyped]
     HAS_SCIPY = True
@@ -52,13 +76,168 @@ class SampleFormat:
     FLOAT32 = 'float32'      # 32-bit IEEE float
 
 
+# Scale from integer samples to [-1.0, 1.0] (powers of two, so exact)
+_DECODE_SCALE = {
+    SampleFormat.INT16: 1.0 / 32768.0,
+    SampleFormat.INT24: 1.0 / 8388608.0,
+    SampleFormat.INT24_32: 1.0 / 2147483648.0,
+    SampleFormat.INT32: 1.0 / 2147483648.0,
+}
+
+# Storage of one interleaved sample; int24 is a trailing axis of 3 bytes
+_FRAME_DTYPES = {
+    SampleFormat.INT16: np.int16,
+    SampleFormat.INT24: np.uint8,
+    SampleFormat.INT24_32: np.int32,
+    SampleFormat.INT32: np.int32,
+    SampleFormat.FLOAT32: np.float32,
+}
+
+ChannelIndex = Union[slice, np.ndarray]
+
+_pool: Optional[ThreadPoolExecutor] = None
+_pool_lock = threading.Lock()
+
+
+def _channel_pool() -> ThreadPoolExecutor:
+    """Thread pool shared by all converters for channel-group conversion."""
+    global _pool
+    with _pool_lock:
+        if _pool is None:
+            _pool = ThreadPoolExecutor(max_workers=os.cpu_count() or 1, thread_name_prefix='proctap-convert')
+        return _pool
+
+
+def _block_frames(channels: int) -> int:
+    """Frames per cache block for a group of channels."""
+    return max(16, BLOCK_BYTES // (4 * channels))
+
+
+def _channel_count(channels: ChannelIndex) -> int:
+    if isinstance(channels, slice):
+        return cast(int, channels.stop - channels.start)
+    return len(channels)
+
+
+def frames_view(pcm_bytes: bytes, sample_format: str, channels: int) -> np.ndarray:
+    """
+    View interleaved PCM bytes as a frames x channels array (no copy).
+
+    Args:
+        pcm_bytes: Raw PCM data
+        sample_format: Format (int16, int24, int24_32, int32, float32)
+        channels: Number of interleaved channels
+
+    Returns:
+        Shape (num_frames, channels), or (num_frames, channels, 3) for int24
+
+    Raises:
+        ValueError: If the format is unknown or the data is not whole frames
+    """
+    dtype = _FRAME_DTYPES.get(sample_format)
+    if dtype is None:
+        raise ValueError(f"Unsupported sample format: {sample_format}")
+    data = np.frombuffer(pcm_bytes, dtype=dtype)
+    if sample_format == SampleFormat.INT24:
+        return data.reshape(-1, channels, 3)
+    return data.reshape(-1, channels)
+
+
+def deinterleave(frames: np.ndarray, channels: ChannelIndex, sample_format: str) -> np.ndarray:
+    """
+    Decode a group of channels from interleaved frames to float32.
+
+    Works through the frames in cache-sized blocks, so each block is
+    gathered, sign-extended and scaled while it is still in cache instead of
+    making one full-size pass (and temporary) per step.
+
+    Args:
+        frames: Interleaved frames from frames_view()
+        channels: Source channels of the group (slice or index array)
+        sample_format: Format of frames
+
+    Returns:
+        Shape (num_frames, group channels), float32 normalized to [-1.0, 1.0]
+    """
+    width = _channel_count(channels)
+    num_frames = frames.shape[0]
+    out = np.empty((num_frames, width), dtype=np.float32)
+    step = _block_frames(width)
+    scale = _DECODE_SCALE.get(sample_format)
+    non_finite = 0
+
+    for start in range(0, num_frames, step):
+        block = frames[start:start + step, channels]
+        dst = out[start:start + step]
+        if sample_format == SampleFormat.INT24:
+            value = (block[..., 0].astype(np.int32) |
+                     (block[..., 1].astype(np.int32) << 8) |
+                     (block[..., 2].astype(np.int32) << 16))
+            dst[...] = (value << 8) >> 8  # Sign-extend from bit 23
+        else:
+            dst[...] = block
+
+        if scale is not None:
+            dst *= scale
+        else:
+            if not np.isfinite(dst).all():
+                non_finite += int((~np.isfinite(dst)).sum())
+                np.nan_to_num(dst, copy=False, nan=0.0, posinf=0.0, neginf=0.0)
+            np.clip(dst, -1.0, 1.0, out=dst)
+
+    if non_finite:
+        logger.warning(f"NaN/Inf detected in float32 audio: {non_finite} samples - replacing with zeros")
+    return out
+
+
+def interleave(audio: np.ndarray, out: np.ndarray, first_channel: int, sample_format: str) -> None:
+    """
+    Encode a group of float32 channels into interleaved output frames.
+
+    The counterpart of deinterleave(), also working in cache-sized blocks.
+
+    Args:
+        audio: Shape (num_frames, group channels), float32
+        out: Interleaved output frames (see frames_view() for the shape);
+             num_frames must match audio
+        first_channel: Output channel of the first group channel
+        sample_format: Format of out
+    """
+    columns = slice(first_channel, first_channel + audio.shape[1])
+    step = _block_frames(audio.shape[1])
+
+    for start in range(0, audio.shape[0], step):
+        block = np.clip(audio[start:start + step], -1.0, 1.0)
+        rows = slice(start, start + step)
+        if sample_format == SampleFormat.INT16:
+            block *= 32767.0
+            out[rows, columns] = block
+        elif sample_format == SampleFormat.INT24:
+            value = (block * 8388607.0).astype(np.int32)
+            out[rows, columns, 0] = value & 0xFF
+            out[rows, columns, 1] = (value >> 8) & 0xFF
+            out[rows, columns, 2] = (value >> 16) & 0xFF
+        elif sample_format == SampleFormat.INT24_32:
+            value = (block * 8388607.0).astype(np.int32)
+            value *= 256
+            out[rows, columns] = value
+        elif sample_format == SampleFormat.INT32:
+            block *= 2147483647.0
+            out[rows, columns] = block
+        elif sample_format == SampleFormat.FLOAT32:
+            out[rows, columns] = block
+        else:
+            raise ValueError(f"Unsupported sample format: {sample_format}")
+
+
 class AudioConverter:
     """
     Converts PCM audio data between different formats.
 
     Supports:
     - Sample rate conversion: 44.1kHz, 48kHz, 96kHz, 192kHz, etc.
-    - Channel conversion: 1-8 channels (mono to 7.1 surround)
+    - Channel conversion: any channel count (mono to 64+ channel interfaces),
+      with default up/downmix rules or an explicit channel map
     - Bit depth conversion:
       - 16-bit PCM (int16)
       - 24-bit PCM (3-byte packed)
@@ -66,6 +245,9 @@ class AudioConverter:
       - 32-bit PCM (int32)
       - 32-bit IEEE float
     - Automatic format detection (int16 vs float32)
+
+    Wide streams are split into channel groups that are decoded, resampled
+    and encoded on a shared thread pool (see workers).
     """
 
     def __init__(
@@ -80,16 +262,18 @@ class AudioConverter:
         dst_format: str = SampleFormat.INT16,
         auto_detect_format: bool = True,
         resample_quality: ResampleQuality = 'best',
+        channel_map: Optional[Sequence[int]] = None,
+        workers: Optional[int] = None,
     ):
         """
         Initialize audio converter.
 
         Args:
             src_rate: Source sample rate in Hz (e.g., 44100, 48000, 96000, 192000)
-            src_channels: Source channel count (1-8)
+            src_channels: Source channel count (>= 1)
             src_width: Source sample width in bytes (2=16bit, 3=24bit, 4=32bit/float)
             dst_rate: Destination sample rate in Hz
-            dst_channels: Destination channel count (1-8)
+            dst_channels: Destination channel count (>= 1)
             dst_width: Destination sample width in bytes
             src_format: Source sample format (int16, int24, int24_32, int32, float32)
             dst_format: Destination sample format
@@ -98,6 +282,15 @@ class AudioConverter:
                 - 'best': Highest quality, ~1.3-1.4ms latency (default)
                 - 'medium': Medium quality, ~0.7-0.9ms latency
                 - 'fast': Lowest quality, ~0.3-0.5ms latency
+            channel_map: Source channel for each destination channel
+                (length dst_channels), e.g. [8, 9] picks channels 9-10 of a
+                wide interface as stereo. None: default up/downmix.
+            workers: Channel groups converted in parallel for streams with
+                WIDE_CHANNELS or more channels (None: one per CPU, 1: serial)
+
+        Raises:
+            RuntimeError: If scipy is not available
+            ValueError: If a parameter is invalid
         """
         if not HAS_SCIPY:
             raise RuntimeError("scipy is required for audio format conversion. Install with: pip install scipy")
@@ -123,23 +316,117 @@ class AudioConverter:
             raise ValueError(f"Unsupported source sample width: {src_width} bytes")
         if dst_width not in (2, 3, 4):
             raise ValueError(f"Unsupported destination sample width: {dst_width} bytes")
-        if src_channels < 1 or src_channels > 8:
-            raise ValueError(f"Unsupported source channel count: {src_channels} (must be 1-8)")
-        if dst_channels < 1 or dst_channels > 8:
-            raise ValueError(f"Unsupported destination channel count: {dst_channels} (must be 1-8)")
+        if src_channels < 1:
+            raise ValueError(f"Unsupported source channel count: {src_channels} (must be >= 1)")
+        if dst_channels < 1:
+            raise ValueError(f"Unsupported destination channel count: {dst_channels} (must be >= 1)")
+        if workers is not None and workers < 1:
+            raise ValueError(f"workers must be >= 1: {workers}")
+
+        self.channel_map: Optional[tuple[int, ...]] = None
+        if channel_map is not None:
+            self.channel_map = tuple(int(ch) for ch in channel_map)
+            if len(self.channel_map) != dst_channels:
+                raise ValueError(
+                    f"channel_map needs one entry per destination channel: "
+                    f"{len(self.channel_map)} != {dst_channels}"
+                )
+            if any(ch < 0 or ch >= src_channels for ch in self.channel_map):
+                raise ValueError(f"channel_map entries must be in 0..{src_channels - 1}: {list(self.channel_map)}")
+            if self.channel_map == tuple(range(src_channels)):
+                self.channel_map = None  # Identity
 
         # Calculate conversion flags
         self.needs_resample = (src_rate != dst_rate)
-        self.needs_channel_conversion = (src_channels != dst_channels)
+        self.needs_channel_conversion = (src_channels != dst_channels or self.channel_map is not None)
         self.needs_bit_conversion = (src_width != dst_width)
 
+        # Channel mapping and resampling commute (both are linear, resampling
+        # is identical per channel), so resample whichever side has fewer
+        # channels: downmix first, but upmix only after resampling
+        self._resample_first = self.needs_resample and dst_channels > src_channels
+
+        # Channel groups of wide streams: (first destination channel, source
+        # channels), or empty for serial conversion
+        self.workers = workers if workers is not None else (os.cpu_count() or 1)
+        self._groups = self._plan_groups()
+
+        # Measured on first use (depends on the available resampler)
+        self._latency_frames: Optional[float] = None
+
+        # Polyphase filters by (up, down); designing one costs as much as
+        # filtering a chunk, and wide streams filter once per channel group
+        self._poly_filters: dict[tuple[int, int], np.ndarray] = {}
+
         logger.info(
             f"AudioConverter initialized: {src_rate}Hz/{src_channels}ch/{src_width*8}bit "
             f"-> {dst_rate}Hz/{dst_channels}ch/{dst_width*8}bit "
             f"(resample={self.needs_resample}, channels={self.needs_channel_conversion}, "
-            f"bits={self.needs_bit_conversion}, quality={resample_quality})"
+            f"bits={self.needs_bit_conversion}, quality={resample_quality}, "
+            f"groups={len(self._groups) or 1})"
         )
 
+    def _selection(self) -> Optional[list[int]]:
+        """
+        Source channel of each destination channel, if the channel
+        conversion only copies channels (None when it mixes).
+        """
+        if self.channel_map is not None:
+            return list(self.channel_map)
+        if self.src_channels == 1 or self.dst_channels >= self.src_channels:
+            last = self.src_channels - 1
+            return [min(ch, last) for ch in range(self.dst_channels)]
+        return None  # Downmix averages channels
+
+    def _plan_groups(self) -> list[tuple[int, ChannelIndex]]:
+        """
+        Split the destination channels into groups for parallel conversion.
+
+        Only wide streams whose channel conversion copies channels (every
+        group then depends on its own source channels only) are split.
+        """
+        if max(self.src_channels, self.dst_channels) < WIDE_CHANNELS:
+            return []
+        selection = self._selection()
+        count = min(self.workers, self.dst_channels // MIN_GROUP_CHANNELS)
+        if selection is None or count < 2:
+            return []
+
+        groups: list[tuple[int, ChannelIndex]] = []
+        bounds = np.linspace(0, self.dst_channels, count + 1).astype(int)
+        for first, stop in zip(bounds[:-1], bounds[1:]):
+            sources = selection[first:stop]
+            index: ChannelIndex
+            if sources == list(range(sources[0], sources[0] + len(sources))):
+                index = slice(sources[0], sources[0] + len(sources))  # Basic slice, no gather
+            else:
+                index = np.array(sources, dtype=np.intp)
+            groups.append((int(first), index))
+        return groups
+
+    @property
+    def latency_frames(self) -> float:
+        """
+        Algorithmic latency of the conversion in destination frames.
+
+        Chunks are resampled independently with zero-phase filters, so this
+        is normally close to 0. It is measured once with an impulse (the
+        resampler in use varies by installation) and cached.
+        """
+        if not self.needs_resample:
+            return 0.0
+        if self._latency_frames is None:
+            from ..latency import impulse_delay
+
+            position = self.src_rate // 20  # 50ms into a 100ms chunk
+            impulse = np.zeros(self.src_rate // 10, dtype=np.float32)
+            impulse[position] = 1.0
+            found = impulse_delay(self._resample(impulse, self.src_rate, self.dst_rate))
+            expected = position * self.dst_rate / self.src_rate
+            self._latency_frames = max(0.0, found - expected) if found is not None else 0.0
+            logger.debug(f"Converter latency: {self._latency_frames:.2f} frames")
+        return self._latency_frames
+
     def _detect_pcm_format(self, pcm_bytes: bytes) -> str:
         """
         Detect if PCM data is int16 or float32.
@@ -219,15 +506,22 @@ class AudioConverter:
         # Use cached format (avoids conditional check on every call after first)
         actual_format = self._actual_format
 
+        if self._groups:
+            frames = frames_view(pcm_bytes, actual_format, self.src_channels)
+            if frames.shape[0] >= MIN_PARALLEL_FRAMES:
+                return self._convert_groups(frames, actual_format)
+
         # Step 1: bytes -> numpy array (normalized float32)
         audio = self._bytes_to_float(pcm_bytes, actual_format, self.src_channels)
 
-        # Step 2: Channel conversion (before resampling for better quality)
+        # Step 2/3: Channel conversion and resampling, on the fewer channels
+        if self._resample_first:
+            audio = self._resample(audio, self.src_rate, self.dst_rate)
+
         if self.needs_channel_conversion:
             audio = self._convert_channels(audio, self.src_channels, self.dst_channels)
 
-        # Step 3: Resample
-        if self.needs_resample:
+        if self.needs_resample and not self._resample_first:
             audio = self._resample(audio, self.src_rate, self.dst_rate)
 
         # Step 4: Convert to destination format
@@ -235,6 +529,43 @@ class AudioConverter:
 
         return pcm_out
 
+    def _convert_groups(self, frames: np.ndarray, sample_format: str) -> bytes:
+        """
+        Convert a wide chunk channel group by channel group on the pool.
+
+        Decoding and resampling (numpy and scipy release the GIL for the
+        heavy loops) run per group; once all groups are resampled the output
+        length is known and the groups are encoded into one interleaved
+        buffer, again in parallel.
+
+        Args:
+            frames: Source frames from frames_view()
+            sample_format: Source format
+
+        Returns:
+            Converted PCM data in destination format
+        """
+        pool = _channel_pool()
+
+        def decode(group: tuple[int, ChannelIndex]) -> np.ndarray:
+            audio = deinterleave(frames, group[1], sample_format)
+            return self._resample(audio, self.src_rate, self.dst_rate)
+
+        planes = list(pool.map(decode, self._groups))
+        num_frames = min(plane.shape[0] for plane in planes)
+
+        shape: tuple[int, ...] = (num_frames, self.dst_channels)
+        if self.dst_format == SampleFormat.INT24:
+            shape += (3,)
+        out = np.empty(shape, dtype=_FRAME_DTYPES[self.dst_format])
+
+        def encode(item: tuple[tuple[int, ChannelIndex], np.ndarray]) -> None:
+            (first, _), plane = item
+            interleave(plane[:num_frames], out, first, self.dst_format)
+
+        list(pool.map(encode, zip(self._groups, planes)))
+        return cast(bytes, out.tobytes())
+
     def _bytes_to_float(self, pcm_bytes: bytes, sample_format: str, channels: int) -> np.ndarray:
         """
         Convert PCM bytes to float32 numpy array normalized to [-1.0, 1.0].
@@ -356,7 +687,7 @@ class AudioConverter:
 
     def _convert_channels(self, audio: np.ndarray, src_ch: int, dst_ch: int) -> np.ndarray:
         """
-        Convert between different channel counts (1-8 channels).
+        Convert between different channel counts (any number of channels).
 
         OPTIMIZATION 1.2: Fully vectorized channel conversion using numpy broadcasting.
 
@@ -364,17 +695,23 @@ class AudioConverter:
         - Upmixing: mono -> stereo/surround (duplicate channels)
         - Downmixing: stereo/surround -> mono (average all channels)
         - Stereo <-> surround: basic channel mapping
+        - Explicit channel_map: each output copies the mapped source channel
 
         Args:
             audio: Shape (num_frames, src_ch) for multi-channel, (num_frames,) for mono
         """
-        if src_ch == dst_ch:
+        if src_ch == dst_ch and self.channel_map is None:
             return audio
 
         # Ensure audio is 2D
         if audio.ndim == 1:
             audio = audio.reshape(-1, 1)
 
+        # Explicit channel map: pick the source channel of each output
+        if self.channel_map is not None:
+            picked: np.ndarray = audio[:, list(self.channel_map)]
+            return picked[:, 0] if dst_ch == 1 else picked
+
         # Downmix to mono (average all channels) - VECTORIZED
         if dst_ch == 1:
             # Return as 1D array for mono (resample expects this)
@@ -452,24 +789,12 @@ class AudioConverter:
 
             logger.debug(f"Resampling with scipy.resample_poly: {src_rate}Hz -> {dst_rate}Hz (up={up}, down={down})")
 
-            if audio.ndim == 1:
-                # Mono
-                result_mono: np.ndarray = signal.resample_poly(audio, up, down).astype(np.float32)  # type: ignore[no-any-return]
-                return result_mono
-            else:
-                # Multi-channel: process along axis=0 (time axis), vectorized per-channel
-                # Note: resample_poly doesn't support multi-channel directly, so we still need a loop
-                # but we optimize by pre-allocating and avoiding redundant calculations
-                num_samples = audio.shape[0]
-                new_num_samples = int(num_samples * ratio)
-                num_channels = audio.shape[1]
-                resampled = np.empty((new_num_samples, num_channels), dtype=np.float32)
-
-                # Process all channels (optimized with pre-allocation)
-                for ch in range(num_channels):
-                    resampled[:, ch] = signal.resample_poly(audio[:, ch], up, down)
-
-                return resampled
+            # Mono or multi-channel: one call filters every channel along
+            # the time axis (no per-channel Python loop)
+            result_poly: np.ndarray = signal.resample_poly(
+                audio, up, down, axis=0, window=self._poly_filter(up, down)
+            ).astype(np.float32, copy=False)
+            return result_poly
         except Exception as e:
             logger.warning(f"scipy.resample_poly failed, falling back to FFT method: {e}")
 
@@ -478,14 +803,23 @@ class AudioConverter:
         num_samples = audio.shape[0]
         new_num_samples = int(num_samples * ratio)
 
-        if audio.ndim == 1:
-            result_fft: np.ndarray = signal.resample(audio, new_num_samples).astype(np.float32)  # type: ignore[no-any-return]
-            return result_fft
-        else:
-            resampled = np.zeros((new_num_samples, audio.shape[1]), dtype=np.float32)
-            for ch in range(audio.shape[1]):
-                resampled[:, ch] = signal.resample(audio[:, ch], new_num_samples)
-            return resampled.astype(np.float32)
+        result_fft: np.ndarray = signal.resample(audio, new_num_samples, axis=0).astype(np.float32, copy=False)
+        return result_fft
+
+    def _poly_filter(self, up: int, down: int) -> np.ndarray:
+        """
+        Anti-aliasing filter for resample_poly, designed once per ratio.
+
+        Same design as resample_poly's default (Kaiser window, beta 5.0), in
+        float32 like the audio, so results are identical to not passing it.
+        """
+        key = (up, down)
+        taps = self._poly_filters.get(key)
+        if taps is None:
+            max_rate = max(up, down)
+            taps = signal.firwin(2 * 10 * max_rate + 1, 1.0 / max_rate, window=('kaiser', 5.0)).astype(np.float32)
+            self._poly_filters[key] = taps
+        return taps
 
 
 def is_conversion_needed(
@@ -505,4 +839,7 @@ def is_conversion_needed(
     )
 
 
-__all__ = ['AudioConverter', 'SampleFormat', 'is_conversion_needed']
+__all__ = [
+    'AudioConverter', 'SampleFormat', 'WIDE_CHANNELS',
+    'deinterleave', 'frames_view', 'interleave', 'is_conversion_needed',
+]
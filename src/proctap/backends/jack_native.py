@@ -0,0 +1,711 @@
+"""
+JACK native API bindings using ctypes.
+
+This module provides ctypes bindings to the JACK C API for deterministic,
+low-latency capture on hosts running JACK (jackd/jackdbus) or PipeWire's
+JACK layer (pipewire-jack).
+
+Capture is passive: a proctap client registers input ports and connects the
+target application's output ports to them. JACK fans out output ports, so the
+application keeps playing to its existing connections and no routing changes.
+
+Requirements:
+- libjack.so.0 (JACK2, JACK1 or pipewire-jack)
+- A running JACK server (the client never auto-starts one)
+
+The process callback is native (proctap._pipeline.JackRing): JACK's realtime
+thread copies every period into a lock-free ring without entering the
+interpreter, and Python only drains the ring on its reader thread.
+
+Latency: one JACK period (e.g. 64 frames @ 48kHz = ~1.3ms)
+"""
+
+from __future__ import annotations
+
+import ctypes
+import ctypes.util
+import logging
+import os
+import re
+import threading
+from dataclasses import dataclass
+from typing import Callable, Optional
+
+logger = logging.getLogger(__name__)
+
+try:
+    from .._pipeline import JackRing
+except ImportError:  # Extension not built
+    JackRing = None  # type: ignore[misc,assignment]
+
+# Type aliases
+PidLookup = Callable[[str], Optional[int]]
+
+
+class JackError(Exception):
+    """Exception raised for JACK API errors."""
+    pass
+
+
+class JackClientError(JackError):
+    """Exception raised when the JACK client cannot be opened or activated."""
+    pass
+
+
+class JackPortError(JackError):
+    """Exception raised for port registration or connection errors."""
+    pass
+
+
+# JACK constants (from jack/types.h)
+JACK_DEFAULT_AUDIO_TYPE = b"32 bit float mono audio"
+
+JackNullOption = 0x00
+JackNoStartServer = 0x01
+
+JackPortIsInput = 0x1
+JackPortIsOutput = 0x2
+JackPortIsPhysical = 0x4
+JackPortIsTerminal = 0x10
+
+
+def _get_status_string(status: int) -> str:
+    """
+    Get human-readable description of a jack_status_t bitmask.
+
+    Args:
+        status: jack_status_t value
+
+    Returns:
+        Human-readable description
+    """
+    if status == 0:
+        return "Success"
+
+    status_names = {
+        0x01: "JackFailure (overall operation failed)",
+        0x02: "JackInvalidOption",
+        0x04: "JackNameNotUnique",
+        0x08: "JackServerStarted",
+        0x10: "JackServerFailed (unable to connect to server)",
+        0x20: "JackServerError (communication error with server)",
+        0x40: "JackNoSuchClient",
+        0x80: "JackLoadFailure",
+        0x100: "JackInitFailure",
+        0x200: "JackShmFailure",
+        0x400: "JackVersionError",
+        0x800: "JackBackendError",
+        0x1000: "JackClientZombie",
+    }
+
+    names = [name for bit, name in status_names.items() if status & bit]
+    return ", ".join(names) if names else f"Unknown status {status:#x}"
+
+
+# Load JACK library
+def _load_jack_library() -> ctypes.CDLL:
+    """
+    Load the JACK shared library.
+
+    Returns:
+        ctypes.CDLL: Loaded JACK library
+
+    Raises:
+        JackError: If library cannot be loaded
+    """
+    lib_name = ctypes.util.find_library('jack')
+    if lib_name is None:
+        raise JackError(
+            "libjack.so not found. "
+            "Install JACK (e.g., libjack-jackd2-0) or pipewire-jack"
+        )
+
+    try:
+        lib = ctypes.CDLL(lib_name)
+        logger.debug(f"Loaded JACK library: {lib_name}")
+        return lib
+    except OSError as e:
+        raise JackError(f"Failed to load JACK library: {e}") from e
+
+
+# Attempt to load library (will raise JackError if not available)
+_jack_lib: Optional[ctypes.CDLL]
+try:
+    _jack_lib = _load_jack_library()
+except JackError as e:
+    logger.debug(f"JACK native bindings unavailable: {e}")
+    _jack_lib = None
+
+
+# Function pointer types (the process callback is native, see JackRing)
+JACK_SHUTDOWN_CALLBACK = ctypes.CFUNCTYPE(None, ctypes.c_void_p)
+
+
+# Define JACK C API functions
+if _jack_lib is not None:
+    # Client
+    _jack_lib.jack_client_open.argtypes = [
+        ctypes.c_char_p,                 # client_name
+        ctypes.c_int,                    # jack_options_t
+        ctypes.POINTER(ctypes.c_int),    # jack_status_t *
+    ]
+    _jack_lib.jack_client_open.restype = ctypes.c_void_p
+
+    _jack_lib.jack_client_close.argtypes = [ctypes.c_void_p]
+    _jack_lib.jack_client_close.restype = ctypes.c_int
+
+    _jack_lib.jack_get_client_name.argtypes = [ctypes.c_void_p]
+    _jack_lib.jack_get_client_name.restype = ctypes.c_char_p
+
+    _jack_lib.jack_activate.argtypes = [ctypes.c_void_p]
+    _jack_lib.jack_activate.restype = ctypes.c_int
+
+    _jack_lib.jack_deactivate.argtypes = [ctypes.c_void_p]
+    _jack_lib.jack_deactivate.restype = ctypes.c_int
+
+    _jack_lib.jack_set_process_callback.argtypes = [
+        ctypes.c_void_p,   # client
+        ctypes.c_void_p,   # JackProcessCallback (native)
+        ctypes.c_void_p,   # arg
+    ]
+    _jack_lib.jack_set_process_callback.restype = ctypes.c_int
+
+    _jack_lib.jack_on_shutdown.argtypes = [
+        ctypes.c_void_p,
+        JACK_SHUTDOWN_CALLBACK,
+        ctypes.c_void_p,
+    ]
+    _jack_lib.jack_on_shutdown.restype = None
+
+    _jack_lib.jack_get_sample_rate.argtypes = [ctypes.c_void_p]
+    _jack_lib.jack_get_sample_rate.restype = ctypes.c_uint32
+
+    _jack_lib.jack_get_buffer_size.argtypes = [ctypes.c_void_p]
+    _jack_lib.jack_get_buffer_size.restype = ctypes.c_uint32
+
+    # Ports
+    _jack_lib.jack_port_register.argtypes = [
+        ctypes.c_void_p,   # client
+        ctypes.c_char_p,   # port_name
+        ctypes.c_char_p,   # port_type
+        ctypes.c_ulong,    # flags
+        ctypes.c_ulong,    # buffer_size
+    ]
+    _jack_lib.jack_port_register.restype = ctypes.c_void_p
+
+    _jack_lib.jack_port_unregister.argtypes = [ctypes.c_void_p, ctypes.c_void_p]
+    _jack_lib.jack_port_unregister.restype = ctypes.c_int
+
+    _jack_lib.jack_port_get_buffer.argtypes = [ctypes.c_void_p, ctypes.c_uint32]
+    _jack_lib.jack_port_get_buffer.restype = ctypes.c_void_p
+
+    _jack_lib.jack_port_name.argtypes = [ctypes.c_void_p]
+    _jack_lib.jack_port_name.restype = ctypes.c_char_p
+
+    _jack_lib.jack_port_by_name.argtypes = [ctypes.c_void_p, ctypes.c_char_p]
+    _jack_lib.jack_port_by_name.restype = ctypes.c_void_p
+
+    _jack_lib.jack_port_flags.argtypes = [ctypes.c_void_p]
+    _jack_lib.jack_port_flags.restype = ctypes.c_int
+
+    _jack_lib.jack_get_ports.argtypes = [
+        ctypes.c_void_p,   # client
+        ctypes.c_char_p,   # port_name_pattern
+        ctypes.c_char_p,   # type_name_pattern
+        ctypes.c_ulong,    # flags
+    ]
+    _jack_lib.jack_get_ports.restype = ctypes.POINTER(ctypes.c_char_p)
+
+    _jack_lib.jack_free.argtypes = [ctypes.c_void_p]
+    _jack_lib.jack_free.restype = None
+
+    _jack_lib.jack_connect.argtypes = [ctypes.c_void_p, ctypes.c_char_p, ctypes.c_char_p]
+    _jack_lib.jack_connect.restype = ctypes.c_int
+
+    _jack_lib.jack_disconnect.argtypes = [ctypes.c_void_p, ctypes.c_char_p, ctypes.c_char_p]
+    _jack_lib.jack_disconnect.restype = ctypes.c_int
+
+    # Optional: not every JACK implementation exports this
+    if hasattr(_jack_lib, 'jack_get_client_pid'):
+        _jack_lib.jack_get_client_pid.argtypes = [ctypes.c_char_p]
+        _jack_lib.jack_get_client_pid.restype = ctypes.c_int
+
+
+def is_available() -> bool:
+    """
+    Check if JACK native bindings are available.
+
+    Returns:
+        True if libjack could be loaded and the native ring is built,
+        False otherwise
+    """
+    return _jack_lib is not None and JackRing is not None
+
+
+@dataclass
+class JackClientInfo:
+    """Output ports of one JACK client."""
+    name: str
+    ports: list[str]
+    pid: Optional[int] = None
+
+
+def group_ports_by_client(port_names: list[str]) -> dict[str, list[str]]:
+    """
+    Group full port names ("client:port") by client name.
+
+    Args:
+        port_names: Full JACK port names
+
+    Returns:
+        Mapping of client name to its port names, in original order
+    """
+    clients: dict[str, list[str]] = {}
+    for port_name in port_names:
+        client, sep, _ = port_name.partition(':')
+        if not sep:
+            continue
+        clients.setdefault(client, []).append(port_name)
+    return clients
+
+
+def _process_names(pid: int) -> list[str]:
+    """Best-effort list of names a process may use as its JACK client name."""
+    names: list[str] = []
+    try:
+        with open(f"/proc/{pid}/comm", "r") as f:
+            names.append(f.read().strip())
+    except OSError:
+        pass
+    try:
+        with open(f"/proc/{pid}/cmdline", "rb") as f:
+            argv0 = f.read().split(b"\0", 1)[0].decode("utf-8", "replace")
+        if argv0:
+            names.append(os.path.basename(argv0))
+    except OSError:
+        pass
+    return [n.lower() for n in names if n]
+
+
+def select_target_clients(
+    clients: list[JackClientInfo],
+    pid: Optional[int] = None,
+    client_name: Optional[str] = None,
+    exclude: tuple[str, ...] = (),
+) -> list[JackClientInfo]:
+    """
+    Select the JACK clients that belong to the target application.
+
+    Matching order:
+    1. client_name, if given (exact match, or regular expression)
+    2. PID reported by the JACK server (jack_get_client_pid)
+    3. Process name of the PID (/proc/<pid>/comm, argv[0]) against the
+       client name, for servers that do not report PIDs
+
+    Args:
+        clients: Candidate clients with their output ports
+        pid: Target process ID
+        client_name: Target client name or regular expression
+        exclude: Client names to never select (e.g. our own client)
+
+    Returns:
+        Matching clients (may be empty)
+    """
+    candidates = [c for c in clients if c.name not in exclude]
+
+    if client_name is not None:
+        exact = [c for c in candidates if c.name == client_name]
+        if exact:
+            return exact
+        pattern = re.compile(client_name)
+        return [c for c in candidates if pattern.fullmatch(c.name)]
+
+    if pid is None:
+        return []
+
+    by_pid = [c for c in candidates if c.pid == pid]
+    if by_pid:
+        return by_pid
+
+    names = _process_names(pid)
+    if not names:
+        return []
+    return [
+        c for c in candidates
+        if c.pid is None and any(c.name.lower().startswith(n) for n in names)
+    ]
+
+
+def plan_connections(source_ports: list[str], client_name: str, channels: int) -> list[tuple[str, str]]:
+    """
+    Map source output ports to our input ports (in_1 .. in_N).
+
+    - Equal counts: one to one.
+    - Fewer sources than channels: the last source is fanned out to the
+      remaining inputs (mono -> stereo).
+    - More sources than channels: source i feeds input i mod channels and
+      JACK sums the ports connected to the same input, so a client with two
+      stereo pairs folds left into left and right into right.
+
+    Args:
+        source_ports: Full names of the source output ports
+        client_name: Our JACK client name
+        channels: Number of input ports
+
+    Returns:
+        List of (source, destination) port name pairs
+    """
+    if len(source_ports) > channels:
+        return [(src, f"{client_name}:in_{i % channels + 1}") for i, src in enumerate(source_ports)]
+    return [
+        (source_ports[min(ch, len(source_ports) - 1)], f"{client_name}:in_{ch + 1}")
+        for ch in range(channels)
+    ]
+
+
+class JackClientCapture:
+    """
+    Passive JACK capture client.
+
+    Registers one input port per channel, connects the target's output
+    ports to them and copies every period into a native JackRing.
+    """
+
+    def __init__(
+        self,
+        channels: int = 2,
+        client_name: str = "proctap",
+        ring_periods: int = 64,
+    ) -> None:
+        """
+        Initialize JACK capture client.
+
+        Args:
+            channels: Number of input ports to register
+            client_name: Requested JACK client name
+            ring_periods: Ring capacity in JACK periods
+
+        Raises:
+            JackError: If JACK bindings are not available
+        """
+        if not is_available():
+            raise JackError("JACK native bindings not available")
+
+        self._channels = channels
+        self._requested_name = client_name
+        self._ring_periods = ring_periods
+
+        self._client: Optional[int] = None
+        self._client_name: str = client_name
+        self._ports: list[int] = []
+        self._connections: list[tuple[str, str]] = []
+        self._ring: Optional[JackRing] = None
+        self._active = False
+        self._sample_rate = 0
+        self._period_frames = 0
+
+        self._shutdown = threading.Event()
+
+        # Keep a reference to prevent garbage collection
+        self._shutdown_cb_ref: Optional[object] = None
+
+    # --- lifecycle --------------------------------------------------------
+
+    def open(self) -> None:
+        """
+        Open the client and register input ports.
+
+        Raises:
+            JackClientError: If the JACK server is not reachable
+            JackPortError: If port registration fails
+        """
+        assert _jack_lib is not None, "JACK library not loaded"
+        assert JackRing is not None, "_pipeline extension not built"
+
+        if self._client is not None:
+            return
+
+        status = ctypes.c_int(0)
+        client = _jack_lib.jack_client_open(
+            self._requested_name.encode('utf-8'),
+            JackNoStartServer,
+            ctypes.byref(status),
+        )
+        if not client:
+            raise JackClientError(
+                f"Failed to open JACK client: {_get_status_string(status.value)}. "
+                "Make sure a JACK server (or pipewire-jack) is running."
+            )
+        self._client = client
+
+        try:
+            name = _jack_lib.jack_get_client_name(client)
+            self._client_name = name.decode('utf-8') if name else self._requested_name
+            self._sample_rate = int(_jack_lib.jack_get_sample_rate(client))
+            self._period_frames = int(_jack_lib.jack_get_buffer_size(client))
+
+            for ch in range(self._channels):
+                port = _jack_lib.jack_port_register(
+                    client,
+                    f"in_{ch + 1}".encode('utf-8'),
+                    JACK_DEFAULT_AUDIO_TYPE,
+                    JackPortIsInput | JackPortIsTerminal,
+                    0,
+                )
+                if not port:
+                    raise JackPortError(f"Failed to register input port in_{ch + 1}")
+                self._ports.append(port)
+
+            # The ring (and its port list) must outlive the active client;
+            # close() deactivates before the ring can be released
+            ring = JackRing(
+                ports=self._ports,
+                capacity_frames=max(self._period_frames, 256) * self._ring_periods,
+                port_get_buffer=ctypes.cast(_jack_lib.jack_port_get_buffer, ctypes.c_void_p).value or 0,
+            )
+            self._ring = ring
+            ret = _jack_lib.jack_set_process_callback(client, ring.process_callback, ring.process_arg)
+            if ret != 0:
+                raise JackClientError(f"Failed to set process callback (ret={ret})")
+
+            self._shutdown_cb_ref = JACK_SHUTDOWN_CALLBACK(self._on_shutdown)
+            _jack_lib.jack_on_shutdown(client, self._shutdown_cb_ref, None)
+
+            logger.info(
+                f"Opened JACK client '{self._client_name}' "
+                f"({self._sample_rate}Hz, period={self._period_frames} frames)"
+            )
+        except Exception:
+            self.close()
+            raise
+
+    def activate(self) -> None:
+        """
+        Activate the client so the process callback starts running.
+
+        Raises:
+            JackClientError: If activation fails
+        """
+        assert _jack_lib is not None, "JACK library not loaded"
+
+        if self._client is None:
+            raise JackClientError("Client is not open. Call open() first.")
+        if self._active:
+            return
+
+        ret = _jack_lib.jack_activate(self._client)
+        if ret != 0:
+            raise JackClientError(f"Failed to activate JACK client (ret={ret})")
+        self._active = True
+
+    def close(self) -> None:
+        """
+        Disconnect, deactivate and close the client.
+
+        Note: This method does not raise exceptions to ensure cleanup always completes.
+        """
+        if _jack_lib is None or self._client is None:
+            return
+
+        for src, dst in self._connections:
+            try:
+                _jack_lib.jack_disconnect(self._client, src.encode('utf-8'), dst.encode('utf-8'))
+            except Exception as e:
+                logger.debug(f"Error disconnecting {src} -> {dst}: {e}")
+        self._connections = []
+
+        try:
+            if self._active:
+                _jack_lib.jack_deactivate(self._client)
+            _jack_lib.jack_client_close(self._client)
+        except Exception as e:
+            logger.warning(f"Error closing JACK client: {e}")
+
+        self._client = None
+        self._active = False
+        self._ports = []
+        self._shutdown_cb_ref = None
+        logger.debug(f"Closed JACK client '{self._client_name}'")
+
+    # --- discovery --------------------------------------------------------
+
+    def list_output_clients(self) -> list[JackClientInfo]:
+        """
+        List clients that own audio output ports.
+
+        Physical (hardware) ports are skipped.
+
+        Returns:
+            One JackClientInfo per client
+        """
+        assert _jack_lib is not None, "JACK library not loaded"
+        if self._client is None:
+            raise JackClientError("Client is not open. Call open() first.")
+
+        port_names = self._get_ports(JackPortIsOutput)
+        port_names = [
+            name for name in port_names
+            if not (self._port_flags(name) & JackPortIsPhysical)
+        ]
+
+        clients = []
+        for name, ports in group_ports_by_client(port_names).items():
+            clients.append(JackClientInfo(name=name, ports=ports, pid=self._client_pid(name)))
+        return clients
+
+    def find_target_ports(
+        self,
+        pid: Optional[int] = None,
+        client_name: Optional[str] = None,
+    ) -> list[str]:
+        """
+        Find the output ports of the target application.
+
+        Args:
+            pid: Target process ID
+            client_name: Target client name or regular expression
+
+        Returns:
+            Full names of the target's output ports (may be empty)
+        """
+        clients = select_target_clients(
+            self.list_output_clients(),
+            pid=pid,
+            client_name=client_name,
+            exclude=(self._client_name,),
+        )
+        ports: list[str] = []
+        for client in clients:
+            logger.info(f"Matched JACK client '{client.name}' (pid={client.pid})")
+            ports.extend(client.ports)
+        return ports
+
+    def connect_sources(self, source_ports: list[str]) -> None:
+        """
+        Connect source output ports to our input ports.
+
+        See plan_connections() for how sources map to inputs when the
+        counts differ.
+
+        Args:
+            source_ports: Full names of the output ports to capture
+
+        Raises:
+            JackPortError: If a connection cannot be made
+        """
+        assert _jack_lib is not None, "JACK library not loaded"
+        if self._client is None:
+            raise JackClientError("Client is not open. Call open() first.")
+        if not source_ports:
+            raise JackPortError("No source ports to connect")
+
+        if len(source_ports) > self._channels:
+            logger.info(
+                f"{len(source_ports)} source ports for {self._channels} channels; "
+                f"folding port i into input i mod {self._channels}"
+            )
+        for src, dst in plan_connections(source_ports, self._client_name, self._channels):
+            ret = _jack_lib.jack_connect(self._client, src.encode('utf-8'), dst.encode('utf-8'))
+            # EEXIST: already connected
+            if ret != 0 and ret != 17:
+                raise JackPortError(f"Failed to connect {src} -> {dst} (ret={ret})")
+            self._connections.append((src, dst))
+            logger.debug(f"Connected {src} -> {dst}")
+
+    # --- callbacks ---------------------------------------------------------
+
+    def _on_shutdown(self, _arg: ctypes.c_void_p) -> None:
+        """JACK server shut down: mark the client inactive."""
+        logger.warning("JACK server shut down")
+        self._active = False
+        self._shutdown.set()
+        if self._ring is not None:
+            self._ring.wake()
+
+    # --- reading ----------------------------------------------------------
+
+    def read(self, timeout: float = 0.1) -> Optional[bytes]:
+        """
+        Read everything captured since the last call.
+
+        Args:
+            timeout: Maximum time to wait for a period
+
+        Returns:
+            Interleaved float32 PCM as bytes, or None on timeout
+        """
+        if self._ring is None:
+            return None
+
+        if self._ring.available == 0:
+            self._ring.wait(timeout)
+        return self._ring.read()
+
+    # --- helpers ----------------------------------------------------------
+
+    def _get_ports(self, flags: int) -> list[str]:
+        """Get audio port names matching the given flags."""
+        assert _jack_lib is not None, "JACK library not loaded"
+        ports_ptr = _jack_lib.jack_get_ports(self._client, None, JACK_DEFAULT_AUDIO_TYPE, flags)
+        if not ports_ptr:
+            return []
+        names = []
+        try:
+            i = 0
+            while ports_ptr[i]:
+                names.append(ports_ptr[i].decode('utf-8'))
+                i += 1
+        finally:
+            _jack_lib.jack_free(ctypes.cast(ports_ptr, ctypes.c_void_p))
+        return names
+
+    def _port_flags(self, port_name: str) -> int:
+        """Get the flags of a port by name (0 if unknown)."""
+        assert _jack_lib is not None, "JACK library not loaded"
+        port = _jack_lib.jack_port_by_name(self._client, port_name.encode('utf-8'))
+        return int(_jack_lib.jack_port_flags(port)) if port else 0
+
+    @staticmethod
+    def _client_pid(client_name: str) -> Optional[int]:
+        """Get the PID of a client, if the server reports it."""
+        if _jack_lib is None or not hasattr(_jack_lib, 'jack_get_client_pid'):
+            return None
+        try:
+            pid = int(_jack_lib.jack_get_client_pid(client_name.encode('utf-8')))
+        except Exception:
+            return None
+        return pid if pid > 0 else None
+
+    # --- properties -------------------------------------------------------
+
+    @property
+    def sample_rate(self) -> int:
+        """Server sample rate in Hz (0 until open)."""
+        return self._sample_rate
+
+    @property
+    def period_frames(self) -> int:
+        """Server period (buffer size) in frames (0 until open)."""
+        return self._period_frames
+
+    @property
+    def buffered_frames(self) -> int:
+        """Frames captured but not read yet."""
+        return self._ring.available if self._ring is not None else 0
+
+    @property
+    def client_name(self) -> str:
+        """Actual client name assigned by the server."""
+        return self._client_name
+
+    @property
+    def is_shut_down(self) -> bool:
+        """True if the JACK server shut down while the client was open."""
+        return self._shutdown.is_set()
+
+    def __del__(self):
+        """Destructor."""
+        try:
+            self.close()
+        except:
+            pass
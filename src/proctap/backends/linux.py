@@ -12,6 +12,7 @@ Features:
 - Automatic detection of PipeWire vs PulseAudio
 - Native PipeWire support via pw-record
 - PulseAudio support via parec
+- JACK support via a passive native client (opt-in)
 - Per-process audio isolation using null-sink strategy
 - Graceful fallback between backends
 - Automatic format conversion to standard format
@@ -20,11 +21,12 @@ Requirements:
 - pulsectl library (pip install pulsectl)
 - For PulseAudio: parec command (pulseaudio-utils package)
 - For PipeWire: pw-record command (pipewire-utils package)
+- For JACK: libjack (JACK2/JACK1) or pipewire-jack
 """
 
 from __future__ import annotations
 
-from typing import Optional, Callable, Any
+from typing import TYPE_CHECKING, Optional, Callable, Any
 from abc import ABC, abstractmethod
 import logging
 import queue
@@ -40,6 +42,10 @@ from .base import (
     STANDARD_SAMPLE_WIDTH,
 )
 from .converter import AudioConverter, SampleFormat
+from . import pipewire_links
+
+if TYPE_CHECKING:
+    from ..hibernation import ActivityDetector
 
 # Try to import native PipeWire bindings
 try:
@@ -49,12 +55,76 @@ except (ImportError, AttributeError):
     PIPEWIRE_NATIVE_AVAILABLE = False
     pipewire_native = None  # type: ignore
 
+# Try to import native JACK bindings
+try:
+    from . import jack_native
+    JACK_NATIVE_AVAILABLE = jack_native.is_available()
+except (ImportError, AttributeError):
+    JACK_NATIVE_AVAILABLE = False
+    jack_native = None  # type: ignore
+
 logger = logging.getLogger(__name__)
 
 # Type alias for audio callback
 AudioCallback = Callable[[bytes, int], None]
 
 
+def _queued_bytes(audio_queue: "queue.Queue[bytes]") -> int:
+    """Total size of the chunks waiting in a capture queue."""
+    with audio_queue.mutex:
+        return sum(len(chunk) for chunk in audio_queue.queue)
+
+
+class _StreamState:
+    """
+    Mute/volume queries for the state poll on a dedicated pulsectl connection.
+
+    pulsectl.Pulse is not thread-safe: the strategy's own connection is used
+    from the caller's thread (start/stop/routing), while is_muted() is
+    polled from the capture worker. The state connection is opened lazily on
+    the first poll, and a lock serializes polls against close().
+    """
+
+    def __init__(self, pulsectl_module: Any, client_name: str) -> None:
+        self._pulsectl = pulsectl_module
+        self._client_name = client_name
+        self._pulse: Any = None
+        self._closed = False
+        self._lock = threading.Lock()
+
+    def muted(self, sink_input_index: Optional[int]) -> Optional[bool]:
+        """
+        Mute state of a sink-input (muted or zero volume), None if unknown.
+
+        Args:
+            sink_input_index: Sink-input of the target stream (or None)
+        """
+        if sink_input_index is None:
+            return None
+        with self._lock:
+            if self._closed:
+                return None
+            try:
+                if self._pulse is None:
+                    self._pulse = self._pulsectl.Pulse(self._client_name)
+                sink_input = self._pulse.sink_input_info(sink_input_index)
+                return bool(sink_input.mute) or sink_input.volume.value_flat <= 0.0
+            except Exception as e:
+                logger.debug(f"Could not query sink-input #{sink_input_index} state: {e}")
+                return None
+
+    def close(self) -> None:
+        """Close the state connection; later polls return None."""
+        with self._lock:
+            self._closed = True
+            if self._pulse is not None:
+                try:
+                    self._pulse.close()
+                except Exception:
+                    pass
+                self._pulse = None
+
+
 def detect_audio_server() -> str:
     """
     Detect which audio server is running on the system.
@@ -105,6 +175,10 @@ class LinuxAudioStrategy(ABC):
     Allows switching between PulseAudio and PipeWire implementations.
     """
 
+    # stop_capture() followed by find_process_stream() and start_capture()
+    # resumes on the same connection (LinuxBackend.park()/unpark())
+    restartable = False
+
     @abstractmethod
     def connect(self) -> None:
         """Connect to the audio server."""
@@ -161,6 +235,18 @@ class LinuxAudioStrategy(ABC):
         """
         pass
 
+    def get_latency_ms(self) -> float:
+        """Algorithmic latency of the strategy (chunk/period size) in milliseconds."""
+        return 0.0
+
+    def get_buffered_ms(self) -> float:
+        """Audio currently waiting in the strategy's queue in milliseconds."""
+        return 0.0
+
+    def is_muted(self) -> Optional[bool]:
+        """Server-side mute/zero-volume state of the stream (None: unknown)."""
+        return None
+
 
 class PulseAudioStrategy(LinuxAudioStrategy):
     """
@@ -170,6 +256,8 @@ class PulseAudioStrategy(LinuxAudioStrategy):
     Works on systems with PulseAudio or PipeWire (via pulseaudio-compat layer).
     """
 
+    restartable = True
+
     def __init__(
         self,
         pid: int,
@@ -193,6 +281,7 @@ class PulseAudioStrategy(LinuxAudioStrategy):
         self._bits_per_sample = sample_width * 8
 
         self._pulse: Any = None  # pulsectl.Pulse instance
+        self._state: Optional[_StreamState] = None  # Own connection for is_muted()
         self._sink_input_index: Optional[int] = None
         self._null_sink_index: Optional[int] = None
         self._null_sink_name: Optional[str] = None
@@ -222,6 +311,7 @@ class PulseAudioStrategy(LinuxAudioStrategy):
         """Connect to PulseAudio server."""
         try:
             self._pulse = self._pulsectl.Pulse('proctap')
+            self._state = _StreamState(self._pulsectl, 'proctap-state')
             logger.info("Connected to PulseAudio server")
         except Exception as e:
             raise RuntimeError(
@@ -571,6 +661,9 @@ class PulseAudioStrategy(LinuxAudioStrategy):
         """Clean up resources and restore audio routing."""
         self.stop_capture()
 
+        if self._state is not None:
+            self._state.close()
+            self._state = None
         if self._pulse:
             self._pulse.close()
             self._pulse = None
@@ -584,6 +677,22 @@ class PulseAudioStrategy(LinuxAudioStrategy):
             'bits_per_sample': self._bits_per_sample,
         }
 
+    def get_latency_ms(self) -> float:
+        """Algorithmic latency: one capture chunk in milliseconds."""
+        return float(self._chunk_duration_ms)
+
+    def get_buffered_ms(self) -> float:
+        """Audio currently waiting in the capture queue in milliseconds."""
+        frame_bytes = self._channels * self._bits_per_sample // 8
+        return 1000.0 * _queued_bytes(self._audio_queue) / (frame_bytes * self._sample_rate)
+
+    def is_muted(self) -> Optional[bool]:
+        """Mute/zero-volume state of the target sink-input."""
+        state = self._state  # close() may clear it from another thread
+        if state is None:
+            return None
+        return state.muted(self._sink_input_index)
+
 
 class PipeWireStrategy(LinuxAudioStrategy):
     """
@@ -595,14 +704,25 @@ class PipeWireStrategy(LinuxAudioStrategy):
 
     Note: Falls back to PulseAudio compatibility layer (pulsectl)
     for stream enumeration and management.
+
+    Isolation modes:
+    - "null-sink" (default): Move the app's sink-input to a temporary
+      null-sink and record its monitor (same as PulseAudioStrategy)
+    - "link": Link the app node's output ports directly to pw-record's
+      input ports via the link-factory. The app keeps playing to its normal
+      sink (no audible interruption, no extra graph hop, no modules to leak).
+      Never falls back to "null-sink": a failed link raises RuntimeError.
     """
 
+    restartable = True
+
     def __init__(
         self,
         pid: int,
         sample_rate: int = 48000,  # PipeWire default is 48kHz
         channels: int = 2,
         sample_width: int = 2,
+        isolation: str = "null-sink",
     ) -> None:
         """
         Initialize PipeWire strategy.
@@ -612,7 +732,11 @@ class PipeWireStrategy(LinuxAudioStrategy):
             sample_rate: Sample rate in Hz (default: 48000 for PipeWire)
             channels: Number of channels (default: 2 for stereo)
             sample_width: Bytes per sample (default: 2 for 16-bit)
+            isolation: Isolation mode, "null-sink" or "link"
         """
+        if isolation not in ("null-sink", "link"):
+            raise ValueError(f"Unknown isolation mode: {isolation}. Use 'null-sink' or 'link'")
+
         self._pid = pid
         self._sample_rate = sample_rate
         self._channels = channels
@@ -620,6 +744,7 @@ class PipeWireStrategy(LinuxAudioStrategy):
         self._bits_per_sample = sample_width * 8
 
         self._pulse: Any = None  # pulsectl.Pulse instance (using PulseAudio compat layer)
+        self._state: Optional[_StreamState] = None  # Own connection for is_muted()
         self._sink_input_index: Optional[int] = None
         self._stream_id: Optional[str] = None
         self._null_sink_index: Optional[int] = None
@@ -630,6 +755,9 @@ class PipeWireStrategy(LinuxAudioStrategy):
         self._stop_event = threading.Event()
         self._pulsectl: Any = None  # pulsectl module
         self._chunk_duration_ms = 10  # Configurable chunk duration in milliseconds
+        self._isolation = isolation
+        self._target_nodes: list[int] = []  # PipeWire node IDs (link mode)
+        self._linker = pipewire_links.PortLinker()
 
         # Check if pw-record is available
         try:
@@ -651,15 +779,22 @@ class PipeWireStrategy(LinuxAudioStrategy):
             import pulsectl
             self._pulsectl = pulsectl
         except ImportError as e:
-            raise RuntimeError(
-                "pulsectl library is required for PipeWire stream management. "
-                "Install it with: pip install pulsectl"
-            ) from e
+            # Link mode only needs pw-dump/pw-link (but then cannot fall back)
+            if isolation != "link":
+                raise RuntimeError(
+                    "pulsectl library is required for PipeWire stream management. "
+                    "Install it with: pip install pulsectl"
+                ) from e
 
     def connect(self) -> None:
         """Connect to PipeWire via PulseAudio compatibility layer."""
+        if self._pulsectl is None:
+            logger.debug("pulsectl not available, using PipeWire graph only (link mode)")
+            return
+
         try:
             self._pulse = self._pulsectl.Pulse('proctap-pipewire')
+            self._state = _StreamState(self._pulsectl, 'proctap-state')
             logger.info("Connected to PipeWire (via PulseAudio compatibility layer)")
         except Exception as e:
             raise RuntimeError(
@@ -671,15 +806,49 @@ class PipeWireStrategy(LinuxAudioStrategy):
         """
         Find sink-input for the target process using PulseAudio compatibility API.
 
+        In link mode, the target's PipeWire nodes are what counts; the
+        sink-input is only looked up (if connected) for its mute state.
+
         Args:
             pid: Process ID to find
 
         Returns:
             True if stream found, False otherwise
         """
+        if self._isolation == "link":
+            try:
+                self._target_nodes = pipewire_links.find_nodes_by_pid(
+                    pipewire_links.dump_graph(), pid
+                )
+            except Exception as e:
+                logger.warning(f"Could not inspect PipeWire graph: {e}")
+                self._target_nodes = []
+            if not self._target_nodes:
+                logger.warning(f"No audio stream found for PID {pid}")
+                return False
+            logger.info(f"Found PipeWire node(s) {self._target_nodes} for PID {pid}")
+            if self._pulse is not None:
+                self._find_sink_input(pid)
+            return True
+
         if self._pulse is None:
             raise RuntimeError("Not connected to PipeWire. Call connect() first.")
 
+        if self._find_sink_input(pid):
+            return True
+        logger.warning(f"No audio stream found for PID {pid}")
+        return False
+
+    def _find_sink_input(self, pid: int) -> bool:
+        """
+        Look up the target's sink-input via the PulseAudio compatibility API.
+
+        Args:
+            pid: Process ID to find
+
+        Returns:
+            True if a sink-input was found
+        """
         try:
             sink_inputs = self._pulse.sink_input_list()
             logger.debug(f"Found {len(sink_inputs)} sink inputs")
@@ -697,8 +866,6 @@ class PipeWireStrategy(LinuxAudioStrategy):
                         f" (PW stream ID: {self._stream_id})"
                     )
                     return True
-
-            logger.warning(f"No audio stream found for PID {pid}")
             return False
 
         except Exception as e:
@@ -709,8 +876,19 @@ class PipeWireStrategy(LinuxAudioStrategy):
         """
         Start capturing audio using PipeWire.
 
-        Uses null-sink strategy similar to PulseAudio for isolation.
+        Uses direct port links in "link" mode (never rerouting the app),
+        otherwise the null-sink strategy similar to PulseAudio.
         """
+        if self._isolation == "link":
+            if not self._target_nodes:
+                raise RuntimeError("No PipeWire node found. Call find_process_stream() first.")
+            try:
+                self._setup_linked_capture()
+            except Exception as e:
+                raise RuntimeError(f"Failed to start PipeWire linked capture: {e}") from e
+            logger.info(f"PipeWire linked capture started for PID {self._pid}")
+            return
+
         if self._sink_input_index is None:
             raise RuntimeError("No sink-input found. Call find_process_stream() first.")
 
@@ -790,19 +968,63 @@ class PipeWireStrategy(LinuxAudioStrategy):
         )
         self._capture_thread.start()
 
-    def _capture_worker_pwrecord(self, source_name: str) -> None:
+    def _setup_linked_capture(self) -> None:
+        """
+        Setup capture by linking the target node's ports to pw-record.
+
+        Strategy:
+        1. Start pw-record with a unique node name and autoconnect disabled
+        2. Wait for its input ports to appear in the graph
+        3. Link every output port of the target node(s) to them (pw-link)
+
+        The target keeps its existing links to the user's sink.
+        """
+        node_name = f"proctap_tap_{self._pid}"
+        properties = f'{{ node.name = "{node_name}" node.autoconnect = false }}'
+
+        self._stop_event.clear()
+        self._capture_thread = threading.Thread(
+            target=self._capture_worker_pwrecord,
+            args=(None, properties),
+            daemon=True
+        )
+        self._capture_thread.start()
+
+        try:
+            _, input_ports = pipewire_links.wait_for_node_ports(node_name, "input")
+            objects = pipewire_links.dump_graph()
+            linked = 0
+            for node_id in self._target_nodes:
+                try:
+                    linked += pipewire_links.link_nodes(objects, node_id, input_ports, self._linker)
+                except pipewire_links.PipeWireLinkError as e:
+                    logger.debug(f"Skipping node {node_id}: {e}")
+            if linked == 0:
+                raise pipewire_links.PipeWireLinkError("No ports could be linked")
+            logger.debug(f"Created {linked} port link(s) to {node_name}")
+        except Exception:
+            self._stop_capture_thread()
+            self._linker.unlink_all()
+            raise
+
+    def _capture_worker_pwrecord(self, source_name: Optional[str], properties: Optional[str] = None) -> None:
         """
         Worker thread using pw-record for PipeWire-native capture.
 
         Args:
             source_name: Name of the source to capture from
+                         (None: do not autoconnect, ports are linked explicitly)
+            properties: Extra stream properties for pw-record
         """
         try:
             # Build pw-record command
             # Note: pw-record uses different argument format than parec
-            cmd = [
-                'pw-record',
-                '--target', source_name,
+            cmd = ['pw-record']
+            if source_name is not None:
+                cmd += ['--target', source_name]
+            if properties is not None:
+                cmd += ['--properties', properties]
+            cmd += [
                 '--rate', str(self._sample_rate),
                 '--channels', str(self._channels),
                 '--format', 's16',  # 16-bit signed
@@ -857,13 +1079,19 @@ class PipeWireStrategy(LinuxAudioStrategy):
         except Exception as e:
             logger.error(f"PipeWire capture worker error: {e}")
 
-    def stop_capture(self) -> None:
-        """Stop capturing audio and clean up."""
+    def _stop_capture_thread(self) -> None:
+        """Signal the pw-record worker to stop and wait for it."""
         self._stop_event.set()
 
         if self._capture_thread and self._capture_thread.is_alive():
             self._capture_thread.join(timeout=2.0)
 
+    def stop_capture(self) -> None:
+        """Stop capturing audio and clean up."""
+        self._stop_capture_thread()
+
+        # Links also vanish with the pw-record node; remove them explicitly anyway
+        self._linker.unlink_all()
         self._cleanup_isolation_modules()
         logger.info("PipeWire audio capture stopped")
 
@@ -905,6 +1133,9 @@ class PipeWireStrategy(LinuxAudioStrategy):
         """Clean up resources."""
         self.stop_capture()
 
+        if self._state is not None:
+            self._state.close()
+            self._state = None
         if self._pulse:
             self._pulse.close()
             self._pulse = None
@@ -918,6 +1149,22 @@ class PipeWireStrategy(LinuxAudioStrategy):
             'bits_per_sample': self._bits_per_sample,
         }
 
+    def get_latency_ms(self) -> float:
+        """Algorithmic latency: one capture chunk in milliseconds."""
+        return float(self._chunk_duration_ms)
+
+    def get_buffered_ms(self) -> float:
+        """Audio currently waiting in the capture queue in milliseconds."""
+        frame_bytes = self._channels * self._bits_per_sample // 8
+        return 1000.0 * _queued_bytes(self._audio_queue) / (frame_bytes * self._sample_rate)
+
+    def is_muted(self) -> Optional[bool]:
+        """Mute/zero-volume state of the target sink-input."""
+        state = self._state  # close() may clear it from another thread
+        if state is None:
+            return None
+        return state.muted(self._sink_input_index)
+
 
 class PipeWireNativeStrategy(LinuxAudioStrategy):
     """
@@ -968,6 +1215,9 @@ class PipeWireNativeStrategy(LinuxAudioStrategy):
         self._target_node_id: Optional[int] = None
         self._audio_queue: queue.Queue[bytes] = queue.Queue(maxsize=100)
         self._is_running = False
+        # Frames per process cycle; the server's default clock.quantum until
+        # the first buffer shows the negotiated one
+        self._quantum_frames = 1024
 
     def connect(self) -> None:
         """Connect to PipeWire server."""
@@ -1017,6 +1267,8 @@ class PipeWireNativeStrategy(LinuxAudioStrategy):
         try:
             # Create audio callback
             def on_audio_data(data: bytes, frames: int) -> None:
+                if frames > 0:
+                    self._quantum_frames = frames
                 try:
                     self._audio_queue.put_nowait(data)
                 except queue.Full:
@@ -1085,6 +1337,186 @@ class PipeWireNativeStrategy(LinuxAudioStrategy):
             'bits_per_sample': self._bits_per_sample,
         }
 
+    def get_latency_ms(self) -> float:
+        """Algorithmic latency: one PipeWire quantum in milliseconds."""
+        return 1000.0 * self._quantum_frames / self._sample_rate
+
+    def get_buffered_ms(self) -> float:
+        """Audio currently waiting in the capture queue in milliseconds."""
+        frame_bytes = self._channels * self._bits_per_sample // 8
+        return 1000.0 * _queued_bytes(self._audio_queue) / (frame_bytes * self._sample_rate)
+
+
+class JackStrategy(LinuxAudioStrategy):
+    """
+    JACK-based audio capture strategy using a passive native client.
+
+    Intended for studio hosts running JACK (or PipeWire's JACK layer) with
+    fixed small periods. The target application's output ports are found by
+    PID or client name and connected to our input ports; JACK fans out
+    output ports, so the application's existing routing is left untouched.
+
+    Features:
+    - Deterministic latency of one JACK period
+    - No routing changes, no null-sinks or modules to clean up
+    - Lock-free ring between the process callback and the reader
+    - Captures float32 at the server sample rate
+    """
+
+    def __init__(
+        self,
+        pid: int,
+        sample_rate: int = 48000,
+        channels: int = 2,
+        sample_width: int = 4,
+        client_name: Optional[str] = None,
+    ) -> None:
+        """
+        Initialize JACK strategy.
+
+        Args:
+            pid: Target process ID
+            sample_rate: Expected sample rate in Hz (the server rate wins)
+            channels: Number of channels to capture (default: 2 for stereo)
+            sample_width: Bytes per sample (JACK always delivers 4-byte float32)
+            client_name: Target JACK client name or regular expression.
+                         If None, the target is found by PID.
+
+        Raises:
+            RuntimeError: If JACK native bindings are not available
+        """
+        if not JACK_NATIVE_AVAILABLE or jack_native is None:
+            raise RuntimeError(
+                "JACK native bindings not available. "
+                "Install JACK (libjack) or pipewire-jack."
+            )
+
+        self._pid = pid
+        self._sample_rate = sample_rate
+        self._channels = channels
+        self._sample_width = 4  # JACK ports are always 32-bit float
+        self._bits_per_sample = 32
+        self._target_client_name = client_name
+
+        self._capture: Optional[Any] = None  # jack_native.JackClientCapture
+        self._source_ports: list[str] = []
+        self._is_running = False
+
+    def connect(self) -> None:
+        """Open the JACK client (never starts a server)."""
+        assert jack_native is not None
+        if self._capture is not None:
+            return
+
+        capture = jack_native.JackClientCapture(
+            channels=self._channels,
+            client_name=f"proctap-{self._pid}",
+        )
+        try:
+            capture.open()
+        except jack_native.JackError as e:
+            raise RuntimeError(f"Failed to connect to JACK server: {e}") from e
+
+        self._capture = capture
+        self._sample_rate = capture.sample_rate
+        logger.info(
+            f"Connected to JACK server ({capture.sample_rate}Hz, "
+            f"period={capture.period_frames} frames)"
+        )
+
+    def find_process_stream(self, pid: int) -> bool:
+        """
+        Find the target application's output ports.
+
+        Args:
+            pid: Process ID to find (ignored if a client name was given)
+
+        Returns:
+            True if ports were found, False otherwise
+        """
+        if self._capture is None:
+            raise RuntimeError("Not connected to JACK. Call connect() first.")
+
+        try:
+            self._source_ports = self._capture.find_target_ports(
+                pid=pid,
+                client_name=self._target_client_name,
+            )
+        except Exception as e:
+            logger.error(f"Error finding JACK ports: {e}")
+            return False
+
+        if not self._source_ports:
+            target = self._target_client_name or f"PID {pid}"
+            logger.warning(f"No JACK output ports found for {target}")
+            return False
+
+        logger.info(f"Found JACK ports for PID {pid}: {', '.join(self._source_ports)}")
+        return True
+
+    def start_capture(self) -> None:
+        """Activate the client and connect the target's ports to it."""
+        if self._capture is None or not self._source_ports:
+            raise RuntimeError("No JACK ports found. Call find_process_stream() first.")
+        if self._is_running:
+            return
+
+        try:
+            self._capture.activate()
+            self._capture.connect_sources(self._source_ports)
+            self._is_running = True
+            logger.info("JACK capture started")
+        except Exception as e:
+            raise RuntimeError(f"Failed to start JACK capture: {e}") from e
+
+    def stop_capture(self) -> None:
+        """Stop capturing (disconnects and closes the client)."""
+        if self._capture is not None:
+            self._capture.close()
+            self._capture = None
+        self._is_running = False
+        logger.info("JACK capture stopped")
+
+    def read_audio(self, timeout: float = 0.1) -> Optional[bytes]:
+        """
+        Read audio data from the capture ring.
+
+        Args:
+            timeout: Maximum time to wait for data
+
+        Returns:
+            Interleaved float32 PCM as bytes, or None if no data available
+        """
+        if self._capture is None:
+            return None
+        return self._capture.read(timeout=timeout)  # type: ignore[no-any-return]
+
+    def close(self) -> None:
+        """Clean up resources."""
+        self.stop_capture()
+        logger.debug("Closed JACK strategy")
+
+    def get_format(self) -> dict[str, int | str]:
+        """Get audio format information."""
+        return {
+            'sample_rate': self._sample_rate,
+            'channels': self._channels,
+            'bits_per_sample': self._bits_per_sample,
+            'sample_format': SampleFormat.FLOAT32,
+        }
+
+    def get_latency_ms(self) -> float:
+        """Algorithmic latency: one JACK period in milliseconds."""
+        if self._capture is None or self._capture.sample_rate == 0:
+            return 0.0
+        return float(1000.0 * self._capture.period_frames / self._capture.sample_rate)
+
+    def get_buffered_ms(self) -> float:
+        """Audio currently waiting in the capture ring in milliseconds."""
+        if self._capture is None or self._capture.sample_rate == 0:
+            return 0.0
+        return float(1000.0 * self._capture.buffered_frames / self._capture.sample_rate)
+
 
 class LinuxBackend(AudioBackend):
     """
@@ -1103,6 +1535,7 @@ class LinuxBackend(AudioBackend):
     Audio Server Support:
     - **PipeWire** (Recommended for modern Linux): Uses pw-record for native capture
     - **PulseAudio** (Traditional): Uses parec for capture
+    - **JACK** (Opt-in, engine="jack"): Passive client, one-period latency
     - **Auto-detection**: Automatically selects the best backend for your system
 
     Isolation Strategy:
@@ -1142,6 +1575,8 @@ class LinuxBackend(AudioBackend):
         sample_width: int = 2,
         engine: str = "auto",
         resample_quality: str = 'best',
+        jack_client_name: Optional[str] = None,
+        isolation: str = "null-sink",
     ) -> None:
         """
         Initialize Linux backend.
@@ -1161,19 +1596,47 @@ class LinuxBackend(AudioBackend):
                    - "pipewire-native": Native PipeWire API (ultra-low latency)
                    - "pipewire": PipeWire via subprocess (pw-record)
                    - "pulse": PulseAudio via subprocess (parec)
+                   - "jack": Passive JACK client (one-period latency, opt-in)
             resample_quality: Resampling quality mode ('best', 'medium', 'fast')
+            jack_client_name: Target JACK client name or regex for engine="jack"
+                              (default: find the client by PID)
+            isolation: Isolation mode:
+                       - "null-sink": Move the app to a temporary null-sink (default)
+                       - "link": Link the app's ports directly to the capture
+                         stream, leaving its playback untouched. Only the
+                         PipeWire subprocess strategy supports this, so it is
+                         always used (engine "auto" or "pipewire") and never
+                         falls back to a null-sink strategy.
+
+        Raises:
+            ValueError: If engine or isolation is invalid, or isolation="link"
+                        is combined with an engine other than "auto"/"pipewire"
+            RuntimeError: If isolation="link" and PipeWire is unavailable
         """
         super().__init__(pid)
 
+        if isolation not in ("null-sink", "link"):
+            raise ValueError(f"Unknown isolation mode: {isolation}. Use 'null-sink' or 'link'")
+        if isolation == "link" and engine not in ("auto", "pipewire"):
+            raise ValueError(
+                f"isolation='link' requires engine 'auto' or 'pipewire', not '{engine}'"
+            )
+
         self._sample_rate = sample_rate
         self._channels = channels
         self._sample_width = sample_width
         self._engine = engine
+        self._resample_quality = resample_quality
         self._is_running = False
+        self._parked = False
 
         # Auto-detect audio server if engine is "auto"
         detected_engine = engine
-        if engine == "auto":
+        if isolation == "link":
+            if engine == "auto" and detect_audio_server() != "pipewire":
+                raise RuntimeError("isolation='link' requires a running PipeWire server")
+            detected_engine = "pipewire"
+        elif engine == "auto":
             server_type = detect_audio_server()
             if server_type == "pipewire":
                 # Prefer native PipeWire if available
@@ -1194,10 +1657,21 @@ class LinuxBackend(AudioBackend):
                 )
 
         # Select strategy based on detected/specified engine
-        if detected_engine == "pipewire-native":
+        if isolation == "link":
+            # Only the PipeWire subprocess strategy can link ports; a failure
+            # must surface rather than silently become a null-sink move
+            self._strategy: LinuxAudioStrategy = PipeWireStrategy(
+                pid=pid,
+                sample_rate=sample_rate,
+                channels=channels,
+                sample_width=sample_width,
+                isolation=isolation,
+            )
+            logger.info(f"Initialized LinuxBackend for PID {pid} (engine: PipeWire subprocess, link isolation)")
+        elif detected_engine == "pipewire-native":
             # Try native PipeWire strategy first
             try:
-                self._strategy: LinuxAudioStrategy = PipeWireNativeStrategy(
+                self._strategy = PipeWireNativeStrategy(
                     pid=pid,
                     sample_rate=sample_rate,
                     channels=channels,
@@ -1219,6 +1693,7 @@ class LinuxBackend(AudioBackend):
                         sample_rate=sample_rate,
                         channels=channels,
                         sample_width=sample_width,
+                        isolation=isolation,
                     )
                     logger.info(
                         f"Initialized LinuxBackend for PID {pid} (engine: PipeWire subprocess)"
@@ -1250,6 +1725,7 @@ class LinuxBackend(AudioBackend):
                     sample_rate=sample_rate,
                     channels=channels,
                     sample_width=sample_width,
+                    isolation=isolation,
                 )
                 logger.info(f"Initialized LinuxBackend for PID {pid} (engine: PipeWire subprocess)")
             except RuntimeError as e:
@@ -1265,31 +1741,67 @@ class LinuxBackend(AudioBackend):
                 logger.info(
                     f"Initialized LinuxBackend for PID {pid} (engine: PulseAudio fallback)"
                 )
+        elif detected_engine == "jack":
+            # JACK is opt-in only: it needs an explicit server and never falls back
+            self._strategy = JackStrategy(
+                pid=pid,
+                sample_rate=sample_rate,
+                channels=channels,
+                client_name=jack_client_name,
+            )
+            logger.info(f"Initialized LinuxBackend for PID {pid} (engine: JACK)")
         else:
             raise ValueError(
                 f"Unknown engine: {engine}. "
-                f"Use 'auto', 'pulse', 'pipewire', or 'pipewire-native'"
+                f"Use 'auto', 'pulse', 'pipewire', 'pipewire-native', or 'jack'"
             )
 
         # Setup audio format converter
-        # Linux backends always capture as int16, so we need to convert to float32
-        src_format = SampleFormat.INT16
+        # Most strategies capture as int16; JACK captures float32
+        self._converter: Optional[AudioConverter] = None
+        self._configure_converter(self._strategy.get_format())
+
+    def _configure_converter(self, native_format: dict[str, int | str]) -> None:
+        """
+        (Re)build the converter for the strategy's native format.
+
+        Some strategies only learn their real format after connecting
+        (e.g. JACK uses the server sample rate), so this is also called
+        from start(). The converter is kept if the format is unchanged.
+
+        Args:
+            native_format: Format dictionary from LinuxAudioStrategy.get_format()
+        """
+        src_rate = int(native_format['sample_rate'])
+        src_channels = int(native_format['channels'])
+        src_width = int(native_format['bits_per_sample']) // 8
+        src_format = str(native_format.get('sample_format', SampleFormat.INT16))
+
+        converter = self._converter
+        if (converter is not None and
+                converter.src_rate == src_rate and
+                converter.src_channels == src_channels and
+                converter.src_width == src_width and
+                converter.src_format == src_format):
+            return
+
         self._converter = AudioConverter(
-            src_rate=sample_rate,
-            src_channels=channels,
-            src_width=sample_width,
+            src_rate=src_rate,
+            src_channels=src_channels,
+            src_width=src_width,
             src_format=src_format,
             dst_rate=STANDARD_SAMPLE_RATE,
             dst_channels=STANDARD_CHANNELS,
             dst_width=STANDARD_SAMPLE_WIDTH,
             dst_format=SampleFormat.FLOAT32,
-            resample_quality=resample_quality,  # type: ignore[arg-type]
+            auto_detect_format=(src_format == SampleFormat.INT16),
+            resample_quality=self._resample_quality,  # type: ignore[arg-type]
         )
         logger.info(
             f"Audio format conversion enabled: "
-            f"{sample_rate}Hz/{channels}ch/{src_format} -> "
+            f"{src_rate}Hz/{src_channels}ch/{src_format} -> "
             f"{STANDARD_SAMPLE_RATE}Hz/{STANDARD_CHANNELS}ch/float32 "
-            f"(quality={resample_quality})"
+            f"(quality={self._resample_quality})"
         )
 
     def start(self) -> None:
@@ -1306,6 +1818,7 @@ class LinuxBackend(AudioBackend):
         try:
             # Connect to audio server
             self._strategy.connect()
+            self._configure_converter(self._strategy.get_format())
 
             # Find process stream
             if not self._strategy.find_process_stream(self._pid):
@@ -1317,6 +1830,7 @@ class LinuxBackend(AudioBackend):
             # Start capture
             self._strategy.start_capture()
             self._is_running = True
+            self._parked = False
 
             logger.info(f"Started audio capture for PID {self._pid}")
 
@@ -1330,8 +1844,10 @@ class LinuxBackend(AudioBackend):
             return
 
         try:
+            # A parked capture is already stopped; this only repeats the cleanup
             self._strategy.stop_capture()
             self._is_running = False
+            self._parked = False
             logger.info("Stopped audio capture")
         except Exception as e:
             logger.error(f"Error stopping capture: {e}")
@@ -1359,6 +1875,103 @@ class LinuxBackend(AudioBackend):
 
         return data
 
+    def is_muted(self) -> Optional[bool]:
+        """
+        Get the stream's mute state from the audio server.
+
+        Returns:
+            True if the target sink-input is muted or at zero volume,
+            None if the strategy cannot tell (native PipeWire, JACK)
+        """
+        return self._strategy.is_muted()
+
+    def hibernate(self) -> None:
+        """Drop the converter while idle; read_activity() tests native audio."""
+        self._converter = None
+
+    def wake(self) -> None:
+        """Rebuild the converter dropped by hibernate()."""
+        if self._converter is None:
+            self._configure_converter(self._strategy.get_format())
+
+    def park(self) -> bool:
+        """
+        Stop the capture of a muted stream.
+
+        The capture thread and its parec/pw-record child exit, isolation
+        routing is restored and the queued audio is released. The strategy's
+        state connection keeps answering is_muted().
+
+        Returns:
+            True if the capture was stopped, False if the strategy cannot
+            be restarted on its connection (native PipeWire, JACK)
+        """
+        if not self._is_running or self._parked:
+            return self._parked
+        if not self._strategy.restartable:
+            return False
+
+        self._strategy.stop_capture()
+        while self._strategy.read_audio(timeout=0.0):
+            pass
+        self._parked = True
+        logger.info(f"Parked audio capture for PID {self._pid}")
+        return True
+
+    def unpark(self) -> None:
+        """
+        Restart the capture stopped by park().
+
+        Raises:
+            RuntimeError: If the stream has gone away or capture fails to start
+        """
+        if not self._parked:
+            return
+
+        # The stream may have been recreated while parked
+        if not self._strategy.find_process_stream(self._pid):
+            raise RuntimeError(f"No audio stream found for PID {self._pid}")
+        self._strategy.start_capture()
+        self._parked = False
+        logger.info(f"Resumed audio capture for PID {self._pid}")
+
+    def read_activity(self, detector: ActivityDetector) -> Optional[bytes]:
+        """
+        Read one native chunk while hibernating and test it for activity.
+
+        Args:
+            detector: Activity detector holding the pre-roll
+
+        Returns:
+            Pre-roll plus chunk in standard format once a chunk is active,
+            None otherwise
+        """
+        if not self._is_running:
+            return None
+
+        data = self._strategy.read_audio(timeout=0.1)
+        if not data:
+            return None
+
+        native_format = self._strategy.get_format()
+        pcm = detector.feed(
+            data,
+            sample_format=str(native_format.get('sample_format', SampleFormat.INT16)),
+            channels=int(native_format['channels']),
+            sample_rate=int(native_format['sample_rate']),
+        )
+        if pcm is None:
+            return None
+
+        self.wake()
+        if self._converter is None:
+            return pcm
+        try:
+            return self._converter.convert(pcm)
+        except Exception as e:
+            logger.error(f"Error converting audio format: {e}")
+            return b''
+
     def get_format(self) -> dict[str, int | str]:
         """
         Get audio format information (always returns standard format).
@@ -1377,6 +1990,35 @@ class LinuxBackend(AudioBackend):
             'sample_format': STANDARD_FORMAT,
         }
 
+    def get_latency_ms(self) -> float:
+        """
+        Get the algorithmic latency: strategy chunk/period plus conversion.
+
+        Returns:
+            Latency in milliseconds
+        """
+        return self._strategy.get_latency_ms() + self.get_conversion_latency_ms()
+
+    def get_conversion_latency_ms(self) -> float:
+        """
+        Get the resampler delay of the converter.
+
+        Returns:
+            Latency in milliseconds (0 while hibernating)
+        """
+        if self._converter is None:
+            return 0.0
+        return 1000.0 * self._converter.latency_frames / STANDARD_SAMPLE_RATE
+
+    def get_buffered_ms(self) -> float:
+        """
+        Get the audio currently queued in the capture strategy.
+
+        Returns:
+            Live queue depth in milliseconds
+        """
+        return self._strategy.get_buffered_ms()
+
     def close(self) -> None:
         """Clean up resources."""
         self.stop()
@@ -1401,6 +2043,9 @@ class LinuxBackend(AudioBackend):
 # ✅ Native PipeWire support via pw-record (PipeWireStrategy class)
 # ✅ Automatic audio server detection (PipeWire vs PulseAudio)
 # ✅ Graceful fallback from PipeWire to PulseAudio
+# ✅ Opt-in JACK capture via passive native client (JackStrategy, jack_native.py)
+# ✅ Opt-in non-invasive isolation via direct port links (isolation="link",
+#    pipewire_links.py) - no null-sink, no rerouting, no added hop
 #
 # Isolation strategy (both PulseAudio and PipeWire):
 # 1. Create temporary null-sink for target process
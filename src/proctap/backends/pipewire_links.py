@@ -0,0 +1,354 @@
+"""
+Direct PipeWire port linking for non-invasive per-node capture.
+
+Instead of moving the target's stream to a temporary null-sink, the target
+node's output ports are linked straight to the input ports of our capture
+stream through the PipeWire link-factory (via pw-link). PipeWire output
+ports fan out, so the application keeps playing to its normal sink while we
+tap it in parallel:
+
+    app node ──┬──> default sink        (unchanged, user keeps hearing it)
+               └──> proctap capture     (extra link, no added hop)
+
+Links are owned by the ports they connect: when our capture node goes away
+(including on a crash) PipeWire destroys the links with it, so nothing leaks.
+
+Requirements:
+- pw-dump and pw-link commands (pipewire-utils package)
+"""
+
+from __future__ import annotations
+
+import json
+import logging
+import subprocess
+import time
+from dataclasses import dataclass
+from typing import Any, Optional
+
+logger = logging.getLogger(__name__)
+
+PW_TYPE_NODE = "PipeWire:Interface:Node"
+PW_TYPE_PORT = "PipeWire:Interface:Port"
+
+
+class PipeWireLinkError(Exception):
+    """Exception raised when a port link cannot be created."""
+    pass
+
+
+@dataclass
+class PortInfo:
+    """Audio port of a PipeWire node."""
+    id: int
+    node_id: int
+    direction: str  # "input" or "output"
+    name: str
+    channel: str  # audio.channel (e.g. "FL", "FR", "MONO"), "" if unknown
+
+
+def dump_graph(timeout: float = 2.0) -> list[dict[str, Any]]:
+    """
+    Get a snapshot of the PipeWire object graph.
+
+    Args:
+        timeout: Maximum time to wait for pw-dump
+
+    Returns:
+        List of objects as reported by pw-dump
+
+    Raises:
+        RuntimeError: If pw-dump fails
+    """
+    try:
+        result = subprocess.run(
+            ['pw-dump'],
+            capture_output=True,
+            timeout=timeout,
+            check=True,
+        )
+    except (OSError, subprocess.SubprocessError) as e:
+        raise RuntimeError(f"pw-dump failed: {e}") from e
+
+    objects = json.loads(result.stdout or b"[]")
+    return objects if isinstance(objects, list) else []
+
+
+def _props(obj: dict[str, Any]) -> dict[str, Any]:
+    """Get the property dictionary of a pw-dump object."""
+    info = obj.get('info') or {}
+    props = info.get('props') or {}
+    return props if isinstance(props, dict) else {}
+
+
+def find_nodes_by_pid(objects: list[dict[str, Any]], pid: int) -> list[int]:
+    """
+    Find playback stream nodes that belong to a process.
+
+    Args:
+        objects: pw-dump output
+        pid: Target process ID
+
+    Returns:
+        Node IDs with media.class "Stream/Output/Audio" for the PID
+    """
+    nodes = []
+    for obj in objects:
+        if obj.get('type') != PW_TYPE_NODE:
+            continue
+        props = _props(obj)
+        if str(props.get('application.process.id', '')) != str(pid):
+            continue
+        if props.get('media.class') != "Stream/Output/Audio":
+            continue
+        nodes.append(int(obj['id']))
+    return nodes
+
+
+def find_node_by_name(objects: list[dict[str, Any]], node_name: str) -> Optional[int]:
+    """
+    Find a node by its node.name property.
+
+    Args:
+        objects: pw-dump output
+        node_name: node.name to look for
+
+    Returns:
+        Node ID, or None if not found
+    """
+    for obj in objects:
+        if obj.get('type') == PW_TYPE_NODE and _props(obj).get('node.name') == node_name:
+            return int(obj['id'])
+    return None
+
+
+def find_node_ports(
+    objects: list[dict[str, Any]],
+    node_id: int,
+    direction: str,
+) -> list[PortInfo]:
+    """
+    Get the audio ports of a node in one direction.
+
+    Monitor ports are skipped, and ports are returned in port ID order
+    (which is the channel order PipeWire created them in).
+
+    Args:
+        objects: pw-dump output
+        node_id: Node ID
+        direction: "input" or "output"
+
+    Returns:
+        List of PortInfo
+    """
+    ports = []
+    for obj in objects:
+        if obj.get('type') != PW_TYPE_PORT:
+            continue
+        info = obj.get('info') or {}
+        props = _props(obj)
+        if str(props.get('node.id', '')) != str(node_id):
+            continue
+        if info.get('direction') != direction:
+            continue
+        if props.get('port.monitor') in (True, 'true'):
+            continue
+        ports.append(PortInfo(
+            id=int(obj['id']),
+            node_id=node_id,
+            direction=direction,
+            name=str(props.get('port.name', '')),
+            channel=str(props.get('audio.channel', '')),
+        ))
+    return sorted(ports, key=lambda p: p.id)
+
+
+def pair_ports(sources: list[PortInfo], sinks: list[PortInfo]) -> list[tuple[PortInfo, PortInfo]]:
+    """
+    Decide which source (output) port feeds which sink (input) port.
+
+    - Ports with the same audio.channel are paired (FL -> FL, FR -> FR)
+    - A mono source is fanned out to every sink port
+    - Remaining sink ports are paired by position
+
+    Args:
+        sources: Output ports of the target node
+        sinks: Input ports of the capture node
+
+    Returns:
+        List of (source, sink) pairs; every sink appears at most once
+    """
+    if not sources or not sinks:
+        return []
+
+    if len(sources) == 1:
+        return [(sources[0], sink) for sink in sinks]
+
+    pairs: list[tuple[PortInfo, PortInfo]] = []
+    by_channel = {p.channel: p for p in sources if p.channel}
+    unmatched = []
+    for sink in sinks:
+        source = by_channel.get(sink.channel) if sink.channel else None
+        if source is not None:
+            pairs.append((source, sink))
+        else:
+            unmatched.append(sink)
+
+    for sink in unmatched:
+        index = sinks.index(sink)
+        pairs.append((sources[min(index, len(sources) - 1)], sink))
+
+    return pairs
+
+
+class PortLinker:
+    """
+    Creates and removes port links with pw-link.
+
+    pw-link instantiates links through the PipeWire link-factory. Links
+    disappear automatically when either node is destroyed; unlink_all()
+    removes them explicitly on a clean stop.
+    """
+
+    def __init__(self, timeout: float = 2.0) -> None:
+        """
+        Initialize linker.
+
+        Args:
+            timeout: Maximum time to wait for each pw-link call
+        """
+        self._timeout = timeout
+        self._links: list[tuple[int, int]] = []
+
+    @property
+    def links(self) -> list[tuple[int, int]]:
+        """(output port ID, input port ID) pairs created by this linker."""
+        return list(self._links)
+
+    def link(self, output_port: int, input_port: int) -> None:
+        """
+        Link an output port to an input port.
+
+        Args:
+            output_port: Output port ID
+            input_port: Input port ID
+
+        Raises:
+            PipeWireLinkError: If pw-link fails
+        """
+        try:
+            result = subprocess.run(
+                ['pw-link', str(output_port), str(input_port)],
+                capture_output=True,
+                timeout=self._timeout,
+            )
+        except (OSError, subprocess.SubprocessError) as e:
+            raise PipeWireLinkError(f"pw-link failed: {e}") from e
+
+        stderr = result.stderr.decode('utf-8', 'replace').strip()
+        # "File exists": link is already there, which is fine
+        if result.returncode != 0 and 'exists' not in stderr:
+            raise PipeWireLinkError(
+                f"Failed to link port {output_port} -> {input_port}: {stderr or result.returncode}"
+            )
+
+        self._links.append((output_port, input_port))
+        logger.debug(f"Linked port {output_port} -> {input_port}")
+
+    def unlink_all(self) -> None:
+        """
+        Remove all links created by this linker.
+
+        Note: This method does not raise exceptions to ensure cleanup always completes.
+        """
+        for output_port, input_port in self._links:
+            try:
+                subprocess.run(
+                    ['pw-link', '-d', str(output_port), str(input_port)],
+                    capture_output=True,
+                    timeout=self._timeout,
+                )
+            except Exception as e:
+                logger.debug(f"Could not unlink {output_port} -> {input_port}: {e}")
+        self._links = []
+
+
+def wait_for_node_ports(
+    node_name: str,
+    direction: str,
+    timeout: float = 2.0,
+    poll_interval: float = 0.05,
+) -> tuple[int, list[PortInfo]]:
+    """
+    Wait until a node with the given name exists and has ports.
+
+    Args:
+        node_name: node.name to wait for
+        direction: Port direction to wait for ("input" or "output")
+        timeout: Maximum time to wait in seconds
+        poll_interval: Time between graph snapshots
+
+    Returns:
+        Tuple of (node ID, ports)
+
+    Raises:
+        PipeWireLinkError: If the node or its ports do not appear in time
+    """
+    deadline = time.monotonic() + timeout
+    while True:
+        objects = dump_graph()
+        node_id = find_node_by_name(objects, node_name)
+        if node_id is not None:
+            ports = find_node_ports(objects, node_id, direction)
+            if ports:
+                return node_id, ports
+        if time.monotonic() >= deadline:
+            raise PipeWireLinkError(
+                f"Timed out waiting for {direction} ports of node '{node_name}'"
+            )
+        time.sleep(poll_interval)
+
+
+def link_nodes(
+    objects: list[dict[str, Any]],
+    source_node: int,
+    sink_ports: list[PortInfo],
+    linker: PortLinker,
+) -> int:
+    """
+    Link every output port of source_node to the matching sink port.
+
+    Args:
+        objects: pw-dump output
+        source_node: Target node ID
+        sink_ports: Input ports of the capture node
+        linker: PortLinker to create links with
+
+    Returns:
+        Number of links created
+
+    Raises:
+        PipeWireLinkError: If the target has no output ports or linking fails
+    """
+    source_ports = find_node_ports(objects, source_node, "output")
+    pairs = pair_ports(source_ports, sink_ports)
+    if not pairs:
+        raise PipeWireLinkError(f"Node {source_node} has no output ports to link")
+
+    for source, sink in pairs:
+        linker.link(source.id, sink.id)
+    return len(pairs)
+
+
+__all__ = [
+    'PipeWireLinkError',
+    'PortInfo',
+    'PortLinker',
+    'dump_graph',
+    'find_nodes_by_pid',
+    'find_node_by_name',
+    'find_node_ports',
+    'link_nodes',
+    'pair_ports',
+    'wait_for_node_ports',
+]
@@ -0,0 +1,620 @@
+"""
+LD_PRELOAD interception backend for Linux.
+
+The other Linux strategies isolate a process through audio-server routing
+(null-sink moves, monitor sources, pw-record targets). That adds hops and
+fails while the application's stream is not visible yet. For processes we
+launch ourselves there is a direct route instead: the _preload shim is
+injected with LD_PRELOAD and mirrors every playback write the application
+makes through ALSA (snd_pcm_writei/writen), libpulse (pa_stream_write) or
+PipeWire (pw_stream_queue_buffer) into a shared-memory ring, together with
+the stream's format. The application's own playback path is unchanged.
+
+- Exact per-process isolation (child processes inherit the shim)
+- Audio is captured when the application hands it to the audio API, before
+  any server or device buffering
+- Each record carries its format; records are converted to the standard
+  format (48kHz/2ch/float32) individually
+
+Limitations:
+- Only processes started through PreloadBackend.launch()
+- ALSA mmap access, planar PipeWire formats and libraries that resolve the
+  audio API with dlopen(RTLD_LOCAL) + dlsym bypass the shim
+- PipeWire streams are described by the format passed to pw_stream_connect
+  (the default of a choice if the format is not fixed)
+- One stream at a time: streams are not mixed, so without stream= the
+  first stream seen is followed and the others are filtered until it is
+  closed (the shim writes a payload-less record from snd_pcm_close,
+  pa_stream_disconnect and pw_stream_destroy) or has been quiet for
+  relock_ms
+
+Usage:
+    backend = PreloadBackend.launch(["mpv", "--no-video", "song.flac"])
+    with ProcessAudioCapture(backend.pid, backend=backend, on_data=callback):
+        backend.process.wait()
+"""
+
+from __future__ import annotations
+
+import itertools
+import logging
+import os
+import struct
+import subprocess
+import sys
+import threading
+import time
+from dataclasses import dataclass
+from multiprocessing import shared_memory
+from pathlib import Path
+from typing import Any, Literal, Optional, Sequence
+
+import numpy as np
+
+from .base import (
+    AudioBackend,
+    STANDARD_CHANNELS,
+    STANDARD_FORMAT,
+    STANDARD_SAMPLE_RATE,
+    STANDARD_SAMPLE_WIDTH,
+)
+from .converter import AudioConverter, SampleFormat
+
+logger = logging.getLogger(__name__)
+
+PreloadApi = Literal['alsa', 'pulse', 'pipewire']
+ResampleQuality = Literal['best', 'medium', 'fast']
+
+# Ring layout (keep in sync with _preload.cpp)
+RING_MAGIC = 0x52505450    # "PTPR"
+RING_VERSION = 1
+RECORD_MAGIC = 0x43525450  # "PTRC"
+PAD_MAGIC = 0x44505450     # "PTPD"
+HEADER_SIZE = 128
+_HEADER = struct.Struct('<IIQQQIIQQQ')
+_RECORD = struct.Struct('<IIIIIHBBQ')
+_POS = struct.Struct('<Q')
+_WRITE_POS_OFFSET = 16
+_RESERVE_POS_OFFSET = 24
+_COUNTERS = struct.Struct('<QQQ')
+_COUNTERS_OFFSET = 40
+
+DEFAULT_RING_BYTES = 1 << 20  # ~2.7s of 48kHz stereo float32
+
+# 24-bit samples in the low bits of a 32-bit container (ALSA S24_LE,
+# PulseAudio S24_32LE, SPA S24_32_LE); AudioConverter's INT24_32 expects
+# the upper bits, so these are shifted before conversion
+INT24_LSB32 = 'int24_lsb32'
+
+_SAMPLE_FORMATS = {
+    1: SampleFormat.INT16,
+    2: SampleFormat.INT24,
+    3: INT24_LSB32,
+    4: SampleFormat.INT32,
+    5: SampleFormat.FLOAT32,
+}
+_SAMPLE_WIDTHS = {
+    SampleFormat.INT16: 2,
+    SampleFormat.INT24: 3,
+    INT24_LSB32: 4,
+    SampleFormat.INT32: 4,
+    SampleFormat.FLOAT32: 4,
+}
+_APIS: dict[int, PreloadApi] = {1: 'alsa', 2: 'pulse', 3: 'pipewire'}
+
+# Application-facing layers call down into lower ones (ALSA's pulse/pipewire
+# plugins, libpulse on pipewire-pulse is out of process), so when several
+# APIs are seen the highest one is what the application actually played
+_API_PRIORITY: dict[str, int] = {'alsa': 3, 'pulse': 2, 'pipewire': 1}
+
+_ring_ids = itertools.count()
+
+
+@dataclass(frozen=True)
+class PreloadRecord:
+    """One mirrored playback write."""
+    api: PreloadApi
+    pid: int
+    stream: int  # Stream id, unique within pid
+    sample_rate: int
+    channels: int
+    sample_format: str  # SampleFormat value or INT24_LSB32
+    timestamp_ns: int  # CLOCK_MONOTONIC when the application wrote it
+    data: bytes  # Empty: the stream was closed
+
+    @property
+    def frames(self) -> int:
+        """Number of frames in the record."""
+        return len(self.data) // (self.channels * _SAMPLE_WIDTHS[self.sample_format])
+
+
+def find_preload_library() -> Optional[str]:
+    """
+    Locate the compiled shim.
+
+    PROCTAP_PRELOAD_LIBRARY overrides the copy built next to the package.
+
+    Returns:
+        Absolute path of the shared library, or None if it is not built
+    """
+    override = os.environ.get('PROCTAP_PRELOAD_LIBRARY')
+    if override:
+        return os.path.abspath(override)
+    package_dir = Path(__file__).resolve().parent.parent
+    candidates = sorted(package_dir.glob('_preload*.so'))
+    return str(candidates[0]) if candidates else None
+
+
+def is_available() -> bool:
+    """Check whether preload capture can be used on this system."""
+    return sys.platform.startswith('linux') and find_preload_library() is not None
+
+
+class PreloadRing:
+    """
+    Reader side of the shared-memory ring written by the shim.
+
+    The ring is created here (before the target is launched) and passed to
+    the shim through the PROCTAP_PRELOAD_RING environment variable.
+    """
+
+    def __init__(self, capacity: int = DEFAULT_RING_BYTES) -> None:
+        """
+        Create a ring.
+
+        Args:
+            capacity: Size of the data area in bytes (multiple of 8, >= 4096)
+
+        Raises:
+            ValueError: If capacity is invalid
+            RuntimeError: If the shared memory cannot be created
+        """
+        if capacity < 4096 or capacity % 8 != 0:
+            raise ValueError(f"Ring capacity must be a multiple of 8 and >= 4096 bytes: {capacity}")
+        name = f"proctap-preload-{os.getpid()}-{next(_ring_ids)}"
+        try:
+            self._shm = shared_memory.SharedMemory(name=name, create=True, size=HEADER_SIZE + capacity)
+        except OSError as e:
+            raise RuntimeError(f"Failed to create preload ring: {e}") from e
+
+        if self._shm.buf is None:
+            raise RuntimeError("Failed to map preload ring")
+        self._capacity = capacity
+        self._buf: memoryview = self._shm.buf
+        self._buf[:HEADER_SIZE] = bytes(HEADER_SIZE)
+        _HEADER.pack_into(self._buf, 0, RING_MAGIC, RING_VERSION, capacity, 0, 0, 0, 0, 0, 0, 0)
+        self._read_pos = 0
+        self._overruns = 0
+        self._closed = False
+
+    @property
+    def name(self) -> str:
+        """shm_open() name of the ring (value for PROCTAP_PRELOAD_RING)."""
+        return self._shm.name if self._shm.name.startswith('/') else '/' + self._shm.name
+
+    @property
+    def capacity(self) -> int:
+        """Size of the data area in bytes."""
+        return self._capacity
+
+    @property
+    def pending_bytes(self) -> int:
+        """Bytes written by the shim and not read yet (including record headers)."""
+        return self._load(_WRITE_POS_OFFSET) - self._read_pos
+
+    def stats(self) -> dict[str, int]:
+        """
+        Get ring counters.
+
+        Returns:
+            Dictionary with 'records' (written by the shim), 'dropped'
+            (writes skipped because the ring lock or the shim's stream
+            registry was busy), 'unsupported' (writes
+            in a format the ring cannot describe) and 'overruns' (times the
+            reader fell a full ring behind)
+        """
+        records, dropped, unsupported = _COUNTERS.unpack_from(self._buf, _COUNTERS_OFFSET)
+        return {
+            'records': records,
+            'dropped': dropped,
+            'unsupported': unsupported,
+            'overruns': self._overruns,
+        }
+
+    def read(self) -> list[PreloadRecord]:
+        """
+        Read all complete records written since the last call.
+
+        Returns:
+            Records in write order (empty if nothing new)
+        """
+        if self._closed:
+            return []
+        records: list[PreloadRecord] = []
+        cap = self._capacity
+        write_pos = self._load(_WRITE_POS_OFFSET)
+        pos = self._read_pos
+        if write_pos - pos > cap:
+            pos = self._overrun(write_pos)
+
+        while pos < write_pos:
+            offset = pos % cap
+            if cap - offset < _RECORD.size:
+                pos += cap - offset
+                continue
+            magic, size, pid, stream, rate, channels, code, api, timestamp = _RECORD.unpack_from(
+                self._buf, HEADER_SIZE + offset
+            )
+            if magic == PAD_MAGIC:
+                pos += cap - offset
+                continue
+            length = _RECORD.size + ((size + 7) & ~7)
+            if magic != RECORD_MAGIC or length > cap - offset:
+                pos = self._overrun(write_pos)
+                break
+            start = HEADER_SIZE + offset + _RECORD.size
+            data = bytes(self._buf[start:start + size])
+            # Intact only if no writer has started overwriting it meanwhile
+            if self._load(_RESERVE_POS_OFFSET) > pos + cap:
+                pos = self._overrun(self._load(_WRITE_POS_OFFSET))
+                break
+            if code in _SAMPLE_FORMATS and api in _APIS and channels > 0:
+                records.append(PreloadRecord(
+                    api=_APIS[api],
+                    pid=pid,
+                    stream=stream,
+                    sample_rate=rate,
+                    channels=channels,
+                    sample_format=_SAMPLE_FORMATS[code],
+                    timestamp_ns=timestamp,
+                    data=data,
+                ))
+            pos += length
+
+        self._read_pos = pos
+        return records
+
+    def close(self) -> None:
+        """Release and unlink the ring. Safe to call multiple times."""
+        if self._closed:
+            return
+        self._closed = True
+        self._buf.release()
+        self._shm.close()
+        try:
+            self._shm.unlink()
+        except FileNotFoundError:
+            pass
+
+    def _load(self, offset: int) -> int:
+        value: int = _POS.unpack_from(self._buf, offset)[0]
+        return value
+
+    def _overrun(self, write_pos: int) -> int:
+        """Skip to the writer's position after falling behind."""
+        self._overruns += 1
+        logger.warning(f"Preload ring overrun: skipped {write_pos - self._read_pos} bytes")
+        return write_pos
+
+
+class PreloadBackend(AudioBackend):
+    """
+    Audio backend reading a process's playback writes mirrored by the shim.
+
+    Created with launch(), which starts the target with the shim injected.
+    """
+
+    def __init__(
+        self,
+        pid: int,
+        ring: PreloadRing,
+        api: Optional[PreloadApi] = None,
+        stream: Optional[int] = None,
+        resample_quality: ResampleQuality = 'best',
+        process: Optional["subprocess.Popen[Any]"] = None,
+        poll_interval: float = 0.002,
+        relock_ms: float = 500.0,
+    ) -> None:
+        """
+        Initialize preload backend.
+
+        Args:
+            pid: Process ID the ring was created for
+            ring: Ring the shim in the target writes to (owned by the backend)
+            api: Only deliver writes made through this API. None: the
+                 highest-level API the process has used (so ALSA routed
+                 through PipeWire is not delivered twice)
+            stream: Only deliver this stream id. None: the first stream seen,
+                    until it is closed or quiet for relock_ms; records of
+                    other streams are counted as filtered meanwhile (their
+                    audio cannot be concatenated with it)
+            resample_quality: Resampling quality for non-standard formats
+            process: Launched target process, if any
+            poll_interval: Sleep between ring polls while waiting for data
+            relock_ms: Quiet time after which another stream takes over the
+                       followed one (stream=None), e.g. after a short
+                       notification sound whose stream stays open
+        """
+        super().__init__(pid)
+        if api is not None and api not in _API_PRIORITY:
+            raise ValueError(f"Unknown preload API: {api}")
+        if relock_ms <= 0:
+            raise ValueError(f"relock_ms must be positive: {relock_ms}")
+        self._ring = ring
+        self._api = api
+        self._stream = stream
+        self._resample_quality = resample_quality
+        self._process = process
+        self._poll_interval = poll_interval
+        self._relock_ns = int(relock_ms * 1e6)
+        self._api_level = 0  # Highest API priority seen (api=None)
+        self._locked_stream: Optional[tuple[int, int]] = None  # (pid, stream) when stream=None
+        self._locked_last_ns = 0  # Timestamp of the followed stream's last record
+        self._ignored_streams: set[tuple[int, int]] = set()
+        self._converters: dict[tuple[int, int, str], Optional[AudioConverter]] = {}
+        self._last_format: Optional[tuple[int, int, str]] = None
+        self._delivered = 0
+        self._filtered = 0
+        self._running = threading.Event()
+
+    @classmethod
+    def launch(
+        cls,
+        argv: Sequence[str],
+        library: Optional[str] = None,
+        ring_bytes: int = DEFAULT_RING_BYTES,
+        api: Optional[PreloadApi] = None,
+        resample_quality: ResampleQuality = 'best',
+        env: Optional[dict[str, str]] = None,
+        **popen_kwargs: Any,
+    ) -> "PreloadBackend":
+        """
+        Launch a process with the shim injected.
+
+        Args:
+            argv: Command line of the target
+            library: Path of the shim (default: find_preload_library())
+            ring_bytes: Ring capacity in bytes
+            api: See __init__
+            resample_quality: See __init__
+            env: Environment of the target (default: this process's)
+            **popen_kwargs: Passed to subprocess.Popen
+
+        Returns:
+            PreloadBackend for the launched process (see .process)
+
+        Raises:
+            RuntimeError: If the shim is not built or the target cannot be started
+        """
+        if not sys.platform.startswith('linux'):
+            raise RuntimeError("Preload capture is only supported on Linux")
+        library = library or find_preload_library()
+        if library is None:
+            raise RuntimeError("Preload shim not built (proctap._preload). Reinstall proc-tap on Linux.")
+
+        ring = PreloadRing(ring_bytes)
+        target_env = dict(os.environ if env is None else env)
+        preload = os.path.abspath(library)
+        if target_env.get('LD_PRELOAD'):
+            preload += ' ' + target_env['LD_PRELOAD']
+        target_env['LD_PRELOAD'] = preload
+        target_env['PROCTAP_PRELOAD_RING'] = ring.name
+
+        try:
+            process = subprocess.Popen(list(argv), env=target_env, **popen_kwargs)
+        except OSError as e:
+            ring.close()
+            raise RuntimeError(f"Failed to launch {argv[0]}: {e}") from e
+
+        logger.info(f"Launched {argv[0]} (pid {process.pid}) with preload ring {ring.name}")
+        return cls(process.pid, ring, api=api, resample_quality=resample_quality, process=process)
+
+    @property
+    def process(self) -> Optional["subprocess.Popen[Any]"]:
+        """Process started by launch() (None if created directly)."""
+        return self._process
+
+    @property
+    def ring(self) -> PreloadRing:
+        """Ring the shim writes to."""
+        return self._ring
+
+    @property
+    def stats(self) -> dict[str, int]:
+        """Ring counters plus 'delivered' and 'filtered' record counts."""
+        return {**self._ring.stats(), 'delivered': self._delivered, 'filtered': self._filtered}
+
+    def start(self) -> None:
+        """Start delivering audio (the shim writes from process start)."""
+        self._running.set()
+
+    def stop(self) -> None:
+        """Stop delivering audio. Safe to call multiple times."""
+        self._running.clear()
+
+    def read(self) -> Optional[bytes]:
+        """
+        Read mirrored audio.
+
+        Waits up to 100ms for new records.
+
+        Returns:
+            PCM audio data in standard format (48kHz/2ch/float32), or None
+            if stopped or nothing was written
+        """
+        deadline = time.monotonic() + 0.1
+        while self._running.is_set():
+            records = self.read_records()
+            if records:
+                return b"".join(self._convert(record) for record in records)
+            if time.monotonic() >= deadline:
+                break
+            time.sleep(self._poll_interval)
+        return None
+
+    def read_records(self) -> list[PreloadRecord]:
+        """
+        Read new records that pass the api/stream selection, unconverted.
+
+        Returns:
+            Records in write order
+        """
+        selected = []
+        for record in self._ring.read():
+            if not record.data:
+                self._stream_closed(record)
+            elif self._select(record):
+                selected.append(record)
+            else:
+                self._filtered += 1
+        self._delivered += len(selected)
+        return selected
+
+    def get_format(self) -> dict[str, int | str]:
+        """
+        Get audio format information.
+
+        Returns:
+            Dictionary with standard format (48kHz/2ch/float32)
+        """
+        return {
+            'sample_rate': STANDARD_SAMPLE_RATE,
+            'channels': STANDARD_CHANNELS,
+            'bits_per_sample': STANDARD_SAMPLE_WIDTH * 8,
+            'sample_format': STANDARD_FORMAT,
+        }
+
+    def get_latency_ms(self) -> float:
+        """
+        Get the algorithmic latency.
+
+        Writes are mirrored as the application makes them, ahead of any
+        server or device buffering, and records are not chunked further.
+
+        Returns:
+            Conversion latency of the current stream in milliseconds
+        """
+        return self.get_conversion_latency_ms()
+
+    def get_conversion_latency_ms(self) -> float:
+        """
+        Get the resampler delay of the current stream's converter.
+
+        Returns:
+            Latency in milliseconds
+        """
+        if self._last_format is None:
+            return 0.0
+        converter = self._converters.get(self._last_format)
+        return 1000.0 * converter.latency_frames / STANDARD_SAMPLE_RATE if converter else 0.0
+
+    def get_buffered_ms(self) -> float:
+        """
+        Get the audio waiting in the ring.
+
+        Returns:
+            Unread ring content in milliseconds, estimated with the format
+            of the last record
+        """
+        rate, channels, sample_format = self._last_format or (
+            STANDARD_SAMPLE_RATE, STANDARD_CHANNELS, SampleFormat.FLOAT32
+        )
+        bytes_per_second = rate * channels * _SAMPLE_WIDTHS[sample_format]
+        return 1000.0 * self._ring.pending_bytes / bytes_per_second
+
+    def close(self) -> None:
+        """Stop and release the ring. The launched process keeps running."""
+        self.stop()
+        self._ring.close()
+
+    def _select(self, record: PreloadRecord) -> bool:
+        """Apply the api/stream selection."""
+        if self._stream is not None:
+            return record.stream == self._stream and (self._api is None or record.api == self._api)
+        if self._api is not None:
+            if record.api != self._api:
+                return False
+        else:
+            level = _API_PRIORITY[record.api]
+            if level > self._api_level:
+                if self._api_level:
+                    logger.info(f"Preload capture following {record.api} (application-facing API)")
+                self._api_level = level
+                self._locked_stream = None  # Streams of the lower-level API are mirrors
+            if level != self._api_level:
+                return False
+        return self._follow_stream(record)
+
+    def _follow_stream(self, record: PreloadRecord) -> bool:
+        """Lock onto the first stream seen (stream=None) and filter the others."""
+        key = (record.pid, record.stream)
+        locked = self._locked_stream
+        if locked is not None and key != locked and record.timestamp_ns - self._locked_last_ns >= self._relock_ns:
+            logger.info(f"Preload stream {locked[1]} of PID {locked[0]} went quiet")
+            self._locked_stream = None
+        if self._locked_stream is None:
+            self._locked_stream = key
+            self._ignored_streams.discard(key)
+            logger.info(f"Preload capture locked onto stream {record.stream} of PID {record.pid}")
+        if key == self._locked_stream:
+            self._locked_last_ns = record.timestamp_ns
+            return True
+        if key not in self._ignored_streams:
+            self._ignored_streams.add(key)
+            logger.info(
+                f"Filtering stream {record.stream} of PID {record.pid} "
+                f"(following stream {self._locked_stream[1]}; pass stream= to choose)"
+            )
+        return False
+
+    def _stream_closed(self, record: PreloadRecord) -> None:
+        """Release the followed stream once the application closes it."""
+        key = (record.pid, record.stream)
+        self._ignored_streams.discard(key)
+        if key == self._locked_stream:
+            logger.info(f"Preload stream {record.stream} of PID {record.pid} closed")
+            self._locked_stream = None
+
+    def _convert(self, record: PreloadRecord) -> bytes:
+        """Convert one record to the standard format."""
+        key = (record.sample_rate, record.channels, record.sample_format)
+        if key not in self._converters:
+            self._converters[key] = self._make_converter(*key)
+        self._last_format = key
+
+        data = record.data
+        if record.sample_format == INT24_LSB32:
+            data = (np.frombuffer(data, dtype='<i4') << 8).tobytes()
+        converter = self._converters[key]
+        return converter.convert(data) if converter is not None else data
+
+    def _make_converter(self, rate: int, channels: int, sample_format: str) -> Optional[AudioConverter]:
+        """Converter for a stream format (None if already standard)."""
+        if (rate == STANDARD_SAMPLE_RATE and channels == STANDARD_CHANNELS
+                and sample_format == SampleFormat.FLOAT32):
+            return None
+        src_format = SampleFormat.INT32 if sample_format == INT24_LSB32 else sample_format
+        logger.debug(f"Preload stream format: {rate}Hz/{channels}ch/{sample_format}")
+        return AudioConverter(
+            src_rate=rate,
+            src_channels=channels,
+            src_width=_SAMPLE_WIDTHS[sample_format],
+            dst_rate=STANDARD_SAMPLE_RATE,
+            dst_channels=STANDARD_CHANNELS,
+            dst_width=STANDARD_SAMPLE_WIDTH,
+            src_format=src_format,
+            dst_format=SampleFormat.FLOAT32,
+            auto_detect_format=False,
+            resample_quality=self._resample_quality,
+        )
+
+
+__all__ = [
+    'DEFAULT_RING_BYTES',
+    'INT24_LSB32',
+    'PreloadBackend',
+    'PreloadRecord',
+    'PreloadRing',
+    'find_preload_library',
+    'is_available',
+]
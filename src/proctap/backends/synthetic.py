@@ -0,0 +1,349 @@
+"""
+Synthetic audio backend for tests, benchmarks and profiling.
+
+Generates a deterministic test signal instead of capturing a process, so the
+full ProcessAudioCapture pipeline (worker thread, conversion, callbacks,
+queues) can be exercised on any machine without an audio server.
+
+The signal can be generated in a non-standard native format (e.g. 44.1kHz
+int16, like the Linux backends) and is then converted to the standard format
+with AudioConverter, exactly like a real backend would.
+
+Usage:
+    backend = SyntheticBackend(signal="sine", frequency=440.0)
+    tap = ProcessAudioCapture(pid=0, backend=backend)
+"""
+
+from __future__ import annotations
+
+import logging
+import threading
+import time
+from typing import TYPE_CHECKING, Literal, Optional
+
+import numpy as np
+
+from .base import (
+    AudioBackend,
+    STANDARD_CHANNELS,
+    STANDARD_FORMAT,
+    STANDARD_SAMPLE_RATE,
+    STANDARD_SAMPLE_WIDTH,
+)
+from .converter import AudioConverter, SampleFormat
+
+if TYPE_CHECKING:
+    from ..hibernation import ActivityDetector
+
+logger = logging.getLogger(__name__)
+
+SignalType = Literal['sine', 'noise', 'silence', 'impulse']
+ResampleQuality = Literal['best', 'medium', 'fast']
+
+
+class SyntheticBackend(AudioBackend):
+    """
+    Audio backend producing a generated test signal.
+
+    Signals:
+    - "sine": Continuous sine wave at `frequency`
+    - "noise": Uniform white noise (seeded, reproducible)
+    - "silence": All zeros
+    - "impulse": Single full-scale sample every `impulse_interval` seconds
+      (the first impulse is at frame 0)
+    """
+
+    def __init__(
+        self,
+        pid: int = 0,
+        signal: SignalType = 'sine',
+        frequency: float = 440.0,
+        amplitude: float = 0.5,
+        chunk_ms: float = 10.0,
+        realtime: bool = True,
+        duration: Optional[float] = None,
+        impulse_interval: float = 1.0,
+        source_rate: int = STANDARD_SAMPLE_RATE,
+        source_channels: int = STANDARD_CHANNELS,
+        source_format: str = SampleFormat.FLOAT32,
+        resample_quality: ResampleQuality = 'best',
+        seed: int = 0,
+    ) -> None:
+        """
+        Initialize synthetic backend.
+
+        Args:
+            pid: Nominal process ID (only reported, nothing is captured)
+            signal: Signal type ('sine', 'noise', 'silence', 'impulse')
+            frequency: Sine frequency in Hz
+            amplitude: Peak amplitude in [0.0, 1.0]
+            chunk_ms: Duration of each chunk returned by read()
+            realtime: If True, read() paces chunks at the wall-clock rate;
+                      if False, chunks are produced as fast as they are read
+            duration: Stop producing data after this many seconds of audio
+                      (None: unlimited)
+            impulse_interval: Seconds between impulses for signal="impulse"
+            source_rate: Native sample rate of the generated signal
+            source_channels: Native channel count of the generated signal
+            source_format: Native sample format (SampleFormat.INT16/INT32/FLOAT32)
+            resample_quality: Resampling quality for the native -> standard conversion
+            seed: Random seed for signal="noise"
+
+        Raises:
+            ValueError: If signal or source_format is not supported
+        """
+        super().__init__(pid)
+
+        if signal not in ('sine', 'noise', 'silence', 'impulse'):
+            raise ValueError(f"Unknown signal: {signal}")
+        if source_format not in (SampleFormat.INT16, SampleFormat.INT32, SampleFormat.FLOAT32):
+            raise ValueError(f"Unsupported source format: {source_format}")
+
+        self._signal = signal
+        self._frequency = frequency
+        self._amplitude = amplitude
+        self._realtime = realtime
+        self._duration = duration
+        self._impulse_interval = impulse_interval
+        self._source_rate = source_rate
+        self._source_channels = source_channels
+        self._source_format = source_format
+        self._chunk_frames = max(1, int(source_rate * chunk_ms / 1000))
+        self._rng = np.random.default_rng(seed)
+
+        self._position = 0  # Frames generated so far (native rate)
+        self._start_time: Optional[float] = None
+        self._running = threading.Event()
+
+        self._resample_quality = resample_quality
+        self._muted = False
+        self._parked = False
+
+        # Convert to standard format like a real backend
+        self._needs_conversion = (
+            source_rate != STANDARD_SAMPLE_RATE
+            or source_channels != STANDARD_CHANNELS
+            or source_format != SampleFormat.FLOAT32
+        )
+        self._converter: Optional[AudioConverter] = None
+        if self._needs_conversion:
+            self._converter = self._make_converter()
+
+    def _make_converter(self) -> AudioConverter:
+        """Build the native -> standard converter."""
+        return AudioConverter(
+            src_rate=self._source_rate,
+            src_channels=self._source_channels,
+            src_width=2 if self._source_format == SampleFormat.INT16 else 4,
+            dst_rate=STANDARD_SAMPLE_RATE,
+            dst_channels=STANDARD_CHANNELS,
+            dst_width=STANDARD_SAMPLE_WIDTH,
+            src_format=self._source_format,
+            dst_format=SampleFormat.FLOAT32,
+            auto_detect_format=False,
+            resample_quality=self._resample_quality,
+        )
+
+    @property
+    def frames_generated(self) -> int:
+        """Number of frames generated so far (at the native rate)."""
+        return self._position
+
+    def start(self) -> None:
+        """Start producing audio."""
+        self._position = 0
+        self._start_time = time.monotonic()
+        self._parked = False
+        self._running.set()
+        logger.debug(
+            f"Synthetic backend started: {self._signal}, "
+            f"{self._source_rate}Hz/{self._source_channels}ch/{self._source_format}"
+        )
+
+    def stop(self) -> None:
+        """Stop producing audio. Safe to call multiple times."""
+        self._running.clear()
+
+    def read(self) -> Optional[bytes]:
+        """
+        Read the next chunk.
+
+        Returns:
+            PCM audio data in standard format (48kHz/2ch/float32), or None
+            if stopped or the configured duration has been produced
+
+        Note:
+            In realtime mode this sleeps until the chunk is "due", which is
+            at most one chunk duration.
+        """
+        pcm = self._next_chunk()
+        if pcm is None:
+            return None
+
+        if self._converter is not None:
+            return self._converter.convert(pcm)
+        return pcm
+
+    def set_signal(self, signal: SignalType) -> None:
+        """
+        Switch the generated signal without restarting (e.g. to simulate
+        a stream going silent and resuming).
+
+        Args:
+            signal: Signal type ('sine', 'noise', 'silence', 'impulse')
+
+        Raises:
+            ValueError: If signal is not supported
+        """
+        if signal not in ('sine', 'noise', 'silence', 'impulse'):
+            raise ValueError(f"Unknown signal: {signal}")
+        self._signal = signal
+
+    def set_muted(self, muted: bool) -> None:
+        """
+        Set the simulated server-side mute state reported by is_muted().
+
+        The generated signal is unchanged, like a capture point in front of
+        the stream volume.
+
+        Args:
+            muted: New mute state
+        """
+        self._muted = muted
+
+    def is_muted(self) -> Optional[bool]:
+        """Simulated server-side mute state (see set_muted())."""
+        return self._muted
+
+    def hibernate(self) -> None:
+        """Drop the converter; it is rebuilt on wake."""
+        self._converter = None
+
+    def wake(self) -> None:
+        """Rebuild the converter dropped by hibernate()."""
+        if self._needs_conversion and self._converter is None:
+            self._converter = self._make_converter()
+
+    @property
+    def is_parked(self) -> bool:
+        """Check if generation is stopped by park()."""
+        return self._parked
+
+    def park(self) -> bool:
+        """Stop generating until unpark(), like a stopped capture."""
+        self._parked = True
+        return True
+
+    def unpark(self) -> None:
+        """Resume generating; the parked period is skipped, not caught up."""
+        if self._parked and self._start_time is not None:
+            self._start_time = time.monotonic() - self._position / self._source_rate
+        self._parked = False
+
+    def read_activity(self, detector: ActivityDetector) -> Optional[bytes]:
+        """
+        Generate the next chunk and test it in the native format.
+
+        Args:
+            detector: Activity detector holding the pre-roll
+
+        Returns:
+            Pre-roll plus chunk in standard format once a chunk is active,
+            None otherwise
+        """
+        pcm = self._next_chunk()
+        if pcm is None:
+            return None
+        pcm = detector.feed(pcm, self._source_format, self._source_channels, self._source_rate)
+        if pcm is None:
+            return None
+        self.wake()
+        if self._converter is not None:
+            return self._converter.convert(pcm)
+        return pcm
+
+    def _next_chunk(self) -> Optional[bytes]:
+        """Generate (and pace) the next chunk in the native format."""
+        if not self._running.is_set() or self._parked or self._start_time is None:
+            return None
+
+        num_frames = self._chunk_frames
+        if self._duration is not None:
+            remaining = int(self._duration * self._source_rate) - self._position
+            if remaining <= 0:
+                return None
+            num_frames = min(num_frames, remaining)
+
+        if self._realtime:
+            due = self._start_time + (self._position + num_frames) / self._source_rate
+            delay = due - time.monotonic()
+            if delay > 0:
+                time.sleep(delay)
+
+        pcm = self._encode(self._generate(num_frames))
+        self._position += num_frames
+        return pcm
+
+    def _generate(self, num_frames: int) -> np.ndarray:
+        """Generate the next num_frames of float32 mono signal."""
+        if self._signal == 'sine':
+            t = (self._position + np.arange(num_frames)) / self._source_rate
+            return (self._amplitude * np.sin(2 * np.pi * self._frequency * t)).astype(np.float32)
+        if self._signal == 'noise':
+            return self._rng.uniform(-self._amplitude, self._amplitude, num_frames).astype(np.float32)
+
+        samples = np.zeros(num_frames, dtype=np.float32)
+        if self._signal == 'impulse':
+            interval = max(1, int(round(self._impulse_interval * self._source_rate)))
+            first = -self._position % interval
+            samples[first::interval] = self._amplitude
+        return samples
+
+    def _encode(self, mono: np.ndarray) -> bytes:
+        """Duplicate mono signal to all channels and encode to the native format."""
+        frames = np.repeat(mono[:, np.newaxis], self._source_channels, axis=1)
+        if self._source_format == SampleFormat.INT16:
+            return (frames * 32767).astype(np.int16).tobytes()
+        if self._source_format == SampleFormat.INT32:
+            # 1.0 * (2**31 - 1) rounds up to 2**31 in float32 and would wrap to
+            # INT32_MIN, so scale in float64 and clip after rounding
+            scaled = np.rint(frames.astype(np.float64) * 2147483647.0)
+            return np.clip(scaled, -2147483648, 2147483647).astype(np.int32).tobytes()
+        return frames.tobytes()
+
+    def get_format(self) -> dict[str, int | str]:
+        """
+        Get audio format information.
+
+        Returns:
+            Dictionary with standard format (48kHz/2ch/float32)
+        """
+        return {
+            'sample_rate': STANDARD_SAMPLE_RATE,
+            'channels': STANDARD_CHANNELS,
+            'bits_per_sample': STANDARD_SAMPLE_WIDTH * 8,
+            'sample_format': STANDARD_FORMAT,
+        }
+
+    def get_latency_ms(self) -> float:
+        """
+        Get the algorithmic latency: one chunk plus the conversion.
+
+        Returns:
+            Latency in milliseconds
+        """
+        return 1000.0 * self._chunk_frames / self._source_rate + self.get_conversion_latency_ms()
+
+    def get_conversion_latency_ms(self) -> float:
+        """
+        Get the resampler delay of the converter.
+
+        Returns:
+            Latency in milliseconds (0 while hibernating)
+        """
+        if self._converter is None:
+            return 0.0
+        return 1000.0 * self._converter.latency_frames / STANDARD_SAMPLE_RATE
+
+
+__all__ = ['SyntheticBackend']
@@ -0,0 +1,507 @@
+"""
+cgroup v2 CPU isolation for capture and worker threads.
+
+On a shared host a heavy consumer (transcription, archival encoding) can
+starve the capture threads. Where the current cgroup is delegated to us
+(e.g. a systemd user scope with Delegate=yes), CgroupIsolation splits this
+process's threads into threaded child cgroups with their own cpu.weight and
+cpu.max:
+
+    <current cgroup>/          cgroup.subtree_control: +cpu
+        proctap-main/          every thread not placed elsewhere
+        proctap-capture/       capture workers and backend threads
+        proctap-workers/       heavy consumer threads
+
+Threads (and processes such as parec) created by a placed thread inherit its
+cgroup, so ProcessAudioCapture.start() places the calling thread in the
+capture group while it starts the backend and worker threads. Consumers
+place their heavy threads with join("workers") or placed("workers").
+
+Pressure stall information (PSI) and CPU statistics are reported per group
+by stats().
+
+Usage:
+    isolation = cgroups.enable(groups={
+        "capture": CpuLimits(weight=1000),
+        "workers": CpuLimits(weight=50, max_percent=200.0),
+    })
+    pool = ThreadPoolExecutor(initializer=isolation.join, initargs=("workers",))
+    ...
+    print(isolation.stats()["capture"]["cpu.pressure"].some.avg10)
+    cgroups.disable()
+"""
+
+from __future__ import annotations
+
+import contextlib
+import logging
+import os
+import threading
+from dataclasses import dataclass
+from pathlib import Path
+from typing import Iterator, Mapping, Optional
+
+logger = logging.getLogger(__name__)
+
+MAIN_GROUP = 'main'
+CAPTURE_GROUP = 'capture'
+WORKERS_GROUP = 'workers'
+
+PRESSURE_FILES = ('cpu.pressure', 'memory.pressure', 'io.pressure')
+
+
+@dataclass(frozen=True)
+class CpuLimits:
+    """CPU controls of one group."""
+    weight: int = 100  # cpu.weight, 1-10000 (100 = default share)
+    max_percent: Optional[float] = None  # cpu.max as % of one CPU (None: unlimited)
+    period_us: int = 100000  # cpu.max period
+
+    def __post_init__(self) -> None:
+        if not 1 <= self.weight <= 10000:
+            raise ValueError(f"cpu.weight must be in 1-10000: {self.weight}")
+        if self.max_percent is not None and self.max_percent <= 0:
+            raise ValueError(f"max_percent must be positive: {self.max_percent}")
+        if not 1000 <= self.period_us <= 1000000:
+            raise ValueError(f"period_us must be in 1000-1000000: {self.period_us}")
+
+    @property
+    def cpu_max(self) -> str:
+        """Value for the cpu.max file."""
+        if self.max_percent is None:
+            return f"max {self.period_us}"
+        quota = max(1000, int(self.period_us * self.max_percent / 100.0))
+        return f"{quota} {self.period_us}"
+
+
+@dataclass(frozen=True)
+class PressureLine:
+    """One line ('some' or 'full') of a PSI file."""
+    avg10: float
+    avg60: float
+    avg300: float
+    total_us: int
+
+
+@dataclass(frozen=True)
+class Pressure:
+    """Pressure stall information of one resource."""
+    some: PressureLine
+    full: Optional[PressureLine] = None  # Not reported for cpu on older kernels
+
+
+def parse_pressure(text: str) -> Pressure:
+    """
+    Parse a PSI file (cpu.pressure, memory.pressure, io.pressure).
+
+    Args:
+        text: File contents, e.g. "some avg10=0.00 avg60=0.00 avg300=0.00 total=0"
+
+    Returns:
+        Parsed pressure
+
+    Raises:
+        ValueError: If the 'some' line is missing or malformed
+    """
+    lines: dict[str, PressureLine] = {}
+    for line in text.splitlines():
+        kind, _, rest = line.strip().partition(' ')
+        if not kind:
+            continue
+        try:
+            fields = dict(item.split('=', 1) for item in rest.split())
+            lines[kind] = PressureLine(
+                avg10=float(fields['avg10']),
+                avg60=float(fields['avg60']),
+                avg300=float(fields['avg300']),
+                total_us=int(fields['total']),
+            )
+        except (KeyError, ValueError) as e:
+            raise ValueError(f"Malformed pressure line: {line!r}") from e
+    if 'some' not in lines:
+        raise ValueError("Pressure data has no 'some' line")
+    return Pressure(some=lines['some'], full=lines.get('full'))
+
+
+def find_cgroup2_mount(proc_root: str = '/proc') -> Optional[Path]:
+    """
+    Find the cgroup v2 mount point (also in hybrid v1/v2 setups).
+
+    Args:
+        proc_root: procfs mount point
+
+    Returns:
+        Mount point, or None if cgroup v2 is not mounted
+    """
+    try:
+        with open(os.path.join(proc_root, 'self', 'mounts')) as f:
+            for line in f:
+                fields = line.split()
+                if len(fields) >= 3 and fields[2] == 'cgroup2':
+                    return Path(fields[1])
+    except OSError:
+        pass
+    return None
+
+
+def current_cgroup(proc_root: str = '/proc') -> Optional[str]:
+    """
+    Get this process's cgroup v2 path (relative to the cgroup2 mount).
+
+    Args:
+        proc_root: procfs mount point
+
+    Returns:
+        Path such as "/user.slice/.../app.scope", or None if unknown
+    """
+    try:
+        with open(os.path.join(proc_root, 'self', 'cgroup')) as f:
+            for line in f:
+                if line.startswith('0::'):
+                    return line[3:].strip()
+    except OSError:
+        pass
+    return None
+
+
+class CgroupIsolation:
+    """
+    Threaded child cgroups of the current (delegated) cgroup.
+
+    setup() creates the groups and moves every thread of the current cgroup
+    into the main group; close() moves them back and removes the groups.
+    """
+
+    def __init__(
+        self,
+        groups: Optional[Mapping[str, CpuLimits]] = None,
+        prefix: str = 'proctap-',
+        cgroup_root: Optional[str] = None,
+        cgroup_path: Optional[str] = None,
+        proc_root: str = '/proc',
+    ) -> None:
+        """
+        Initialize isolation (nothing is changed until setup()).
+
+        Args:
+            groups: CPU limits per group name. 'main' (default limits) is
+                    always created. Default: capture weight 1000, workers
+                    weight 50
+            prefix: Directory name prefix of the child cgroups
+            cgroup_root: cgroup v2 mount point (default: from /proc/self/mounts)
+            cgroup_path: Cgroup to split (default: from /proc/self/cgroup)
+            proc_root: procfs mount point
+        """
+        if groups is None:
+            groups = {CAPTURE_GROUP: CpuLimits(weight=1000), WORKERS_GROUP: CpuLimits(weight=50)}
+        self._limits = {MAIN_GROUP: CpuLimits(), **groups}
+        self._prefix = prefix
+        self._proc_root = proc_root
+
+        root = Path(cgroup_root) if cgroup_root is not None else find_cgroup2_mount(proc_root)
+        path = cgroup_path if cgroup_path is not None else current_cgroup(proc_root)
+        self._base: Optional[Path] = None
+        if root is not None and path is not None:
+            self._base = root / path.lstrip('/')
+
+        self._lock = threading.Lock()
+        self._placement: dict[int, str] = {}  # Native thread ID -> group
+        self._active = False
+
+    @property
+    def base(self) -> Optional[Path]:
+        """The cgroup being split."""
+        return self._base
+
+    @property
+    def groups(self) -> list[str]:
+        """Group names."""
+        return list(self._limits)
+
+    @property
+    def active(self) -> bool:
+        """Whether setup() has completed and close() has not been called."""
+        return self._active
+
+    def path(self, group: str) -> Path:
+        """
+        Get the directory of a group.
+
+        Raises:
+            KeyError: If the group is unknown
+            RuntimeError: If the current cgroup is unknown
+        """
+        if group not in self._limits:
+            raise KeyError(f"Unknown cgroup group: {group}")
+        if self._base is None:
+            raise RuntimeError("Current cgroup v2 path is unknown")
+        return self._base / f"{self._prefix}{group}"
+
+    def check_delegation(self) -> Optional[str]:
+        """
+        Check whether the current cgroup can be split.
+
+        Returns:
+            None if it can, otherwise the reason why not
+        """
+        if self._base is None:
+            return "cgroup v2 is not mounted or the current cgroup is unknown"
+        try:
+            controllers = (self._base / 'cgroup.controllers').read_text().split()
+        except OSError as e:
+            return f"cannot read {self._base / 'cgroup.controllers'}: {e}"
+        if 'cpu' not in controllers:
+            return f"cpu controller is not available in {self._base}"
+        if not os.access(self._base, os.W_OK):
+            return f"{self._base} is not writable (not delegated)"
+        for name in ('cgroup.subtree_control', 'cgroup.threads'):
+            if not os.access(self._base / name, os.W_OK):
+                return f"{self._base / name} is not writable (not delegated)"
+        return None
+
+    def is_delegated(self) -> bool:
+        """Whether the current cgroup can be split (see check_delegation())."""
+        return self.check_delegation() is None
+
+    def setup(self) -> None:
+        """
+        Create the groups, enable the cpu controller and apply the limits.
+
+        Raises:
+            RuntimeError: If the cgroup is not delegated or setup fails (any
+                          partial setup is undone)
+        """
+        if self._active:
+            return
+        reason = self.check_delegation()
+        if reason is not None:
+            raise RuntimeError(f"cgroup isolation unavailable: {reason}")
+        assert self._base is not None
+
+        try:
+            for group in self._limits:
+                directory = self.path(group)
+                directory.mkdir(exist_ok=True)
+                self._write(directory / 'cgroup.type', 'threaded')
+
+            # Threaded children may only enable threaded controllers; every
+            # thread in the base cgroup goes to main first
+            for tid in self._threads(self._base):
+                self._move(tid, MAIN_GROUP)
+            self._write(self._base / 'cgroup.subtree_control', '+cpu')
+
+            for group, limits in self._limits.items():
+                self._write(self.path(group) / 'cpu.weight', str(limits.weight))
+                self._write(self.path(group) / 'cpu.max', limits.cpu_max)
+        except OSError as e:
+            self._teardown()
+            raise RuntimeError(f"Failed to set up cgroup isolation in {self._base}: {e}") from e
+
+        self._active = True
+        logger.info(f"cgroup isolation enabled in {self._base}: {', '.join(self._limits)}")
+
+    def close(self) -> None:
+        """Move all threads back to the base cgroup and remove the groups."""
+        if not self._active:
+            return
+        self._active = False
+        self._teardown()
+        logger.info(f"cgroup isolation disabled in {self._base}")
+
+    def join(self, group: str) -> None:
+        """
+        Move the calling thread into a group (threads and processes it
+        creates afterwards start there too).
+
+        Args:
+            group: Group name
+
+        Raises:
+            KeyError: If the group is unknown
+            RuntimeError: If isolation is not active or the move fails
+        """
+        if not self._active:
+            raise RuntimeError("cgroup isolation is not active")
+        try:
+            self._move(threading.get_native_id(), group)
+        except OSError as e:
+            raise RuntimeError(f"Failed to move thread into cgroup '{group}': {e}") from e
+
+    @contextlib.contextmanager
+    def placed(self, group: str) -> Iterator[None]:
+        """
+        Run a block with the calling thread in a group, then move it back.
+
+        Threads started inside the block stay in the group.
+
+        Args:
+            group: Group name
+        """
+        tid = threading.get_native_id()
+        with self._lock:
+            previous = self._placement.get(tid, MAIN_GROUP)
+        self.join(group)
+        try:
+            yield
+        finally:
+            if self._active:
+                try:
+                    self._move(tid, previous)
+                except OSError as e:
+                    logger.warning(f"Failed to move thread back to cgroup '{previous}': {e}")
+
+    def stats(self) -> dict[str, dict[str, object]]:
+        """
+        Get pressure and CPU statistics per group.
+
+        Returns:
+            {group: {'cpu.pressure': Pressure, 'memory.pressure': Pressure,
+            'io.pressure': Pressure, 'usage_usec': int, 'throttled_usec': int,
+            'nr_throttled': int}}; entries the kernel does not provide are
+            omitted
+        """
+        result: dict[str, dict[str, object]] = {}
+        for group in self._limits:
+            directory = self.path(group)
+            entry: dict[str, object] = {}
+            for name in PRESSURE_FILES:
+                try:
+                    entry[name] = parse_pressure((directory / name).read_text())
+                except (OSError, ValueError):
+                    pass
+            try:
+                for line in (directory / 'cpu.stat').read_text().splitlines():
+                    key, _, value = line.partition(' ')
+                    if key in ('usage_usec', 'throttled_usec', 'nr_throttled'):
+                        entry[key] = int(value)
+            except (OSError, ValueError):
+                pass
+            result[group] = entry
+        return result
+
+    def _teardown(self) -> None:
+        """Undo setup() as far as possible (errors are logged)."""
+        assert self._base is not None
+        for group in self._limits:
+            directory = self.path(group)
+            if not directory.is_dir():
+                continue
+            for tid in self._threads(directory):
+                try:
+                    self._write(self._base / 'cgroup.threads', str(tid))
+                except OSError as e:
+                    logger.debug(f"Could not move thread {tid} out of {directory}: {e}")
+        try:
+            self._write(self._base / 'cgroup.subtree_control', '-cpu')
+        except OSError as e:
+            logger.debug(f"Could not disable cpu controller in {self._base}: {e}")
+        for group in self._limits:
+            try:
+                self.path(group).rmdir()
+            except OSError as e:
+                logger.debug(f"Could not remove {self.path(group)}: {e}")
+        with self._lock:
+            self._placement.clear()
+
+    def _move(self, tid: int, group: str) -> None:
+        self._write(self.path(group) / 'cgroup.threads', str(tid))
+        with self._lock:
+            self._placement[tid] = group
+
+    @staticmethod
+    def _threads(directory: Path) -> list[int]:
+        try:
+            return [int(line) for line in (directory / 'cgroup.threads').read_text().split()]
+        except (OSError, ValueError):
+            return []
+
+    @staticmethod
+    def _write(path: Path, value: str) -> None:
+        # cgroupfs files take one value per write()
+        with open(path, 'w') as f:
+            f.write(value)
+
+
+# -------------------------------
+# Process-wide isolation
+# -------------------------------
+
+_active_isolation: Optional[CgroupIsolation] = None
+_active_lock = threading.Lock()
+
+
+def enable(
+    groups: Optional[Mapping[str, CpuLimits]] = None,
+    prefix: str = 'proctap-',
+    cgroup_root: Optional[str] = None,
+    cgroup_path: Optional[str] = None,
+    proc_root: str = '/proc',
+) -> CgroupIsolation:
+    """
+    Enable process-wide cgroup isolation.
+
+    Captures started afterwards run their threads in the 'capture' group.
+
+    Args:
+        groups: CPU limits per group name (see CgroupIsolation)
+        prefix: Directory name prefix of the child cgroups
+        cgroup_root: cgroup v2 mount point (default: from /proc/self/mounts)
+        cgroup_path: Cgroup to split (default: from /proc/self/cgroup)
+        proc_root: procfs mount point
+
+    Returns:
+        The active isolation
+
+    Raises:
+        RuntimeError: If isolation is already enabled or unavailable
+    """
+    global _active_isolation
+    with _active_lock:
+        if _active_isolation is not None:
+            raise RuntimeError("cgroup isolation is already enabled")
+        isolation = CgroupIsolation(groups, prefix, cgroup_root, cgroup_path, proc_root)
+        isolation.setup()
+        _active_isolation = isolation
+        return isolation
+
+
+def disable() -> None:
+    """Disable process-wide cgroup isolation (no-op if not enabled)."""
+    global _active_isolation
+    with _active_lock:
+        isolation, _active_isolation = _active_isolation, None
+    if isolation is not None:
+        isolation.close()
+
+
+def active() -> Optional[CgroupIsolation]:
+    """Get the process-wide isolation, if enabled."""
+    return _active_isolation
+
+
+@contextlib.contextmanager
+def capture_placement() -> Iterator[None]:
+    """Place the calling thread in the capture group, if isolation is enabled."""
+    isolation = _active_isolation
+    with contextlib.ExitStack() as stack:
+        if isolation is not None and isolation.active and CAPTURE_GROUP in isolation.groups:
+            try:
+                stack.enter_context(isolation.placed(CAPTURE_GROUP))
+            except RuntimeError as e:
+                logger.warning(f"Capture threads not isolated: {e}")
+        yield
+
+
+__all__ = [
+    'CpuLimits',
+    'CgroupIsolation',
+    'Pressure',
+    'PressureLine',
+    'parse_pressure',
+    'find_cgroup2_mount',
+    'current_cgroup',
+    'enable',
+    'disable',
+    'active',
+    'capture_placement',
+]
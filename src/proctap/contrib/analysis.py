@@ -32,6 +32,7 @@ import numpy as np
 from numpy.typing import NDArray
 
 from ..core import ProcessAudioCapture
+from ..spectral import SpectralBus, SpectralFrame, Subscription
 
 logger = logging.getLogger(__name__)
 
@@ -45,6 +46,9 @@ class AudioAnalyzer:
     - Peak amplitude
     - Spectrum analysis (FFT)
     - Frequency analysis
+
+    If a SpectralBus is given, the spectrum comes from the bus' shared STFT
+    frames instead of a private FFT; the bus must be fed the same stream.
     """
 
     def __init__(
@@ -53,6 +57,7 @@ class AudioAnalyzer:
         channels: int = 2,
         fft_size: int = 2048,
         update_interval: float = 0.05,  # 50ms
+        bus: Optional[SpectralBus] = None,
     ):
         """
         Initialize audio analyzer.
@@ -62,6 +67,7 @@ class AudioAnalyzer:
             channels: Number of audio channels
             fft_size: FFT window size (power of 2)
             update_interval: Analysis update interval in seconds
+            bus: Optional shared STFT bus to take spectra from
         """
         self.sample_rate = sample_rate
         self.channels = channels
@@ -79,6 +85,28 @@ class AudioAnalyzer:
         self._buffer: deque[float] = deque(maxlen=fft_size * 2)
         self._last_update = 0.0
 
+        # Shared spectra (hop of half a window, like the private FFT's overlap)
+        self._last_spectrum_update = 0.0
+        self._subscription: Optional[Subscription] = None
+        if bus is not None:
+            self._subscription = bus.subscribe(fft_size, fft_size // 2, callback=self._on_frame)
+
+    def close(self) -> None:
+        """Unsubscribe from the spectral bus (if any)."""
+        if self._subscription is not None:
+            self._subscription.close()
+            self._subscription = None
+
+    def _on_frame(self, frame: SpectralFrame) -> None:
+        """Take the spectrum from a shared STFT frame."""
+        now = time.time()
+        if now - self._last_spectrum_update < self.update_interval:
+            return
+        self._last_spectrum_update = now
+        spectrum_db = frame.magnitude_db()
+        with self._lock:
+            self._spectrum = spectrum_db
+
     def process_audio(self, pcm: bytes) -> None:
         """
         Process audio chunk and update analysis.
@@ -118,15 +146,20 @@ class AudioAnalyzer:
         peak = np.max(np.abs(samples))
         peak_db = 20 * np.log10(peak + 1e-10)
 
+        # Update thread-safe
+        with self._lock:
+            self._rms_db = float(rms_db)
+            self._peak_db = float(peak_db)
+
+        if self._subscription is not None:
+            return  # Spectrum is delivered by the bus
+
         # FFT spectrum
         windowed = samples * np.hanning(len(samples))
         spectrum = np.abs(np.fft.rfft(windowed))
         spectrum_db = 20 * np.log10(spectrum + 1e-10)
 
-        # Update thread-safe
         with self._lock:
-            self._rms_db = float(rms_db)
-            self._peak_db = float(peak_db)
             self._spectrum = spectrum_db.astype(np.float32)
 
     @property
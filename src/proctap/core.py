@@ -5,6 +5,7 @@ import threading
 import queue
 import asyncio
 import logging
+import time
 
 logger = logging.getLogger(__name__)
 
@@ -20,6 +21,10 @@ from .backends.base import (
     STANDARD_FORMAT,
     STANDARD_SAMPLE_WIDTH,
 )
+from .cgroups import capture_placement
+from .hibernation import ActivityDetector, HibernationPolicy
+from .latency import LatencyReport, LatencyStage
+from .poll import CaptureSelector, ChunkQueue
 
 AudioCallback = Callable[[bytes, int], None]  # (pcm_bytes, num_frames)
 
@@ -51,6 +56,8 @@ class ProcessAudioCapture:
         pid: int,
         on_data: Optional[AudioCallback] = None,
         resample_quality: ResampleQuality = 'best',
+        backend: Optional[AudioBackend] = None,
+        hibernation: Optional[HibernationPolicy] = None,
     ) -> None:
         """
         Initialize process audio capture.
@@ -62,20 +69,38 @@ class ProcessAudioCapture:
                 - 'best': Highest quality, ~1.3-1.4ms latency (default)
                 - 'medium': Medium quality, ~0.7-0.9ms latency
                 - 'fast': Lowest quality, ~0.3-0.5ms latency
+            backend: Optional backend instance to use instead of the platform
+                     backend (e.g. SyntheticBackend for tests and benchmarks).
+                     Must return the standard format.
+            hibernation: Optional policy for hibernating the capture while its
+                         stream is silent or muted (see proctap.hibernation).
+                         None: always active
         """
         self._pid = pid
         self._on_data = on_data
         self._resample_quality = resample_quality
 
         # Get platform-specific backend (always returns standard format)
-        self._backend: AudioBackend = get_backend(pid=pid, resample_quality=resample_quality)
+        if backend is None:
+            backend = get_backend(pid=pid, resample_quality=resample_quality)
+        self._backend: AudioBackend = backend
 
         logger.debug(f"Using backend: {type(self._backend).__name__}")
         logger.debug(f"Standard format: {STANDARD_SAMPLE_RATE}Hz, {STANDARD_CHANNELS}ch, {STANDARD_FORMAT}")
 
         self._thread: Optional[threading.Thread] = None
         self._stop_event = threading.Event()
-        self._async_queue: "queue.Queue[bytes | None]" = queue.Queue()
+        self._paused = threading.Event()
+        self._async_queue = ChunkQueue()
+        self._waiters: tuple[CaptureSelector, ...] = ()
+        self._waiters_lock = threading.Lock()
+        self._eof = False
+        self._hibernation = hibernation
+        self._hibernating = threading.Event()
+        self._parked = threading.Event()
+        # Cleared by the state thread while the server reports the stream muted
+        self._audible = threading.Event()
+        self._state_thread: Optional[threading.Thread] = None
 
     # --- public API -----------------------------------------------------
 
@@ -84,25 +109,54 @@ class ProcessAudioCapture:
             # すでに start 済みなら何もしない
             return
 
-        # Start platform-specific backend
-        self._backend.start()
-
-        self._stop_event.clear()
-        self._thread = threading.Thread(target=self._worker, daemon=True)
-        self._thread.start()
+        # Backend threads/processes and the worker inherit the cgroup of
+        # this thread, so start them from the capture group (if enabled)
+        with capture_placement():
+            # Start platform-specific backend
+            self._backend.start()
+
+            self._stop_event.clear()
+            self._hibernating.clear()
+            self._parked.clear()
+            self._audible.set()
+            self._eof = False
+            if self._hibernation is not None and self._hibernation.use_stream_state:
+                self._state_thread = threading.Thread(target=self._state_worker, daemon=True)
+                self._state_thread.start()
+            self._thread = threading.Thread(target=self._worker, daemon=True)
+            self._thread.start()
 
     def stop(self) -> None:
         self._stop_event.set()
+        self._audible.set()  # Wake a parked worker
 
         if self._thread is not None:
             self._thread.join(timeout=1.0)
             self._thread = None
+        if self._state_thread is not None:
+            self._state_thread.join(timeout=1.0)
+            self._state_thread = None
 
         try:
             self._backend.stop()
         except Exception:
             logger.exception("Error while stopping capture")
 
+    def pause(self) -> None:
+        """
+        Pause delivery of audio without stopping the capture.
+
+        The backend keeps running and is drained (so no stale backlog builds
+        up and converter state stays warm), but chunks are discarded instead
+        of being passed to the callback or queued. resume() makes audio flow
+        again within one chunk.
+        """
+        self._paused.set()
+
+    def resume(self) -> None:
+        """Resume delivery of audio after pause()."""
+        self._paused.clear()
+
     def close(self) -> None:
         self.stop()
 
@@ -120,6 +174,21 @@ class ProcessAudioCapture:
         """Check if audio capture is currently running."""
         return self._thread is not None and self._thread.is_alive()
 
+    @property
+    def is_paused(self) -> bool:
+        """Check if audio delivery is paused."""
+        return self._paused.is_set()
+
+    @property
+    def is_hibernating(self) -> bool:
+        """Check if the capture is hibernating (idle stream, nothing converted)."""
+        return self._hibernating.is_set()
+
+    @property
+    def is_parked(self) -> bool:
+        """Check if the backend's capture is stopped while its stream is muted."""
+        return self._parked.is_set()
+
     @property
     def pid(self) -> int:
         """Get the target process ID."""
@@ -168,6 +237,44 @@ class ProcessAudioCapture:
         """
         return self._backend.get_format()
 
+    def latency(self, include_queue: Optional[bool] = None) -> LatencyReport:
+        """
+        Get the end-to-end latency of the capture right now.
+
+        Args:
+            include_queue: Include chunks waiting for read()/iter_chunks().
+                           None: only when no on_data callback is set
+                           (callback consumers never drain that queue)
+
+        Returns:
+            LatencyReport with 'strategy' (capture chunk/period and the
+            backend queue), 'converter' (resampler delay) and 'read_queue'
+            (live depth of the read queue)
+
+        Example:
+            >>> report = tap.latency().with_stage("encoder", algorithmic_ms=20.0)
+            >>> print(report.describe())
+        """
+        converter_ms = self._backend.get_conversion_latency_ms()
+        stages = [
+            LatencyStage(
+                'strategy',
+                algorithmic_ms=self._backend.get_latency_ms() - converter_ms,
+                buffered_ms=self._backend.get_buffered_ms(),
+            ),
+            LatencyStage('converter', algorithmic_ms=converter_ms),
+        ]
+        if include_queue is None:
+            include_queue = self._on_data is None
+        if include_queue:
+            queued = self._async_queue.queued_bytes
+            frame_bytes = STANDARD_CHANNELS * STANDARD_SAMPLE_WIDTH
+            stages.append(LatencyStage(
+                'read_queue',
+                buffered_ms=1000.0 * queued / (frame_bytes * STANDARD_SAMPLE_RATE),
+            ))
+        return LatencyReport(tuple(stages))
+
     def read(self, timeout: float = 1.0) -> Optional[bytes]:
         """
         Synchronous API: Read one audio chunk (blocking).
@@ -190,6 +297,30 @@ class ProcessAudioCapture:
         except queue.Empty:
             return None
 
+    @property
+    def available_frames(self) -> int:
+        """Frames queued for read()/drain() (standard format)."""
+        return self._async_queue.queued_bytes // (STANDARD_CHANNELS * STANDARD_SAMPLE_WIDTH)
+
+    def drain(self, max_frames: Optional[int] = None) -> list[bytes]:
+        """
+        Take queued chunks without blocking or copying.
+
+        Returns the chunks exactly as the backend produced them (no join),
+        for consumers woken by proctap.poll() or a CaptureSelector.
+
+        Args:
+            max_frames: Stop once at least this many frames were taken
+                        (whole chunks only; None: take everything queued)
+
+        Returns:
+            PCM chunks (48kHz/2ch/float32) in order; empty if nothing is queued
+        """
+        max_bytes = None
+        if max_frames is not None:
+            max_bytes = max_frames * STANDARD_CHANNELS * STANDARD_SAMPLE_WIDTH
+        return self._async_queue.get_chunks(max_bytes)
+
     # --- async interface ------------------------------------------------
 
     async def iter_chunks(self) -> AsyncIterator[bytes]:
@@ -213,18 +344,68 @@ class ProcessAudioCapture:
             data = backend.read()
             -> callback
             -> async_queue
+
+        With a hibernation policy, an idle stream switches the loop to
+        backend.read_activity() until a chunk is active again. While the
+        state thread reports the stream muted, a hibernated backend is
+        parked and the loop sleeps until the stream is audible again.
         """
+        policy = self._hibernation
+        detector: Optional[ActivityDetector] = None
+        poll_s = 0.0
+        if policy is not None:
+            detector = ActivityDetector(policy.threshold_db, policy.preroll_ms)
+            poll_s = policy.state_poll_ms / 1000.0
+        last_active = time.monotonic()
+        can_park = True
+
         while not self._stop_event.is_set():
+            # Set by the state thread; no server round-trip on this thread
+            muted = not self._audible.is_set()
+
             try:
-                data = self._backend.read()
+                if detector is not None and self._hibernating.is_set():
+                    if self._parked.is_set():
+                        if muted:
+                            self._audible.wait(poll_s)
+                            continue
+                        if not self._unpark(detector):
+                            self._stop_event.wait(poll_s)
+                            continue
+                    elif muted and can_park:
+                        can_park = self._park()
+                        continue
+
+                    # Muted chunks only feed the pre-roll, so the backend
+                    # stays hibernated and no woken-up audio is dropped
+                    detector.hold = muted
+                    data = self._backend.read_activity(detector)
+                    if data is None:
+                        continue
+                    self._wake()
+                    last_active = time.monotonic()
+                else:
+                    data = self._backend.read()
             except Exception:
                 logger.exception("Error reading data from backend")
                 continue
 
+            if policy is not None and detector is not None:
+                now = time.monotonic()
+                if data and not muted and detector.is_active(data):
+                    last_active = now
+                elif now - last_active >= policy.idle_ms / 1000.0:
+                    self._hibernate(detector)
+                    continue
+
             if not data:
                 # パケットがまだ無いケース。ここで sleep 入れるかは後で調整。
                 continue
 
+            if self._paused.is_set():
+                # Keep draining the backend, but deliver nothing
+                continue
+
             # callback
             if self._on_data is not None:
                 try:
@@ -240,9 +421,116 @@ class ProcessAudioCapture:
             except queue.Full:
                 # リアルタイム性重視なので捨てる
                 pass
+            self._notify_waiters()
+
+        # Leave the backend fully initialized for a later start(); a parked
+        # capture is cleaned up by backend.stop()
+        self._parked.clear()
+        if self._hibernating.is_set():
+            self._wake()
 
         # 終了シグナル
         try:
             self._async_queue.put_nowait(None)
         except queue.Full:
             pass
+        self._eof = True
+        self._notify_waiters()
+
+    def _state_worker(self) -> None:
+        """
+        Poll the stream's mute state for the hibernation policy.
+
+        Runs on its own thread so the audio server round-trip never blocks
+        the capture worker, which only reads the _audible flag.
+        """
+        assert self._hibernation is not None
+        poll_s = self._hibernation.state_poll_ms / 1000.0
+
+        while not self._stop_event.is_set():
+            try:
+                muted = bool(self._backend.is_muted())
+            except Exception:
+                logger.exception("Error querying stream state")
+                muted = False
+            if muted and not self._stop_event.is_set():
+                self._audible.clear()
+            else:
+                self._audible.set()
+            self._stop_event.wait(poll_s)
+
+    # --- readiness (proctap.poll) ---------------------------------------
+
+    def _add_waiter(self, selector: CaptureSelector) -> None:
+        with self._waiters_lock:
+            if selector not in self._waiters:
+                self._waiters = self._waiters + (selector,)
+
+    def _remove_waiter(self, selector: CaptureSelector) -> None:
+        with self._waiters_lock:
+            self._waiters = tuple(w for w in self._waiters if w is not selector)
+
+    def _notify_waiters(self) -> None:
+        for selector in self._waiters:  # Immutable snapshot, no lock needed
+            selector._notify(self)
+
+    def _queued_bytes(self) -> int:
+        return self._async_queue.queued_bytes
+
+    def _at_eof(self) -> bool:
+        return self._eof
+
+    def _hibernate(self, detector: ActivityDetector) -> None:
+        """Release backend state and switch the worker to activity probing."""
+        detector.reset()
+        try:
+            self._backend.hibernate()
+        except Exception:
+            logger.exception("Error while hibernating backend")
+        self._hibernating.set()
+        logger.debug(f"Capture for PID {self._pid} hibernating")
+
+    def _park(self) -> bool:
+        """
+        Stop the backend's capture while the hibernated stream is muted.
+
+        Returns:
+            False if the backend cannot park (it is not asked again until
+            the next start())
+        """
+        try:
+            parked = self._backend.park()
+        except Exception:
+            logger.exception("Error while parking backend")
+            return False
+        if parked:
+            self._parked.set()
+            logger.debug(f"Capture for PID {self._pid} parked")
+        return parked
+
+    def _unpark(self, detector: ActivityDetector) -> bool:
+        """
+        Restart a parked backend once its stream is audible again.
+
+        Returns:
+            True if the backend is capturing again, False to retry later
+        """
+        try:
+            self._backend.unpark()
+        except Exception as e:
+            logger.warning(f"Could not resume capture for PID {self._pid}: {e}")
+            return False
+        # Pre-roll from before the park does not lead into the new audio
+        detector.reset()
+        self._parked.clear()
+        logger.debug(f"Capture for PID {self._pid} unparked")
+        return True
+
+    def _wake(self) -> None:
+        """Restore backend state after hibernation."""
+        try:
+            self._backend.wake()
+        except Exception:
+            logger.exception("Error while waking backend")
+        self._hibernating.clear()
+        logger.debug(f"Capture for PID {self._pid} woke up")
@@ -0,0 +1,506 @@
+"""
+Host-wide block grid for aligned multi-stream processing.
+
+Every backend delivers chunks of a different size: parec reads 10ms, PipeWire
+delivers its quantum, WASAPI delivers packet sizes and the resampler output
+length varies per chunk. A BlockGrid re-blocks every registered stream once,
+on a common tick, so downstream stages always see uniformly sized blocks that
+start at the same grid frame for all streams.
+
+Audio is expected in the standard format (48kHz/2ch/float32).
+
+Usage:
+    grid = BlockGrid(block_frames=480)  # 10ms blocks
+    grid.attach(capture_a, name="game")
+    grid.attach(capture_b, name="music")
+
+    # Pull mode
+    block = grid.tick()
+    block.data  # shape (num_streams, 480, 2)
+
+    # Push mode (ticks on a timer thread)
+    grid.start(on_block=lambda block: process(block.data))
+"""
+
+from __future__ import annotations
+
+import logging
+import math
+import threading
+import time
+from dataclasses import dataclass, field
+from typing import TYPE_CHECKING, Callable, Optional
+
+import numpy as np
+
+from .backends.base import STANDARD_CHANNELS, STANDARD_DTYPE, STANDARD_SAMPLE_RATE
+
+if TYPE_CHECKING:
+    from .core import ProcessAudioCapture
+
+logger = logging.getLogger(__name__)
+
+BlockCallback = Callable[["GridBlock"], None]
+
+
+@dataclass
+class GridBlock:
+    """
+    One tick worth of aligned audio for every stream on the grid.
+
+    Attributes:
+        tick: Tick index since the grid origin
+        start_frame: Grid frame position of the first frame in this block
+        names: Stream names, in the same order as the first axis of data
+        data: float32 array of shape (num_streams, block_frames, channels)
+        underruns: Names of streams that were zero-filled on this tick
+    """
+    tick: int
+    start_frame: int
+    names: tuple[str, ...]
+    data: np.ndarray
+    underruns: tuple[str, ...] = field(default_factory=tuple)
+
+    def stream(self, name: str) -> np.ndarray:
+        """
+        Get the block for a single stream.
+
+        Args:
+            name: Stream name
+
+        Returns:
+            View of shape (block_frames, channels)
+        """
+        return self.data[self.names.index(name)]  # type: ignore[no-any-return]
+
+
+class GridStream:
+    """
+    Per-stream ring buffer drained by the grid in fixed-size blocks.
+
+    Incoming chunks of arbitrary length are written into a ring; the grid
+    reads exactly block_frames per tick. The stream also tracks its offset
+    against the grid clock in (fractional) frames so that consumers can apply
+    sub-sample alignment if they need it.
+    """
+
+    def __init__(
+        self,
+        name: str,
+        grid: "BlockGrid",
+        capacity_frames: int,
+        start_frame: int = 0,
+    ) -> None:
+        self.name = name
+        self._grid = grid
+        self._channels = grid.channels
+        self._ring = np.zeros((capacity_frames, self._channels), dtype=STANDARD_DTYPE)
+        self._capacity = capacity_frames
+        self._lock = threading.Lock()
+        # Monotonic positions on the grid timeline (in frames)
+        self._write_pos = start_frame
+        self._read_pos = start_frame
+
+        # Alignment state
+        self._aligned = False
+        self._offset_frames = 0.0
+
+        # Statistics
+        self._underruns = 0
+        self._overruns = 0
+        self._dropped_frames = 0
+
+    # --- producer side ----------------------------------------------------
+
+    def push(self, pcm: bytes | np.ndarray, timestamp: Optional[float] = None) -> None:
+        """
+        Append captured audio to the stream.
+
+        Args:
+            pcm: float32 PCM as bytes (interleaved) or an array of shape
+                 (frames, channels) / (frames * channels,)
+            timestamp: Clock time at which the last frame of the chunk was
+                       captured (defaults to the grid clock "now")
+        """
+        if isinstance(pcm, (bytes, bytearray, memoryview)):
+            frames = np.frombuffer(pcm, dtype=STANDARD_DTYPE)
+        else:
+            frames = np.asarray(pcm, dtype=STANDARD_DTYPE)
+
+        if frames.size == 0:
+            return
+        frames = frames.reshape(-1, self._channels)
+        num_frames = frames.shape[0]
+
+        if timestamp is None:
+            timestamp = self._grid.clock()
+
+        with self._lock:
+            # Position of the first frame of this chunk on the grid timeline
+            grid_pos = self._grid.frames_at(timestamp) - num_frames
+            if not self._aligned:
+                self._align(grid_pos, num_frames)
+            else:
+                # Slowly track the offset so that clock drift is visible
+                measured = grid_pos - self._write_pos
+                self._offset_frames += 0.01 * (measured - self._offset_frames)
+
+            self._write(frames)
+
+    def _align(self, grid_pos: float, num_frames: int) -> None:
+        """Place the first chunk on the grid (called with the lock held)."""
+        self._aligned = True
+        start = max(grid_pos, float(self._read_pos))
+        lead_in = int(math.floor(start)) - self._read_pos
+        # Lead-in and first chunk must fit the ring, or the chunk would
+        # overwrite its own lead-in and land early anyway
+        max_lead_in = self._capacity - min(num_frames, self._capacity)
+        if lead_in > max_lead_in:
+            logger.warning(
+                f"Stream '{self.name}' starts {lead_in} frames ahead of the grid, "
+                f"more than its ring holds; clamping lead-in to {max_lead_in} frames"
+            )
+            lead_in = max_lead_in
+        if lead_in > 0:
+            # Silence until the stream actually starts on the grid
+            self._write(np.zeros((lead_in, self._channels), dtype=STANDARD_DTYPE))
+        self._offset_frames = start - self._write_pos
+        logger.debug(
+            f"Stream '{self.name}' aligned to grid frame {start:.2f} "
+            f"(lead-in={max(lead_in, 0)} frames)"
+        )
+
+    def _write(self, frames: np.ndarray) -> None:
+        """Copy frames into the ring, dropping the oldest data on overflow."""
+        if self._write_pos < self._read_pos:
+            # The grid zero-filled past our position on underrun; continue
+            # at the read position so no pushed frame is lost or left behind
+            self._write_pos = self._read_pos
+
+        num_frames = frames.shape[0]
+        if num_frames > self._capacity:
+            frames = frames[-self._capacity:]
+            self._dropped_frames += num_frames - self._capacity
+            num_frames = self._capacity
+
+        overflow = (self._write_pos + num_frames) - (self._read_pos + self._capacity)
+        if overflow > 0:
+            # Real-time first: drop the oldest frames
+            self._read_pos += overflow
+            self._dropped_frames += overflow
+            self._overruns += 1
+
+        start = self._write_pos % self._capacity
+        first = min(num_frames, self._capacity - start)
+        self._ring[start:start + first] = frames[:first]
+        if first < num_frames:
+            self._ring[:num_frames - first] = frames[first:]
+        self._write_pos += num_frames
+
+    # --- consumer side ----------------------------------------------------
+
+    def _read_into(self, out: np.ndarray) -> bool:
+        """
+        Fill out with the next block (zero-filled on underrun).
+
+        Returns:
+            True if the block was complete, False on underrun
+        """
+        num_frames = out.shape[0]
+        with self._lock:
+            available = self._write_pos - self._read_pos
+            take = min(available, num_frames)
+
+            if take > 0:
+                start = self._read_pos % self._capacity
+                first = min(take, self._capacity - start)
+                out[:first] = self._ring[start:start + first]
+                if first < take:
+                    out[first:take] = self._ring[:take - first]
+            if take < num_frames:
+                out[take:] = 0.0
+                self._underruns += 1
+
+            # The grid position always advances, even on underrun, so that
+            # the stream stays aligned once data arrives again. The write
+            # position belongs to the producer; _write() catches up itself.
+            self._read_pos += num_frames
+
+        return bool(take == num_frames)
+
+    # --- properties -------------------------------------------------------
+
+    @property
+    def available(self) -> int:
+        """Number of frames buffered and not yet drained by the grid."""
+        with self._lock:
+            return max(self._write_pos - self._read_pos, 0)
+
+    @property
+    def offset_frames(self) -> float:
+        """Offset of this stream against the grid clock in frames."""
+        with self._lock:
+            return self._offset_frames
+
+    @property
+    def fractional_offset(self) -> float:
+        """Sub-sample part of the grid offset, in [0.0, 1.0)."""
+        offset = self.offset_frames
+        return offset - math.floor(offset)
+
+    @property
+    def stats(self) -> dict[str, int]:
+        """
+        Get stream statistics.
+
+        Returns:
+            Dictionary with keys:
+            - 'available': Frames currently buffered
+            - 'underruns': Ticks that had to be zero-filled
+            - 'overruns': Pushes that overflowed the ring
+            - 'dropped_frames': Frames discarded on overflow
+        """
+        with self._lock:
+            return {
+                'available': max(self._write_pos - self._read_pos, 0),
+                'underruns': self._underruns,
+                'overruns': self._overruns,
+                'dropped_frames': self._dropped_frames,
+            }
+
+
+class BlockGrid:
+    """
+    Common clock grid that drains every stream in fixed N-frame blocks.
+
+    All streams share the same sample rate, channel count and tick, so a
+    GridBlock can be processed across streams in a single vectorized pass
+    without per-stream re-blocking.
+    """
+
+    def __init__(
+        self,
+        block_frames: int = 480,
+        sample_rate: int = STANDARD_SAMPLE_RATE,
+        channels: int = STANDARD_CHANNELS,
+        ring_blocks: int = 32,
+        clock: Callable[[], float] = time.monotonic,
+        lead_ms: float = 10.0,
+    ) -> None:
+        """
+        Initialize block grid.
+
+        Args:
+            block_frames: Frames per block (default: 480 = 10ms @ 48kHz)
+            sample_rate: Sample rate of every stream in Hz
+            channels: Channel count of every stream
+            ring_blocks: Per-stream ring capacity in blocks
+            clock: Monotonic clock in seconds (injectable for testing)
+            lead_ms: Delivery allowance of the tick thread: a block is emitted
+                     this long after its last frame was captured, so chunks
+                     that arrive slightly late are not underruns (default:
+                     10ms = one parec chunk; use the PipeWire quantum or
+                     backend chunk size for other sources)
+        """
+        if block_frames <= 0:
+            raise ValueError(f"block_frames must be positive, got {block_frames}")
+        if ring_blocks < 2:
+            raise ValueError(f"ring_blocks must be at least 2, got {ring_blocks}")
+        if lead_ms < 0:
+            raise ValueError(f"lead_ms must be >= 0, got {lead_ms}")
+
+        self.block_frames = block_frames
+        self.sample_rate = sample_rate
+        self.channels = channels
+        self.ring_blocks = ring_blocks
+        self.clock = clock
+        self.lead_ms = lead_ms
+
+        self._origin = clock()
+        self._tick = 0
+        self._streams: dict[str, GridStream] = {}
+        self._streams_lock = threading.Lock()
+
+        self._thread: Optional[threading.Thread] = None
+        self._stop_event = threading.Event()
+
+    # --- clock ------------------------------------------------------------
+
+    @property
+    def block_duration(self) -> float:
+        """Duration of one block in seconds."""
+        return self.block_frames / self.sample_rate
+
+    @property
+    def tick_count(self) -> int:
+        """Number of ticks emitted so far."""
+        with self._streams_lock:
+            return self._tick
+
+    def deadline(self, tick: int) -> float:
+        """
+        Get the clock time at which the tick thread emits a block.
+
+        Args:
+            tick: Tick index
+
+        Returns:
+            Capture time of the block's last frame plus lead_ms
+        """
+        return self._origin + (tick + 1) * self.block_duration + self.lead_ms / 1000.0
+
+    def frames_at(self, timestamp: float) -> float:
+        """
+        Convert a clock time to a (fractional) grid frame position.
+
+        Args:
+            timestamp: Clock time in seconds
+
+        Returns:
+            Frames elapsed since the grid origin
+        """
+        return (timestamp - self._origin) * self.sample_rate
+
+    # --- stream management -------------------------------------------------
+
+    def add_stream(self, name: str) -> GridStream:
+        """
+        Register a new stream on the grid.
+
+        Args:
+            name: Unique stream name
+
+        Returns:
+            GridStream to push audio into
+
+        Raises:
+            ValueError: If a stream with the same name already exists
+        """
+        with self._streams_lock:
+            if name in self._streams:
+                raise ValueError(f"Stream '{name}' is already registered")
+            stream = GridStream(
+                name,
+                self,
+                capacity_frames=self.block_frames * self.ring_blocks,
+                start_frame=self._tick * self.block_frames,
+            )
+            self._streams[name] = stream
+        logger.debug(f"Added grid stream '{name}'")
+        return stream
+
+    def attach(self, capture: "ProcessAudioCapture", name: Optional[str] = None) -> GridStream:
+        """
+        Register a ProcessAudioCapture and feed it into the grid.
+
+        Note:
+            This replaces the capture's data callback.
+
+        Args:
+            capture: Capture to attach
+            name: Stream name (default: "pid-<pid>")
+
+        Returns:
+            GridStream fed by the capture
+        """
+        stream = self.add_stream(name or f"pid-{capture.pid}")
+        capture.set_callback(lambda data, _frames: stream.push(data))
+        return stream
+
+    def remove_stream(self, name: str) -> None:
+        """
+        Remove a stream from the grid.
+
+        Args:
+            name: Stream name
+        """
+        with self._streams_lock:
+            self._streams.pop(name, None)
+
+    @property
+    def streams(self) -> dict[str, GridStream]:
+        """Snapshot of the registered streams."""
+        with self._streams_lock:
+            return dict(self._streams)
+
+    # --- ticking ----------------------------------------------------------
+
+    def tick(self) -> GridBlock:
+        """
+        Drain exactly one block from every stream.
+
+        Streams without enough buffered audio are zero-filled so the
+        block always has the same shape.
+
+        Returns:
+            GridBlock with data of shape (num_streams, block_frames, channels)
+        """
+        with self._streams_lock:
+            streams = list(self._streams.values())
+            tick = self._tick
+            self._tick += 1
+
+        data = np.empty((len(streams), self.block_frames, self.channels), dtype=STANDARD_DTYPE)
+        underruns = tuple(
+            stream.name for i, stream in enumerate(streams) if not stream._read_into(data[i])
+        )
+
+        return GridBlock(
+            tick=tick,
+            start_frame=tick * self.block_frames,
+            names=tuple(stream.name for stream in streams),
+            data=data,
+            underruns=underruns,
+        )
+
+    def start(self, on_block: BlockCallback) -> None:
+        """
+        Start ticking on a background thread.
+
+        Ticks are scheduled against absolute deadlines derived from the grid
+        origin (see deadline()), so scheduling jitter does not accumulate.
+
+        Args:
+            on_block: Called with each GridBlock from the grid thread
+        """
+        if self._thread is not None:
+            return
+
+        self._stop_event.clear()
+        self._thread = threading.Thread(
+            target=self._run,
+            args=(on_block,),
+            daemon=True,
+            name="BlockGrid",
+        )
+        self._thread.start()
+
+    def stop(self) -> None:
+        """Stop the background tick thread."""
+        self._stop_event.set()
+        if self._thread is not None:
+            self._thread.join(timeout=1.0)
+            self._thread = None
+
+    def _run(self, on_block: BlockCallback) -> None:
+        """Tick loop."""
+        while not self._stop_event.is_set():
+            # A block is due lead_ms after its last frame has been captured
+            delay = self.deadline(self.tick_count) - self.clock()
+            if delay > 0 and self._stop_event.wait(delay):
+                break
+
+            block = self.tick()
+            try:
+                on_block(block)
+            except Exception:
+                logger.exception("Error in grid block callback")
+
+    def __enter__(self) -> "BlockGrid":
+        return self
+
+    def __exit__(self, _exc_type, _exc, _tb) -> None:
+        self.stop()
+
+
+__all__ = ['BlockGrid', 'GridBlock', 'GridStream']
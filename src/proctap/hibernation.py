@@ -0,0 +1,196 @@
+"""
+Idle-stream hibernation.
+
+Most captured applications are silent most of the time, yet an active
+capture converts, resamples and delivers every chunk. With a
+HibernationPolicy, ProcessAudioCapture hibernates a capture once its stream
+has been silent (peak below threshold_db) or muted/at zero volume (as
+reported by the audio server via AudioBackend.is_muted()) for idle_ms:
+
+- The backend releases its converter and conversion state
+  (AudioBackend.hibernate()).
+- Nothing is converted or delivered; the worker thread blocks on the
+  backend's native queue and only an ActivityDetector looks at each raw
+  chunk (one peak computation, no conversion).
+- The detector keeps the last preroll_ms of native audio, so the onset is
+  not cut off.
+
+The first chunk above the threshold wakes the capture: the backend rebuilds
+its converter and the pre-roll plus that chunk are delivered together, i.e.
+within one chunk period of the onset.
+
+The mute state is polled every state_poll_ms on a separate thread, so no
+audio server round-trip runs on the capture path. While a hibernated stream
+is muted, the backend is parked (AudioBackend.park()): its capture thread
+and recorder process stop, its native queue is released and the worker sleeps
+until the stream is reported audible, when the capture is restarted and
+probed again. Backends that cannot park keep capturing and muted chunks only
+go to the pre-roll (ActivityDetector.hold). A silent but unmuted stream is
+never parked, as detecting its onset needs the audio.
+
+Usage:
+    policy = HibernationPolicy(idle_ms=2000.0, threshold_db=-60.0)
+    tap = ProcessAudioCapture(pid, on_data=callback, hibernation=policy)
+"""
+
+from __future__ import annotations
+
+from dataclasses import dataclass
+from typing import Optional
+
+import numpy as np
+
+from .backends.base import STANDARD_CHANNELS, STANDARD_FORMAT, STANDARD_SAMPLE_RATE
+from .backends.converter import SampleFormat
+
+_SAMPLE_WIDTHS = {
+    SampleFormat.INT16: 2,
+    SampleFormat.INT24: 3,
+    SampleFormat.INT24_32: 4,
+    SampleFormat.INT32: 4,
+    SampleFormat.FLOAT32: 4,
+}
+
+
+@dataclass(frozen=True)
+class HibernationPolicy:
+    """When a capture hibernates and how it wakes up."""
+    idle_ms: float = 5000.0  # Silent/muted period before hibernating
+    threshold_db: float = -70.0  # Peak level (dBFS) that counts as activity
+    preroll_ms: float = 20.0  # Audio before the onset delivered on wake
+    use_stream_state: bool = True  # Treat server-side mute/zero volume as idle
+    state_poll_ms: float = 250.0  # Interval for querying mute/volume state
+
+    def __post_init__(self) -> None:
+        if self.idle_ms <= 0:
+            raise ValueError(f"idle_ms must be positive: {self.idle_ms}")
+        if self.threshold_db > 0:
+            raise ValueError(f"threshold_db must be <= 0 dBFS: {self.threshold_db}")
+        if self.preroll_ms < 0:
+            raise ValueError(f"preroll_ms must be >= 0: {self.preroll_ms}")
+        if self.state_poll_ms <= 0:
+            raise ValueError(f"state_poll_ms must be positive: {self.state_poll_ms}")
+
+
+class ActivityDetector:
+    """
+    Peak-level activity detector for native PCM chunks.
+
+    Works directly on the backend's native sample format, so a hibernating
+    capture never runs its converter. Non-active chunks are kept (up to
+    preroll_ms) and prepended to the first active one.
+
+    Attributes:
+        hold: While True, every chunk is treated as non-active (the stream
+              is muted), so nothing is returned and audio only goes to the
+              pre-roll
+    """
+
+    def __init__(self, threshold_db: float = -70.0, preroll_ms: float = 20.0) -> None:
+        """
+        Initialize detector.
+
+        Args:
+            threshold_db: Peak level in dBFS at or above which a chunk is active
+            preroll_ms: Audio to keep from before the onset
+        """
+        self._threshold = float(10.0 ** (threshold_db / 20.0))
+        self._preroll_ms = preroll_ms
+        self._preroll = bytearray()
+        self.hold = False
+
+    @property
+    def threshold(self) -> float:
+        """Linear peak threshold (full scale = 1.0)."""
+        return self._threshold
+
+    @property
+    def preroll_bytes(self) -> int:
+        """Bytes currently held as pre-roll."""
+        return len(self._preroll)
+
+    def peak(self, chunk: bytes, sample_format: str = STANDARD_FORMAT) -> float:
+        """
+        Get the peak level of a chunk.
+
+        Args:
+            chunk: Interleaved PCM data
+            sample_format: SampleFormat of the data
+
+        Returns:
+            Peak absolute sample value (full scale = 1.0)
+
+        Raises:
+            ValueError: If sample_format is not supported
+        """
+        if not chunk:
+            return 0.0
+        if sample_format == SampleFormat.FLOAT32:
+            samples = np.frombuffer(chunk, dtype=np.float32, count=len(chunk) // 4)
+            return float(np.abs(samples).max())
+        if sample_format == SampleFormat.INT16:
+            ints = np.frombuffer(chunk, dtype=np.int16, count=len(chunk) // 2)
+            return max(int(ints.max()), -int(ints.min())) / 32768.0
+        if sample_format in (SampleFormat.INT32, SampleFormat.INT24_32):
+            ints = np.frombuffer(chunk, dtype=np.int32, count=len(chunk) // 4)
+            return max(int(ints.max()), -int(ints.min())) / 2147483648.0
+        if sample_format == SampleFormat.INT24:
+            data = np.frombuffer(chunk, dtype=np.uint8, count=len(chunk) // 3 * 3).reshape(-1, 3)
+            ints = (data[:, 2].astype(np.int8).astype(np.int32) << 16) | (data[:, 1].astype(np.int32) << 8) | data[:, 0]
+            return max(int(ints.max()), -int(ints.min())) / 8388608.0
+        raise ValueError(f"Unsupported sample format: {sample_format}")
+
+    def is_active(self, chunk: bytes, sample_format: str = STANDARD_FORMAT) -> bool:
+        """
+        Check whether a chunk reaches the activity threshold.
+
+        Args:
+            chunk: Interleaved PCM data
+            sample_format: SampleFormat of the data
+
+        Returns:
+            True if the chunk's peak is at or above the threshold
+        """
+        return self.peak(chunk, sample_format) >= self._threshold
+
+    def feed(
+        self,
+        chunk: bytes,
+        sample_format: str = STANDARD_FORMAT,
+        channels: int = STANDARD_CHANNELS,
+        sample_rate: int = STANDARD_SAMPLE_RATE,
+    ) -> Optional[bytes]:
+        """
+        Feed one chunk while hibernating.
+
+        Args:
+            chunk: Interleaved PCM data in the given format
+            sample_format: SampleFormat of the data
+            channels: Channel count of the data
+            sample_rate: Sample rate of the data
+
+        Returns:
+            The pre-roll followed by the chunk if the chunk is active (the
+            pre-roll is then cleared), otherwise None (the chunk is kept as
+            pre-roll). Always None while hold is set.
+        """
+        if not self.hold and self.is_active(chunk, sample_format):
+            pcm = bytes(self._preroll) + chunk
+            self._preroll = bytearray()
+            return pcm
+
+        frame_bytes = channels * _SAMPLE_WIDTHS.get(sample_format, 4)
+        limit = int(self._preroll_ms * sample_rate / 1000.0) * frame_bytes
+        self._preroll += chunk
+        excess = len(self._preroll) - limit
+        if excess > 0:
+            excess += -excess % frame_bytes  # Keep whole frames
+            del self._preroll[:excess]
+        return None
+
+    def reset(self) -> None:
+        """Drop the pre-roll."""
+        self._preroll = bytearray()
+
+
+__all__ = ['ActivityDetector', 'HibernationPolicy']
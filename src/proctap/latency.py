@@ -0,0 +1,281 @@
+"""
+End-to-end latency accounting and compensation.
+
+Every stage between the target process and a consumer adds delay: backend
+chunking and device buffers, resampler lookahead/group delay, queues, and
+consumer-side buffers. Each of these now declares it:
+
+- Algorithmic latency: fixed by configuration (chunk size, filter length).
+  Backends report it via AudioBackend.get_latency_ms(), AudioConverter via
+  latency_frames, native pipeline stages in their stats.
+- Buffered latency: live depth of a queue at the time of the report.
+
+ProcessAudioCapture.latency() and NativePipeline.latency() return a
+LatencyReport with the per-stage breakdown and totals; consumers append
+their own buffers with with_stage().
+
+Parallel branches (multitrack recording, source switching) with different
+latency are aligned by delaying the faster ones (LatencyCompensator).
+
+Usage:
+    report = capture.latency().with_stage("encoder", algorithmic_ms=20.0)
+    print(report.describe())
+    assert report.total_ms < 50.0  # Latency SLA
+
+    comp = LatencyCompensator.for_captures({"game": game_cap, "voice": voice_cap})
+    aligned = comp.process("voice", block)
+"""
+
+from __future__ import annotations
+
+import logging
+from dataclasses import dataclass, field
+from typing import TYPE_CHECKING, Optional
+
+import numpy as np
+
+from .backends.base import STANDARD_CHANNELS, STANDARD_DTYPE, STANDARD_SAMPLE_RATE
+
+if TYPE_CHECKING:
+    from .core import ProcessAudioCapture
+
+logger = logging.getLogger(__name__)
+
+
+@dataclass(frozen=True)
+class LatencyStage:
+    """Latency contribution of one stage."""
+    name: str
+    algorithmic_ms: float = 0.0  # Fixed by configuration
+    buffered_ms: float = 0.0  # Live queue depth
+
+    @property
+    def total_ms(self) -> float:
+        """Algorithmic plus buffered latency."""
+        return self.algorithmic_ms + self.buffered_ms
+
+
+@dataclass(frozen=True)
+class LatencyReport:
+    """Per-stage latency breakdown of a pipeline."""
+    stages: tuple[LatencyStage, ...] = field(default_factory=tuple)
+
+    @property
+    def algorithmic_ms(self) -> float:
+        """Sum of the declared (fixed) latencies."""
+        return sum(s.algorithmic_ms for s in self.stages)
+
+    @property
+    def buffered_ms(self) -> float:
+        """Sum of the live queue depths."""
+        return sum(s.buffered_ms for s in self.stages)
+
+    @property
+    def total_ms(self) -> float:
+        """End-to-end latency right now."""
+        return self.algorithmic_ms + self.buffered_ms
+
+    def stage(self, name: str) -> Optional[LatencyStage]:
+        """Get a stage by name (None if not present)."""
+        return next((s for s in self.stages if s.name == name), None)
+
+    def with_stage(self, name: str, algorithmic_ms: float = 0.0, buffered_ms: float = 0.0) -> "LatencyReport":
+        """
+        Append a stage (e.g. a consumer buffer).
+
+        Returns:
+            New report including the stage
+        """
+        return LatencyReport(self.stages + (LatencyStage(name, algorithmic_ms, buffered_ms),))
+
+    def as_dict(self) -> dict[str, object]:
+        """Report as a plain dictionary (for logging/metrics)."""
+        return {
+            'total_ms': self.total_ms,
+            'algorithmic_ms': self.algorithmic_ms,
+            'buffered_ms': self.buffered_ms,
+            'stages': [
+                {'name': s.name, 'algorithmic_ms': s.algorithmic_ms, 'buffered_ms': s.buffered_ms}
+                for s in self.stages
+            ],
+        }
+
+    def describe(self) -> str:
+        """Human-readable table."""
+        lines = [f"{'stage':<20} {'fixed ms':>9} {'queued ms':>10}"]
+        for s in self.stages:
+            lines.append(f"{s.name:<20} {s.algorithmic_ms:>9.2f} {s.buffered_ms:>10.2f}")
+        lines.append(f"{'total':<20} {self.algorithmic_ms:>9.2f} {self.buffered_ms:>10.2f}  = {self.total_ms:.2f} ms")
+        return "\n".join(lines)
+
+
+def frames_to_ms(frames: float, sample_rate: int) -> float:
+    """Convert a frame count to milliseconds."""
+    return 1000.0 * frames / sample_rate
+
+
+def impulse_delay(signal: np.ndarray, threshold: float = 0.5) -> Optional[float]:
+    """
+    Find the position of the first impulse in a signal.
+
+    The position is refined to sub-sample precision with a parabolic fit
+    around the peak, so resampled impulses are located accurately.
+
+    Args:
+        signal: Shape (frames,) or (frames, channels); channels are averaged
+        threshold: Fraction of the global peak that marks the first impulse
+
+    Returns:
+        Frame position of the first impulse, or None if the signal is silent
+    """
+    x = np.abs(signal.mean(axis=1) if signal.ndim == 2 else signal).astype(np.float64)
+    if len(x) == 0 or x.max() <= 0:
+        return None
+    above = np.flatnonzero(x >= threshold * x.max())
+    # Peak of the first cluster above threshold
+    start = int(above[0])
+    end = start
+    while end + 1 < len(x) and x[end + 1] >= threshold * x.max():
+        end += 1
+    peak = start + int(np.argmax(x[start:end + 1]))
+    if 0 < peak < len(x) - 1:
+        a, b, c = x[peak - 1], x[peak], x[peak + 1]
+        denom = a - 2 * b + c
+        if denom != 0:
+            return float(peak + 0.5 * (a - c) / denom)
+    return float(peak)
+
+
+class DelayLine:
+    """
+    Fixed delay applied block by block.
+
+    Used to bring branches with lower pipeline latency in line with the
+    slowest one.
+    """
+
+    def __init__(self, delay_frames: int, channels: int) -> None:
+        """
+        Initialize delay line.
+
+        Args:
+            delay_frames: Delay in frames (0 = pass-through)
+            channels: Channel count
+        """
+        self.delay_frames = max(0, delay_frames)
+        self._buffer = np.zeros((self.delay_frames, channels), dtype=STANDARD_DTYPE)
+
+    def process(self, block: np.ndarray) -> np.ndarray:
+        """
+        Delay a block.
+
+        Args:
+            block: Input of shape (frames, channels)
+
+        Returns:
+            Delayed block of the same shape
+        """
+        if self.delay_frames == 0:
+            return block
+        joined = np.concatenate((self._buffer, block))
+        self._buffer = joined[-self.delay_frames:].copy()
+        return joined[:block.shape[0]]
+
+
+class LatencyCompensator:
+    """
+    Aligns parallel branches by delaying all but the slowest.
+
+    Each branch declares its latency; process() delays its blocks by
+    (max latency - branch latency), so audio that happened at the same time
+    comes out at the same position in every branch.
+    """
+
+    def __init__(
+        self,
+        latencies_ms: dict[str, float],
+        sample_rate: int = STANDARD_SAMPLE_RATE,
+        channels: int = STANDARD_CHANNELS,
+    ) -> None:
+        """
+        Initialize compensator.
+
+        Args:
+            latencies_ms: Latency of each branch by name
+            sample_rate: Sample rate of the branches
+            channels: Channel count of the branches
+        """
+        self.sample_rate = sample_rate
+        self.channels = channels
+        self._latency_frames = {
+            name: int(round(ms * sample_rate / 1000)) for name, ms in latencies_ms.items()
+        }
+        target = max(self._latency_frames.values(), default=0)
+        self._delays = {
+            name: DelayLine(target - frames, channels) for name, frames in self._latency_frames.items()
+        }
+        logger.debug(f"Latency compensation (frames): {self.delays}")
+
+    @classmethod
+    def for_captures(
+        cls,
+        captures: dict[str, "ProcessAudioCapture"],
+        include_buffered: bool = False,
+    ) -> "LatencyCompensator":
+        """
+        Build a compensator from the captures' latency reports.
+
+        Args:
+            captures: Capture of each branch by name
+            include_buffered: Also compensate the current queue depth
+                              (a snapshot; normally only fixed latency is used)
+
+        Returns:
+            LatencyCompensator in the standard format
+        """
+        latencies = {}
+        for name, capture in captures.items():
+            report = capture.latency()
+            latencies[name] = report.total_ms if include_buffered else report.algorithmic_ms
+        return cls(latencies)
+
+    @property
+    def delays(self) -> dict[str, int]:
+        """Delay applied to each branch in frames."""
+        return {name: line.delay_frames for name, line in self._delays.items()}
+
+    @property
+    def latency_ms(self) -> float:
+        """Common latency of all branches after compensation."""
+        return frames_to_ms(max(self._latency_frames.values(), default=0), self.sample_rate)
+
+    def process(self, name: str, block: np.ndarray) -> np.ndarray:
+        """
+        Delay a block of one branch.
+
+        Args:
+            name: Branch name
+            block: Shape (frames, channels)
+
+        Returns:
+            Aligned block of the same shape
+
+        Raises:
+            KeyError: If the branch is unknown
+        """
+        return self._delays[name].process(block)
+
+    def process_bytes(self, name: str, pcm: bytes) -> bytes:
+        """Delay interleaved float32 PCM of one branch."""
+        block = np.frombuffer(pcm, dtype=STANDARD_DTYPE).reshape(-1, self.channels)
+        return self.process(name, block).tobytes()
+
+
+__all__ = [
+    'DelayLine',
+    'LatencyCompensator',
+    'LatencyReport',
+    'LatencyStage',
+    'frames_to_ms',
+    'impulse_delay',
+]
@@ -0,0 +1,574 @@
+"""
+Python-free native audio pipelines.
+
+ProcessAudioCapture delivers every chunk to Python, so each 10ms of audio
+costs interpreter work (and the GIL) for conversion, filtering and writing.
+A NativePipeline is configured once from Python with a declarative spec and
+then runs entirely in the native core (proctap._pipeline):
+
+    source -> stages (conversion, filters, meters) -> sinks
+
+The native thread never takes the GIL. Python only receives control events
+(started / meter / error / finished / stopped) and statistics, at whatever
+rate it polls for them.
+
+Usage:
+    spec = PipelineSpec(
+        source=SyntheticSource(signal="sine", rate=44100, channels=1, duration=5.0),
+        stages=[Resample(48000), Channels(2), HighPass(120.0), Meter(interval_ms=100)],
+        sinks=[WavSink("out.wav")],
+    )
+    with NativePipeline(spec, on_event=print) as pipeline:
+        pipeline.wait()
+    print(pipeline.stats())
+
+On Linux, pipewire_source() feeds the pipeline from pw-record, so a process
+can be recorded to disk without any per-chunk Python work.
+
+Stages are reordered and fused by proctap.planner before the pipeline is
+built (optimize=True), so the list can be written in the natural order.
+Only exact rewrites are made by default; approximate=True also lets filters
+move across resamplers, which changes the output slightly.
+"""
+
+from __future__ import annotations
+
+import logging
+import sys
+import threading
+from dataclasses import dataclass, field, fields
+from typing import TYPE_CHECKING, Any, Callable, ClassVar, Literal, Optional, Union
+
+from .latency import LatencyReport, LatencyStage
+
+if TYPE_CHECKING:
+    from .planner import Plan
+
+logger = logging.getLogger(__name__)
+
+try:
+    from . import _pipeline
+except ImportError:  # Extension not built (pure-Python install)
+    _pipeline = None  # type: ignore[assignment]
+
+SignalType = Literal['sine', 'noise', 'silence', 'impulse']
+PcmFormat = Literal['s16', 'f32']
+EventCallback = Callable[[dict[str, Any]], None]
+
+_PCM_FORMATS = ('s16', 'f32')
+_FINAL_EVENTS = ('finished', 'stopped', 'error')
+
+
+def is_available() -> bool:
+    """
+    Check whether the native pipeline extension is available.
+
+    Returns:
+        True if proctap._pipeline was built and can be imported
+    """
+    return _pipeline is not None
+
+
+@dataclass(frozen=True)
+class _Node:
+    """Base class for spec nodes; fields map 1:1 to native spec keys."""
+
+    kind: ClassVar[str] = ""
+
+    def validate(self) -> None:
+        """
+        Check parameters.
+
+        Raises:
+            ValueError: If a parameter is out of range
+        """
+
+    def to_dict(self) -> dict[str, Any]:
+        """Convert to the dict understood by the native core."""
+        spec: dict[str, Any] = {'type': self.kind}
+        for f in fields(self):
+            value = getattr(self, f.name)
+            if value is not None:
+                spec[f.name] = list(value) if isinstance(value, tuple) else value
+        return spec
+
+
+def _require_positive(name: str, value: float) -> None:
+    if value <= 0:
+        raise ValueError(f"{name} must be positive, got {value}")
+
+
+def _require_format(value: str) -> None:
+    if value not in _PCM_FORMATS:
+        raise ValueError(f"Unsupported PCM format: {value} (use 's16' or 'f32')")
+
+
+# Sources -------------------------------------------------------------------
+
+@dataclass(frozen=True)
+class SyntheticSource(_Node):
+    """Generated test signal (same signals as backends.SyntheticBackend)."""
+
+    kind: ClassVar[str] = 'synthetic'
+
+    signal: SignalType = 'sine'
+    frequency: float = 440.0
+    amplitude: float = 0.5
+    rate: int = 48000
+    channels: int = 2
+    chunk_frames: Optional[int] = None  # Default: 10ms
+    realtime: bool = False
+    duration: Optional[float] = None  # Seconds, None = unlimited
+    impulse_interval: float = 1.0
+    seed: int = 0
+
+    def validate(self) -> None:
+        if self.signal not in ('sine', 'noise', 'silence', 'impulse'):
+            raise ValueError(f"Unknown signal: {self.signal}")
+        _require_positive('rate', self.rate)
+        _require_positive('channels', self.channels)
+        if self.chunk_frames is not None:
+            _require_positive('chunk_frames', self.chunk_frames)
+
+
+@dataclass(frozen=True)
+class WavFileSource(_Node):
+    """PCM (16/24/32-bit) or float32 WAV file."""
+
+    kind: ClassVar[str] = 'wav'
+
+    path: str
+    chunk_frames: int = 480
+
+    def validate(self) -> None:
+        _require_positive('chunk_frames', self.chunk_frames)
+
+
+@dataclass(frozen=True)
+class CommandSource(_Node):
+    """
+    Raw interleaved PCM read from a child process' stdout (POSIX only).
+
+    The process is started by start() and terminated by stop().
+    """
+
+    kind: ClassVar[str] = 'command'
+
+    argv: tuple[str, ...]
+    rate: int = 48000
+    channels: int = 2
+    format: PcmFormat = 's16'
+    chunk_frames: Optional[int] = None  # Default: 10ms
+
+    def validate(self) -> None:
+        if sys.platform == 'win32':
+            raise ValueError("CommandSource is not supported on Windows")
+        if not self.argv:
+            raise ValueError("argv must not be empty")
+        _require_positive('rate', self.rate)
+        _require_positive('channels', self.channels)
+        _require_format(self.format)
+
+
+def pipewire_source(
+    pid: Optional[int] = None,
+    target: Optional[Union[int, str]] = None,
+    rate: int = 48000,
+    channels: int = 2,
+) -> CommandSource:
+    """
+    Create a source recording a PipeWire node with pw-record.
+
+    Args:
+        pid: Record the (first) playback stream of this process
+        target: PipeWire node ID or name to record (alternative to pid)
+        rate: Sample rate to record at
+        channels: Channel count to record
+
+    Returns:
+        CommandSource running pw-record
+
+    Raises:
+        ValueError: If neither pid nor target is given
+        RuntimeError: If the process has no PipeWire playback stream
+    """
+    if target is None:
+        if pid is None:
+            raise ValueError("Either pid or target is required")
+        from .backends.pipewire_links import dump_graph, find_nodes_by_pid
+
+        nodes = find_nodes_by_pid(dump_graph(), pid)
+        if not nodes:
+            raise RuntimeError(f"No PipeWire playback stream found for PID {pid}")
+        target = nodes[0]
+
+    argv = (
+        'pw-record',
+        '--target', str(target),
+        '--rate', str(rate),
+        '--channels', str(channels),
+        '--format', 's16',
+        '-',
+    )
+    return CommandSource(argv=argv, rate=rate, channels=channels, format='s16')
+
+
+# Stages --------------------------------------------------------------------
+
+@dataclass(frozen=True)
+class Channels(_Node):
+    """Channel conversion with AudioConverter's up/downmix rules."""
+
+    kind: ClassVar[str] = 'channels'
+
+    channels: int
+    name: Optional[str] = None
+
+    def validate(self) -> None:
+        _require_positive('channels', self.channels)
+
+
+@dataclass(frozen=True)
+class Resample(_Node):
+    """Windowed-sinc resampler (arbitrary ratio)."""
+
+    kind: ClassVar[str] = 'resample'
+
+    rate: int
+    name: Optional[str] = None
+
+    def validate(self) -> None:
+        _require_positive('rate', self.rate)
+
+
+@dataclass(frozen=True)
+class Gain(_Node):
+    """Constant gain in dB."""
+
+    kind: ClassVar[str] = 'gain'
+
+    db: float
+    name: Optional[str] = None
+
+
+@dataclass(frozen=True)
+class HighPass(_Node):
+    """First-order high-pass (same response as contrib.filters.HighPassFilter)."""
+
+    kind: ClassVar[str] = 'highpass'
+
+    cutoff_hz: float = 120.0
+    name: Optional[str] = None
+
+    def validate(self) -> None:
+        _require_positive('cutoff_hz', self.cutoff_hz)
+
+
+@dataclass(frozen=True)
+class LowPass(_Node):
+    """First-order low-pass (same response as contrib.filters.LowPassFilter)."""
+
+    kind: ClassVar[str] = 'lowpass'
+
+    cutoff_hz: float = 8000.0
+    name: Optional[str] = None
+
+    def validate(self) -> None:
+        _require_positive('cutoff_hz', self.cutoff_hz)
+
+
+@dataclass(frozen=True)
+class Meter(_Node):
+    """
+    Level meter.
+
+    Emits a "meter" event with per-channel 'rms_db' and 'peak_db' lists every
+    interval_ms of audio.
+    """
+
+    kind: ClassVar[str] = 'meter'
+
+    interval_ms: float = 100.0
+    name: Optional[str] = None
+
+    def validate(self) -> None:
+        _require_positive('interval_ms', self.interval_ms)
+
+
+# Sinks ---------------------------------------------------------------------
+
+@dataclass(frozen=True)
+class WavSink(_Node):
+    """WAV file (header is finalized when the pipeline ends)."""
+
+    kind: ClassVar[str] = 'wav'
+
+    path: str
+    format: PcmFormat = 's16'
+    name: Optional[str] = None
+
+    def validate(self) -> None:
+        _require_format(self.format)
+
+
+@dataclass(frozen=True)
+class RawSink(_Node):
+    """Headerless interleaved PCM file."""
+
+    kind: ClassVar[str] = 'raw'
+
+    path: str
+    format: PcmFormat = 'f32'
+    name: Optional[str] = None
+
+    def validate(self) -> None:
+        _require_format(self.format)
+
+
+@dataclass(frozen=True)
+class NullSink(_Node):
+    """Discards audio (for benchmarks and meter-only pipelines)."""
+
+    kind: ClassVar[str] = 'null'
+
+    name: Optional[str] = None
+
+
+SourceSpec = Union[SyntheticSource, WavFileSource, CommandSource]
+StageSpec = Union[Channels, Resample, Gain, HighPass, LowPass, Meter]
+SinkSpec = Union[WavSink, RawSink, NullSink]
+
+
+@dataclass
+class PipelineSpec:
+    """Declarative description of a native pipeline."""
+
+    source: SourceSpec
+    stages: list[StageSpec] = field(default_factory=list)
+    sinks: list[SinkSpec] = field(default_factory=list)
+    event_queue: int = 1024  # Max buffered control events (oldest are dropped)
+
+    def validate(self) -> None:
+        """
+        Check the spec before handing it to the native core.
+
+        Raises:
+            ValueError: If the spec is invalid
+        """
+        if not self.sinks:
+            raise ValueError("Pipeline needs at least one sink")
+        names: set[str] = set()
+        for node in [self.source, *self.stages, *self.sinks]:
+            node.validate()
+            name = getattr(node, 'name', None)
+            if name is not None:
+                if name in names:
+                    raise ValueError(f"Duplicate node name: {name}")
+                names.add(name)
+
+    def to_dict(self) -> dict[str, Any]:
+        """
+        Convert to the dict understood by the native core.
+
+        Raises:
+            ValueError: If the spec is invalid
+        """
+        self.validate()
+        return {
+            'source': self.source.to_dict(),
+            'stages': [stage.to_dict() for stage in self.stages],
+            'sinks': [sink.to_dict() for sink in self.sinks],
+            'event_queue': self.event_queue,
+        }
+
+
+class NativePipeline:
+    """
+    Runs a PipelineSpec in the native core.
+
+    Events can be consumed either by polling (poll_events()) or by passing
+    on_event, in which case a small Python thread dispatches them. Either
+    way Python only sees control-rate events, never audio.
+    """
+
+    def __init__(
+        self,
+        spec: PipelineSpec,
+        on_event: Optional[EventCallback] = None,
+        optimize: bool = True,
+        approximate: bool = False,
+    ) -> None:
+        """
+        Build the native pipeline.
+
+        Args:
+            spec: Pipeline description
+            on_event: Optional callback receiving event dicts
+            optimize: Reorder/fuse stages into a cheaper equivalent plan
+                      (see proctap.planner); False runs stages as written
+            approximate: Also allow planner rewrites that are not exact
+                         (filters moved across resamplers); the rewritten
+                         plan is logged at info level
+
+        Raises:
+            RuntimeError: If the native extension is not available
+            ValueError: If the spec is invalid
+        """
+        if _pipeline is None:
+            raise RuntimeError(
+                "Native pipeline extension (_pipeline) is not available. "
+                "Reinstall proc-tap with a C++17 compiler available."
+            )
+        self._spec = spec
+        self._plan: Optional[Plan] = None
+        if optimize:
+            from .planner import optimize as plan_spec
+
+            self._plan = plan_spec(spec, approximate=approximate)
+            if approximate and self._plan.changed:
+                logger.info(f"Pipeline rewritten with approximate reordering:\n{self._plan.describe()}")
+            spec = self._plan.apply(spec)
+        self._native = _pipeline.Pipeline(spec.to_dict())
+        self._on_event = on_event
+        self._event_thread: Optional[threading.Thread] = None
+        self._closing = threading.Event()
+
+    @property
+    def spec(self) -> PipelineSpec:
+        """The spec this pipeline was built from (as written)."""
+        return self._spec
+
+    @property
+    def plan(self) -> Optional[Plan]:
+        """The planner result, or None if built with optimize=False."""
+        return self._plan
+
+    def get_format(self) -> dict[str, int]:
+        """
+        Get source and output format.
+
+        Returns:
+            Dictionary with 'source_rate', 'source_channels', 'sample_rate'
+            and 'channels' (the latter two describe what sinks receive)
+        """
+        return dict(self._native.get_format())
+
+    def start(self) -> None:
+        """
+        Open source and sinks and start the native thread.
+
+        Raises:
+            RuntimeError: If the source or a sink cannot be opened, or the
+                          pipeline was already started
+        """
+        self._native.start()
+        logger.debug(f"Native pipeline started: {self.get_format()}")
+        if self._on_event is not None:
+            self._event_thread = threading.Thread(
+                target=self._dispatch_events, name="proctap-pipeline-events", daemon=True
+            )
+            self._event_thread.start()
+
+    def stop(self) -> None:
+        """Stop the pipeline and finalize sinks. Safe to call multiple times."""
+        self._native.stop()
+        self._closing.set()
+        if self._event_thread is not None:
+            self._event_thread.join(timeout=2.0)
+            self._event_thread = None
+
+    def wait(self, timeout: Optional[float] = None) -> bool:
+        """
+        Wait for the source to end (or the pipeline to fail).
+
+        Args:
+            timeout: Maximum time to wait in seconds (None = forever)
+
+        Returns:
+            True if the pipeline is no longer running
+        """
+        return bool(self._native.wait(-1.0 if timeout is None else timeout))
+
+    def poll_events(self, timeout: float = 0.0) -> list[dict[str, Any]]:
+        """
+        Get pending control events.
+
+        Do not mix with on_event: events are delivered only once.
+
+        Args:
+            timeout: Time to wait for the first event in seconds
+
+        Returns:
+            List of event dicts with 'type', 'time' (seconds since start),
+            'frame' (source position) and type-specific keys
+        """
+        return list(self._native.poll_events(timeout))
+
+    def stats(self) -> dict[str, Any]:
+        """
+        Get pipeline statistics.
+
+        Returns:
+            Dictionary with 'state', frame/block counters, 'elapsed',
+            per-stage processing time and latency ('stages'), per-sink
+            counters ('sinks') and the total declared latency
+            ('latency_ms'); 'error' is present if the pipeline failed
+        """
+        return dict(self._native.stats())
+
+    def latency(self) -> LatencyReport:
+        """
+        Get the latency breakdown of the pipeline.
+
+        The native pipeline processes each block synchronously, so all
+        latency is algorithmic: source chunking plus stage lookahead.
+
+        Returns:
+            LatencyReport with the source and one entry per stage
+        """
+        stats = self._native.stats()
+        stages = [LatencyStage('source', stats['source_latency_ms'])]
+        stages += [LatencyStage(s['name'], s['latency_ms']) for s in stats['stages']]
+        return LatencyReport(tuple(stages))
+
+    def _dispatch_events(self) -> None:
+        """Deliver events to on_event until the pipeline ends."""
+        assert self._on_event is not None
+        while True:
+            events = self._native.poll_events(0.1)
+            for event in events:
+                try:
+                    self._on_event(event)
+                except Exception:
+                    logger.exception("Error in pipeline event callback")
+            if any(e['type'] in _FINAL_EVENTS for e in events):
+                break
+            if not events and self._closing.is_set():
+                break
+
+    def __enter__(self) -> "NativePipeline":
+        self.start()
+        return self
+
+    def __exit__(self, exc_type: Any, exc: Any, tb: Any) -> None:
+        self.stop()
+
+
+__all__ = [
+    'PipelineSpec',
+    'NativePipeline',
+    'is_available',
+    'SyntheticSource',
+    'WavFileSource',
+    'CommandSource',
+    'pipewire_source',
+    'Channels',
+    'Resample',
+    'Gain',
+    'HighPass',
+    'LowPass',
+    'Meter',
+    'WavSink',
+    'RawSink',
+    'NullSink',
+]
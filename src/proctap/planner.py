@@ -0,0 +1,571 @@
+"""
+Cost-based planner for native pipeline stages.
+
+Stage lists are usually written in "natural" order: convert to the standard
+48kHz stereo format, filter, then convert again for the consumer. A 16kHz
+mono transcription consumer fed from a 44.1kHz stereo source therefore pays
+for stereo 48kHz filtering and two resamplers:
+
+    Channels(2) -> Resample(48000) -> HighPass -> Channels(1) -> Resample(16000)
+
+The planner knows which stages commute and what each costs per sample, and
+rewrites the list into an equivalent, cheaper one:
+
+    Channels(1) -> Resample(48000) -> HighPass -> Resample(16000)
+
+or, with approximate=True, also runs the filter at the consumer rate:
+
+    Channels(1) -> Resample(16000) -> HighPass
+
+Rewrites:
+- Reordering of adjacent stages that commute. Channel mapping and gain are
+  linear and identical per channel, so they commute exactly with each other
+  and with resampling and filtering. Moving a filter across a resampler
+  changes the rate it runs at, so the output is no longer what the stages
+  as written produce. This is opt-in (approximate=True) and then only done
+  when the cutoff is far below both Nyquist frequencies, where the
+  first-order response is effectively unchanged.
+- Fusion of adjacent stages: gains add up, channel maps that compose to a
+  direct map merge, and back-to-back resamplers merge when the intermediate
+  rate does not band-limit more than the direct conversion would.
+- Removal of no-ops (0dB gain, same-rate resample, same-count channel map).
+
+Meters are barriers: nothing moves across them, so levels are measured at
+the same point (and format) as written.
+
+Usage:
+    plan = optimize(spec, compare=True)
+    print(plan.describe())
+    pipeline = NativePipeline(plan.apply(spec), optimize=False)
+"""
+
+from __future__ import annotations
+
+import logging
+import math
+import os
+import tempfile
+import wave
+from dataclasses import dataclass, field, replace
+from typing import Callable, Optional, Sequence
+
+import numpy as np
+
+from .pipeline import (
+    Channels,
+    Gain,
+    HighPass,
+    LowPass,
+    Meter,
+    PipelineSpec,
+    RawSink,
+    Resample,
+    StageSpec,
+    SyntheticSource,
+    WavFileSource,
+)
+
+logger = logging.getLogger(__name__)
+
+# Estimated CPU cost in ns per sample (per channel) of the native stages,
+# measured on x86-64 at -O2. The resampler is charged per sample at the
+# higher of its input and output rate (its kernel widens when decimating).
+DEFAULT_COSTS: dict[str, float] = {
+    'gain': 1.0,
+    'highpass': 3.5,
+    'lowpass': 3.5,
+    'channels': 1.0,  # Charged for input + output channels
+    'meter': 3.0,
+    'resample': 140.0,
+}
+
+# Search limit per segment (segments are split at meters); 7 stages = 5040 orders
+MAX_SEARCH_ORDERS = 5040
+
+# Filters may cross a resampler if cutoff <= this fraction of the lower rate
+APPROXIMATE_CUTOFF_RATIO = 0.1
+
+_FILTERS = (HighPass, LowPass)
+
+
+@dataclass
+class Plan:
+    """Result of planning a stage list."""
+
+    stages: list[StageSpec]
+    naive_stages: list[StageSpec]
+    cost: float  # Estimated ns of CPU per second of audio
+    naive_cost: float
+    steps: list[str] = field(default_factory=list)  # Applied rewrites
+    comparison: Optional[dict[str, float]] = None  # Filled by compare_plan()
+
+    @property
+    def savings(self) -> float:
+        """Estimated fraction of stage CPU saved (0.0 - 1.0)."""
+        if self.naive_cost <= 0:
+            return 0.0
+        return 1.0 - self.cost / self.naive_cost
+
+    @property
+    def changed(self) -> bool:
+        """True if the plan differs from the naive order."""
+        return self.stages != self.naive_stages
+
+    def apply(self, spec: PipelineSpec) -> PipelineSpec:
+        """
+        Get a copy of spec with the planned stages.
+
+        Args:
+            spec: Spec the plan was made for
+
+        Returns:
+            New PipelineSpec (source and sinks unchanged)
+        """
+        return replace(spec, stages=list(self.stages))
+
+    def describe(self) -> str:
+        """Human-readable summary of the plan."""
+        lines = [
+            f"naive:   {_format_stages(self.naive_stages)}  ({self.naive_cost / 1e6:.2f} ms CPU per s)",
+            f"planned: {_format_stages(self.stages)}  ({self.cost / 1e6:.2f} ms CPU per s, "
+            f"-{self.savings * 100:.0f}%)",
+        ]
+        lines.extend(f"  - {step}" for step in self.steps)
+        if self.comparison is not None:
+            lines.append(
+                f"compared: max_abs_error={self.comparison['max_abs_error']:.2e} "
+                f"snr_db={self.comparison['snr_db']:.1f}"
+            )
+        return "\n".join(lines)
+
+
+def _format_stages(stages: Sequence[StageSpec]) -> str:
+    if not stages:
+        return "(empty)"
+    return " -> ".join(_label(stage) for stage in stages)
+
+
+def _label(stage: StageSpec) -> str:
+    if isinstance(stage, Channels):
+        return f"Channels({stage.channels})"
+    if isinstance(stage, Resample):
+        return f"Resample({stage.rate})"
+    if isinstance(stage, Gain):
+        return f"Gain({stage.db:g}dB)"
+    if isinstance(stage, _FILTERS):
+        return f"{type(stage).__name__}({stage.cutoff_hz:g}Hz)"
+    return type(stage).__name__
+
+
+def channel_matrix(src: int, dst: int) -> np.ndarray:
+    """
+    Mixing matrix of a channel map (same rules as AudioConverter).
+
+    Args:
+        src: Input channel count
+        dst: Output channel count
+
+    Returns:
+        Matrix of shape (dst, src) so that out = matrix @ in
+    """
+    m = np.zeros((dst, src))
+    if src == dst:
+        return np.eye(src)
+    if dst == 1:
+        m[0, :] = 1.0 / src
+    elif dst < src:
+        for c in range(dst - 1):
+            m[c, c] = 1.0
+        m[dst - 1, dst - 1:] = 1.0 / (src - dst + 1)
+    else:
+        for c in range(src):
+            m[c, c] = 1.0
+        m[src:, src - 1] = 1.0
+    return m
+
+
+def _output_format(stage: StageSpec, rate: int, channels: int) -> tuple[int, int]:
+    if isinstance(stage, Resample):
+        return stage.rate, channels
+    if isinstance(stage, Channels):
+        return rate, stage.channels
+    return rate, channels
+
+
+def estimate_cost(
+    stages: Sequence[StageSpec],
+    rate: int,
+    channels: int,
+    costs: Optional[dict[str, float]] = None,
+) -> float:
+    """
+    Estimate the CPU cost of a stage list.
+
+    Args:
+        stages: Stage list
+        rate: Input sample rate
+        channels: Input channel count
+        costs: Per-sample costs by stage kind (default: DEFAULT_COSTS)
+
+    Returns:
+        Estimated ns of CPU per second of audio
+    """
+    table = {**DEFAULT_COSTS, **(costs or {})}
+    total = 0.0
+    for stage in stages:
+        out_rate, out_channels = _output_format(stage, rate, channels)
+        unit = table.get(stage.kind, 0.0)
+        if isinstance(stage, Resample):
+            total += unit * max(rate, out_rate) * channels
+        elif isinstance(stage, Channels):
+            total += unit * rate * (channels + out_channels)
+        else:
+            total += unit * rate * channels
+        rate, channels = out_rate, out_channels
+    return total
+
+
+def _commutes(a: StageSpec, b: StageSpec, rate: int, approximate: bool) -> bool:
+    """Whether adjacent stages a -> b (a seeing `rate`) can be swapped."""
+    if isinstance(a, Meter) or isinstance(b, Meter):
+        return False
+    if isinstance(a, Gain) or isinstance(b, Gain):
+        return True
+    kinds = {type(a), type(b)}
+    if Channels in kinds:
+        return len(kinds) == 2  # Not with another channel map (fusion handles that)
+    if kinds <= set(_FILTERS):
+        return True  # Both LTI
+    if Resample in kinds and len(kinds) == 2:
+        if not approximate:
+            return False
+        resample = a if isinstance(a, Resample) else b
+        filt = b if resample is a else a
+        assert isinstance(resample, Resample) and isinstance(filt, _FILTERS)
+        # The filter runs at one side of the resampler before and the other after
+        low = min(rate, resample.rate)
+        return filt.cutoff_hz <= APPROXIMATE_CUTOFF_RATIO * low
+    return False
+
+
+def _fuse(
+    stages: list[StageSpec],
+    rate: int,
+    channels: int,
+    steps: Optional[list[str]] = None,
+) -> list[StageSpec]:
+    """Merge adjacent stages and drop no-ops until nothing changes."""
+    def note(message: str) -> None:
+        if steps is not None:
+            steps.append(message)
+
+    changed = True
+    while changed:
+        changed = False
+        out: list[StageSpec] = []
+        r, ch = rate, channels
+        formats: list[tuple[int, int]] = []  # Input format of each stage in out
+        for stage in stages:
+            if isinstance(stage, Gain) and stage.db == 0.0:
+                note("drop 0dB gain")
+                changed = True
+                continue
+            if isinstance(stage, Resample) and stage.rate == r:
+                note(f"drop no-op Resample({stage.rate})")
+                changed = True
+                continue
+            if isinstance(stage, Channels) and stage.channels == ch:
+                note(f"drop no-op Channels({stage.channels})")
+                changed = True
+                continue
+
+            prev = out[-1] if out else None
+            if isinstance(stage, Gain) and isinstance(prev, Gain):
+                out[-1] = replace(prev, db=prev.db + stage.db)
+                note(f"fuse gains into {prev.db + stage.db:g}dB")
+                changed = True
+                continue
+            if isinstance(stage, Channels) and isinstance(prev, Channels):
+                src = formats[-1][1]
+                direct = channel_matrix(src, stage.channels)
+                composed = channel_matrix(prev.channels, stage.channels) @ channel_matrix(src, prev.channels)
+                if np.allclose(direct, composed):
+                    out[-1] = replace(prev, channels=stage.channels)
+                    ch = stage.channels
+                    note(f"fuse channel maps {src}->{prev.channels}->{stage.channels}")
+                    changed = True
+                    continue
+            if isinstance(stage, Resample) and isinstance(prev, Resample):
+                src_rate = formats[-1][0]
+                # The intermediate rate must not have band-limited the signal further
+                if prev.rate >= min(src_rate, stage.rate):
+                    out[-1] = replace(prev, rate=stage.rate)
+                    r = stage.rate
+                    note(f"fuse resamplers {src_rate}->{prev.rate}->{stage.rate}")
+                    changed = True
+                    continue
+
+            out.append(stage)
+            formats.append((r, ch))
+            r, ch = _output_format(stage, r, ch)
+        stages = out
+    return stages
+
+
+def _segments(stages: Sequence[StageSpec]) -> list[list[StageSpec]]:
+    """Split at meters; each meter is its own segment."""
+    segments: list[list[StageSpec]] = [[]]
+    for stage in stages:
+        if isinstance(stage, Meter):
+            segments.append([stage])
+            segments.append([])
+        else:
+            segments[-1].append(stage)
+    return [s for s in segments if s]
+
+
+def _best_order(
+    stages: list[StageSpec],
+    rate: int,
+    approximate: bool,
+    cost_of: Callable[[list[StageSpec]], float],
+) -> list[StageSpec]:
+    """Cheapest order reachable from `stages` through commuting adjacent swaps."""
+    def rates(order: tuple[int, ...]) -> list[int]:
+        r = rate
+        result = []
+        for i in order:
+            result.append(r)
+            r = _output_format(stages[i], r, 1)[0]
+        return result
+
+    start = tuple(range(len(stages)))
+    best, best_cost = start, cost_of(stages)
+    seen = {start}
+    frontier = [start]
+    while frontier and len(seen) < MAX_SEARCH_ORDERS:
+        next_frontier = []
+        for order in frontier:
+            rate_before = rates(order)
+            for k in range(len(order) - 1):
+                a, b = stages[order[k]], stages[order[k + 1]]
+                if not _commutes(a, b, rate_before[k], approximate):
+                    continue
+                swapped = order[:k] + (order[k + 1], order[k]) + order[k + 2:]
+                if swapped in seen:
+                    continue
+                seen.add(swapped)
+                next_frontier.append(swapped)
+                cost = cost_of([stages[i] for i in swapped])
+                if cost < best_cost - 1e-6:
+                    best, best_cost = swapped, cost
+        frontier = next_frontier
+    return [stages[i] for i in best]
+
+
+def plan_stages(
+    stages: Sequence[StageSpec],
+    source_rate: int,
+    source_channels: int,
+    costs: Optional[dict[str, float]] = None,
+    approximate: bool = False,
+) -> Plan:
+    """
+    Find a cheaper equivalent order for a stage list.
+
+    Args:
+        stages: Stage list in naive order
+        source_rate: Sample rate entering the first stage
+        source_channels: Channel count entering the first stage
+        costs: Per-sample cost overrides by stage kind
+        approximate: Allow filters to move across resamplers when their
+                     cutoff is far below Nyquist (not bit-exact)
+
+    Returns:
+        Plan with the chosen stages and estimated costs
+    """
+    naive = list(stages)
+    naive_cost = estimate_cost(naive, source_rate, source_channels, costs)
+
+    planned: list[StageSpec] = []
+    rate, channels = source_rate, source_channels
+    for segment in _segments(naive):
+        def cost_of(order: list[StageSpec], r: int = rate, ch: int = channels) -> float:
+            return estimate_cost(_fuse(order, r, ch), r, ch, costs)
+
+        best = _best_order(segment, rate, approximate, cost_of)
+        for stage in best:
+            rate, channels = _output_format(stage, rate, channels)
+        planned.extend(best)
+
+    steps: list[str] = []
+    if [id(s) for s in planned] != [id(s) for s in naive]:
+        steps.append(f"reorder to {_format_stages(planned)}")
+    planned = _fuse(planned, source_rate, source_channels, steps)
+    cost = estimate_cost(planned, source_rate, source_channels, costs)
+
+    if cost >= naive_cost:
+        # Nothing to gain: keep the stages exactly as written
+        return Plan(stages=naive, naive_stages=naive, cost=naive_cost, naive_cost=naive_cost)
+    return Plan(stages=planned, naive_stages=naive, cost=cost, naive_cost=naive_cost, steps=steps)
+
+
+def source_format(spec: PipelineSpec) -> tuple[int, int]:
+    """
+    Get (rate, channels) produced by the spec's source.
+
+    Raises:
+        RuntimeError: If a WAV source cannot be read
+    """
+    source = spec.source
+    if isinstance(source, WavFileSource):
+        from . import pipeline
+
+        if pipeline.is_available():
+            fmt = pipeline._pipeline.Pipeline(
+                PipelineSpec(source=source, sinks=[RawSink(os.devnull)]).to_dict()
+            ).get_format()
+            return int(fmt['source_rate']), int(fmt['source_channels'])
+        try:
+            with wave.open(source.path, 'rb') as f:
+                return f.getframerate(), f.getnchannels()
+        except (OSError, wave.Error) as e:
+            raise RuntimeError(f"Cannot read WAV format of {source.path}: {e}") from e
+    return source.rate, source.channels
+
+
+def optimize(
+    spec: PipelineSpec,
+    costs: Optional[dict[str, float]] = None,
+    approximate: bool = False,
+    compare: bool = False,
+) -> Plan:
+    """
+    Plan the stages of a pipeline spec.
+
+    Args:
+        spec: Pipeline spec in naive order
+        costs: Per-sample cost overrides by stage kind
+        approximate: See plan_stages()
+        compare: Also run naive and planned stages on test noise and store
+                 the difference in plan.comparison (needs the extension)
+
+    Returns:
+        Plan for spec.stages
+    """
+    rate, channels = source_format(spec)
+    plan = plan_stages(spec.stages, rate, channels, costs, approximate)
+    if plan.changed:
+        logger.debug(f"Pipeline plan:\n{plan.describe()}")
+    if compare:
+        compare_plan(plan, rate, channels)
+    return plan
+
+
+def compare_plan(
+    plan: Plan,
+    source_rate: int,
+    source_channels: int,
+    duration: float = 1.0,
+) -> dict[str, float]:
+    """
+    Run naive and planned stages on the same noise and compare the outputs.
+
+    Args:
+        plan: Plan to check
+        source_rate: Source sample rate
+        source_channels: Source channel count
+        duration: Seconds of test signal
+
+    Returns:
+        Dictionary with 'max_abs_error', 'snr_db' (naive output power over
+        difference power) and measured 'naive_ns' / 'planned_ns' stage time;
+        also stored in plan.comparison
+
+    Raises:
+        RuntimeError: If the native extension is not available
+    """
+    from .pipeline import NativePipeline
+
+    source = SyntheticSource(
+        signal='noise', rate=source_rate, channels=source_channels,
+        duration=duration, amplitude=0.5, seed=1,
+    )
+    outputs = []
+    measured = []
+    with tempfile.TemporaryDirectory(prefix="proctap-plan-") as tmp:
+        for name, stages in (('naive', plan.naive_stages), ('planned', plan.stages)):
+            path = os.path.join(tmp, f"{name}.raw")
+            spec = PipelineSpec(
+                source=source,
+                # Meters only emit events; drop them to keep the comparison quiet
+                stages=[s for s in stages if not isinstance(s, Meter)],
+                sinks=[RawSink(path)],
+            )
+            pipeline = NativePipeline(spec, optimize=False)
+            pipeline.start()
+            pipeline.wait()
+            pipeline.stop()
+            stats = pipeline.stats()
+            measured.append(float(sum(s['total_ns'] for s in stats['stages'])))
+            outputs.append(np.fromfile(path, dtype=np.float32).reshape(-1, stats['output_channels']))
+
+    naive_out, planned_out = outputs
+    frames = min(len(naive_out), len(planned_out))
+    diff = naive_out[:frames] - planned_out[:frames]
+    signal_power = float(np.mean(naive_out[:frames] ** 2)) if frames else 0.0
+    error_power = float(np.mean(diff ** 2)) if frames else 0.0
+    comparison = {
+        'max_abs_error': float(np.max(np.abs(diff))) if frames else 0.0,
+        'snr_db': 10 * math.log10(signal_power / error_power) if error_power > 0 else math.inf,
+        'naive_ns': measured[0],
+        'planned_ns': measured[1],
+    }
+    plan.comparison = comparison
+    return comparison
+
+
+def consumer_chain(
+    filters: Sequence[StageSpec],
+    consumer_rate: int,
+    consumer_channels: int,
+    standard_rate: int = 48000,
+    standard_channels: int = 2,
+) -> list[StageSpec]:
+    """
+    Build the naive stage list used by capture consumers today.
+
+    Mirrors ProcessAudioCapture + consumer: convert to the standard format
+    (channels, then resample, like AudioConverter), run the filters, then
+    convert to what the consumer needs.
+
+    Args:
+        filters: Filter/gain/meter stages run by the consumer
+        consumer_rate: Sample rate the consumer wants
+        consumer_channels: Channel count the consumer wants
+        standard_rate: Standard capture rate
+        standard_channels: Standard capture channel count
+
+    Returns:
+        Stage list to pass to plan_stages()
+    """
+    return [
+        Channels(standard_channels),
+        Resample(standard_rate),
+        *filters,
+        Channels(consumer_channels),
+        Resample(consumer_rate),
+    ]
+
+
+__all__ = [
+    'DEFAULT_COSTS',
+    'Plan',
+    'channel_matrix',
+    'compare_plan',
+    'consumer_chain',
+    'estimate_cost',
+    'optimize',
+    'plan_stages',
+    'source_format',
+]
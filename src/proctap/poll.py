@@ -0,0 +1,252 @@
+"""
+Readiness polling across many captures.
+
+A consumer serving many ProcessAudioCapture instances would otherwise need a
+thread per capture, or spin over read(timeout=...) calls one by one, because
+every capture has its own queue. CaptureSelector waits on all of them with a
+single condition variable instead:
+
+- Each capture keeps an O(1) fill level of its read queue (ChunkQueue).
+- Captures signal their selectors after every enqueued chunk; select() only
+  re-checks the captures that were signalled (or were ready before), so one
+  call costs O(ready captures), not O(registered captures).
+- Ready captures are drained with ProcessAudioCapture.drain(), which hands
+  over the chunks produced by the backend without joining or copying them.
+
+Usage:
+    with CaptureSelector(min_frames=480) as selector:
+        for tap in taps:
+            selector.register(tap)
+        while running:
+            for tap in selector.select(timeout=0.1):
+                for chunk in tap.drain():
+                    process(tap.pid, chunk)
+
+    # One-shot form
+    ready = proctap.poll(taps, timeout=0.1, min_frames=480)
+"""
+
+from __future__ import annotations
+
+import logging
+import queue
+import threading
+import time
+from typing import TYPE_CHECKING, Iterable, Optional
+
+from .backends.base import STANDARD_CHANNELS, STANDARD_SAMPLE_WIDTH
+
+if TYPE_CHECKING:
+    from .core import ProcessAudioCapture
+
+logger = logging.getLogger(__name__)
+
+FRAME_BYTES = STANDARD_CHANNELS * STANDARD_SAMPLE_WIDTH
+
+
+class ChunkQueue(queue.Queue[Optional[bytes]]):
+    """
+    Read queue of a capture that tracks its fill level.
+
+    queue.Queue calls _put/_get with its mutex held, so queued_bytes is
+    always consistent with the queue contents. None is the end-of-stream
+    sentinel and counts as zero bytes.
+    """
+
+    def _init(self, maxsize: int) -> None:
+        super()._init(maxsize)
+        self.queued_bytes = 0
+
+    def _put(self, item: Optional[bytes]) -> None:
+        super()._put(item)
+        if item:
+            self.queued_bytes += len(item)
+
+    def _get(self) -> Optional[bytes]:
+        item = super()._get()
+        if item:
+            self.queued_bytes -= len(item)
+        return item
+
+    def get_chunks(self, max_bytes: Optional[int] = None) -> list[bytes]:
+        """
+        Remove queued chunks without blocking.
+
+        Stops at the end-of-stream sentinel, which stays queued for
+        iter_chunks().
+
+        Args:
+            max_bytes: Stop once at least this many bytes were removed
+                       (None: remove everything)
+
+        Returns:
+            The removed chunks, in order
+        """
+        chunks: list[bytes] = []
+        taken = 0
+        with self.mutex:
+            while self.queue and self.queue[0] is not None:
+                if max_bytes is not None and taken >= max_bytes:
+                    break
+                chunk = self._get()
+                assert chunk is not None
+                chunks.append(chunk)
+                taken += len(chunk)
+            if chunks:
+                self.not_full.notify()
+        return chunks
+
+
+class CaptureSelector:
+    """
+    Waits until any of many captures has enough audio queued.
+
+    Uses one condition variable for all registered captures. A capture is
+    ready when its read queue holds at least its min_frames, or when its
+    worker has stopped (end of stream: drain() then returns what is left,
+    and an empty list once exhausted - unregister it then).
+    """
+
+    def __init__(self, min_frames: int = 1) -> None:
+        """
+        Initialize selector.
+
+        Args:
+            min_frames: Default readiness threshold in frames (standard format)
+
+        Raises:
+            ValueError: If min_frames < 1
+        """
+        if min_frames < 1:
+            raise ValueError(f"min_frames must be >= 1: {min_frames}")
+        self._min_frames = min_frames
+        self._cond = threading.Condition()
+        self._captures: dict["ProcessAudioCapture", tuple[int, int]] = {}  # -> (min_bytes, order)
+        self._candidates: set["ProcessAudioCapture"] = set()
+        self._order = 0
+
+    def register(self, capture: "ProcessAudioCapture", min_frames: Optional[int] = None) -> None:
+        """
+        Start watching a capture.
+
+        Args:
+            capture: Capture to watch
+            min_frames: Readiness threshold for this capture (default: the
+                        selector's min_frames)
+
+        Raises:
+            ValueError: If min_frames < 1
+        """
+        frames = self._min_frames if min_frames is None else min_frames
+        if frames < 1:
+            raise ValueError(f"min_frames must be >= 1: {frames}")
+        with self._cond:
+            if capture not in self._captures:
+                self._order += 1
+            order = self._captures.get(capture, (0, self._order))[1]
+            self._captures[capture] = (frames * FRAME_BYTES, order)
+            self._candidates.add(capture)
+        capture._add_waiter(self)
+
+    def unregister(self, capture: "ProcessAudioCapture") -> None:
+        """
+        Stop watching a capture. Unknown captures are ignored.
+
+        Args:
+            capture: Capture to remove
+        """
+        capture._remove_waiter(self)
+        with self._cond:
+            self._captures.pop(capture, None)
+            self._candidates.discard(capture)
+
+    @property
+    def captures(self) -> list["ProcessAudioCapture"]:
+        """Registered captures, in registration order."""
+        with self._cond:
+            return sorted(self._captures, key=lambda c: self._captures[c][1])
+
+    def select(self, timeout: Optional[float] = None) -> list["ProcessAudioCapture"]:
+        """
+        Block until at least one registered capture is ready.
+
+        Args:
+            timeout: Maximum time to wait in seconds (None: forever,
+                     0: check without waiting)
+
+        Returns:
+            Ready captures in registration order (empty on timeout)
+        """
+        deadline = None if timeout is None else time.monotonic() + timeout
+        with self._cond:
+            while True:
+                ready = []
+                for capture in list(self._candidates):
+                    min_bytes, order = self._captures[capture]
+                    if capture._queued_bytes() >= min_bytes or capture._at_eof():
+                        ready.append((order, capture))
+                    else:
+                        # Only a notification can make it ready again
+                        self._candidates.discard(capture)
+                if ready:
+                    return [capture for _, capture in sorted(ready, key=lambda item: item[0])]
+
+                remaining = None if deadline is None else deadline - time.monotonic()
+                if remaining is not None and remaining <= 0:
+                    return []
+                self._cond.wait(remaining)
+
+    def close(self) -> None:
+        """Unregister all captures."""
+        for capture in self.captures:
+            self.unregister(capture)
+
+    def _notify(self, capture: "ProcessAudioCapture") -> None:
+        """Called by a capture's worker after it queued a chunk or stopped."""
+        with self._cond:
+            if capture in self._captures:
+                self._candidates.add(capture)
+                self._cond.notify_all()
+
+    def __len__(self) -> int:
+        with self._cond:
+            return len(self._captures)
+
+    def __enter__(self) -> "CaptureSelector":
+        return self
+
+    def __exit__(self, _exc_type, _exc, _tb) -> None:
+        self.close()
+
+
+def poll(
+    captures: Iterable["ProcessAudioCapture"],
+    timeout: Optional[float] = None,
+    min_frames: int = 1,
+) -> list["ProcessAudioCapture"]:
+    """
+    Wait until any of the captures has at least min_frames queued.
+
+    One-shot form of CaptureSelector; for a long-running loop over many
+    captures keep a CaptureSelector instead, so captures are not
+    re-registered on every call.
+
+    Args:
+        captures: Captures to watch
+        timeout: Maximum time to wait in seconds (None: forever)
+        min_frames: Readiness threshold in frames (standard format)
+
+    Returns:
+        Ready captures in the given order (empty on timeout)
+
+    Example:
+        >>> for tap in proctap.poll(taps, timeout=0.1, min_frames=480):
+        ...     chunks = tap.drain()
+    """
+    with CaptureSelector(min_frames) as selector:
+        for capture in captures:
+            selector.register(capture)
+        return selector.select(timeout)
+
+
+__all__ = ['CaptureSelector', 'ChunkQueue', 'poll']
@@ -0,0 +1,481 @@
+"""
+Shared STFT analysis bus for spectral consumers of a stream.
+
+Spectrum meters, spectral VADs, noise suppressors, fingerprinters and beat
+trackers all window and FFT the same audio. A SpectralBus computes each
+distinct STFT configuration - (size, hop, window, mix) - once per stream and
+hands the same frames to every subscriber, so spectral work scales with the
+number of configurations, not the number of consumers.
+
+- Lazy: a configuration exists only while it has subscribers. With no
+  subscribers, feeding the bus only advances its position counter.
+- Batched: all frames that become ready in one chunk are computed with a
+  single rfft call.
+- Ref-counted frames: a frame is shared (never copied) between subscribers.
+  Callback subscribers get a borrowed frame valid for the duration of the
+  callback and call retain() to keep it; queue subscribers own one
+  reference per frame and release() it when done (or use `with frame:`).
+  Once the last reference is released the frame's buffers are dropped, and
+  further access raises RuntimeError.
+
+Usage:
+    bus = SpectralBus(sample_rate=48000, channels=2)
+    capture = ProcessAudioCapture(pid, on_data=bus.on_data)
+
+    bus.subscribe(2048, 512, callback=lambda f: print(f.time, f.magnitude.argmax()))
+
+    with bus.subscribe(2048, 512) as sub:   # queue mode
+        with sub.get(timeout=1.0) as frame:
+            use(frame.power)
+"""
+
+from __future__ import annotations
+
+import logging
+import queue
+import threading
+import time
+from dataclasses import dataclass
+from typing import Callable, Literal, Optional
+
+import numpy as np
+from numpy.typing import NDArray
+
+from .backends.base import STANDARD_CHANNELS, STANDARD_DTYPE, STANDARD_SAMPLE_RATE
+
+logger = logging.getLogger(__name__)
+
+WindowType = Literal['hann', 'hamming', 'blackman', 'rect']
+FrameCallback = Callable[['SpectralFrame'], None]
+
+
+@dataclass(frozen=True)
+class STFTConfig:
+    """Key of a shared STFT computation."""
+    size: int
+    hop: int
+    window: WindowType = 'hann'
+    mix: bool = True  # True: downmix to mono first; False: per-channel spectra
+
+
+def make_window(window: WindowType, size: int) -> NDArray[np.float32]:
+    """
+    Create an analysis window.
+
+    Args:
+        window: Window type
+        size: Window length in samples
+
+    Returns:
+        Window of shape (size,)
+
+    Raises:
+        ValueError: If the window type is unknown
+    """
+    if window == 'hann':
+        w = np.hanning(size)
+    elif window == 'hamming':
+        w = np.hamming(size)
+    elif window == 'blackman':
+        w = np.blackman(size)
+    elif window == 'rect':
+        w = np.ones(size)
+    else:
+        raise ValueError(f"Unknown window: {window}")
+    return w.astype(np.float32)
+
+
+class SpectralFrame:
+    """One STFT frame shared by all subscribers of a configuration."""
+
+    __slots__ = (
+        'config', 'index', 'position', 'sample_rate',
+        '_spectrum', '_magnitude', '_power', '_refs', '_lock',
+    )
+
+    def __init__(
+        self,
+        config: STFTConfig,
+        index: int,
+        position: int,
+        sample_rate: int,
+        spectrum: NDArray[np.complex64],
+    ) -> None:
+        self.config = config
+        self.index = index  # Frame number within this configuration
+        self.position = position  # Stream sample index of the first windowed sample
+        self.sample_rate = sample_rate
+        spectrum.flags.writeable = False
+        self._spectrum: Optional[NDArray[np.complex64]] = spectrum
+        self._magnitude: Optional[NDArray[np.float32]] = None
+        self._power: Optional[NDArray[np.float32]] = None
+        self._refs = 1
+        self._lock = threading.Lock()
+
+    @property
+    def time(self) -> float:
+        """Stream time of the first windowed sample in seconds."""
+        return self.position / self.sample_rate
+
+    @property
+    def refcount(self) -> int:
+        """Number of outstanding references (0 = released)."""
+        return self._refs
+
+    @property
+    def spectrum(self) -> NDArray[np.complex64]:
+        """
+        Complex spectrum (read-only).
+
+        Shape (size // 2 + 1,) for mixed configurations, otherwise
+        (channels, size // 2 + 1).
+
+        Raises:
+            RuntimeError: If the frame has been released
+        """
+        if self._spectrum is None:
+            raise RuntimeError("SpectralFrame has been released")
+        return self._spectrum
+
+    @property
+    def magnitude(self) -> NDArray[np.float32]:
+        """|spectrum|, computed on first access and shared by all subscribers."""
+        if self._magnitude is None:
+            magnitude = np.abs(self.spectrum).astype(np.float32)
+            magnitude.flags.writeable = False
+            self._magnitude = magnitude
+        return self._magnitude
+
+    @property
+    def power(self) -> NDArray[np.float32]:
+        """|spectrum|^2, computed on first access and shared by all subscribers."""
+        if self._power is None:
+            power = np.square(self.magnitude)
+            power.flags.writeable = False
+            self._power = power
+        return self._power
+
+    def magnitude_db(self, floor: float = 1e-10) -> NDArray[np.float32]:
+        """Magnitude in dB (new array)."""
+        result: NDArray[np.float32] = (20 * np.log10(self.magnitude + floor)).astype(np.float32)
+        return result
+
+    def freqs(self) -> NDArray[np.float32]:
+        """Bin center frequencies in Hz."""
+        result: NDArray[np.float32] = np.fft.rfftfreq(self.config.size, 1 / self.sample_rate).astype(np.float32)
+        return result
+
+    def retain(self) -> "SpectralFrame":
+        """
+        Take an additional reference.
+
+        Returns:
+            self
+
+        Raises:
+            RuntimeError: If the frame has already been released
+        """
+        with self._lock:
+            if self._refs <= 0:
+                raise RuntimeError("SpectralFrame has been released")
+            self._refs += 1
+        return self
+
+    def release(self) -> None:
+        """Drop a reference; the last one frees the frame's buffers."""
+        with self._lock:
+            if self._refs <= 0:
+                return
+            self._refs -= 1
+            if self._refs == 0:
+                self._spectrum = None
+                self._magnitude = None
+                self._power = None
+
+    def __enter__(self) -> "SpectralFrame":
+        return self
+
+    def __exit__(self, _exc_type, _exc, _tb) -> None:
+        self.release()
+
+
+class Subscription:
+    """A consumer of one STFT configuration."""
+
+    def __init__(
+        self,
+        bus: "SpectralBus",
+        config: STFTConfig,
+        callback: Optional[FrameCallback],
+        max_queue: int,
+    ) -> None:
+        self._bus = bus
+        self.config = config
+        self._callback = callback
+        self._queue: Optional[queue.Queue[SpectralFrame]] = (
+            queue.Queue(maxsize=max_queue) if callback is None else None
+        )
+        self.dropped = 0  # Frames dropped because the queue was full
+        self.closed = False
+
+    def get(self, timeout: Optional[float] = None) -> Optional[SpectralFrame]:
+        """
+        Get the next frame (queue mode). The caller owns one reference.
+
+        Args:
+            timeout: Maximum time to wait in seconds (None = forever)
+
+        Returns:
+            Frame to release() when done, or None on timeout
+
+        Raises:
+            RuntimeError: If the subscription uses a callback
+        """
+        if self._queue is None:
+            raise RuntimeError("get() is only available for queue subscriptions")
+        try:
+            return self._queue.get(timeout=timeout)
+        except queue.Empty:
+            return None
+
+    def close(self) -> None:
+        """Unsubscribe and release queued frames. Safe to call multiple times."""
+        if self.closed:
+            return
+        self.closed = True
+        self._bus._unsubscribe(self)
+        if self._queue is not None:
+            while True:
+                try:
+                    self._queue.get_nowait().release()
+                except queue.Empty:
+                    break
+
+    def _deliver(self, frame: SpectralFrame) -> None:
+        """Hand a frame to this subscriber (called on the feeding thread)."""
+        if self._callback is not None:
+            try:
+                self._callback(frame)
+            except Exception:
+                logger.exception("Error in spectral frame callback")
+            return
+
+        assert self._queue is not None
+        frame.retain()
+        while True:
+            try:
+                self._queue.put_nowait(frame)
+                return
+            except queue.Full:
+                try:
+                    self._queue.get_nowait().release()
+                    self.dropped += 1
+                except queue.Empty:
+                    pass
+
+    def __enter__(self) -> "Subscription":
+        return self
+
+    def __exit__(self, _exc_type, _exc, _tb) -> None:
+        self.close()
+
+
+class _Analysis:
+    """State of one active STFT configuration."""
+
+    def __init__(self, config: STFTConfig, channels: int, start: int) -> None:
+        self.config = config
+        self.window = make_window(config.window, config.size)
+        self.subscribers: list[Subscription] = []
+        width = 1 if config.mix else channels
+        self.pending = np.zeros((0, width), dtype=STANDARD_DTYPE)
+        self.pending_start = start  # Stream position of pending[0]
+        self.frames = 0
+        self.fft_seconds = 0.0
+
+    def push(self, samples: NDArray[np.float32], mono: Optional[NDArray[np.float32]]) -> NDArray[np.complex64]:
+        """Append samples and compute every frame that became ready."""
+        size, hop = self.config.size, self.config.hop
+        data = mono[:, np.newaxis] if self.config.mix and mono is not None else samples
+        self.pending = np.concatenate([self.pending, data]) if len(self.pending) else data
+
+        count = 0 if len(self.pending) < size else 1 + (len(self.pending) - size) // hop
+        if count == 0:
+            return np.zeros((0,), dtype=np.complex64)
+
+        t0 = time.perf_counter()
+        # (frames, channels, size) view; one batched rfft for all of them
+        windows = np.lib.stride_tricks.sliding_window_view(self.pending, size, axis=0)[::hop][:count]
+        spectra = np.fft.rfft(windows * self.window, axis=-1).astype(np.complex64)
+        if self.config.mix:
+            spectra = spectra[:, 0, :]
+        self.fft_seconds += time.perf_counter() - t0
+
+        consumed = count * hop
+        self.pending = self.pending[consumed:].copy()
+        self.pending_start += consumed
+        return spectra
+
+
+class SpectralBus:
+    """
+    Per-stream STFT bus.
+
+    Feed it the stream (on_data() has the ProcessAudioCapture callback
+    signature) and subscribe spectral consumers to (size, hop) pairs.
+    Frames are delivered on the feeding thread.
+    """
+
+    def __init__(
+        self,
+        sample_rate: int = STANDARD_SAMPLE_RATE,
+        channels: int = STANDARD_CHANNELS,
+    ) -> None:
+        """
+        Initialize bus.
+
+        Args:
+            sample_rate: Stream sample rate in Hz
+            channels: Stream channel count (input is interleaved float32)
+        """
+        self.sample_rate = sample_rate
+        self.channels = channels
+        self._lock = threading.Lock()
+        self._analyses: dict[STFTConfig, _Analysis] = {}
+        self._position = 0  # Stream samples fed so far
+
+    @property
+    def position(self) -> int:
+        """Number of stream frames fed so far."""
+        return self._position
+
+    @property
+    def active(self) -> bool:
+        """True if any configuration has subscribers."""
+        return bool(self._analyses)
+
+    def subscribe(
+        self,
+        size: int,
+        hop: Optional[int] = None,
+        callback: Optional[FrameCallback] = None,
+        window: WindowType = 'hann',
+        mix: bool = True,
+        max_queue: int = 64,
+    ) -> Subscription:
+        """
+        Subscribe to STFT frames.
+
+        Subscribers with the same (size, hop, window, mix) share one
+        computation. A new configuration starts at the next fed sample.
+
+        Args:
+            size: FFT size in samples
+            hop: Hop size in samples (default: size // 2)
+            callback: Called with each frame (borrowed, retain() to keep);
+                      if None, frames are queued for Subscription.get()
+            window: Analysis window
+            mix: Downmix channels to mono before the FFT
+            max_queue: Queue length in queue mode (oldest frames are dropped)
+
+        Returns:
+            Subscription (close() to unsubscribe)
+
+        Raises:
+            ValueError: If size, hop or window is invalid
+        """
+        hop = size // 2 if hop is None else hop
+        if size < 2:
+            raise ValueError(f"FFT size must be at least 2, got {size}")
+        if not 0 < hop <= size:
+            raise ValueError(f"Hop must be in 1..{size}, got {hop}")
+        config = STFTConfig(size, hop, window, mix)
+        make_window(window, 2)  # Validate early
+
+        subscription = Subscription(self, config, callback, max_queue)
+        with self._lock:
+            analysis = self._analyses.get(config)
+            if analysis is None:
+                analysis = _Analysis(config, self.channels, self._position)
+                self._analyses[config] = analysis
+                logger.debug(f"Spectral analysis activated: {config}")
+            analysis.subscribers = analysis.subscribers + [subscription]
+        return subscription
+
+    def _unsubscribe(self, subscription: Subscription) -> None:
+        with self._lock:
+            analysis = self._analyses.get(subscription.config)
+            if analysis is None:
+                return
+            analysis.subscribers = [s for s in analysis.subscribers if s is not subscription]
+            if not analysis.subscribers:
+                del self._analyses[subscription.config]
+                logger.debug(f"Spectral analysis deactivated: {subscription.config}")
+
+    def on_data(self, pcm: bytes, frames: int = -1) -> None:
+        """
+        Feed interleaved float32 PCM (ProcessAudioCapture callback signature).
+
+        Args:
+            pcm: Interleaved float32 PCM data
+            frames: Ignored (computed from the data)
+        """
+        self.feed(np.frombuffer(pcm, dtype=STANDARD_DTYPE).reshape(-1, self.channels))
+
+    def feed(self, samples: NDArray[np.float32]) -> None:
+        """
+        Feed a block of samples.
+
+        Args:
+            samples: Array of shape (frames, channels)
+        """
+        with self._lock:
+            analyses = list(self._analyses.values())
+            self._position += len(samples)
+        if not analyses:
+            return
+
+        mono: Optional[NDArray[np.float32]] = None
+        if any(a.config.mix for a in analyses):
+            mono = samples.mean(axis=1, dtype=STANDARD_DTYPE) if self.channels > 1 else samples[:, 0]
+
+        for analysis in analyses:
+            start = analysis.pending_start
+            spectra = analysis.push(samples, mono)
+            hop = analysis.config.hop
+            for i in range(len(spectra)):
+                frame = SpectralFrame(
+                    analysis.config, analysis.frames, start + i * hop, self.sample_rate, spectra[i],
+                )
+                analysis.frames += 1
+                for subscriber in analysis.subscribers:
+                    subscriber._deliver(frame)
+                frame.release()  # Drop the bus reference
+
+    def stats(self) -> dict[str, object]:
+        """
+        Get bus statistics.
+
+        Returns:
+            Dictionary with 'position' and per-configuration 'analyses'
+            (config fields, 'subscribers', 'frames', 'fft_seconds')
+        """
+        with self._lock:
+            return {
+                'position': self._position,
+                'analyses': [
+                    {
+                        'size': a.config.size,
+                        'hop': a.config.hop,
+                        'window': a.config.window,
+                        'mix': a.config.mix,
+                        'subscribers': len(a.subscribers),
+                        'frames': a.frames,
+                        'fft_seconds': a.fft_seconds,
+                    }
+                    for a in self._analyses.values()
+                ],
+            }
+
+
+__all__ = ['SpectralBus', 'SpectralFrame', 'STFTConfig', 'Subscription', 'make_window']
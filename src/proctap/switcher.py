@@ -0,0 +1,427 @@
+"""
+Glitch-free live switching between capture sources.
+
+Tearing down one ProcessAudioCapture and starting another costs a backend
+startup delay, an audible gap and a fresh resampler. A SourceSwitcher keeps
+every candidate source attached to a shared BlockGrid instead, so switching
+is a gain change applied at a block boundary:
+
+- Sources stay warm (or, with pause_inactive=True, keep their backend
+  running but stop delivering until they are switched to)
+- The switch crossfades from the current mix to the new source over
+  crossfade_ms (equal-power by default; 0 gives a hard cut)
+- Sources with different pipeline latency are delayed to the same total
+  latency, so a switch does not jump forwards or backwards in time
+
+Output is a stream of (block_frames, channels) float32 blocks in the
+standard format.
+
+Usage:
+    switcher = SourceSwitcher(crossfade_ms=50)
+    switcher.add_source("game", game_capture)
+    switcher.add_source("music", music_capture, latency_ms=20)
+
+    switcher.start(on_block=send)  # or switcher.start() + switcher.read()
+    switcher.switch("music")       # takes effect at the next block boundary
+"""
+
+from __future__ import annotations
+
+import logging
+import math
+import queue
+import threading
+from dataclasses import dataclass
+from typing import TYPE_CHECKING, Callable, Literal, Optional
+
+import numpy as np
+
+from .backends.base import STANDARD_DTYPE
+from .grid import BlockGrid, GridBlock, GridStream
+from .latency import DelayLine
+
+if TYPE_CHECKING:
+    from .core import ProcessAudioCapture
+
+logger = logging.getLogger(__name__)
+
+SwitchCallback = Callable[[np.ndarray], None]
+FadeCurve = Literal['equal-power', 'linear']
+
+
+@dataclass
+class _Source:
+    """Switcher state for one source."""
+    name: str
+    stream: GridStream
+    capture: Optional["ProcessAudioCapture"]
+    latency_frames: int
+    delay: DelayLine
+    gain: float = 0.0
+    fade_from: float = 0.0
+    fade_to: float = 0.0
+    fade_pos: int = 0
+    ready_frames: int = 0  # Consecutive frames delivered without underrun
+
+
+class SourceSwitcher:
+    """
+    Crossfading switcher over a set of warm capture sources.
+
+    All sources share one BlockGrid tick. Switch requests are applied on
+    the grid thread at the next block boundary, so they are sample-aligned
+    and never interrupt a block.
+    """
+
+    def __init__(
+        self,
+        block_frames: int = 480,
+        crossfade_ms: float = 50.0,
+        curve: FadeCurve = 'equal-power',
+        pause_inactive: bool = False,
+        resume_timeout_ms: float = 100.0,
+        grid: Optional[BlockGrid] = None,
+    ) -> None:
+        """
+        Initialize switcher.
+
+        Args:
+            block_frames: Frames per output block (ignored if grid is given)
+            crossfade_ms: Crossfade duration (0 = hard cut at the block boundary)
+            curve: 'equal-power' (for unrelated sources) or 'linear'
+            pause_inactive: Pause captures of inactive sources; they are
+                            resumed on switch() and the crossfade starts as
+                            soon as their audio arrives
+            resume_timeout_ms: With pause_inactive, start the crossfade after
+                               this long even if the resumed source is silent
+            grid: Existing BlockGrid to use (default: create one)
+        """
+        if curve not in ('equal-power', 'linear'):
+            raise ValueError(f"Unknown fade curve: {curve}. Use 'equal-power' or 'linear'")
+
+        self._grid = grid if grid is not None else BlockGrid(block_frames=block_frames)
+        self._rate = self._grid.sample_rate
+        self._channels = self._grid.channels
+        self._fade_frames = int(round(crossfade_ms * self._rate / 1000))
+        self._curve = curve
+        self._pause_inactive = pause_inactive
+        self._resume_timeout_frames = int(resume_timeout_ms * self._rate / 1000)
+
+        self._lock = threading.Lock()
+        self._sources: dict[str, _Source] = {}
+        self._active: Optional[str] = None
+        self._pending: Optional[str] = None
+        self._pending_frames = 0  # Frames waited for the pending source
+        self._fading = False
+
+        self._output: "queue.Queue[bytes]" = queue.Queue(maxsize=50)
+        self._switches = 0
+        self._dropped_blocks = 0
+
+    # --- sources ------------------------------------------------------------
+
+    def add_source(
+        self,
+        name: str,
+        capture: Optional["ProcessAudioCapture"] = None,
+        latency_ms: Optional[float] = None,
+    ) -> GridStream:
+        """
+        Register a candidate source.
+
+        The first source added becomes active.
+
+        Args:
+            name: Unique source name
+            capture: Capture feeding the source (its callback is replaced);
+                     None to push audio into the returned stream manually
+            latency_ms: Pipeline latency of this source (capture + backend
+                        buffering); sources are delayed to the largest value.
+                        None: the capture's declared latency (0 without one)
+
+        Returns:
+            GridStream the source is fed through
+        """
+        if latency_ms is None:
+            latency_ms = capture.latency().algorithmic_ms if capture is not None else 0.0
+        stream = self._grid.attach(capture, name) if capture is not None else self._grid.add_stream(name)
+        latency_frames = int(round(latency_ms * self._rate / 1000))
+
+        with self._lock:
+            source = _Source(
+                name=name,
+                stream=stream,
+                capture=capture,
+                latency_frames=latency_frames,
+                delay=DelayLine(0, self._channels),
+            )
+            self._sources[name] = source
+            if self._active is None:
+                self._active = name
+                source.gain = source.fade_from = source.fade_to = 1.0
+            elif self._pause_inactive and capture is not None:
+                capture.pause()
+            self._update_delays()
+
+        logger.debug(f"Added switcher source '{name}' (latency={latency_ms}ms)")
+        return stream
+
+    def remove_source(self, name: str) -> None:
+        """
+        Remove a source.
+
+        Args:
+            name: Source name
+
+        Raises:
+            ValueError: If the source is active or being switched to
+        """
+        with self._lock:
+            if name in (self._active, self._pending):
+                raise ValueError(f"Cannot remove active source '{name}', switch away first")
+            self._sources.pop(name, None)
+            self._update_delays()
+        self._grid.remove_stream(name)
+
+    def _update_delays(self) -> None:
+        """
+        Delay every source to the largest latency (called with the lock held).
+
+        A delay change on an audible source would jump in time, so once the
+        grid is running it is only applied while the source is silent;
+        audible sources pick it up the next time they are faded out.
+        """
+        if not self._sources:
+            return
+        started = self._grid.tick_count > 0
+        target = max(s.latency_frames for s in self._sources.values())
+        for source in self._sources.values():
+            delay = target - source.latency_frames
+            if delay == source.delay.delay_frames:
+                continue
+            if started and (source.gain != 0.0 or source.fade_to != 0.0):
+                continue
+            source.delay = DelayLine(delay, self._channels)
+
+    # --- switching ----------------------------------------------------------
+
+    def switch(self, name: str) -> None:
+        """
+        Switch output to another source.
+
+        Returns immediately; the crossfade starts at the next block boundary
+        (or, with pause_inactive, as soon as the resumed source delivers).
+
+        Args:
+            name: Source name
+
+        Raises:
+            KeyError: If the source is not registered
+        """
+        with self._lock:
+            if name not in self._sources:
+                raise KeyError(f"Unknown source: {name}")
+            if name == self._active and self._pending is None:
+                return
+            self._pending = name
+            self._pending_frames = 0
+            source = self._sources[name]
+            if self._pause_inactive and source.capture is not None and source.capture.is_paused:
+                source.ready_frames = 0
+                source.capture.resume()
+        logger.debug(f"Switch to '{name}' requested")
+
+    def _start_fade(self, target: str) -> None:
+        """Begin fading every source towards target (called with the lock held)."""
+        for source in self._sources.values():
+            source.fade_from = source.gain
+            source.fade_to = 1.0 if source.name == target else 0.0
+            source.fade_pos = 0
+        self._active = target
+        self._pending = None
+        self._fading = True
+        self._switches += 1
+        logger.info(f"Switching to source '{target}'")
+
+    def _pending_ready(self, block_frames: int) -> bool:
+        """Check if the pending source can be faded in (called with the lock held)."""
+        assert self._pending is not None
+        source = self._sources[self._pending]
+        self._pending_frames += block_frames
+        if source.capture is None or not self._pause_inactive:
+            return True
+        # Its first real audio has to make it through the delay line
+        if source.ready_frames >= source.delay.delay_frames + block_frames:
+            return True
+        return self._pending_frames >= self._resume_timeout_frames
+
+    def _ramp(self, source: _Source, num_frames: int) -> np.ndarray | float:
+        """Gain for each frame of the next block, advancing the fade."""
+        if source.fade_from == source.fade_to or self._fade_frames == 0:
+            source.gain = source.fade_to
+            return source.gain
+
+        t = np.minimum((source.fade_pos + np.arange(1, num_frames + 1)) / self._fade_frames, 1.0)
+        if self._curve == 'equal-power':
+            theta = t * (math.pi / 2)
+            gains = source.fade_from * np.cos(theta) + source.fade_to * np.sin(theta)
+        else:
+            gains = source.fade_from + (source.fade_to - source.fade_from) * t
+        gains = np.clip(gains, 0.0, max(source.fade_from, source.fade_to)).astype(STANDARD_DTYPE)
+
+        source.fade_pos += num_frames
+        if source.fade_pos >= self._fade_frames:
+            source.fade_from = source.gain = source.fade_to
+        else:
+            source.gain = float(gains[-1])
+        return gains[:, np.newaxis]
+
+    # --- processing -------------------------------------------------------
+
+    def process(self, block: GridBlock) -> np.ndarray:
+        """
+        Mix one grid block into an output block.
+
+        Args:
+            block: GridBlock from the switcher's grid
+
+        Returns:
+            float32 array of shape (block_frames, channels)
+        """
+        num_frames = block.data.shape[1]
+        out = np.zeros((num_frames, self._channels), dtype=STANDARD_DTYPE)
+
+        with self._lock:
+            for source in self._sources.values():
+                if source.name in block.names and source.name not in block.underruns:
+                    source.ready_frames += num_frames
+                else:
+                    source.ready_frames = 0
+
+            if self._pending is not None and self._pending_ready(num_frames):
+                self._start_fade(self._pending)
+
+            for source in self._sources.values():
+                if source.name not in block.names:
+                    continue  # Added after this block was drained
+                # Silent sources still run their delay line to stay warm
+                x = source.delay.process(block.stream(source.name))
+                gain = self._ramp(source, num_frames)
+                if isinstance(gain, float) and gain == 0.0:
+                    continue
+                out += x * gain
+
+            if self._fading and all(s.gain == s.fade_to for s in self._sources.values()):
+                self._finish_fade()
+
+        return out
+
+    def _finish_fade(self) -> None:
+        """Complete a switch (called with the lock held)."""
+        self._fading = False
+        if self._pause_inactive:
+            for source in self._sources.values():
+                if source.name != self._active and source.capture is not None:
+                    source.capture.pause()
+        # Delay changes postponed while sources were audible
+        self._update_delays()
+
+    def tick(self) -> np.ndarray:
+        """
+        Pull mode: drain one grid block and mix it.
+
+        Returns:
+            float32 array of shape (block_frames, channels)
+        """
+        return self.process(self._grid.tick())
+
+    def start(self, on_block: Optional[SwitchCallback] = None) -> None:
+        """
+        Start producing output on the grid thread.
+
+        Args:
+            on_block: Called with each output block; if None, blocks are
+                      queued as bytes for read()
+        """
+        def handle(block: GridBlock) -> None:
+            out = self.process(block)
+            if on_block is not None:
+                on_block(out)
+                return
+            try:
+                self._output.put_nowait(out.tobytes())
+            except queue.Full:
+                self._dropped_blocks += 1
+
+        self._grid.start(handle)
+
+    def stop(self) -> None:
+        """Stop the grid thread. Captures are left to the caller."""
+        self._grid.stop()
+
+    def read(self, timeout: float = 1.0) -> Optional[bytes]:
+        """
+        Read one output block (push mode without a callback).
+
+        Args:
+            timeout: Maximum time to wait in seconds
+
+        Returns:
+            PCM bytes (48kHz/2ch/float32), or None on timeout
+        """
+        try:
+            return self._output.get(timeout=timeout)
+        except queue.Empty:
+            return None
+
+    # --- properties -------------------------------------------------------
+
+    @property
+    def grid(self) -> BlockGrid:
+        """Underlying block grid."""
+        return self._grid
+
+    @property
+    def active(self) -> Optional[str]:
+        """Name of the source being played (or faded in)."""
+        with self._lock:
+            return self._active
+
+    @property
+    def sources(self) -> list[str]:
+        """Registered source names."""
+        with self._lock:
+            return list(self._sources)
+
+    @property
+    def stats(self) -> dict[str, object]:
+        """
+        Get switcher statistics.
+
+        Returns:
+            Dictionary with keys:
+            - 'active': Active source name
+            - 'pending': Source waiting to be faded in, or None
+            - 'switches': Number of completed switch starts
+            - 'gains': Current gain per source
+            - 'delays': Latency compensation per source in frames
+            - 'dropped_blocks': Output blocks dropped because read() lagged
+        """
+        with self._lock:
+            return {
+                'active': self._active,
+                'pending': self._pending,
+                'switches': self._switches,
+                'gains': {s.name: s.gain for s in self._sources.values()},
+                'delays': {s.name: s.delay.delay_frames for s in self._sources.values()},
+                'dropped_blocks': self._dropped_blocks,
+            }
+
+    def __enter__(self) -> "SourceSwitcher":
+        return self
+
+    def __exit__(self, _exc_type, _exc, _tb) -> None:
+        self.stop()
+
+
+__all__ = ['SourceSwitcher']
@@ -0,0 +1,266 @@
+/*
+ * Fake audio library for the preload tests.
+ *
+ * Implements the playback calls declared in fake_audio.h. "Playing" appends
+ * the interleaved PCM to the file named by FAKE_AUDIO_OUT, so a test can
+ * check that the application's playback is unchanged by the shim.
+ *
+ * An ALSA device opened as "pulse" forwards its writes to an internal
+ * pa_stream, like ALSA's pulse plugin, to exercise nested API calls.
+ */
+#include "fake_audio.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static void play(const void* data, size_t bytes) {
+    const char* path = getenv("FAKE_AUDIO_OUT");
+    if (path == NULL || bytes == 0) return;
+    FILE* f = fopen(path, "ab");
+    if (f == NULL) return;
+    fwrite(data, 1, bytes, f);
+    fclose(f);
+}
+
+static unsigned int alsa_width(int format) {
+    switch (format) {
+        case SND_PCM_FORMAT_S16_LE: return 2;
+        case SND_PCM_FORMAT_S24_3LE: return 3;
+        default: return 4;
+    }
+}
+
+static int alsa_to_pulse(int format) {
+    switch (format) {
+        case SND_PCM_FORMAT_S16_LE: return PA_SAMPLE_S16LE;
+        case SND_PCM_FORMAT_S24_LE: return PA_SAMPLE_S24_32LE;
+        case SND_PCM_FORMAT_S32_LE: return PA_SAMPLE_S32LE;
+        case SND_PCM_FORMAT_S24_3LE: return PA_SAMPLE_S24LE;
+        default: return PA_SAMPLE_FLOAT32LE;
+    }
+}
+
+/* --- ALSA ----------------------------------------------------------------- */
+
+struct _snd_pcm_hw_params {
+    int access;
+    int format;
+    unsigned int channels;
+    unsigned int rate;
+};
+
+struct _snd_pcm {
+    int stream;
+    struct _snd_pcm_hw_params params;
+    pa_stream* plugin;  /* Set for the "pulse" device */
+};
+
+int snd_pcm_open(snd_pcm_t** pcm, const char* name, int stream, int mode) {
+    (void)mode;
+    *pcm = calloc(1, sizeof(snd_pcm_t));
+    (*pcm)->stream = stream;
+    (*pcm)->plugin = (name != NULL && strcmp(name, "pulse") == 0) ? (pa_stream*)1 : NULL;
+    return 0;
+}
+
+int snd_pcm_hw_params_malloc(snd_pcm_hw_params_t** params) {
+    *params = calloc(1, sizeof(snd_pcm_hw_params_t));
+    return 0;
+}
+
+void snd_pcm_hw_params_free(snd_pcm_hw_params_t* params) { free(params); }
+
+int snd_pcm_hw_params_any(snd_pcm_t* pcm, snd_pcm_hw_params_t* params) {
+    (void)pcm;
+    memset(params, 0, sizeof(*params));
+    return 0;
+}
+
+int snd_pcm_hw_params_set_access(snd_pcm_t* pcm, snd_pcm_hw_params_t* params, int access) {
+    (void)pcm;
+    params->access = access;
+    return 0;
+}
+
+int snd_pcm_hw_params_set_format(snd_pcm_t* pcm, snd_pcm_hw_params_t* params, int format) {
+    (void)pcm;
+    params->format = format;
+    return 0;
+}
+
+int snd_pcm_hw_params_set_channels(snd_pcm_t* pcm, snd_pcm_hw_params_t* params, unsigned int channels) {
+    (void)pcm;
+    params->channels = channels;
+    return 0;
+}
+
+int snd_pcm_hw_params_set_rate_near(snd_pcm_t* pcm, snd_pcm_hw_params_t* params, unsigned int* rate, int* dir) {
+    (void)pcm;
+    (void)dir;
+    params->rate = *rate;
+    return 0;
+}
+
+int snd_pcm_hw_params_get_rate(const snd_pcm_hw_params_t* params, unsigned int* rate, int* dir) {
+    *rate = params->rate;
+    if (dir != NULL) *dir = 0;
+    return 0;
+}
+
+int snd_pcm_hw_params_get_channels(const snd_pcm_hw_params_t* params, unsigned int* channels) {
+    *channels = params->channels;
+    return 0;
+}
+
+int snd_pcm_hw_params_get_format(const snd_pcm_hw_params_t* params, int* format) {
+    *format = params->format;
+    return 0;
+}
+
+int snd_pcm_stream(snd_pcm_t* pcm) { return pcm->stream; }
+
+int snd_pcm_hw_params(snd_pcm_t* pcm, snd_pcm_hw_params_t* params) {
+    pcm->params = *params;
+    if (pcm->plugin != NULL) {
+        pa_sample_spec spec = {alsa_to_pulse(params->format), params->rate, (uint8_t)params->channels};
+        pcm->plugin = pa_stream_new(NULL, "alsa-plugin", &spec, NULL);
+        pa_stream_connect_playback(pcm->plugin, NULL, NULL, 0, NULL, NULL);
+    }
+    return 0;
+}
+
+int snd_pcm_set_params(snd_pcm_t* pcm, int format, int access, unsigned int channels,
+                       unsigned int rate, int soft_resample, unsigned int latency) {
+    (void)soft_resample;
+    (void)latency;
+    /* Like alsa-lib, configure through the public hw_params call */
+    snd_pcm_hw_params_t params = {access, format, channels, rate};
+    return snd_pcm_hw_params(pcm, &params);
+}
+
+snd_pcm_sframes_t snd_pcm_writei(snd_pcm_t* pcm, const void* buffer, snd_pcm_uframes_t size) {
+    size_t bytes = size * pcm->params.channels * alsa_width(pcm->params.format);
+    if (pcm->plugin != NULL) {
+        pa_stream_write(pcm->plugin, buffer, bytes, NULL, 0, 0);
+    } else {
+        play(buffer, bytes);
+    }
+    return (snd_pcm_sframes_t)size;
+}
+
+snd_pcm_sframes_t snd_pcm_writen(snd_pcm_t* pcm, void** bufs, snd_pcm_uframes_t size) {
+    unsigned int channels = pcm->params.channels;
+    unsigned int width = alsa_width(pcm->params.format);
+    unsigned char* interleaved = malloc(size * channels * width);
+    for (snd_pcm_uframes_t i = 0; i < size; ++i) {
+        for (unsigned int c = 0; c < channels; ++c) {
+            memcpy(interleaved + (i * channels + c) * width, (unsigned char*)bufs[c] + i * width, width);
+        }
+    }
+    play(interleaved, size * channels * width);
+    free(interleaved);
+    return (snd_pcm_sframes_t)size;
+}
+
+int snd_pcm_close(snd_pcm_t* pcm) {
+    if (pcm->plugin != NULL && pcm->plugin != (pa_stream*)1) {
+        pa_stream_disconnect(pcm->plugin);
+        pa_stream_unref(pcm->plugin);
+    }
+    free(pcm);
+    return 0;
+}
+
+/* --- libpulse --------------------------------------------------------------- */
+
+struct pa_stream {
+    pa_sample_spec spec;
+};
+
+pa_stream* pa_stream_new(void* context, const char* name, const pa_sample_spec* ss, const void* map) {
+    (void)context;
+    (void)name;
+    (void)map;
+    pa_stream* s = calloc(1, sizeof(pa_stream));
+    s->spec = *ss;
+    return s;
+}
+
+int pa_stream_connect_playback(pa_stream* s, const char* dev, const void* attr, int flags,
+                               const void* volume, pa_stream* sync_stream) {
+    (void)s;
+    (void)dev;
+    (void)attr;
+    (void)flags;
+    (void)volume;
+    (void)sync_stream;
+    return 0;
+}
+
+int pa_stream_disconnect(pa_stream* s) {
+    (void)s;
+    return 0;
+}
+
+const pa_sample_spec* pa_stream_get_sample_spec(pa_stream* s) { return &s->spec; }
+
+int pa_stream_write(pa_stream* s, const void* data, size_t nbytes, pa_free_cb_t free_cb,
+                    int64_t offset, int seek) {
+    (void)s;
+    (void)offset;
+    (void)seek;
+    play(data, nbytes);
+    if (free_cb != NULL) free_cb((void*)data);
+    return 0;
+}
+
+void pa_stream_unref(pa_stream* s) { free(s); }
+
+/* --- PipeWire --------------------------------------------------------------- */
+
+#define FAKE_PW_BUFFER_BYTES 65536
+
+struct pw_stream {
+    int direction;
+    struct pw_buffer buffer;
+    struct spa_buffer spa;
+    struct spa_data data;
+    struct spa_chunk chunk;
+    unsigned char memory[FAKE_PW_BUFFER_BYTES];
+};
+
+struct pw_stream* pw_stream_new(void* core, const char* name, void* props) {
+    (void)core;
+    (void)name;
+    (void)props;
+    struct pw_stream* stream = calloc(1, sizeof(struct pw_stream));
+    stream->data.data = stream->memory;
+    stream->data.maxsize = FAKE_PW_BUFFER_BYTES;
+    stream->data.chunk = &stream->chunk;
+    stream->spa.n_datas = 1;
+    stream->spa.datas = &stream->data;
+    stream->buffer.buffer = &stream->spa;
+    return stream;
+}
+
+int pw_stream_connect(struct pw_stream* stream, int direction, uint32_t target_id, int flags,
+                      const struct spa_pod** params, uint32_t n_params) {
+    (void)target_id;
+    (void)flags;
+    (void)params;
+    (void)n_params;
+    stream->direction = direction;
+    return 0;
+}
+
+struct pw_buffer* pw_stream_dequeue_buffer(struct pw_stream* stream) { return &stream->buffer; }
+
+int pw_stream_queue_buffer(struct pw_stream* stream, struct pw_buffer* buffer) {
+    struct spa_data* d = &buffer->buffer->datas[0];
+    play((unsigned char*)d->data + d->chunk->offset, d->chunk->size);
+    (void)stream;
+    return 0;
+}
+
+void pw_stream_destroy(struct pw_stream* stream) { free(stream); }
@@ -0,0 +1,115 @@
+/*
+ * Minimal stand-ins for the ALSA, libpulse and PipeWire playback APIs.
+ *
+ * Only the calls the test player makes are declared; the struct layouts the
+ * preload shim reads (pa_sample_spec, pw_buffer/spa_buffer/spa_data/
+ * spa_chunk) match the real ABI.
+ */
+#ifndef PROCTAP_FAKE_AUDIO_H
+#define PROCTAP_FAKE_AUDIO_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* ALSA */
+typedef struct _snd_pcm snd_pcm_t;
+typedef struct _snd_pcm_hw_params snd_pcm_hw_params_t;
+typedef unsigned long snd_pcm_uframes_t;
+typedef long snd_pcm_sframes_t;
+
+#define SND_PCM_STREAM_PLAYBACK 0
+#define SND_PCM_ACCESS_RW_INTERLEAVED 3
+#define SND_PCM_ACCESS_RW_NONINTERLEAVED 4
+#define SND_PCM_FORMAT_S16_LE 2
+#define SND_PCM_FORMAT_S24_LE 6
+#define SND_PCM_FORMAT_S32_LE 10
+#define SND_PCM_FORMAT_FLOAT_LE 14
+#define SND_PCM_FORMAT_S24_3LE 32
+
+int snd_pcm_open(snd_pcm_t** pcm, const char* name, int stream, int mode);
+int snd_pcm_hw_params_malloc(snd_pcm_hw_params_t** params);
+void snd_pcm_hw_params_free(snd_pcm_hw_params_t* params);
+int snd_pcm_hw_params_any(snd_pcm_t* pcm, snd_pcm_hw_params_t* params);
+int snd_pcm_hw_params_set_access(snd_pcm_t* pcm, snd_pcm_hw_params_t* params, int access);
+int snd_pcm_hw_params_set_format(snd_pcm_t* pcm, snd_pcm_hw_params_t* params, int format);
+int snd_pcm_hw_params_set_channels(snd_pcm_t* pcm, snd_pcm_hw_params_t* params, unsigned int channels);
+int snd_pcm_hw_params_set_rate_near(snd_pcm_t* pcm, snd_pcm_hw_params_t* params, unsigned int* rate, int* dir);
+int snd_pcm_hw_params(snd_pcm_t* pcm, snd_pcm_hw_params_t* params);
+int snd_pcm_set_params(snd_pcm_t* pcm, int format, int access, unsigned int channels,
+                       unsigned int rate, int soft_resample, unsigned int latency);
+snd_pcm_sframes_t snd_pcm_writei(snd_pcm_t* pcm, const void* buffer, snd_pcm_uframes_t size);
+snd_pcm_sframes_t snd_pcm_writen(snd_pcm_t* pcm, void** bufs, snd_pcm_uframes_t size);
+int snd_pcm_close(snd_pcm_t* pcm);
+
+/* libpulse */
+typedef struct pa_stream pa_stream;
+typedef void (*pa_free_cb_t)(void* p);
+typedef struct pa_sample_spec {
+    int format;
+    uint32_t rate;
+    uint8_t channels;
+} pa_sample_spec;
+
+#define PA_SAMPLE_S16LE 3
+#define PA_SAMPLE_FLOAT32LE 5
+#define PA_SAMPLE_S32LE 7
+#define PA_SAMPLE_S24LE 9
+#define PA_SAMPLE_S24_32LE 11
+
+pa_stream* pa_stream_new(void* context, const char* name, const pa_sample_spec* ss, const void* map);
+int pa_stream_connect_playback(pa_stream* s, const char* dev, const void* attr, int flags,
+                               const void* volume, pa_stream* sync_stream);
+int pa_stream_disconnect(pa_stream* s);
+const pa_sample_spec* pa_stream_get_sample_spec(pa_stream* s);
+int pa_stream_write(pa_stream* s, const void* data, size_t nbytes, pa_free_cb_t free_cb,
+                    int64_t offset, int seek);
+void pa_stream_unref(pa_stream* s);
+
+/* PipeWire / SPA */
+struct spa_pod {
+    uint32_t size;
+    uint32_t type;
+};
+struct spa_chunk {
+    uint32_t offset;
+    uint32_t size;
+    int32_t stride;
+    int32_t flags;
+};
+struct spa_data {
+    uint32_t type;
+    uint32_t flags;
+    int64_t fd;
+    uint32_t mapoffset;
+    uint32_t maxsize;
+    void* data;
+    struct spa_chunk* chunk;
+};
+struct spa_buffer {
+    uint32_t n_metas;
+    uint32_t n_datas;
+    void* metas;
+    struct spa_data* datas;
+};
+struct pw_buffer {
+    struct spa_buffer* buffer;
+    void* user_data;
+    uint64_t size;
+};
+struct pw_stream;
+
+#define PW_DIRECTION_OUTPUT 1
+#define SPA_AUDIO_FORMAT_S16_LE 0x103
+#define SPA_AUDIO_FORMAT_S24_32_LE 0x107
+#define SPA_AUDIO_FORMAT_S32_LE 0x10b
+#define SPA_AUDIO_FORMAT_S24_LE 0x10f
+#define SPA_AUDIO_FORMAT_F32_LE 0x11b
+
+struct pw_stream* pw_stream_new(void* core, const char* name, void* props);
+int pw_stream_connect(struct pw_stream* stream, int direction, uint32_t target_id, int flags,
+                      const struct spa_pod** params, uint32_t n_params);
+struct pw_buffer* pw_stream_dequeue_buffer(struct pw_stream* stream);
+int pw_stream_queue_buffer(struct pw_stream* stream, struct pw_buffer* buffer);
+void pw_stream_destroy(struct pw_stream* stream);
+
+#endif /* PROCTAP_FAKE_AUDIO_H */
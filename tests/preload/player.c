@@ -0,0 +1,197 @@
+/*
+ * Small test player for the preload shim.
+ *
+ * Plays a stereo-phase sine through one playback API, the way typical
+ * clients use it:
+ *
+ *   player <api> <rate> <channels> <format> <frames> [block_frames] [streams]
+ *
+ *   api:    alsa | alsa-writen | alsa-set-params | alsa-pulse | pulse | pipewire
+ *   format: s16 | s24 | s24_32 | s32 | f32
+ *
+ * Channel c carries sin(2*pi*440*t) * (c % 2 ? -0.5 : 0.5). With streams > 1
+ * the signal is played that many times, each on a newly opened stream that
+ * is closed afterwards (like a player moving to the next track).
+ */
+#include "fake_audio.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+enum { S16, S24, S24_32, S32, F32 };
+
+static int parse_format(const char* name) {
+    if (strcmp(name, "s16") == 0) return S16;
+    if (strcmp(name, "s24") == 0) return S24;
+    if (strcmp(name, "s24_32") == 0) return S24_32;
+    if (strcmp(name, "s32") == 0) return S32;
+    if (strcmp(name, "f32") == 0) return F32;
+    return -1;
+}
+
+static unsigned int width(int format) {
+    return format == S16 ? 2 : format == S24 ? 3 : 4;
+}
+
+static void encode(int format, double x, unsigned char* out) {
+    if (format == S16) {
+        int16_t v = (int16_t)lrint(x * 32767.0);
+        memcpy(out, &v, 2);
+    } else if (format == S24 || format == S24_32) {
+        int32_t v = (int32_t)lrint(x * 8388607.0);
+        memcpy(out, &v, format == S24 ? 3 : 4);  /* Little-endian: low 3 bytes */
+    } else if (format == S32) {
+        int32_t v = (int32_t)lrint(x * 2147483647.0);
+        memcpy(out, &v, 4);
+    } else {
+        float v = (float)x;
+        memcpy(out, &v, 4);
+    }
+}
+
+static double sample(unsigned long frame, unsigned int channel, unsigned int rate) {
+    double x = sin(2.0 * M_PI * 440.0 * (double)frame / rate);
+    return (channel % 2 ? -0.5 : 0.5) * x;
+}
+
+static int alsa_format(int format) {
+    static const int formats[] = {
+        SND_PCM_FORMAT_S16_LE, SND_PCM_FORMAT_S24_3LE, SND_PCM_FORMAT_S24_LE,
+        SND_PCM_FORMAT_S32_LE, SND_PCM_FORMAT_FLOAT_LE,
+    };
+    return formats[format];
+}
+
+static int pulse_format(int format) {
+    static const int formats[] = {
+        PA_SAMPLE_S16LE, PA_SAMPLE_S24LE, PA_SAMPLE_S24_32LE, PA_SAMPLE_S32LE, PA_SAMPLE_FLOAT32LE,
+    };
+    return formats[format];
+}
+
+static uint32_t spa_format(int format) {
+    static const uint32_t formats[] = {
+        SPA_AUDIO_FORMAT_S16_LE, SPA_AUDIO_FORMAT_S24_LE, SPA_AUDIO_FORMAT_S24_32_LE,
+        SPA_AUDIO_FORMAT_S32_LE, SPA_AUDIO_FORMAT_F32_LE,
+    };
+    return formats[format];
+}
+
+/* EnumFormat object pod like spa_format_audio_raw_build(); the rate is
+ * wrapped in a (single-value) choice to exercise choice parsing */
+static const struct spa_pod* build_format_pod(uint32_t* pod, uint32_t format, uint32_t rate, uint32_t channels) {
+    uint32_t* p = pod + 2;
+    *p++ = 0x40003;  /* SPA_TYPE_OBJECT_Format */
+    *p++ = 3;        /* SPA_PARAM_EnumFormat */
+    /* key, flags, value pod {size, type}, value, pad */
+    const uint32_t ids[][2] = {{1, 1}, {2, 1}, {0x10001, format}};  /* mediaType audio, subtype raw, format */
+    for (int i = 0; i < 3; ++i) {
+        *p++ = ids[i][0]; *p++ = 0; *p++ = 4; *p++ = 3; *p++ = ids[i][1]; *p++ = 0;
+    }
+    /* rate: Choice(None) { u32 type, u32 flags, child {4, Int}, value } */
+    *p++ = 0x10003; *p++ = 0; *p++ = 20; *p++ = 19;
+    *p++ = 0; *p++ = 0; *p++ = 4; *p++ = 4; *p++ = rate; *p++ = 0;
+    *p++ = 0x10004; *p++ = 0; *p++ = 4; *p++ = 4; *p++ = channels; *p++ = 0;
+    pod[0] = (uint32_t)((p - pod - 2) * 4);
+    pod[1] = 15;  /* SPA_TYPE_Object */
+    return (const struct spa_pod*)pod;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 6) {
+        fprintf(stderr, "usage: %s <api> <rate> <channels> <format> <frames> [block_frames] [streams]\n", argv[0]);
+        return 2;
+    }
+    const char* api = argv[1];
+    unsigned int rate = (unsigned int)atoi(argv[2]);
+    unsigned int channels = (unsigned int)atoi(argv[3]);
+    int format = parse_format(argv[4]);
+    unsigned long frames = strtoul(argv[5], NULL, 10);
+    unsigned long block = argc > 6 ? strtoul(argv[6], NULL, 10) : 480;
+    unsigned long streams = argc > 7 ? strtoul(argv[7], NULL, 10) : 1;
+    if (format < 0 || channels == 0 || rate == 0 || block == 0 || streams == 0) {
+        fprintf(stderr, "invalid arguments\n");
+        return 2;
+    }
+
+    unsigned int w = width(format);
+    unsigned char* interleaved = malloc(block * channels * w);
+    unsigned char* planes = malloc(block * channels * w);
+    void* plane_ptrs[64];
+
+    for (unsigned long round = 0; round < streams; ++round) {
+        snd_pcm_t* pcm = NULL;
+        pa_stream* stream = NULL;
+        struct pw_stream* pw = NULL;
+
+        if (strncmp(api, "alsa", 4) == 0) {
+            snd_pcm_open(&pcm, strcmp(api, "alsa-pulse") == 0 ? "pulse" : "default", SND_PCM_STREAM_PLAYBACK, 0);
+            int access = strcmp(api, "alsa-writen") == 0 ? SND_PCM_ACCESS_RW_NONINTERLEAVED : SND_PCM_ACCESS_RW_INTERLEAVED;
+            if (strcmp(api, "alsa-set-params") == 0) {
+                snd_pcm_set_params(pcm, alsa_format(format), access, channels, rate, 1, 100000);
+            } else {
+                snd_pcm_hw_params_t* params;
+                snd_pcm_hw_params_malloc(&params);
+                snd_pcm_hw_params_any(pcm, params);
+                snd_pcm_hw_params_set_access(pcm, params, access);
+                snd_pcm_hw_params_set_format(pcm, params, alsa_format(format));
+                snd_pcm_hw_params_set_channels(pcm, params, channels);
+                snd_pcm_hw_params_set_rate_near(pcm, params, &rate, NULL);
+                snd_pcm_hw_params(pcm, params);
+                snd_pcm_hw_params_free(params);
+            }
+        } else if (strcmp(api, "pulse") == 0) {
+            pa_sample_spec spec = {pulse_format(format), rate, (uint8_t)channels};
+            stream = pa_stream_new(NULL, "player", &spec, NULL);
+            pa_stream_connect_playback(stream, NULL, NULL, 0, NULL, NULL);
+        } else if (strcmp(api, "pipewire") == 0) {
+            uint32_t pod[64];
+            const struct spa_pod* params[1] = {build_format_pod(pod, spa_format(format), rate, channels)};
+            pw = pw_stream_new(NULL, "player", NULL);
+            pw_stream_connect(pw, PW_DIRECTION_OUTPUT, 0xffffffff, 0, params, 1);
+        } else {
+            fprintf(stderr, "unknown api '%s'\n", api);
+            return 2;
+        }
+
+        for (unsigned long start = 0; start < frames; start += block) {
+            unsigned long n = frames - start < block ? frames - start : block;
+            for (unsigned long i = 0; i < n; ++i) {
+                for (unsigned int c = 0; c < channels; ++c) {
+                    double x = sample(start + i, c, rate);
+                    encode(format, x, interleaved + (i * channels + c) * w);
+                    encode(format, x, planes + (c * block + i) * w);
+                }
+            }
+
+            if (strcmp(api, "alsa-writen") == 0) {
+                for (unsigned int c = 0; c < channels && c < 64; ++c) plane_ptrs[c] = planes + c * block * w;
+                snd_pcm_writen(pcm, plane_ptrs, n);
+            } else if (pcm != NULL) {
+                snd_pcm_writei(pcm, interleaved, n);
+            } else if (stream != NULL) {
+                pa_stream_write(stream, interleaved, n * channels * w, NULL, 0, 0);
+            } else {
+                struct pw_buffer* b = pw_stream_dequeue_buffer(pw);
+                struct spa_data* d = &b->buffer->datas[0];
+                memcpy(d->data, interleaved, n * channels * w);
+                d->chunk->offset = 0;
+                d->chunk->size = (uint32_t)(n * channels * w);
+                d->chunk->stride = (int32_t)(channels * w);
+                pw_stream_queue_buffer(pw, b);
+            }
+        }
+
+        if (pcm != NULL) snd_pcm_close(pcm);
+        if (stream != NULL) {
+            pa_stream_disconnect(stream);
+            pa_stream_unref(stream);
+        }
+        if (pw != NULL) pw_stream_destroy(pw);
+    }
+    free(interleaved);
+    free(planes);
+    return 0;
+}
@@ -0,0 +1,223 @@
+"""
+Tests for the host-wide block grid.
+
+Uses an injectable fake clock so alignment is deterministic.
+"""
+
+import threading
+
+import numpy as np
+import pytest
+
+from proctap.grid import BlockGrid
+
+
+class FakeClock:
+    """Manually advanced clock."""
+
+    def __init__(self) -> None:
+        self.now = 0.0
+
+    def __call__(self) -> float:
+        return self.now
+
+
+def make_chunk(frames: int, value: float, channels: int = 2) -> bytes:
+    """Create an interleaved float32 chunk filled with a constant value."""
+    return np.full(frames * channels, value, dtype=np.float32).tobytes()
+
+
+class TestBlockShape:
+    """Test that blocks are uniformly sized regardless of chunk sizes."""
+
+    def test_invalid_block_frames(self):
+        with pytest.raises(ValueError):
+            BlockGrid(block_frames=0)
+
+    def test_irregular_chunks_are_reblocked(self):
+        clock = FakeClock()
+        grid = BlockGrid(block_frames=480, clock=clock)
+        stream = grid.add_stream("a")
+
+        # 441 + 1024 + 235 = 1700 frames delivered in irregular chunks
+        for frames in (441, 1024, 235):
+            clock.now += frames / 48000
+            stream.push(make_chunk(frames, 0.5), timestamp=0.0 + frames / 48000)
+
+        blocks = [grid.tick() for _ in range(3)]
+        for block in blocks:
+            assert block.data.shape == (1, 480, 2)
+            assert block.data.dtype == np.float32
+        assert [b.start_frame for b in blocks] == [0, 480, 960]
+
+    def test_all_streams_share_one_array(self):
+        clock = FakeClock()
+        grid = BlockGrid(block_frames=256, clock=clock)
+        a = grid.add_stream("a")
+        b = grid.add_stream("b")
+        a.push(make_chunk(256, 0.25), timestamp=256 / 48000)
+        b.push(make_chunk(256, -0.25), timestamp=256 / 48000)
+
+        block = grid.tick()
+        assert block.names == ("a", "b")
+        assert block.data.shape == (2, 256, 2)
+        np.testing.assert_allclose(block.stream("a"), 0.25)
+        np.testing.assert_allclose(block.stream("b"), -0.25)
+
+    def test_duplicate_stream_name(self):
+        grid = BlockGrid()
+        grid.add_stream("a")
+        with pytest.raises(ValueError, match="already registered"):
+            grid.add_stream("a")
+
+
+class TestUnderrunOverrun:
+    """Test zero-fill on underrun and oldest-drop on overrun."""
+
+    def test_underrun_zero_fills(self):
+        clock = FakeClock()
+        grid = BlockGrid(block_frames=480, clock=clock)
+        stream = grid.add_stream("a")
+        stream.push(make_chunk(100, 1.0), timestamp=100 / 48000)
+
+        block = grid.tick()
+        assert block.underruns == ("a",)
+        np.testing.assert_allclose(block.stream("a")[:100], 1.0)
+        np.testing.assert_allclose(block.stream("a")[100:], 0.0)
+        assert stream.stats['underruns'] == 1
+
+    def test_push_after_underrun_is_not_lost(self):
+        clock = FakeClock()
+        grid = BlockGrid(block_frames=480, clock=clock)
+        stream = grid.add_stream("a")
+        stream.push(make_chunk(480, 0.5), timestamp=480 / 48000)
+        grid.tick()
+        assert grid.tick().underruns == ("a",)
+        assert stream._write_pos == 480  # Producer position left alone
+
+        stream.push(make_chunk(480, 0.25), timestamp=3 * 480 / 48000)
+        assert stream.available == 480
+        np.testing.assert_allclose(grid.tick().stream("a"), 0.25)
+
+    def test_overrun_drops_oldest(self):
+        clock = FakeClock()
+        grid = BlockGrid(block_frames=100, ring_blocks=2, clock=clock)
+        stream = grid.add_stream("a")
+        stream.push(make_chunk(100, 0.1), timestamp=100 / 48000)
+        stream.push(make_chunk(100, 0.2), timestamp=200 / 48000)
+        stream.push(make_chunk(100, 0.3), timestamp=300 / 48000)
+
+        assert stream.stats['overruns'] == 1
+        assert stream.available == 200
+        np.testing.assert_allclose(grid.tick().stream("a"), 0.2)
+        np.testing.assert_allclose(grid.tick().stream("a"), 0.3)
+
+
+class TestAlignment:
+    """Test grid alignment of streams that start at different times."""
+
+    def test_late_stream_gets_lead_in(self):
+        clock = FakeClock()
+        grid = BlockGrid(block_frames=480, clock=clock)
+        early = grid.add_stream("early")
+        late = grid.add_stream("late")
+
+        # Early stream starts at grid frame 0
+        early.push(make_chunk(960, 0.5), timestamp=960 / 48000)
+        # Late stream's first frame lands at grid frame 240.5
+        late.push(make_chunk(720, 0.5), timestamp=(240.5 + 720) / 48000)
+
+        block = grid.tick()
+        np.testing.assert_allclose(block.stream("early"), 0.5)
+        # 240 frames of lead-in silence, then audio
+        np.testing.assert_allclose(block.stream("late")[:240], 0.0)
+        np.testing.assert_allclose(block.stream("late")[240:], 0.5)
+        assert late.fractional_offset == pytest.approx(0.5)
+
+    def test_lead_in_clamped_to_ring(self, caplog):
+        clock = FakeClock()
+        grid = BlockGrid(block_frames=100, ring_blocks=4, clock=clock)
+        stream = grid.add_stream("a")
+        # First frame would land at grid frame 1000, beyond the 400 frame ring
+        with caplog.at_level("WARNING", logger="proctap.grid"):
+            stream.push(make_chunk(100, 0.5), timestamp=1100 / 48000)
+        assert "clamping lead-in to 300 frames" in caplog.text
+        assert stream.stats['dropped_frames'] == 0
+
+        blocks = [grid.tick().stream("a") for _ in range(4)]
+        np.testing.assert_allclose(np.concatenate(blocks[:3]), 0.0)
+        np.testing.assert_allclose(blocks[3], 0.5)
+
+    def test_stream_added_after_ticks(self):
+        clock = FakeClock()
+        grid = BlockGrid(block_frames=480, clock=clock)
+        for _ in range(4):
+            grid.tick()
+
+        stream = grid.add_stream("a")
+        # Arrives exactly on the start of tick 4
+        stream.push(make_chunk(480, 0.75), timestamp=(4 * 480 + 480) / 48000)
+        block = grid.tick()
+        assert block.start_frame == 4 * 480
+        np.testing.assert_allclose(block.stream("a"), 0.75)
+
+
+class TestDeadline:
+    """Tick deadlines leave room for late delivery."""
+
+    @staticmethod
+    def run_late_producer(lead_ms):
+        """Tick at each deadline; chunk k (value k + 1) arrives 3ms after capture."""
+        clock = FakeClock()
+        grid = BlockGrid(block_frames=480, clock=clock, lead_ms=lead_ms)
+        stream = grid.add_stream("a")
+        pushed = 0
+        blocks = []
+        for tick in range(10):
+            clock.now = grid.deadline(tick)
+            while (pushed + 1) * 0.01 + 0.003 <= clock.now:
+                stream.push(make_chunk(480, pushed + 1.0), timestamp=(pushed + 1) * 0.01)
+                pushed += 1
+            block = grid.tick()
+            blocks.append((block.underruns, float(block.stream("a").mean())))
+        return blocks
+
+    def test_late_producer_within_lead(self):
+        assert self.run_late_producer(lead_ms=5.0) == [((), k + 1.0) for k in range(10)]
+
+    def test_late_producer_without_lead(self):
+        # The first block underruns and every later block is one block late
+        blocks = self.run_late_producer(lead_ms=0.0)
+        assert blocks[0] == (("a",), 0.0)
+        assert blocks[1:] == [((), float(k)) for k in range(1, 10)]
+
+    def test_deadline(self):
+        grid = BlockGrid(block_frames=480, clock=FakeClock(), lead_ms=2.0)
+        assert grid.deadline(0) == pytest.approx(0.012)
+        assert grid.deadline(9) == pytest.approx(0.102)
+        with pytest.raises(ValueError):
+            BlockGrid(lead_ms=-1.0)
+
+
+class TestTickThread:
+    """Test the background tick thread."""
+
+    def test_start_stop_delivers_blocks(self):
+        grid = BlockGrid(block_frames=48)  # 1ms blocks
+        grid.add_stream("a")
+        received = []
+        done = threading.Event()
+
+        def on_block(block):
+            received.append(block)
+            if len(received) >= 5:
+                done.set()
+
+        grid.start(on_block)
+        try:
+            assert done.wait(timeout=2.0)
+        finally:
+            grid.stop()
+
+        ticks = [b.tick for b in received[:5]]
+        assert ticks == list(range(5))
@@ -0,0 +1,232 @@
+"""
+Tests for cgroup v2 isolation.
+
+Most tests run against a fake cgroup filesystem in a temporary directory;
+writes are recorded so thread migrations can be checked. The live test only
+runs inside a delegated cgroup (e.g. systemd-run --user --scope -p
+Delegate=yes pytest ...).
+"""
+
+import threading
+from pathlib import Path
+
+import pytest
+
+from proctap import ProcessAudioCapture, cgroups
+from proctap.backends.synthetic import SyntheticBackend
+from proctap.cgroups import CgroupIsolation, CpuLimits, parse_pressure
+
+PRESSURE = (
+    "some avg10=1.50 avg60=0.75 avg300=0.10 total=123456\n"
+    "full avg10=0.50 avg60=0.25 avg300=0.00 total=4567\n"
+)
+
+
+@pytest.fixture
+def fake(tmp_path, monkeypatch):
+    """Fake /proc and cgroup2 mount with a delegated /app.scope."""
+    proc = tmp_path / "proc"
+    (proc / "self").mkdir(parents=True)
+    mount = tmp_path / "cgroup"
+    (proc / "self" / "mounts").write_text(
+        "proc /proc proc rw 0 0\n"
+        "cgroup /sys/fs/cgroup/cpu cgroup rw,cpu 0 0\n"
+        f"cgroup2 {mount} cgroup2 rw,nsdelegate 0 0\n"
+    )
+    (proc / "self" / "cgroup").write_text("1:cpu:/\n0::/app.scope\n")
+    base = mount / "app.scope"
+    base.mkdir(parents=True)
+    (base / "cgroup.controllers").write_text("cpu memory io\n")
+    (base / "cgroup.subtree_control").write_text("")
+    (base / "cgroup.threads").write_text("100\n101\n")
+
+    writes = []
+    original = CgroupIsolation._write
+
+    def record(path, value):
+        writes.append((str(Path(path).relative_to(base)), value))
+        original(path, value)
+
+    monkeypatch.setattr(CgroupIsolation, "_write", staticmethod(record))
+    return {"proc": str(proc), "base": base, "writes": writes}
+
+
+def make(fake, **kwargs):
+    return CgroupIsolation(proc_root=fake["proc"], **kwargs)
+
+
+class TestParsing:
+    """PSI parsing and cgroup discovery."""
+
+    def test_parse_pressure(self):
+        pressure = parse_pressure(PRESSURE)
+        assert pressure.some.avg10 == 1.5
+        assert pressure.some.total_us == 123456
+        assert pressure.full is not None and pressure.full.avg60 == 0.25
+
+    def test_parse_pressure_some_only(self):
+        assert parse_pressure("some avg10=0.00 avg60=0.00 avg300=0.00 total=0\n").full is None
+
+    @pytest.mark.parametrize("text", ["", "full avg10=0 avg60=0 avg300=0 total=0", "some avg10=x"])
+    def test_parse_pressure_invalid(self, text):
+        with pytest.raises(ValueError):
+            parse_pressure(text)
+
+    def test_discovery(self, fake):
+        assert cgroups.current_cgroup(fake["proc"]) == "/app.scope"
+        assert cgroups.find_cgroup2_mount(fake["proc"]) == fake["base"].parent
+        assert make(fake).base == fake["base"]
+
+    def test_cpu_max(self):
+        assert CpuLimits().cpu_max == "max 100000"
+        assert CpuLimits(max_percent=250.0).cpu_max == "250000 100000"
+        assert CpuLimits(max_percent=50.0, period_us=20000).cpu_max == "10000 20000"
+
+    @pytest.mark.parametrize("kwargs", [{'weight': 0}, {'weight': 10001}, {'max_percent': 0.0}, {'period_us': 10}])
+    def test_invalid_limits(self, kwargs):
+        with pytest.raises(ValueError):
+            CpuLimits(**kwargs)
+
+
+class TestCgroupIsolation:
+    """Setup, thread placement, stats and teardown on the fake filesystem."""
+
+    def test_setup(self, fake):
+        isolation = make(fake, groups={"capture": CpuLimits(weight=1000), "workers": CpuLimits(weight=20, max_percent=150.0)})
+        assert isolation.is_delegated()
+        isolation.setup()
+        assert isolation.active
+        assert isolation.groups == ["main", "capture", "workers"]
+
+        writes = fake["writes"]
+        assert ("proctap-capture/cgroup.type", "threaded") in writes
+        # Every thread moves to main before the controller is enabled
+        enable = writes.index(("cgroup.subtree_control", "+cpu"))
+        assert writes.index(("proctap-main/cgroup.threads", "100")) < enable
+        assert writes.index(("proctap-main/cgroup.threads", "101")) < enable
+        assert ("proctap-capture/cpu.weight", "1000") in writes
+        assert ("proctap-workers/cpu.weight", "20") in writes
+        assert ("proctap-workers/cpu.max", "150000 100000") in writes
+        assert ("proctap-main/cpu.max", "max 100000") in writes
+
+    def test_not_delegated(self, fake):
+        (fake["base"] / "cgroup.controllers").write_text("memory io\n")
+        isolation = make(fake)
+        assert "cpu controller" in isolation.check_delegation()
+        with pytest.raises(RuntimeError):
+            isolation.setup()
+        assert not (fake["base"] / "proctap-main").exists()
+
+    def test_unknown_cgroup(self, tmp_path):
+        isolation = CgroupIsolation(proc_root=str(tmp_path))
+        assert not isolation.is_delegated()
+
+    def test_failed_setup_is_undone(self, fake):
+        (fake["base"] / "proctap-workers" / "cpu.max").mkdir(parents=True)  # Write fails
+        isolation = make(fake)
+        with pytest.raises(RuntimeError):
+            isolation.setup()
+        assert not isolation.active
+        assert ("cgroup.subtree_control", "-cpu") in fake["writes"]
+
+    def test_join_and_placed(self, fake):
+        isolation = make(fake)
+        with pytest.raises(RuntimeError):
+            isolation.join("workers")
+        isolation.setup()
+        tid = str(threading.get_native_id())
+        fake["writes"].clear()
+
+        with isolation.placed("workers"):
+            assert fake["writes"] == [("proctap-workers/cgroup.threads", tid)]
+        assert fake["writes"][-1] == ("proctap-main/cgroup.threads", tid)
+
+        isolation.join("capture")
+        with isolation.placed("workers"):
+            pass
+        assert fake["writes"][-1] == ("proctap-capture/cgroup.threads", tid)
+        with pytest.raises(KeyError):
+            isolation.join("realtime")
+
+    def test_stats(self, fake):
+        isolation = make(fake)
+        isolation.setup()
+        capture = fake["base"] / "proctap-capture"
+        (capture / "cpu.pressure").write_text(PRESSURE)
+        (capture / "cpu.stat").write_text("usage_usec 5000\nuser_usec 4000\nnr_throttled 3\nthrottled_usec 700\n")
+
+        stats = isolation.stats()
+        assert set(stats) == {"main", "capture", "workers"}
+        assert stats["capture"]["cpu.pressure"].some.avg10 == 1.5
+        assert stats["capture"]["usage_usec"] == 5000
+        assert stats["capture"]["nr_throttled"] == 3
+        assert stats["capture"]["throttled_usec"] == 700
+        assert "memory.pressure" not in stats["capture"]
+        assert stats["main"] == {}
+
+    def test_close_moves_threads_back(self, fake):
+        isolation = make(fake)
+        isolation.setup()
+        fake["writes"].clear()
+        isolation.close()
+        assert not isolation.active
+        assert ("cgroup.threads", "101") in fake["writes"]  # Last thread moved to main
+        assert ("cgroup.subtree_control", "-cpu") in fake["writes"]
+        isolation.close()
+
+
+class TestProcessWide:
+    """enable()/disable() and capture placement."""
+
+    def test_capture_threads_start_in_capture_group(self, fake):
+        isolation = cgroups.enable(proc_root=fake["proc"])
+        try:
+            assert cgroups.active() is isolation
+            with pytest.raises(RuntimeError):
+                cgroups.enable(proc_root=fake["proc"])
+
+            tid = str(threading.get_native_id())
+            fake["writes"].clear()
+            tap = ProcessAudioCapture(0, backend=SyntheticBackend())
+            tap.start()
+            tap.close()
+            assert fake["writes"] == [
+                ("proctap-capture/cgroup.threads", tid),
+                ("proctap-main/cgroup.threads", tid),
+            ]
+        finally:
+            cgroups.disable()
+        assert cgroups.active() is None
+        cgroups.disable()
+
+    def test_capture_without_isolation(self, fake):
+        tap = ProcessAudioCapture(0, backend=SyntheticBackend())
+        tap.start()
+        tap.close()
+        assert fake["writes"] == []
+
+
+live = CgroupIsolation(prefix="proctap-test-")
+
+
+@pytest.mark.skipif(not live.is_delegated(), reason=f"no delegated cgroup v2: {live.check_delegation()}")
+class TestLive:
+    """Against the real cgroup filesystem."""
+
+    def test_workers_group(self):
+        live.setup()
+        try:
+            placed = {}
+
+            def work():
+                live.join("workers")
+                placed["cgroup"] = Path("/proc/thread-self/cgroup").read_text()
+
+            thread = threading.Thread(target=work)
+            thread.start()
+            thread.join()
+            assert placed["cgroup"].strip().endswith("/proctap-test-workers")
+            assert "cpu.pressure" in live.stats()["workers"]
+        finally:
+            live.close()
+        assert not (live.base / "proctap-test-workers").exists()
@@ -161,6 +161,67 @@ class TestVectorizedChannelConversion:
         assert np.allclose(result_array[:, 2], right, atol=1)
         assert np.allclose(result_array[:, 3], right, atol=1)
 
+    def resampler_inputs(self, converter):
+        """Record the shape of every array the converter hands to its resampler."""
+        shapes = []
+        resample = converter._resample
+
+        def spy(audio, src_rate, dst_rate):
+            shapes.append(audio.shape)
+            return resample(audio, src_rate, dst_rate)
+
+        converter._resample = spy
+        return shapes
+
+    def test_upmix_resamples_before_channel_conversion(self):
+        """Mono -> stereo with resampling resamples the single channel, then upmixes."""
+        def make():
+            return AudioConverter(
+                src_rate=44100, src_channels=1, src_width=4,
+                dst_rate=48000, dst_channels=2, dst_width=4,
+                src_format=SampleFormat.FLOAT32,
+                dst_format=SampleFormat.FLOAT32,
+                auto_detect_format=False
+            )
+
+        converter = make()
+        reference = make()
+        reference._resample_first = False  # Unoptimized order: upmix, then resample
+        shapes = self.resampler_inputs(converter)
+
+        mono = (0.5 * np.sin(2 * np.pi * 440 * np.arange(4410) / 44100)).astype(np.float32)
+        result = np.frombuffer(converter.convert(mono.tobytes()), dtype=np.float32).reshape(-1, 2)
+        expected = np.frombuffer(reference.convert(mono.tobytes()), dtype=np.float32).reshape(-1, 2)
+
+        assert shapes == [(4410,)]
+        assert abs(len(result) - 4800) <= 1
+        np.testing.assert_array_equal(result[:, 0], result[:, 1])
+        np.testing.assert_allclose(result, expected, atol=1e-6)
+
+    def test_downmix_before_resampling(self):
+        """Stereo -> mono downmixes first, so only one channel is resampled."""
+        def make():
+            return AudioConverter(
+                src_rate=44100, src_channels=2, src_width=2,
+                dst_rate=48000, dst_channels=1, dst_width=2,
+                auto_detect_format=False
+            )
+
+        converter = make()
+        reference = make()
+        reference._resample_first = True  # Unoptimized order: resample both channels, then downmix
+        shapes = self.resampler_inputs(converter)
+
+        left = (np.sin(2 * np.pi * 440 * np.arange(4410) / 44100) * 16000).astype(np.int16)
+        right = (np.sin(2 * np.pi * 660 * np.arange(4410) / 44100) * 16000).astype(np.int16)
+        pcm_bytes = np.stack([left, right], axis=1).tobytes()
+        result = np.frombuffer(converter.convert(pcm_bytes), dtype=np.int16)
+        expected = np.frombuffer(reference.convert(pcm_bytes), dtype=np.int16)
+
+        assert shapes == [(4410,)]
+        assert len(result) == len(expected)
+        assert np.abs(result.astype(np.int32) - expected).max() <= 1
+
 
 class TestOptimized24BitPCM:
     """Test optimization 1.3: Optimize 24-bit PCM conversion with numpy array views."""
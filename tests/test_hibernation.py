@@ -0,0 +1,423 @@
+"""
+Tests for idle-stream hibernation (ActivityDetector, HibernationPolicy and
+ProcessAudioCapture with a hibernation policy).
+"""
+
+import subprocess
+import threading
+import time
+from typing import Optional
+from unittest import mock
+
+import numpy as np
+import pytest
+
+from proctap import HibernationPolicy, ProcessAudioCapture
+from proctap.backends import linux
+from proctap.backends.base import AudioBackend
+from proctap.backends.converter import SampleFormat
+from proctap.backends.synthetic import SyntheticBackend
+from proctap.hibernation import ActivityDetector
+
+
+def wait_for(condition, timeout=2.0):
+    deadline = time.monotonic() + timeout
+    while not condition():
+        if time.monotonic() > deadline:
+            return False
+        time.sleep(0.002)
+    return True
+
+
+class TestActivityDetector:
+    """Peak detection on native formats and pre-roll."""
+
+    def test_peak_formats(self):
+        detector = ActivityDetector()
+        assert detector.peak(np.array([0, -32768, 100], dtype=np.int16).tobytes(), SampleFormat.INT16) == 1.0
+        assert detector.peak(np.array([2 ** 30], dtype=np.int32).tobytes(), SampleFormat.INT32) == 0.5
+        assert detector.peak(np.array([0.25, -0.75], dtype=np.float32).tobytes()) == 0.75
+        packed = (-(2 ** 21)).to_bytes(4, 'little', signed=True)[:3] + (1000).to_bytes(3, 'little')
+        assert detector.peak(packed, SampleFormat.INT24) == 0.25
+        assert detector.peak(b'') == 0.0
+        with pytest.raises(ValueError):
+            detector.peak(b'\0\0', 'int8')
+
+    def test_threshold(self):
+        detector = ActivityDetector(threshold_db=-60.0)
+        assert not detector.is_active(np.full(64, 0.0005, dtype=np.float32).tobytes())
+        assert detector.is_active(np.full(64, 0.002, dtype=np.float32).tobytes())
+        assert not detector.is_active(np.full(64, 16, dtype=np.int16).tobytes(), SampleFormat.INT16)
+        assert detector.is_active(np.full(64, 100, dtype=np.int16).tobytes(), SampleFormat.INT16)
+
+    def test_feed_keeps_bounded_preroll(self):
+        detector = ActivityDetector(threshold_db=-60.0, preroll_ms=10.0)
+        silence = np.zeros((300, 2), dtype=np.int16).tobytes()
+        for _ in range(5):
+            assert detector.feed(silence, SampleFormat.INT16, channels=2, sample_rate=48000) is None
+        assert detector.preroll_bytes == 480 * 4
+
+        onset = np.full((300, 2), 1000, dtype=np.int16).tobytes()
+        pcm = detector.feed(onset, SampleFormat.INT16, channels=2, sample_rate=48000)
+        assert pcm == bytes(480 * 4) + onset
+        assert detector.preroll_bytes == 0
+
+    def test_hold_keeps_active_chunks_as_preroll(self):
+        detector = ActivityDetector(preroll_ms=10.0)
+        onset = np.full(960, 0.5, dtype=np.float32).tobytes()
+        detector.hold = True
+        assert detector.feed(onset) is None
+        assert detector.preroll_bytes == 480 * 8
+        detector.hold = False
+        assert detector.feed(onset) == onset[-480 * 8:] + onset
+
+    def test_no_preroll(self):
+        detector = ActivityDetector(preroll_ms=0.0)
+        assert detector.feed(bytes(64)) is None
+        assert detector.preroll_bytes == 0
+
+
+class TestHibernationPolicy:
+    """Parameter validation."""
+
+    @pytest.mark.parametrize("kwargs", [
+        {'idle_ms': 0.0},
+        {'threshold_db': 3.0},
+        {'preroll_ms': -1.0},
+        {'state_poll_ms': 0.0},
+    ])
+    def test_invalid(self, kwargs):
+        with pytest.raises(ValueError):
+            HibernationPolicy(**kwargs)
+
+
+class QueueBackend(AudioBackend):
+    """Backend without hibernation support returning prepared chunks."""
+
+    def __init__(self, chunks):
+        super().__init__(0)
+        self.chunks = list(chunks)
+
+    def start(self) -> None:
+        pass
+
+    def stop(self) -> None:
+        pass
+
+    def read(self) -> Optional[bytes]:
+        return self.chunks.pop(0) if self.chunks else None
+
+    def get_format(self) -> dict[str, int | str]:
+        return {}
+
+
+class TestDefaultReadActivity:
+    """AudioBackend.read_activity() default for backends without overrides."""
+
+    def test_returns_preroll_and_onset(self):
+        silence = bytes(8 * 480)
+        onset = np.full(960, 0.5, dtype=np.float32).tobytes()
+        backend = QueueBackend([silence, silence, onset])
+        detector = ActivityDetector(preroll_ms=5.0)
+        assert backend.read_activity(detector) is None
+        assert backend.read_activity(detector) is None
+        assert backend.read_activity(detector) == bytes(8 * 240) + onset
+        assert backend.read_activity(detector) is None
+
+
+class UnparkedBackend(SyntheticBackend):
+    """Synthetic backend that keeps capturing while muted."""
+
+    def park(self) -> bool:
+        return False
+
+
+class StatePollBackend(SyntheticBackend):
+    """Synthetic backend recording the threads that query the mute state."""
+
+    def __init__(self, **kwargs):
+        super().__init__(**kwargs)
+        self.state_threads = set()
+
+    def is_muted(self) -> Optional[bool]:
+        self.state_threads.add(threading.current_thread())
+        return super().is_muted()
+
+
+class TestCaptureHibernation:
+    """ProcessAudioCapture with a hibernation policy."""
+
+    def make(self, backend, **policy):
+        chunks = []
+        tap = ProcessAudioCapture(
+            0,
+            on_data=lambda data, frames: chunks.append((time.monotonic(), data)),
+            backend=backend,
+            hibernation=HibernationPolicy(**policy),
+        )
+        return tap, chunks
+
+    def test_silent_stream_hibernates_and_releases_converter(self):
+        backend = SyntheticBackend(signal='silence', source_rate=44100, source_format=SampleFormat.INT16)
+        tap, chunks = self.make(backend, idle_ms=50.0)
+        tap.start()
+        try:
+            assert wait_for(lambda: tap.is_hibernating)
+            assert backend._converter is None
+            delivered = len(chunks)
+            time.sleep(0.1)
+            assert len(chunks) == delivered
+            assert backend.frames_generated > 0  # Still probing
+        finally:
+            tap.close()
+        assert not tap.is_hibernating
+        assert backend._converter is not None
+
+    def test_wakes_within_one_chunk_with_preroll(self):
+        backend = SyntheticBackend(signal='silence', chunk_ms=10.0)
+        tap, chunks = self.make(backend, idle_ms=30.0, preroll_ms=20.0)
+        tap.start()
+        try:
+            assert wait_for(lambda: tap.is_hibernating)
+            time.sleep(0.05)  # Fill the pre-roll
+            chunks.clear()
+            onset = time.monotonic()
+            backend.set_signal('sine')
+            assert wait_for(lambda: len(chunks) > 0)
+            woke_at, first = chunks[0]
+            assert not tap.is_hibernating
+        finally:
+            tap.close()
+
+        assert woke_at - onset < 0.1
+        audio = np.frombuffer(first, dtype=np.float32).reshape(-1, 2)
+        assert audio.shape[0] == 960 + 480  # Pre-roll plus the onset chunk
+        assert not audio[:960].any()
+        assert np.abs(audio[960:]).max() > 0.4
+
+    def test_active_stream_stays_awake(self):
+        backend = SyntheticBackend(signal='sine')
+        tap, chunks = self.make(backend, idle_ms=30.0)
+        tap.start()
+        try:
+            time.sleep(0.2)
+            assert not tap.is_hibernating
+        finally:
+            tap.close()
+        assert len(chunks) >= 10
+
+    def test_muted_stream_hibernates(self):
+        backend = SyntheticBackend(signal='sine')
+        backend.set_muted(True)
+        tap, chunks = self.make(backend, idle_ms=30.0, state_poll_ms=5.0)
+        tap.start()
+        try:
+            assert wait_for(lambda: tap.is_hibernating)
+            time.sleep(0.05)
+            assert tap.is_hibernating  # Signal present, but still muted
+            chunks.clear()
+            backend.set_muted(False)
+            assert wait_for(lambda: len(chunks) > 0)
+            assert not tap.is_hibernating
+        finally:
+            tap.close()
+
+    def test_muted_stream_is_parked(self):
+        backend = SyntheticBackend(signal='sine', chunk_ms=10.0)
+        backend.set_muted(True)
+        tap, chunks = self.make(backend, idle_ms=30.0, preroll_ms=20.0, state_poll_ms=5.0)
+        tap.start()
+        try:
+            assert wait_for(lambda: tap.is_parked)
+            assert tap.is_hibernating and backend.is_parked
+            generated = backend.frames_generated
+            time.sleep(0.1)
+            assert backend.frames_generated == generated  # Nothing captured
+            chunks.clear()
+            backend.set_muted(False)
+            assert wait_for(lambda: len(chunks) > 0)
+            assert not tap.is_parked and not backend.is_parked
+            first = chunks[0][1]
+        finally:
+            tap.close()
+
+        # Audio from before the park is not delivered as pre-roll
+        assert len(first) == 480 * 8
+
+    def test_stop_while_parked(self):
+        backend = SyntheticBackend(signal='sine')
+        backend.set_muted(True)
+        tap, _ = self.make(backend, idle_ms=30.0, state_poll_ms=1000.0)
+        tap.start()
+        try:
+            assert wait_for(lambda: tap.is_parked, timeout=4.0)
+        finally:
+            started = time.monotonic()
+            tap.close()
+        assert time.monotonic() - started < 0.5
+        assert not tap.is_running and not tap.is_parked
+
+    def test_stream_state_polled_off_capture_thread(self):
+        backend = StatePollBackend(signal='sine')
+        tap, _ = self.make(backend, state_poll_ms=5.0)
+        tap.start()
+        try:
+            worker = tap._thread
+            assert wait_for(lambda: len(backend.state_threads) > 0)
+            time.sleep(0.05)
+        finally:
+            tap.close()
+        assert worker not in backend.state_threads
+        assert not any(thread.is_alive() for thread in backend.state_threads)
+
+    def test_muted_stream_stays_hibernated_and_keeps_preroll(self):
+        backend = UnparkedBackend(signal='sine', chunk_ms=10.0)
+        backend.set_muted(True)
+        tap, chunks = self.make(backend, idle_ms=30.0, preroll_ms=20.0, state_poll_ms=5.0)
+        tap.start()
+        try:
+            assert wait_for(lambda: tap.is_hibernating)
+            time.sleep(0.05)
+            assert not tap.is_parked
+            assert backend._converter is None  # Muted audio never woke the backend
+            chunks.clear()
+            backend.set_muted(False)
+            assert wait_for(lambda: len(chunks) > 0)
+            first = chunks[0][1]
+        finally:
+            tap.close()
+
+        audio = np.frombuffer(first, dtype=np.float32).reshape(-1, 2)
+        assert audio.shape[0] == 960 + 480  # Pre-roll plus the chunk, nothing dropped
+        assert np.abs(audio[:960]).max() > 0.4
+
+    def test_stream_state_can_be_ignored(self):
+        backend = SyntheticBackend(signal='sine')
+        backend.set_muted(True)
+        tap, chunks = self.make(backend, idle_ms=30.0, use_stream_state=False)
+        tap.start()
+        try:
+            time.sleep(0.15)
+            assert not tap.is_hibernating
+        finally:
+            tap.close()
+
+
+class FakeStrategy:
+    """Restartable strategy recording the capture lifecycle."""
+
+    restartable = True
+
+    def __init__(self):
+        self.calls = []
+        self.queued = [b'a', b'b']
+        self.stream = True
+
+    def stop_capture(self):
+        self.calls.append('stop')
+
+    def find_process_stream(self, pid):
+        self.calls.append('find')
+        return self.stream
+
+    def start_capture(self):
+        self.calls.append('start')
+
+    def read_audio(self, timeout=0.1):
+        return self.queued.pop(0) if self.queued else None
+
+
+class TestLinuxParking:
+    """LinuxBackend.park()/unpark() stop and restart the strategy's capture."""
+
+    def make(self, strategy):
+        completed = subprocess.CompletedProcess([], 0, b"", b"")
+        with mock.patch("subprocess.run", return_value=completed):
+            backend = linux.LinuxBackend(1234, engine="pipewire", isolation="link")
+        backend._strategy = strategy
+        backend._is_running = True
+        return backend
+
+    def test_park_stops_capture_and_releases_queue(self):
+        strategy = FakeStrategy()
+        backend = self.make(strategy)
+        assert backend.park()
+        assert strategy.calls == ['stop'] and strategy.queued == []
+        assert backend.park()  # Already parked
+        assert strategy.calls == ['stop']
+
+        backend.unpark()
+        assert strategy.calls == ['stop', 'find', 'start']
+        backend.unpark()  # Not parked
+        assert strategy.calls == ['stop', 'find', 'start']
+
+    def test_unpark_after_stream_is_gone(self):
+        strategy = FakeStrategy()
+        backend = self.make(strategy)
+        backend.park()
+        strategy.stream = False
+        with pytest.raises(RuntimeError, match="1234"):
+            backend.unpark()
+        assert 'start' not in strategy.calls
+
+        strategy.stream = True
+        backend.unpark()
+        assert strategy.calls[-1] == 'start'
+
+    def test_strategy_without_restart_keeps_capturing(self):
+        strategy = FakeStrategy()
+        strategy.restartable = False
+        backend = self.make(strategy)
+        assert not backend.park()
+        assert strategy.calls == []
+
+    def test_stop_while_parked(self):
+        strategy = FakeStrategy()
+        backend = self.make(strategy)
+        backend.park()
+        backend.stop()
+        assert not backend._is_running and not backend._parked
+
+
+class FakePulse:
+    """pulsectl.Pulse stand-in recording which connection served a query."""
+
+    opened: list["FakePulse"] = []
+
+    def __init__(self, client_name):
+        self.client_name = client_name
+        self.closed = False
+        self.queries = 0
+        FakePulse.opened.append(self)
+
+    def sink_input_info(self, index):
+        self.queries += 1
+        volume = type('Volume', (), {'value_flat': 0.0 if index == 2 else 1.0})()
+        return type('SinkInput', (), {'mute': index == 1, 'volume': volume})()
+
+    def close(self):
+        self.closed = True
+
+
+class TestStreamState:
+    """Mute polls run on their own pulsectl connection."""
+
+    def test_dedicated_connection(self):
+        from proctap.backends.linux import _StreamState
+
+        FakePulse.opened = []
+        state = _StreamState(type('pulsectl', (), {'Pulse': FakePulse}), 'proctap-state')
+        assert state.muted(None) is None
+        assert FakePulse.opened == []  # Opened lazily by the first poll
+
+        assert state.muted(0) is False
+        assert state.muted(1) is True
+        assert state.muted(2) is True  # Zero volume
+        assert len(FakePulse.opened) == 1
+        connection = FakePulse.opened[0]
+        assert connection.client_name == 'proctap-state' and connection.queries == 3
+
+        state.close()
+        assert connection.closed
+        assert state.muted(0) is None
+        assert len(FakePulse.opened) == 1  # Not reopened after close()
@@ -0,0 +1,269 @@
+"""
+Tests for JACK native API bindings and the JackStrategy helpers.
+
+The ring buffer and port matching tests run everywhere. Integration tests
+start a local jackd with the dummy driver and are skipped if it is missing.
+"""
+
+import ctypes
+import os
+import shutil
+import subprocess
+import threading
+import time
+
+import numpy as np
+import pytest
+
+try:
+    from proctap.backends import jack_native
+except ImportError:
+    pytest.skip("JACK native bindings not available", allow_module_level=True)
+
+
+class TestJackAvailability:
+    """Test JACK library availability checks."""
+
+    def test_is_available(self):
+        """Test is_available() returns a boolean."""
+        assert isinstance(jack_native.is_available(), bool)
+
+    def test_library_loading(self):
+        """Test library loading succeeds or fails gracefully."""
+        if jack_native.is_available():
+            assert jack_native._jack_lib is not None
+            assert jack_native.JackRing is not None
+        else:
+            assert jack_native._jack_lib is None or jack_native.JackRing is None
+
+    def test_status_string(self):
+        """Test jack_status_t formatting."""
+        assert jack_native._get_status_string(0) == "Success"
+        msg = jack_native._get_status_string(0x01 | 0x10)
+        assert "JackFailure" in msg
+        assert "JackServerFailed" in msg
+
+
+PROCESS_CALLBACK = ctypes.CFUNCTYPE(ctypes.c_int, ctypes.c_uint32, ctypes.c_void_p)
+GET_BUFFER = ctypes.CFUNCTYPE(ctypes.c_void_p, ctypes.c_void_p, ctypes.c_uint32)
+
+
+@pytest.mark.skipif(jack_native.JackRing is None, reason="_pipeline extension not built")
+class TestJackRing:
+    """Test the native ring filled by the JACK process callback."""
+
+    def make(self, channels, capacity_frames):
+        """Ring over fake ports whose buffers are numpy arrays set per period."""
+        buffers = [np.zeros(0, dtype=np.float32)] * channels
+
+        @GET_BUFFER
+        def get_buffer(port, nframes):
+            return buffers[port - 1].ctypes.data
+
+        ring = jack_native.JackRing(
+            ports=list(range(1, channels + 1)),
+            capacity_frames=capacity_frames,
+            port_get_buffer=ctypes.cast(get_buffer, ctypes.c_void_p).value,
+        )
+        process = PROCESS_CALLBACK(ring.process_callback)
+
+        def run(*periods, _keep=get_buffer):  # Callback must outlive the ring
+            buffers[:] = [np.ascontiguousarray(p, dtype=np.float32) for p in periods]
+            assert process(len(buffers[0]), ring.process_arg) == 0
+
+        return ring, run
+
+    def test_interleaves_channel_buffers(self):
+        ring, run = self.make(channels=2, capacity_frames=16)
+        left = np.arange(4, dtype=np.float32)
+        right = -np.arange(4, dtype=np.float32)
+
+        run(left, right)
+        data = np.frombuffer(ring.read(), dtype=np.float32).reshape(-1, 2)
+        np.testing.assert_array_equal(data[:, 0], left)
+        np.testing.assert_array_equal(data[:, 1], right)
+
+    def test_wraparound(self):
+        ring, run = self.make(channels=1, capacity_frames=6)
+        run([1, 2, 3, 4])
+        ring.read(3)
+        run([5, 6, 7, 8])
+
+        data = np.frombuffer(ring.read(), dtype=np.float32)
+        np.testing.assert_array_equal(data, [4, 5, 6, 7, 8])
+
+    def test_overrun_drops_new_frames(self):
+        ring, run = self.make(channels=1, capacity_frames=4)
+        run(np.ones(3))
+        run(np.full(3, 2.0))
+
+        assert ring.overruns == 1
+        assert ring.available == 4
+        np.testing.assert_array_equal(np.frombuffer(ring.read(), dtype=np.float32), [1, 1, 1, 2])
+
+    def test_empty_read(self):
+        ring, _ = self.make(channels=2, capacity_frames=4)
+        assert ring.read() is None
+        assert not ring.wait(0.01)
+
+    def test_wait_and_wake(self):
+        ring, run = self.make(channels=1, capacity_frames=8)
+        run([1.0])
+        assert ring.wait(1.0)
+
+        ring.read()
+        threading.Timer(0.05, ring.wake).start()
+        start = time.monotonic()
+        assert not ring.wait(5.0)
+        assert time.monotonic() - start < 2.0
+
+    @pytest.mark.parametrize("kwargs", [
+        {'ports': [], 'capacity_frames': 4, 'port_get_buffer': 1},
+        {'ports': [0], 'capacity_frames': 4, 'port_get_buffer': 1},
+        {'ports': [1], 'capacity_frames': 0, 'port_get_buffer': 1},
+        {'ports': [1], 'capacity_frames': 4, 'port_get_buffer': 0},
+    ])
+    def test_invalid(self, kwargs):
+        with pytest.raises(ValueError):
+            jack_native.JackRing(**kwargs)
+
+
+class TestTargetSelection:
+    """Test finding the target application's JACK client."""
+
+    def make_clients(self):
+        return [
+            jack_native.JackClientInfo("system", ["system:capture_1"], pid=None),
+            jack_native.JackClientInfo("Ardour", ["Ardour:out_1", "Ardour:out_2"], pid=1234),
+            jack_native.JackClientInfo("mpv", ["mpv:out_0", "mpv:out_1"], pid=5678),
+            jack_native.JackClientInfo("proctap-1", ["proctap-1:x"], pid=os.getpid()),
+        ]
+
+    def test_group_ports_by_client(self):
+        grouped = jack_native.group_ports_by_client(
+            ["a:out_1", "b:out_1", "a:out_2", "malformed"]
+        )
+        assert grouped == {"a": ["a:out_1", "a:out_2"], "b": ["b:out_1"]}
+
+    def test_select_by_pid(self):
+        selected = jack_native.select_target_clients(self.make_clients(), pid=5678)
+        assert [c.name for c in selected] == ["mpv"]
+
+    def test_select_by_client_name(self):
+        selected = jack_native.select_target_clients(self.make_clients(), client_name="Ardour")
+        assert [c.name for c in selected] == ["Ardour"]
+
+    def test_select_by_client_regex(self):
+        selected = jack_native.select_target_clients(self.make_clients(), client_name="A.*")
+        assert [c.name for c in selected] == ["Ardour"]
+
+    def test_exclude_own_client(self):
+        selected = jack_native.select_target_clients(
+            self.make_clients(), pid=os.getpid(), exclude=("proctap-1",)
+        )
+        assert selected == []
+
+    def test_select_by_process_name_fallback(self):
+        """Servers without PID reporting are matched by process name."""
+        with open(f"/proc/{os.getpid()}/comm") as f:
+            comm = f.read().strip()
+        clients = [jack_native.JackClientInfo(comm, [f"{comm}:out"], pid=None)]
+
+        selected = jack_native.select_target_clients(clients, pid=os.getpid())
+        assert [c.name for c in selected] == [comm]
+
+    def test_no_match(self):
+        assert jack_native.select_target_clients(self.make_clients(), pid=999999) == []
+
+    def test_plan_connections(self):
+        plan = jack_native.plan_connections
+        assert plan(["a:L", "a:R"], "tap", 2) == [("a:L", "tap:in_1"), ("a:R", "tap:in_2")]
+        assert plan(["a:mono"], "tap", 2) == [("a:mono", "tap:in_1"), ("a:mono", "tap:in_2")]
+        # Two stereo pairs fold left into left and right into right
+        assert plan(["a:L1", "a:R1", "a:L2", "a:R2"], "tap", 2) == [
+            ("a:L1", "tap:in_1"), ("a:R1", "tap:in_2"), ("a:L2", "tap:in_1"), ("a:R2", "tap:in_2"),
+        ]
+
+
+class _SineClient:
+    """Minimal JACK client that plays a constant value on two output ports."""
+
+    def __init__(self, name: str, value: float) -> None:
+        lib = jack_native._jack_lib
+        status = ctypes.c_int(0)
+        self.lib = lib
+        self.client = lib.jack_client_open(name.encode(), jack_native.JackNoStartServer, ctypes.byref(status))
+        assert self.client, jack_native._get_status_string(status.value)
+        self.ports = [
+            lib.jack_port_register(
+                self.client, f"out_{i}".encode(), jack_native.JACK_DEFAULT_AUDIO_TYPE,
+                jack_native.JackPortIsOutput, 0,
+            )
+            for i in (1, 2)
+        ]
+        self.value = value
+        self.cb = PROCESS_CALLBACK(self._process)
+        lib.jack_set_process_callback(self.client, self.cb, None)
+        assert lib.jack_activate(self.client) == 0
+
+    def _process(self, nframes, _arg):
+        for port in self.ports:
+            ptr = self.lib.jack_port_get_buffer(port, nframes)
+            np.ctypeslib.as_array((ctypes.c_float * nframes).from_address(ptr))[:] = self.value
+        return 0
+
+    def close(self):
+        self.lib.jack_deactivate(self.client)
+        self.lib.jack_client_close(self.client)
+
+
+@pytest.fixture
+def jackd_dummy():
+    """Run a local jackd with the dummy driver."""
+    jackd = shutil.which("jackd")
+    if jackd is None or not jack_native.is_available():
+        pytest.skip("jackd not available")
+
+    proc = subprocess.Popen(
+        [jackd, "--no-realtime", "-d", "dummy", "-r", "48000", "-p", "64"],
+        stdout=subprocess.DEVNULL,
+        stderr=subprocess.DEVNULL,
+    )
+    time.sleep(1.0)
+    if proc.poll() is not None:
+        pytest.skip("jackd failed to start")
+    yield
+    proc.terminate()
+    proc.wait(timeout=5)
+
+
+@pytest.mark.integration
+class TestJackIntegration:
+    """Integration tests against a local jackd (dummy driver)."""
+
+    def test_passive_capture_by_client_name(self, jackd_dummy):
+        player = _SineClient("proctap-test-player", 0.25)
+        capture = jack_native.JackClientCapture(channels=2, client_name="proctap-test-capture")
+        try:
+            capture.open()
+            assert capture.sample_rate == 48000
+            assert capture.period_frames == 64
+
+            ports = capture.find_target_ports(client_name="proctap-test-player")
+            assert ports == ["proctap-test-player:out_1", "proctap-test-player:out_2"]
+
+            capture.activate()
+            capture.connect_sources(ports)
+
+            received = b""
+            deadline = time.time() + 2.0
+            while len(received) < 4800 * 8 and time.time() < deadline:
+                received += capture.read(timeout=0.1) or b""
+
+            samples = np.frombuffer(received, dtype=np.float32)
+            assert samples.size > 0
+            # Skip the first periods captured before the connection was made
+            assert np.allclose(samples[-128:], 0.25)
+        finally:
+            capture.close()
+            player.close()
@@ -0,0 +1,245 @@
+"""
+Tests for latency accounting and compensation.
+
+Impulses from SyntheticBackend / the native synthetic source have known
+positions, so declared latency can be checked against where they come out.
+"""
+
+import time
+
+import numpy as np
+import pytest
+
+from proctap.backends import linux
+from proctap.backends.synthetic import SyntheticBackend
+from proctap.core import ProcessAudioCapture
+from proctap.latency import (
+    DelayLine,
+    LatencyCompensator,
+    LatencyReport,
+    LatencyStage,
+    impulse_delay,
+)
+from proctap.pipeline import (
+    NativePipeline,
+    NullSink,
+    PipelineSpec,
+    RawSink,
+    Resample,
+    SyntheticSource,
+    is_available,
+)
+
+native = pytest.mark.skipif(not is_available(), reason="_pipeline extension not built")
+
+
+def read_all(backend):
+    """Drain a non-realtime backend into a (frames, 2) array."""
+    backend.start()
+    chunks = []
+    while (data := backend.read()) is not None:
+        chunks.append(data)
+    return np.frombuffer(b"".join(chunks), dtype=np.float32).reshape(-1, 2)
+
+
+def impulse_positions(signal, interval):
+    """Impulse position in each interval-long window."""
+    return [impulse_delay(signal[start:start + interval]) for start in range(0, len(signal), interval)]
+
+
+class TestLatencyReport:
+    """Totals and helpers."""
+
+    def test_totals(self):
+        report = LatencyReport((LatencyStage('backend', 10.0, 2.5), LatencyStage('queue', buffered_ms=20.0)))
+        assert report.algorithmic_ms == 10.0
+        assert report.buffered_ms == 22.5
+        assert report.total_ms == 32.5
+        assert report.stage('queue') == LatencyStage('queue', 0.0, 20.0)
+        assert report.stage('missing') is None
+
+    def test_with_stage_appends(self):
+        report = LatencyReport((LatencyStage('backend', 10.0),))
+        extended = report.with_stage('encoder', algorithmic_ms=20.0)
+        assert extended.total_ms == 30.0
+        assert report.total_ms == 10.0
+        assert [s['name'] for s in extended.as_dict()['stages']] == ['backend', 'encoder']
+        assert "30.00 ms" in extended.describe()
+
+
+class TestImpulseDelay:
+    """Impulse locator used by the tests and converter measurement."""
+
+    def test_integer_position(self):
+        signal = np.zeros(100)
+        signal[37] = 1.0
+        assert impulse_delay(signal) == 37.0
+
+    def test_subsample_position(self):
+        t = np.arange(200)
+        signal = np.exp(-0.5 * ((t - 80.3) / 3.0) ** 2)
+        assert impulse_delay(signal) == pytest.approx(80.3, abs=0.05)
+
+    def test_first_impulse_wins(self):
+        signal = np.zeros((100, 2))
+        signal[20] = 0.8
+        signal[60] = 1.0
+        assert impulse_delay(signal) == 20.0
+
+    def test_silence(self):
+        assert impulse_delay(np.zeros(10)) is None
+
+
+class TestBackendLatency:
+    """Backends declare latency that matches impulse timing."""
+
+    def test_chunk_latency(self):
+        assert SyntheticBackend(chunk_ms=10.0).get_latency_ms() == pytest.approx(10.0)
+        assert SyntheticBackend(chunk_ms=25.0).get_latency_ms() == pytest.approx(25.0)
+
+    def test_converted_impulses_match_declared_latency(self):
+        backend = SyntheticBackend(
+            signal='impulse', impulse_interval=0.1, source_rate=44100, source_channels=1,
+            realtime=False, duration=0.5, chunk_ms=20.0,
+        )
+        positions = impulse_positions(read_all(backend), 4800)
+        converter_frames = backend.get_latency_ms() * 48 - 20.0 * 48
+        assert converter_frames >= 0.0
+        for position in positions:
+            assert position == pytest.approx(converter_frames, abs=1.0)
+
+
+class TestCaptureLatency:
+    """ProcessAudioCapture reports backend and live queue latency."""
+
+    def test_read_queue_depth(self):
+        backend = SyntheticBackend(realtime=False, duration=0.1)
+        tap = ProcessAudioCapture(pid=0, backend=backend)
+        tap.start()
+        deadline = time.monotonic() + 5.0
+        while tap.latency().buffered_ms < 100.0 and time.monotonic() < deadline:
+            time.sleep(0.01)
+        report = tap.latency()
+        assert report.stage('strategy') == LatencyStage('strategy', pytest.approx(10.0), 0.0)
+        assert report.stage('converter') == LatencyStage('converter', 0.0)
+        assert report.stage('read_queue').buffered_ms == pytest.approx(100.0)
+
+        tap.read(timeout=1.0)
+        assert tap.latency().buffered_ms == pytest.approx(90.0)
+        tap.close()
+
+    def test_converter_is_its_own_stage(self):
+        class ResamplingBackend(SyntheticBackend):
+            def get_conversion_latency_ms(self):
+                return 1.5  # scipy's polyphase resampler is zero-phase
+
+        backend = ResamplingBackend(chunk_ms=20.0)
+        report = ProcessAudioCapture(pid=0, on_data=lambda data, frames: None, backend=backend).latency()
+        assert report.stage('strategy').algorithmic_ms == pytest.approx(20.0)
+        assert report.stage('converter').algorithmic_ms == 1.5
+        assert report.algorithmic_ms == pytest.approx(21.5)
+        assert backend.get_latency_ms() == pytest.approx(21.5)
+
+    def test_callback_mode_excludes_read_queue(self):
+        tap = ProcessAudioCapture(pid=0, on_data=lambda data, frames: None, backend=SyntheticBackend())
+        assert tap.latency().stage('read_queue') is None
+        assert tap.latency(include_queue=True).stage('read_queue') is not None
+
+
+class FakeStreamCapture:
+    """pipewire_native.PipeWireStreamCapture stand-in."""
+
+    def __init__(self, sample_rate, channels, on_data):
+        self.on_data = on_data
+
+    def start(self, target_id, blocking):
+        pass
+
+
+class TestPipeWireNativeLatency:
+    """The native PipeWire strategy declares one quantum."""
+
+    def test_quantum(self, monkeypatch):
+        monkeypatch.setattr(linux, 'PIPEWIRE_NATIVE_AVAILABLE', True)
+        monkeypatch.setattr(linux, 'pipewire_native', type('pw', (), {'PipeWireStreamCapture': FakeStreamCapture}))
+        strategy = linux.PipeWireNativeStrategy(0)
+        assert strategy.get_latency_ms() == pytest.approx(1000.0 * 1024 / 48000)  # Default quantum
+
+        strategy.start_capture()
+        strategy._stream_capture.on_data(bytes(256 * 4), 256)
+        assert strategy.get_latency_ms() == pytest.approx(1000.0 * 256 / 48000)
+
+
+class FakeBranch:
+    """Branch that delays an impulse train by a known number of frames."""
+
+    def __init__(self, delay_frames):
+        self.delay = DelayLine(delay_frames, 2)
+        self.latency_ms = delay_frames / 48
+
+    def latency(self):
+        return LatencyReport((LatencyStage('backend', self.latency_ms),))
+
+
+class TestLatencyCompensator:
+    """Branches with different latency come out aligned."""
+
+    def test_aligns_impulses(self):
+        branches = {'fast': FakeBranch(30), 'slow': FakeBranch(250), 'mid': FakeBranch(96)}
+        compensator = LatencyCompensator.for_captures(branches)
+        assert compensator.delays == {'fast': 220, 'slow': 0, 'mid': 154}
+        assert compensator.latency_ms == pytest.approx(250 / 48)
+
+        source = read_all(SyntheticBackend(signal='impulse', impulse_interval=0.05, realtime=False, duration=0.3))
+        outputs = {name: [] for name in branches}
+        for start in range(0, len(source), 480):
+            block = source[start:start + 480]
+            for name, branch in branches.items():
+                outputs[name].append(compensator.process(name, branch.delay.process(block)))
+
+        aligned = {name: impulse_positions(np.concatenate(blocks), 2400) for name, blocks in outputs.items()}
+        assert aligned['fast'] == aligned['slow'] == aligned['mid'] == [250.0] * 6
+
+    def test_bytes_interface(self):
+        compensator = LatencyCompensator({'a': 0.0, 'b': 1.0})
+        pcm = np.ones((96, 2), dtype=np.float32).tobytes()
+        out = np.frombuffer(compensator.process_bytes('a', pcm), dtype=np.float32).reshape(-1, 2)
+        assert np.all(out[:48] == 0.0) and np.all(out[48:] == 1.0)
+        assert compensator.process_bytes('b', pcm) == pcm
+
+
+@native
+class TestNativePipelineLatency:
+    """Native stages declare their lookahead; output stays aligned."""
+
+    def test_declared_latency(self):
+        spec = PipelineSpec(
+            source=SyntheticSource(rate=48000, chunk_frames=960, duration=0.1),
+            stages=[Resample(16000)],
+            sinks=[NullSink()],
+        )
+        report = NativePipeline(spec, optimize=False).latency()
+        assert report.stage('source').algorithmic_ms == pytest.approx(20.0)
+        # Kaiser sinc: 16 zero crossings at a 1/3 cutoff = 48 input frames
+        assert report.stage('resample0').algorithmic_ms == pytest.approx(1.0)
+        assert report.total_ms == pytest.approx(21.0)
+        assert report.buffered_ms == 0.0
+
+    def test_resampled_impulses_stay_aligned(self, tmp_path):
+        path = tmp_path / "out.f32"
+        spec = PipelineSpec(
+            source=SyntheticSource(signal='impulse', rate=44100, channels=1, impulse_interval=0.1, duration=0.5),
+            stages=[Resample(48000)],
+            sinks=[RawSink(str(path))],
+        )
+        pipeline = NativePipeline(spec)
+        pipeline.start()
+        assert pipeline.wait(10.0)
+        pipeline.stop()
+
+        signal = np.fromfile(path, dtype=np.float32)
+        assert len(signal) == 24000
+        # Lookahead delays delivery, not position: impulses land on their timestamps
+        for position in impulse_positions(signal, 4800):
+            assert position == pytest.approx(0.0, abs=0.5)
+        assert pipeline.stats()['latency_ms'] == pytest.approx(pipeline.latency().total_ms)
@@ -0,0 +1,341 @@
+"""
+Tests for the native (Python-free) pipeline.
+
+Spec validation runs everywhere; runtime tests use the synthetic source and
+file sinks and are skipped when the _pipeline extension is not built.
+"""
+
+import os
+import struct
+import sys
+import time
+import wave
+from pathlib import Path
+
+import numpy as np
+import pytest
+
+from proctap.pipeline import (
+    Channels,
+    CommandSource,
+    Gain,
+    HighPass,
+    LowPass,
+    Meter,
+    NativePipeline,
+    NullSink,
+    PipelineSpec,
+    RawSink,
+    Resample,
+    SyntheticSource,
+    WavFileSource,
+    WavSink,
+    is_available,
+)
+
+native = pytest.mark.skipif(not is_available(), reason="_pipeline extension not built")
+
+
+def read_wav(path):
+    with wave.open(str(path), 'rb') as f:
+        data = np.frombuffer(f.readframes(f.getnframes()), dtype=np.int16)
+        return f.getframerate(), f.getnchannels(), data.reshape(-1, f.getnchannels()) / 32767.0
+
+
+def write_wav_header(path, channels, rate, bits=16, tag=1, data=b"\0" * 16):
+    """Hand-built WAV, so headers the wave module refuses can be tested."""
+    block = channels * bits // 8
+    fmt = struct.pack('<HHIIHH', tag, channels, rate, rate * block, block, bits)
+    body = b'WAVE' + b'fmt ' + struct.pack('<I', len(fmt)) + fmt + b'data' + struct.pack('<I', len(data)) + data
+    path.write_bytes(b'RIFF' + struct.pack('<I', len(body)) + body)
+
+
+def child_cmdlines():
+    """Command lines of this process' children (Linux /proc)."""
+    cmdlines = []
+    for stat in Path('/proc').glob('[0-9]*/stat'):
+        try:
+            if int(stat.read_text().rsplit(')', 1)[1].split()[1]) == os.getpid():
+                cmdlines.append(stat.with_name('cmdline').read_bytes().split(b'\0'))
+        except (OSError, ValueError, IndexError):
+            pass
+    return cmdlines
+
+
+def run(spec, timeout=10.0):
+    pipeline = NativePipeline(spec)
+    pipeline.start()
+    assert pipeline.wait(timeout)
+    events = pipeline.poll_events()
+    pipeline.stop()
+    return pipeline, events
+
+
+class TestPipelineSpec:
+    """Spec building and validation (no extension needed)."""
+
+    def test_to_dict(self):
+        spec = PipelineSpec(
+            source=SyntheticSource(rate=44100, channels=1, duration=1.0),
+            stages=[Resample(48000), Channels(2, name="up")],
+            sinks=[WavSink("out.wav")],
+        )
+        d = spec.to_dict()
+        assert d['source']['type'] == 'synthetic'
+        assert d['source']['rate'] == 44100
+        assert 'chunk_frames' not in d['source']  # None = native default
+        assert d['stages'] == [
+            {'type': 'resample', 'rate': 48000},
+            {'type': 'channels', 'channels': 2, 'name': 'up'},
+        ]
+        assert d['sinks'] == [{'type': 'wav', 'path': 'out.wav', 'format': 's16'}]
+
+    def test_command_argv_is_list(self):
+        d = CommandSource(argv=('cat', 'x.raw')).to_dict()
+        assert d['argv'] == ['cat', 'x.raw']
+
+    def test_requires_sink(self):
+        with pytest.raises(ValueError, match="sink"):
+            PipelineSpec(source=SyntheticSource()).to_dict()
+
+    def test_duplicate_names(self):
+        spec = PipelineSpec(
+            source=SyntheticSource(),
+            stages=[Gain(-6.0, name="a"), Meter(name="a")],
+            sinks=[NullSink()],
+        )
+        with pytest.raises(ValueError, match="Duplicate"):
+            spec.validate()
+
+    @pytest.mark.parametrize("node", [
+        SyntheticSource(signal='square'),  # type: ignore[arg-type]
+        SyntheticSource(rate=0),
+        Resample(0),
+        HighPass(cutoff_hz=-1.0),
+        Meter(interval_ms=0),
+        WavSink("x.wav", format='s24'),  # type: ignore[arg-type]
+    ])
+    def test_invalid_parameters(self, node):
+        with pytest.raises(ValueError):
+            node.validate()
+
+
+@native
+class TestNativePipeline:
+    """End-to-end runs with synthetic sources and file sinks."""
+
+    def test_resample_and_upmix_to_wav(self, tmp_path):
+        out = tmp_path / "out.wav"
+        spec = PipelineSpec(
+            source=SyntheticSource(frequency=1000.0, rate=44100, channels=1, duration=1.0),
+            stages=[Resample(48000), Channels(2)],
+            sinks=[WavSink(str(out))],
+        )
+        pipeline, _ = run(spec)
+
+        rate, channels, x = read_wav(out)
+        assert (rate, channels) == (48000, 2)
+        assert len(x) == 48000  # Resampler tail is flushed, length is exact
+        np.testing.assert_array_equal(x[:, 0], x[:, 1])
+
+        # Tone stays at 1kHz with its amplitude preserved
+        segment = x[4800:4800 + 24000, 0]
+        spectrum = np.abs(np.fft.rfft(segment * np.hanning(len(segment))))
+        assert np.argmax(spectrum) * 48000 / len(segment) == pytest.approx(1000.0, abs=2.0)
+        assert np.max(np.abs(segment)) == pytest.approx(0.5, abs=0.01)
+
+        stats = pipeline.stats()
+        assert stats['state'] == 'finished'
+        assert stats['frames_in'] == 44100
+        assert stats['frames_out'] == 48000
+        assert [s['type'] for s in stats['stages']] == ['resample', 'channels']
+        assert all(s['blocks'] == stats['blocks'] for s in stats['stages'])
+        assert stats['sinks'][0]['frames'] == 48000
+
+    def test_downmix_matches_converter_rule(self, tmp_path):
+        out = tmp_path / "out.raw"
+        src = tmp_path / "in.wav"
+        # 3 channels with distinct constant levels
+        frames = np.tile(np.array([[0.1, 0.2, 0.4]], dtype=np.float32), (480, 1))
+        with wave.open(str(src), 'wb') as f:
+            f.setnchannels(3)
+            f.setsampwidth(2)
+            f.setframerate(48000)
+            f.writeframes((frames * 32767).astype(np.int16).tobytes())
+
+        spec = PipelineSpec(
+            source=WavFileSource(str(src), chunk_frames=100),
+            stages=[Channels(2)],
+            sinks=[RawSink(str(out))],
+        )
+        run(spec)
+
+        y = np.fromfile(out, dtype=np.float32).reshape(-1, 2)
+        assert len(y) == 480
+        # First channel copied, last output channel = mean of the rest
+        np.testing.assert_allclose(y[0], [0.1, 0.3], atol=1e-3)
+
+    def test_meter_events(self):
+        spec = PipelineSpec(
+            source=SyntheticSource(amplitude=0.5, duration=1.0),
+            stages=[Gain(-6.0), Meter(interval_ms=100, name="level")],
+            sinks=[NullSink()],
+        )
+        _, events = run(spec)
+
+        types = [e['type'] for e in events]
+        assert types[0] == 'started'
+        assert types[-1] == 'finished'
+        meters = [e for e in events if e['type'] == 'meter']
+        assert len(meters) == 10
+        assert meters[0]['stage'] == 'level'
+        # 0.5 peak sine at -6dB: peak ~ -12dBFS, RMS 3dB below
+        assert meters[-1]['peak_db'][0] == pytest.approx(-12.0, abs=0.1)
+        assert meters[-1]['rms_db'][0] == pytest.approx(-15.0, abs=0.1)
+        assert len(meters[-1]['rms_db']) == 2
+
+    def test_filters_match_contrib(self, tmp_path):
+        from proctap.contrib.filters import HighPassFilter
+
+        out = tmp_path / "out.raw"
+        spec = PipelineSpec(
+            source=SyntheticSource(signal='noise', channels=1, duration=0.1, seed=3),
+            stages=[HighPass(300.0)],
+            sinks=[RawSink(str(out))],
+        )
+        unfiltered = tmp_path / "in.raw"
+        run(spec)
+        run(PipelineSpec(source=spec.source, sinks=[RawSink(str(unfiltered))]))
+
+        x = np.fromfile(unfiltered, dtype=np.float32)
+        y = np.fromfile(out, dtype=np.float32)
+        expected = HighPassFilter(cutoff_hz=300.0, sample_rate=48000).process(x.reshape(-1, 1))
+        np.testing.assert_allclose(y, expected.reshape(-1), atol=1e-4)
+
+    def test_lowpass_attenuates(self):
+        spec = PipelineSpec(
+            source=SyntheticSource(frequency=10000.0, channels=1, duration=0.5),
+            stages=[LowPass(500.0), Meter(interval_ms=500)],
+            sinks=[NullSink()],
+        )
+        _, events = run(spec)
+        meter = [e for e in events if e['type'] == 'meter'][0]
+        assert meter['rms_db'][0] < -30.0
+
+    def test_stop_realtime_pipeline(self):
+        spec = PipelineSpec(source=SyntheticSource(realtime=True), sinks=[NullSink()])
+        received = []
+        pipeline = NativePipeline(spec, on_event=received.append)
+        pipeline.start()
+        assert not pipeline.wait(0.2)
+        assert pipeline.stats()['state'] == 'running'
+        pipeline.stop()
+
+        assert pipeline.stats()['state'] == 'stopped'
+        assert [e['type'] for e in received] == ['started', 'stopped']
+        # Roughly realtime: 0.2s of waiting produced about 0.2s of audio
+        assert 0.1 * 48000 < pipeline.stats()['frames_in'] < 1.0 * 48000
+
+    def test_sink_open_error(self, tmp_path):
+        spec = PipelineSpec(
+            source=SyntheticSource(duration=0.1),
+            sinks=[WavSink(str(tmp_path / "missing" / "out.wav"))],
+        )
+        pipeline = NativePipeline(spec)
+        with pytest.raises(RuntimeError, match="cannot open"):
+            pipeline.start()
+
+    def test_missing_wav_source(self, tmp_path):
+        with pytest.raises(RuntimeError, match="cannot open"):
+            NativePipeline(PipelineSpec(
+                source=WavFileSource(str(tmp_path / "missing.wav")),
+                sinks=[NullSink()],
+            ))
+
+    @pytest.mark.parametrize("channels,rate,bits", [(0, 48000, 16), (1, 0, 16), (300, 48000, 16), (2, 48000, 8)])
+    def test_invalid_wav_header(self, tmp_path, channels, rate, bits):
+        src = tmp_path / "bad.wav"
+        write_wav_header(src, channels, rate, bits)
+        with pytest.raises(RuntimeError, match="unsupported"):
+            NativePipeline(PipelineSpec(source=WavFileSource(str(src)), sinks=[NullSink()]))
+
+    def test_huge_fmt_chunk_size(self, tmp_path):
+        # 40 bytes claiming a 4 GB fmt chunk must not be allocated up front
+        src = tmp_path / "huge.wav"
+        src.write_bytes(b'RIFF' + struct.pack('<I', 32) + b'WAVE' + b'fmt ' + struct.pack('<I', 0xFFFFFFF0) + bytes(20))
+        assert len(src.read_bytes()) == 40
+        start = time.monotonic()
+        with pytest.raises(RuntimeError, match="bad fmt chunk"):
+            NativePipeline(PipelineSpec(source=WavFileSource(str(src)), sinks=[NullSink()]))
+        assert time.monotonic() - start < 1.0
+
+    def test_int24_wav_source(self, tmp_path):
+        src = tmp_path / "in.wav"
+        values = np.array([0, 1, -1, 0x7FFFFF, -0x800000, -0x123456], dtype=np.int32)
+        pcm = b''.join(int(v).to_bytes(3, 'little', signed=True) for v in values)
+        write_wav_header(src, 1, 48000, bits=24, data=pcm)
+        out = tmp_path / "out.raw"
+
+        run(PipelineSpec(source=WavFileSource(str(src)), sinks=[RawSink(str(out))]))
+        np.testing.assert_array_equal(np.fromfile(out, dtype=np.float32), values / 8388608.0)
+
+    def test_reinit_replaces_pipeline(self):
+        native_pipeline = NativePipeline(PipelineSpec(source=SyntheticSource(realtime=True), sinks=[NullSink()]))
+        native_pipeline.start()
+        native_pipeline._native.__init__(PipelineSpec(source=SyntheticSource(duration=0.1), sinks=[NullSink()]).to_dict())
+        assert native_pipeline.stats()['state'] == 'idle'
+        native_pipeline.start()
+        assert native_pipeline.wait(10.0)
+        assert native_pipeline.stats()['frames_in'] == 4800
+
+    @pytest.mark.skipif(sys.platform == 'win32', reason="POSIX only")
+    def test_stop_blocked_command_source(self):
+        spec = PipelineSpec(source=CommandSource(argv=('sleep', '30')), sinks=[NullSink()])
+        pipeline = NativePipeline(spec)
+        pipeline.start()
+        assert not pipeline.wait(0.1)
+        start = time.monotonic()
+        pipeline.stop()
+        assert time.monotonic() - start < 5.0
+        assert pipeline.stats()['state'] == 'stopped'
+
+    @pytest.mark.skipif(sys.platform == 'win32', reason="POSIX only")
+    def test_stop_command_ignoring_sigterm(self):
+        spec = PipelineSpec(
+            source=CommandSource(argv=('sh', '-c', "trap '' TERM; exec sleep 30")),
+            sinks=[NullSink()],
+        )
+        pipeline = NativePipeline(spec)
+        pipeline.start()
+        assert not pipeline.wait(0.1)
+        start = time.monotonic()
+        pipeline.stop()
+        assert time.monotonic() - start < 5.0  # SIGKILL after the grace period
+        assert pipeline.stats()['state'] == 'stopped'
+
+    @pytest.mark.skipif(not sys.platform.startswith('linux'), reason="uses /proc")
+    def test_sink_open_error_stops_command(self, tmp_path):
+        spec = PipelineSpec(
+            source=CommandSource(argv=('sleep', '31')),
+            sinks=[WavSink(str(tmp_path / "missing" / "out.wav"))],
+        )
+        pipeline = NativePipeline(spec)
+        with pytest.raises(RuntimeError, match="cannot open"):
+            pipeline.start()
+        assert [b'sleep', b'31', b''] not in child_cmdlines()
+
+    @pytest.mark.skipif(sys.platform == 'win32', reason="POSIX only")
+    def test_command_source(self, tmp_path):
+        raw = tmp_path / "in.raw"
+        (np.arange(960, dtype=np.int16) - 480).tofile(raw)
+        out = tmp_path / "out.raw"
+
+        spec = PipelineSpec(
+            source=CommandSource(argv=('cat', str(raw)), rate=48000, channels=2, format='s16'),
+            sinks=[RawSink(str(out), format='s16')],
+        )
+        pipeline, events = run(spec)
+
+        assert events[-1]['type'] == 'finished'
+        np.testing.assert_array_equal(np.fromfile(out, dtype=np.int16), np.arange(960) - 480)
+        assert pipeline.stats()['frames_in'] == 480
@@ -0,0 +1,162 @@
+"""
+Tests for the cost-based pipeline planner.
+
+Planning is pure Python; the naive-vs-planned comparison runs the native
+pipeline and is skipped when the extension is not built.
+"""
+
+import numpy as np
+import pytest
+
+from proctap.pipeline import (
+    Channels,
+    Gain,
+    HighPass,
+    LowPass,
+    Meter,
+    NativePipeline,
+    NullSink,
+    PipelineSpec,
+    Resample,
+    SyntheticSource,
+    is_available,
+)
+from proctap.planner import (
+    channel_matrix,
+    consumer_chain,
+    estimate_cost,
+    optimize,
+    plan_stages,
+)
+
+native = pytest.mark.skipif(not is_available(), reason="_pipeline extension not built")
+
+
+class TestChannelMatrix:
+    """Mixing matrices follow AudioConverter's rules."""
+
+    def test_downmix_to_mono(self):
+        np.testing.assert_allclose(channel_matrix(4, 1), [[0.25, 0.25, 0.25, 0.25]])
+
+    def test_downmix_last_channel_is_mean_of_rest(self):
+        np.testing.assert_allclose(channel_matrix(3, 2), [[1, 0, 0], [0, 0.5, 0.5]])
+
+    def test_upmix_repeats_last_channel(self):
+        np.testing.assert_allclose(channel_matrix(2, 4), [[1, 0], [0, 1], [0, 1], [0, 1]])
+
+
+class TestCostModel:
+    """Cost estimates scale with rate and channel count."""
+
+    def test_filter_cost_scales_with_format(self):
+        stereo_48k = estimate_cost([HighPass()], 48000, 2)
+        mono_16k = estimate_cost([HighPass()], 16000, 1)
+        assert stereo_48k == pytest.approx(6 * mono_16k)
+
+    def test_cost_overrides(self):
+        assert estimate_cost([Gain(-3.0)], 48000, 1, costs={'gain': 2.0}) == 96000.0
+
+
+class TestPlanStages:
+    """Reordering and fusion rules."""
+
+    def test_transcription_consumer(self):
+        """44.1kHz stereo -> 16kHz mono consumer: downmix and decimate first."""
+        naive = consumer_chain([HighPass(120.0)], consumer_rate=16000, consumer_channels=1)
+        plan = plan_stages(naive, 44100, 2, approximate=True)
+
+        assert plan.stages == [Channels(1), Resample(16000), HighPass(120.0)]
+        assert plan.naive_stages == naive
+        assert plan.savings > 0.5
+        assert any("fuse resamplers" in step for step in plan.steps)
+
+    def test_no_change_returns_naive(self):
+        stages = [HighPass(120.0), Gain(-3.0)]
+        plan = plan_stages(stages, 48000, 2)
+        assert not plan.changed
+        assert plan.cost == plan.naive_cost
+        assert plan.steps == []
+
+    def test_upmix_moves_after_filters(self):
+        plan = plan_stages([Channels(6), HighPass(80.0), LowPass(2000.0)], 48000, 1)
+        assert plan.stages[-1] == Channels(6)
+
+    def test_gains_fuse_and_cancel(self):
+        plan = plan_stages([Gain(-6.0), HighPass(), Gain(6.0)], 48000, 2)
+        assert plan.stages == [HighPass()]
+
+    def test_meter_is_a_barrier(self):
+        stages = [Resample(48000), Meter(), Channels(1)]
+        plan = plan_stages(stages, 44100, 2)
+        assert plan.stages == stages
+
+    def test_channel_maps_fuse_only_when_equivalent(self):
+        # 2 -> 1 -> 2 is not the identity (channels are averaged)
+        plan = plan_stages([Channels(1), Channels(2)], 48000, 2)
+        assert plan.stages == [Channels(1), Channels(2)]
+        # 1 -> 2 -> 4 duplicates like 1 -> 4
+        plan = plan_stages([Channels(2), Channels(4)], 48000, 1)
+        assert plan.stages == [Channels(4)]
+
+    def test_band_limiting_resamplers_do_not_fuse(self):
+        # 48k -> 16k -> 48k band-limits to 8kHz; fusing would drop that
+        stages = [Resample(16000), Resample(48000)]
+        assert plan_stages(stages, 48000, 1).stages == stages
+
+    def test_high_cutoff_filter_does_not_cross_resampler(self):
+        plan = plan_stages([LowPass(7000.0), Resample(16000)], 48000, 1, approximate=True)
+        assert plan.stages == [LowPass(7000.0), Resample(16000)]
+
+    def test_exact_mode_keeps_filters_at_their_rate(self):
+        stages = [Resample(48000), HighPass(120.0), Resample(16000)]
+        approx = plan_stages(stages, 44100, 1, approximate=True)
+        exact = plan_stages(stages, 44100, 1, approximate=False)
+        assert approx.stages == [Resample(16000), HighPass(120.0)]
+        assert exact.stages == stages
+
+
+@native
+class TestPlanComparison:
+    """The planned order produces (nearly) the naive output, for less CPU."""
+
+    def spec(self):
+        return PipelineSpec(
+            source=SyntheticSource(rate=44100, channels=2, duration=1.0),
+            stages=consumer_chain([HighPass(120.0), Gain(-3.0)], 16000, 1),
+            sinks=[NullSink()],
+        )
+
+    def test_exact_rewrites_match(self):
+        plan = optimize(self.spec(), approximate=False, compare=True)
+        assert plan.changed
+        assert plan.comparison is not None
+        assert plan.comparison['snr_db'] > 60.0
+
+    def test_approximate_rewrites_are_close_and_cheaper(self):
+        plan = optimize(self.spec(), approximate=True, compare=True)
+        assert plan.comparison is not None
+        assert plan.comparison['snr_db'] > 30.0
+        assert plan.comparison['planned_ns'] < plan.comparison['naive_ns']
+
+    def test_native_pipeline_optimizes_by_default(self):
+        pipeline = NativePipeline(self.spec())
+        assert pipeline.plan is not None and pipeline.plan.changed
+        assert pipeline.get_format()['sample_rate'] == 16000
+        assert pipeline.get_format()['channels'] == 1
+
+        unplanned = NativePipeline(self.spec(), optimize=False)
+        assert unplanned.plan is None
+        assert unplanned.get_format() == pipeline.get_format()
+
+    def test_native_pipeline_approximate_is_opt_in(self):
+        def high_pass_rate(pipeline):
+            rate = 44100
+            for stage in pipeline.plan.stages:
+                if isinstance(stage, HighPass):
+                    return rate
+                if isinstance(stage, Resample):
+                    rate = stage.rate
+            raise AssertionError("no HighPass stage")
+
+        assert high_pass_rate(NativePipeline(self.spec())) == 48000  # As written
+        assert high_pass_rate(NativePipeline(self.spec(), approximate=True)) == 16000
@@ -0,0 +1,277 @@
+"""
+Tests for direct PipeWire port linking (PipeWireStrategy isolation="link").
+
+Graph parsing and port pairing run everywhere against a recorded pw-dump
+snapshot. The integration test needs a running (headless) PipeWire with
+pw-dump, pw-link and pw-record and is skipped otherwise.
+"""
+
+import shutil
+import subprocess
+import time
+from unittest import mock
+
+import pytest
+
+from proctap.backends import linux, pipewire_links
+from proctap.backends.linux import LinuxBackend
+from proctap.backends.pipewire_links import PortInfo
+
+
+def _node(node_id, pid, name, media_class):
+    return {
+        "id": node_id,
+        "type": "PipeWire:Interface:Node",
+        "info": {"props": {
+            "application.process.id": pid,
+            "node.name": name,
+            "media.class": media_class,
+        }},
+    }
+
+
+def _port(port_id, node_id, direction, channel, monitor=False):
+    return {
+        "id": port_id,
+        "type": "PipeWire:Interface:Port",
+        "info": {
+            "direction": direction,
+            "props": {
+                "node.id": node_id,
+                "port.name": f"{direction}_{channel}",
+                "audio.channel": channel,
+                "port.monitor": monitor,
+            },
+        },
+    }
+
+
+GRAPH = [
+    _node(40, 1234, "Firefox", "Stream/Output/Audio"),
+    _port(41, 40, "output", "FL"),
+    _port(42, 40, "output", "FR"),
+    _node(50, 1234, "Firefox mic", "Stream/Input/Audio"),
+    _node(60, None, "alsa_output.speakers", "Audio/Sink"),
+    _port(61, 60, "input", "FL"),
+    _port(62, 60, "input", "FR"),
+    _port(63, 60, "output", "FL", monitor=True),
+    _node(70, 999, "proctap_tap_1234", "Stream/Input/Audio"),
+    _port(72, 70, "input", "FR"),
+    _port(71, 70, "input", "FL"),
+]
+
+
+class TestGraphParsing:
+    """Test pw-dump snapshot parsing."""
+
+    def test_find_nodes_by_pid_only_playback_streams(self):
+        assert pipewire_links.find_nodes_by_pid(GRAPH, 1234) == [40]
+
+    def test_find_nodes_by_pid_no_match(self):
+        assert pipewire_links.find_nodes_by_pid(GRAPH, 4321) == []
+
+    def test_find_node_by_name(self):
+        assert pipewire_links.find_node_by_name(GRAPH, "proctap_tap_1234") == 70
+        assert pipewire_links.find_node_by_name(GRAPH, "missing") is None
+
+    def test_find_node_ports_sorted(self):
+        ports = pipewire_links.find_node_ports(GRAPH, 70, "input")
+        assert [p.id for p in ports] == [71, 72]
+        assert [p.channel for p in ports] == ["FL", "FR"]
+
+    def test_find_node_ports_skips_monitor(self):
+        assert pipewire_links.find_node_ports(GRAPH, 60, "output") == []
+
+    def test_dump_graph_error(self):
+        with mock.patch("subprocess.run", side_effect=FileNotFoundError("pw-dump")):
+            with pytest.raises(RuntimeError, match="pw-dump failed"):
+                pipewire_links.dump_graph()
+
+
+class TestPortPairing:
+    """Test source -> capture port pairing."""
+
+    def ports(self, direction, channels, base=1):
+        return [PortInfo(base + i, 0, direction, f"p{i}", ch) for i, ch in enumerate(channels)]
+
+    def test_pair_by_channel(self):
+        sources = self.ports("output", ["FR", "FL"])
+        sinks = self.ports("input", ["FL", "FR"], base=10)
+        pairs = [(s.channel, d.channel) for s, d in pipewire_links.pair_ports(sources, sinks)]
+        assert pairs == [("FL", "FL"), ("FR", "FR")]
+
+    def test_mono_fan_out(self):
+        sources = self.ports("output", ["MONO"])
+        sinks = self.ports("input", ["FL", "FR"], base=10)
+        pairs = pipewire_links.pair_ports(sources, sinks)
+        assert [(s.id, d.id) for s, d in pairs] == [(1, 10), (1, 11)]
+
+    def test_positional_fallback(self):
+        sources = self.ports("output", ["AUX0", "AUX1", "AUX2"])
+        sinks = self.ports("input", ["FL", "FR"], base=10)
+        pairs = pipewire_links.pair_ports(sources, sinks)
+        assert [(s.id, d.id) for s, d in pairs] == [(1, 10), (2, 11)]
+
+    def test_empty(self):
+        assert pipewire_links.pair_ports([], self.ports("input", ["FL"])) == []
+
+
+class TestPortLinker:
+    """Test pw-link invocation with a mocked subprocess."""
+
+    def completed(self, returncode=0, stderr=b""):
+        return subprocess.CompletedProcess([], returncode, b"", stderr)
+
+    def test_link_nodes(self):
+        linker = pipewire_links.PortLinker()
+        sinks = pipewire_links.find_node_ports(GRAPH, 70, "input")
+        with mock.patch("subprocess.run", return_value=self.completed()) as run:
+            assert pipewire_links.link_nodes(GRAPH, 40, sinks, linker) == 2
+
+        assert [c.args[0] for c in run.call_args_list] == [
+            ["pw-link", "41", "71"],
+            ["pw-link", "42", "72"],
+        ]
+        assert linker.links == [(41, 71), (42, 72)]
+
+    def test_existing_link_is_ok(self):
+        linker = pipewire_links.PortLinker()
+        with mock.patch("subprocess.run", return_value=self.completed(1, b"failed to link ports: File exists")):
+            linker.link(41, 71)
+        assert linker.links == [(41, 71)]
+
+    def test_link_failure(self):
+        linker = pipewire_links.PortLinker()
+        with mock.patch("subprocess.run", return_value=self.completed(1, b"No such port")):
+            with pytest.raises(pipewire_links.PipeWireLinkError, match="No such port"):
+                linker.link(41, 71)
+        assert linker.links == []
+
+    def test_unlink_all(self):
+        linker = pipewire_links.PortLinker()
+        with mock.patch("subprocess.run", return_value=self.completed()) as run:
+            linker.link(41, 71)
+            linker.unlink_all()
+        assert run.call_args_list[-1].args[0] == ["pw-link", "-d", "41", "71"]
+        assert linker.links == []
+
+    def test_node_without_outputs(self):
+        linker = pipewire_links.PortLinker()
+        with pytest.raises(pipewire_links.PipeWireLinkError):
+            pipewire_links.link_nodes(GRAPH, 50, [], linker)
+
+
+class TestLinkIsolation:
+    """isolation="link" never silently becomes a null-sink move."""
+
+    def completed(self, returncode=0):
+        return subprocess.CompletedProcess([], returncode, b"", b"")
+
+    def test_invalid_isolation(self):
+        with pytest.raises(ValueError, match="isolation"):
+            LinuxBackend(1234, isolation="remap")
+
+    @pytest.mark.parametrize("engine", ["pulse", "pipewire-native", "jack"])
+    def test_link_rejects_other_engines(self, engine):
+        with pytest.raises(ValueError, match="link"):
+            LinuxBackend(1234, engine=engine, isolation="link")
+
+    def test_link_requires_pipewire_server(self):
+        with mock.patch.object(linux, "detect_audio_server", return_value="pulseaudio"):
+            with pytest.raises(RuntimeError, match="PipeWire"):
+                LinuxBackend(1234, isolation="link")
+
+    def test_auto_link_uses_subprocess_strategy(self):
+        with mock.patch.object(linux, "detect_audio_server", return_value="pipewire"), \
+                mock.patch.object(linux, "PIPEWIRE_NATIVE_AVAILABLE", True), \
+                mock.patch("subprocess.run", return_value=self.completed()):
+            backend = LinuxBackend(1234, isolation="link")
+        assert isinstance(backend._strategy, linux.PipeWireStrategy)
+        assert backend._strategy._isolation == "link"
+
+    def test_link_does_not_fall_back_to_pulse(self):
+        with mock.patch("subprocess.run", return_value=self.completed(1)):
+            with pytest.raises(RuntimeError, match="pw-record"):
+                LinuxBackend(1234, engine="pipewire", isolation="link")
+
+    def strategy(self):
+        with mock.patch("subprocess.run", return_value=self.completed()):
+            strategy = linux.PipeWireStrategy(1234, isolation="link")
+        strategy._pulse = mock.Mock()
+        strategy._pulse.sink_input_list.return_value = []
+        return strategy
+
+    def test_stream_found_without_sink_input(self):
+        strategy = self.strategy()
+        with mock.patch.object(pipewire_links, "dump_graph", return_value=GRAPH):
+            assert strategy.find_process_stream(1234)
+        assert strategy._target_nodes == [40]
+        assert strategy._sink_input_index is None
+
+    def test_link_failure_does_not_fall_back(self):
+        strategy = self.strategy()
+        strategy._target_nodes = [40]
+        strategy._sink_input_index = 7
+        with mock.patch.object(strategy, "_setup_linked_capture", side_effect=RuntimeError("no ports")):
+            with pytest.raises(RuntimeError, match="linked capture"):
+                strategy.start_capture()
+        strategy._pulse.module_load.assert_not_called()
+
+
+def _pipewire_running():
+    if not all(shutil.which(cmd) for cmd in ("pw-dump", "pw-link", "pw-record", "pw-play")):
+        return False
+    try:
+        pipewire_links.dump_graph()
+        return True
+    except Exception:
+        return False
+
+
+@pytest.mark.integration
+@pytest.mark.skipif(not _pipewire_running(), reason="PipeWire not running")
+class TestPipeWireLinkIntegration:
+    """Integration test against a running (headless) PipeWire."""
+
+    def test_tap_player_without_rerouting(self, tmp_path):
+        import wave
+
+        wav = tmp_path / "tone.wav"
+        with wave.open(str(wav), "wb") as f:
+            f.setnchannels(2)
+            f.setsampwidth(2)
+            f.setframerate(48000)
+            f.writeframes(b"\x00\x10" * 2 * 48000 * 5)
+
+        player = subprocess.Popen(["pw-play", str(wav)])
+        try:
+            deadline = time.monotonic() + 3.0
+            nodes = []
+            while not nodes and time.monotonic() < deadline:
+                nodes = pipewire_links.find_nodes_by_pid(pipewire_links.dump_graph(), player.pid)
+                time.sleep(0.1)
+            if not nodes:
+                pytest.skip("pw-play node did not appear")
+
+            recorder = subprocess.Popen(
+                ["pw-record", "--properties",
+                 '{ node.name = "proctap_test_tap" node.autoconnect = false }',
+                 "--rate", "48000", "--channels", "2", "--format", "s16", "-"],
+                stdout=subprocess.PIPE,
+            )
+            linker = pipewire_links.PortLinker()
+            try:
+                _, inputs = pipewire_links.wait_for_node_ports("proctap_test_tap", "input")
+                assert pipewire_links.link_nodes(pipewire_links.dump_graph(), nodes[0], inputs, linker) == 2
+
+                assert recorder.stdout is not None
+                data = recorder.stdout.read(48000)
+                assert len(data) == 48000
+                assert b"\x00\x10" in data
+            finally:
+                linker.unlink_all()
+                recorder.terminate()
+                recorder.wait(timeout=5)
+        finally:
+            player.terminate()
+            player.wait(timeout=5)
@@ -0,0 +1,193 @@
+"""
+Tests for readiness polling across captures (proctap.poll, CaptureSelector).
+"""
+
+import threading
+import time
+from typing import Optional
+
+import numpy as np
+import pytest
+
+import proctap
+from proctap import CaptureSelector, ProcessAudioCapture
+from proctap.backends.base import AudioBackend
+from proctap.backends.synthetic import SyntheticBackend
+from proctap.poll import ChunkQueue
+
+
+class ListBackend(AudioBackend):
+    """Backend returning prepared chunk objects, then nothing."""
+
+    def __init__(self, chunks):
+        super().__init__(0)
+        self.chunks = list(chunks)
+
+    def start(self) -> None:
+        pass
+
+    def stop(self) -> None:
+        pass
+
+    def read(self) -> Optional[bytes]:
+        if self.chunks:
+            return self.chunks.pop(0)
+        time.sleep(0.001)
+        return None
+
+    def get_format(self) -> dict[str, int | str]:
+        return {}
+
+
+def chunk(frames, value=0.5):
+    return np.full(frames * 2, value, dtype=np.float32).tobytes()
+
+
+class TestChunkQueue:
+    """Fill level accounting."""
+
+    def test_queued_bytes(self):
+        q = ChunkQueue()
+        q.put(b'a' * 8)
+        q.put(b'b' * 16)
+        assert q.queued_bytes == 24
+        assert q.get() == b'a' * 8
+        assert q.queued_bytes == 16
+
+    def test_get_chunks_keeps_sentinel(self):
+        q = ChunkQueue()
+        for data in (b'1' * 8, b'2' * 8, b'3' * 8, None):
+            q.put(data)
+        assert q.get_chunks(max_bytes=16) == [b'1' * 8, b'2' * 8]
+        assert q.get_chunks() == [b'3' * 8]
+        assert q.get_chunks() == []
+        assert q.queued_bytes == 0
+        assert q.get() is None
+
+
+class TestPoll:
+    """proctap.poll() and drain()."""
+
+    def test_timeout_without_data(self):
+        tap = ProcessAudioCapture(0, backend=ListBackend([]))
+        tap.start()
+        try:
+            start = time.monotonic()
+            assert proctap.poll([tap], timeout=0.05) == []
+            assert time.monotonic() - start >= 0.04
+        finally:
+            tap.close()
+
+    def test_ready_once_min_frames_queued(self):
+        active = ProcessAudioCapture(0, backend=SyntheticBackend(chunk_ms=10.0))
+        idle = ProcessAudioCapture(1, backend=SyntheticBackend(chunk_ms=10.0))
+        active.start()
+        try:
+            start = time.monotonic()
+            ready = proctap.poll([idle, active], timeout=2.0, min_frames=2400)
+            elapsed = time.monotonic() - start
+            assert ready == [active]
+            assert active.available_frames >= 2400
+            assert elapsed >= 0.03
+        finally:
+            active.close()
+
+    def test_drain_is_zero_copy(self):
+        chunks = [chunk(480), chunk(240), chunk(480)]
+        tap = ProcessAudioCapture(0, backend=ListBackend(chunks))
+        tap.start()
+        try:
+            assert proctap.poll([tap], timeout=2.0, min_frames=1200) == [tap]
+            drained = tap.drain()
+        finally:
+            tap.close()
+        assert len(drained) == 3
+        assert all(a is b for a, b in zip(drained, chunks))
+        assert tap.available_frames == 0
+
+    def test_drain_max_frames_takes_whole_chunks(self):
+        tap = ProcessAudioCapture(0, backend=ListBackend([chunk(480), chunk(480), chunk(480)]))
+        tap.start()
+        try:
+            assert proctap.poll([tap], timeout=2.0, min_frames=1440) == [tap]
+            assert [len(c) // 8 for c in tap.drain(max_frames=500)] == [480, 480]
+            assert tap.available_frames == 480
+        finally:
+            tap.close()
+
+    def test_stopped_capture_is_ready(self):
+        tap = ProcessAudioCapture(0, backend=ListBackend([chunk(10)]))
+        tap.start()
+        assert proctap.poll([tap], timeout=2.0) == [tap]
+        tap.close()
+        assert proctap.poll([tap], timeout=2.0, min_frames=480) == [tap]
+        assert len(tap.drain()) == 1
+        assert tap.drain() == []
+
+    def test_invalid_min_frames(self):
+        with pytest.raises(ValueError):
+            CaptureSelector(min_frames=0)
+
+
+class TestCaptureSelector:
+    """Persistent selector serving many captures from one thread."""
+
+    def test_register_unregister(self):
+        a = ProcessAudioCapture(0, backend=ListBackend([]))
+        b = ProcessAudioCapture(1, backend=ListBackend([]))
+        with CaptureSelector() as selector:
+            selector.register(b)
+            selector.register(a)
+            selector.register(b, min_frames=10)
+            assert selector.captures == [b, a]
+            selector.unregister(b)
+            assert len(selector) == 1
+            assert b._waiters == ()
+        assert a._waiters == ()
+
+    def test_per_capture_threshold(self):
+        small = ProcessAudioCapture(0, backend=ListBackend([chunk(100)]))
+        large = ProcessAudioCapture(1, backend=ListBackend([chunk(100)]))
+        with CaptureSelector() as selector:
+            selector.register(small, min_frames=50)
+            selector.register(large, min_frames=200)
+            small.start()
+            large.start()
+            try:
+                assert selector.select(timeout=2.0) == [small]
+                time.sleep(0.05)
+                assert selector.select(timeout=0) == [small]
+            finally:
+                small.close()
+                large.close()
+
+    def test_one_thread_serves_many_captures(self):
+        num_captures = 64
+        taps = [ProcessAudioCapture(i, backend=SyntheticBackend(chunk_ms=10.0, frequency=100.0 + i))
+                for i in range(num_captures)]
+        received: dict[int, list[bytes]] = {tap.pid: [] for tap in taps}
+        done = threading.Event()
+
+        def consume(selector):
+            while not done.is_set():
+                for tap in selector.select(timeout=0.05):
+                    received[tap.pid].extend(tap.drain())
+
+        with CaptureSelector(min_frames=480) as selector:
+            for tap in taps:
+                selector.register(tap)
+                tap.start()
+            consumer = threading.Thread(target=consume, args=(selector,))
+            consumer.start()
+            time.sleep(0.3)
+            done.set()
+            consumer.join()
+            for tap in taps:
+                tap.close()
+
+        for tap in taps:
+            audio = np.frombuffer(b"".join(received[tap.pid]), dtype=np.float32).reshape(-1, 2)
+            assert audio.shape[0] >= 4800
+            t = np.arange(audio.shape[0]) / 48000
+            expected = 0.5 * np.sin(2 * np.pi * (100.0 + tap.pid) * t)
+            np.testing.assert_allclose(audio[:, 0], expected, atol=1e-5)
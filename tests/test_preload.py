@@ -0,0 +1,297 @@
+"""
+Tests for the LD_PRELOAD interception shim and PreloadBackend.
+
+The shim and a small test player are compiled from source; the player links
+against a fake audio library (tests/preload/fake_audio.c) standing in for
+libasound/libpulse/libpipewire, which "plays" into a file. Each test checks
+that the mirrored PCM matches what was played, byte for byte.
+"""
+
+import os
+import shutil
+import subprocess
+import sys
+import time
+from pathlib import Path
+
+import numpy as np
+import pytest
+
+from proctap.backends.converter import SampleFormat
+from proctap.backends.preload import INT24_LSB32, PreloadBackend, PreloadRecord, PreloadRing
+from proctap.core import ProcessAudioCapture
+
+pytestmark = pytest.mark.skipif(
+    not sys.platform.startswith('linux') or shutil.which('gcc') is None or shutil.which('g++') is None,
+    reason="preload shim needs Linux and a C/C++ compiler",
+)
+
+ROOT = Path(__file__).resolve().parent.parent
+FIXTURES = Path(__file__).resolve().parent / "preload"
+
+
+@pytest.fixture(scope="module")
+def build(tmp_path_factory):
+    """Compile the shim, the fake audio library and the player."""
+    out = tmp_path_factory.mktemp("preload")
+    subprocess.run(
+        ["gcc", "-shared", "-fPIC", "-o", str(out / "libfakeaudio.so"), str(FIXTURES / "fake_audio.c")],
+        check=True,
+    )
+    subprocess.run(
+        ["gcc", "-o", str(out / "player"), str(FIXTURES / "player.c"),
+         f"-L{out}", "-lfakeaudio", f"-Wl,-rpath,{out}", "-lm"],
+        check=True,
+    )
+    subprocess.run(
+        ["g++", "-std=c++17", "-O2", "-Wall", "-Wextra", "-Werror", "-shared", "-fPIC", "-pthread",
+         "-o", str(out / "libproctap_preload.so"), str(ROOT / "src/proctap/_preload.cpp"), "-ldl"],
+        check=True,
+    )
+    return out
+
+
+def play(build, tmp_path, api, rate=44100, channels=2, fmt="s16", frames=4800, block=480, streams=1, **kwargs):
+    """Run the player under the shim; returns (backend, played bytes)."""
+    played = tmp_path / "played.raw"
+    backend = PreloadBackend.launch(
+        [str(build / "player"), api, str(rate), str(channels), fmt, str(frames), str(block), str(streams)],
+        library=str(build / "libproctap_preload.so"),
+        env={**os.environ, "FAKE_AUDIO_OUT": str(played)},
+        **kwargs,
+    )
+    assert backend.process is not None
+    assert backend.process.wait(timeout=10) == 0
+    return backend, played.read_bytes()
+
+
+def expected_signal(rate, channels, frames):
+    """The player's signal as float (frames, channels)."""
+    x = np.sin(2 * np.pi * 440.0 * np.arange(frames) / rate)
+    return np.stack([(-0.5 if c % 2 else 0.5) * x for c in range(channels)], axis=1)
+
+
+class TestMirroring:
+    """Every API's playback writes are mirrored exactly, with their format."""
+
+    @pytest.mark.parametrize("api, expected_api", [
+        ("alsa", "alsa"),
+        ("alsa-writen", "alsa"),
+        ("alsa-set-params", "alsa"),
+        ("pulse", "pulse"),
+        ("pipewire", "pipewire"),
+    ])
+    def test_records_match_playback(self, build, tmp_path, api, expected_api):
+        backend, played = play(build, tmp_path, api, rate=44100, channels=2, fmt="s16", frames=4410, block=441)
+        records = backend.read_records()
+        backend.close()
+
+        assert b"".join(r.data for r in records) == played
+        assert len(played) == 4410 * 2 * 2
+        assert {(r.api, r.sample_rate, r.channels, r.sample_format) for r in records} == {
+            (expected_api, 44100, 2, SampleFormat.INT16)
+        }
+        assert [r.frames for r in records] == [441] * 10
+        assert len({r.stream for r in records}) == 1
+        assert all(r.pid == backend.pid for r in records)
+
+    @pytest.mark.parametrize("fmt, sample_format", [
+        ("s24", SampleFormat.INT24),
+        ("s24_32", INT24_LSB32),
+        ("s32", SampleFormat.INT32),
+        ("f32", SampleFormat.FLOAT32),
+    ])
+    def test_sample_formats(self, build, tmp_path, fmt, sample_format):
+        backend, played = play(build, tmp_path, "pipewire", rate=48000, channels=1, fmt=fmt, frames=960)
+        records = backend.read_records()
+        backend.close()
+        assert b"".join(r.data for r in records) == played
+        assert {r.sample_format for r in records} == {sample_format}
+
+    def test_nested_api_is_mirrored_once(self, build, tmp_path):
+        # ALSA's pulse plugin calls pa_stream_write inside snd_pcm_writei
+        backend, played = play(build, tmp_path, "alsa-pulse", frames=960)
+        records = backend.read_records()
+        backend.close()
+        assert {r.api for r in records} == {"alsa"}
+        assert b"".join(r.data for r in records) == played
+
+    def test_large_writes_are_split(self, build, tmp_path):
+        backend, played = play(build, tmp_path, "alsa", fmt="f32", frames=4800, block=4800, ring_bytes=65536)
+        records = backend.read_records()
+        backend.close()
+        assert len(records) > 1
+        assert all(len(r.data) % 8 == 0 for r in records)
+        assert b"".join(r.data for r in records) == played
+
+    def test_large_writen_is_interleaved_in_pieces(self, build, tmp_path):
+        # 4800 frames of 8ch float32 are far larger than the per-thread scratch buffer
+        backend, played = play(build, tmp_path, "alsa-writen", channels=8, fmt="f32", frames=4800, block=4800)
+        records = backend.read_records()
+        stats = backend.stats
+        backend.close()
+        assert len(records) > 1
+        assert b"".join(r.data for r in records) == played
+        assert stats['dropped'] == 0
+
+    def test_overrun_skips_to_writer(self, build, tmp_path):
+        backend, _ = play(build, tmp_path, "alsa", frames=48000, ring_bytes=4096)
+        assert backend.read_records() == []
+        stats = backend.stats
+        assert stats['overruns'] == 1
+        assert stats['records'] > 0 and stats['dropped'] == 0
+        backend.close()
+
+    def test_frame_wider_than_record_is_unsupported(self, build, tmp_path):
+        # 256ch float32 frames (1 KiB) do not fit a quarter of the smallest ring
+        backend, played = play(build, tmp_path, "alsa", channels=256, fmt="f32", frames=96, block=48, ring_bytes=4096)
+        assert len(played) == 96 * 256 * 4
+        assert backend.read_records() == []
+        assert backend.stats['unsupported'] == 2
+        backend.close()
+
+    @pytest.mark.parametrize("api", ["alsa", "pulse", "pipewire"])
+    def test_next_stream_followed_after_close(self, build, tmp_path, api):
+        # Like a player opening a new stream for the next track
+        backend, played = play(build, tmp_path, api, frames=960, streams=2)
+        records = backend.read_records()
+        stats = backend.stats
+        backend.close()
+        assert len({r.stream for r in records}) == 2
+        assert b"".join(r.data for r in records) == played
+        assert stats['filtered'] == 0
+
+    def test_inert_without_ring(self, build, tmp_path):
+        played = tmp_path / "played.raw"
+        env = {**os.environ, "FAKE_AUDIO_OUT": str(played), "LD_PRELOAD": str(build / "libproctap_preload.so"),
+               "PROCTAP_PRELOAD_RING": "/proctap-preload-missing"}
+        subprocess.run([str(build / "player"), "alsa", "48000", "2", "s16", "960"], env=env, check=True)
+        assert played.stat().st_size == 960 * 4
+
+
+class TestPreloadBackend:
+    """Records are converted to the standard format."""
+
+    @pytest.mark.parametrize("api, fmt, rate, channels", [
+        ("alsa", "f32", 48000, 2),
+        ("pulse", "s16", 48000, 1),
+        ("pipewire", "s24_32", 48000, 2),
+        ("alsa-writen", "s24", 48000, 2),
+    ])
+    def test_converted_to_standard(self, build, tmp_path, api, fmt, rate, channels):
+        backend, _ = play(build, tmp_path, api, rate=rate, channels=channels, fmt=fmt, frames=4800)
+        backend.start()
+        pcm = backend.read()
+        backend.close()
+
+        assert pcm is not None
+        audio = np.frombuffer(pcm, dtype=np.float32).reshape(-1, 2)
+        expected = expected_signal(rate, 2 if channels == 2 else 1, 4800)
+        if channels == 1:
+            expected = np.repeat(expected, 2, axis=1)
+        np.testing.assert_allclose(audio, expected, atol=2e-4)
+
+    def test_resampled_format(self, build, tmp_path):
+        backend, _ = play(build, tmp_path, "alsa", rate=44100, fmt="s16", frames=4410, block=441)
+        backend.start()
+        pcm = backend.read()
+        backend.close()
+        assert pcm is not None
+        assert len(pcm) == 4800 * 2 * 4
+
+    def test_capture_through_process_audio_capture(self, build, tmp_path):
+        played = tmp_path / "played.raw"
+        backend = PreloadBackend.launch(
+            [str(build / "player"), "pulse", "48000", "2", "f32", "9600"],
+            library=str(build / "libproctap_preload.so"),
+            env={**os.environ, "FAKE_AUDIO_OUT": str(played)},
+        )
+        chunks = []
+        tap = ProcessAudioCapture(backend.pid, on_data=lambda data, frames: chunks.append(data), backend=backend)
+        tap.start()
+        backend.process.wait(timeout=10)
+        deadline = time.monotonic() + 5.0
+        while sum(map(len, chunks)) < len(played.read_bytes()) and time.monotonic() < deadline:
+            time.sleep(0.01)
+        tap.close()
+        backend.close()
+        assert b"".join(chunks) == played.read_bytes()
+
+
+class FakeRing:
+    """Ring returning prepared records."""
+
+    def __init__(self, records):
+        self.records = records
+
+    def read(self):
+        records, self.records = self.records, []
+        return records
+
+    def stats(self):
+        return {}
+
+
+def record(api, stream=1, ms=0, data=bytes(8)):
+    return PreloadRecord(api, 1, stream, 48000, 2, SampleFormat.FLOAT32, ms * 1000000, data)
+
+
+class TestSelection:
+    """API and stream selection."""
+
+    def test_auto_follows_application_facing_api(self):
+        ring = FakeRing([record("pipewire"), record("alsa"), record("pipewire"), record("alsa")])
+        backend = PreloadBackend(1, ring)  # type: ignore[arg-type]
+        assert [r.api for r in backend.read_records()] == ["pipewire", "alsa", "alsa"]
+
+    def test_explicit_api_and_stream(self):
+        ring = FakeRing([record("alsa", 1), record("pulse", 1), record("pulse", 2)])
+        backend = PreloadBackend(1, ring, api="pulse", stream=2)  # type: ignore[arg-type]
+        assert [(r.api, r.stream) for r in backend.read_records()] == [("pulse", 2)]
+
+    def test_locks_onto_first_stream(self):
+        ring = FakeRing([record("pulse", 3), record("pulse", 4), record("pulse", 3), record("pulse", 4)])
+        backend = PreloadBackend(1, ring)  # type: ignore[arg-type]
+        assert [r.stream for r in backend.read_records()] == [3, 3]
+        assert backend.stats['filtered'] == 2
+
+    def test_higher_api_relocks_stream(self):
+        ring = FakeRing([record("pipewire", 7), record("alsa", 2), record("pipewire", 7), record("alsa", 2)])
+        backend = PreloadBackend(1, ring)  # type: ignore[arg-type]
+        assert [(r.api, r.stream) for r in backend.read_records()] == [("pipewire", 7), ("alsa", 2), ("alsa", 2)]
+
+    def test_close_record_releases_stream(self):
+        ring = FakeRing([record("pulse", 3), record("pulse", 3, data=b""), record("pulse", 4), record("pulse", 3)])
+        backend = PreloadBackend(1, ring)  # type: ignore[arg-type]
+        assert [r.stream for r in backend.read_records()] == [3, 4]
+        assert backend.stats['filtered'] == 1
+
+    def test_quiet_stream_is_released(self):
+        # A notification stream that stays open, then the actual playback
+        ring = FakeRing([record("pulse", 3, ms=0), record("pulse", 4, ms=100), record("pulse", 4, ms=600),
+                         record("pulse", 3, ms=700)])
+        backend = PreloadBackend(1, ring, relock_ms=500.0)  # type: ignore[arg-type]
+        assert [(r.stream, r.timestamp_ns // 1000000) for r in backend.read_records()] == [(3, 0), (4, 600)]
+        assert backend.stats['filtered'] == 2
+
+    def test_invalid_api(self):
+        with pytest.raises(ValueError):
+            PreloadBackend(1, FakeRing([]), api="jack")  # type: ignore[arg-type]
+        with pytest.raises(ValueError):
+            PreloadBackend(1, FakeRing([]), relock_ms=0.0)  # type: ignore[arg-type]
+
+
+class TestPreloadRing:
+    """Ring creation."""
+
+    def test_invalid_capacity(self):
+        with pytest.raises(ValueError):
+            PreloadRing(1000)
+
+    def test_close_unlinks(self):
+        ring = PreloadRing(4096)
+        path = Path("/dev/shm") / ring.name.lstrip('/')
+        assert path.exists()
+        ring.close()
+        ring.close()
+        assert not path.exists()
@@ -0,0 +1,271 @@
+"""
+Tests for the crossfading source switcher.
+
+Uses a fake grid clock and constant-valued sources so gains can be read
+straight from the output.
+"""
+
+import numpy as np
+import pytest
+
+from proctap.grid import BlockGrid
+from proctap.latency import DelayLine, LatencyReport, LatencyStage
+from proctap.switcher import SourceSwitcher
+
+BLOCK = 480
+
+
+class FakeClock:
+    """Manually advanced clock."""
+
+    def __init__(self) -> None:
+        self.now = 0.0
+
+    def __call__(self) -> float:
+        return self.now
+
+
+class FakeCapture:
+    """Stands in for ProcessAudioCapture (pause/resume/callback/latency only)."""
+
+    def __init__(self, pid: int, latency_ms: float = 0.0) -> None:
+        self.pid = pid
+        self.callback = None
+        self.is_paused = False
+        self.latency_ms = latency_ms
+
+    def latency(self):
+        return LatencyReport((LatencyStage('backend', self.latency_ms),))
+
+    def set_callback(self, callback):
+        self.callback = callback
+
+    def pause(self):
+        self.is_paused = True
+
+    def resume(self):
+        self.is_paused = False
+
+    def deliver(self, value: float, frames: int = BLOCK) -> None:
+        if not self.is_paused and self.callback is not None:
+            self.callback(np.full(frames * 2, value, dtype=np.float32).tobytes(), frames)
+
+
+def make_switcher(**kwargs):
+    clock = FakeClock()
+    grid = BlockGrid(block_frames=BLOCK, clock=clock)
+    return SourceSwitcher(grid=grid, **kwargs), clock
+
+
+def step(switcher, clock, values):
+    """Push one block per source (by name -> value) and tick."""
+    clock.now += BLOCK / 48000
+    for name, value in values.items():
+        switcher.grid.streams[name].push(np.full((BLOCK, 2), value, dtype=np.float32), timestamp=clock.now)
+    return switcher.tick()
+
+
+class TestDelayLine:
+    """Test latency compensation delay."""
+
+    def test_passthrough(self):
+        block = np.ones((4, 2), dtype=np.float32)
+        assert DelayLine(0, 2).process(block) is block
+
+    def test_delay_across_blocks(self):
+        delay = DelayLine(3, 1)
+        out1 = delay.process(np.arange(1, 5, dtype=np.float32).reshape(-1, 1))
+        out2 = delay.process(np.arange(5, 9, dtype=np.float32).reshape(-1, 1))
+        assert out1.ravel().tolist() == [0, 0, 0, 1]
+        assert out2.ravel().tolist() == [2, 3, 4, 5]
+
+
+class TestSwitching:
+    """Test switch timing and crossfades."""
+
+    def test_first_source_is_active(self):
+        switcher, clock = make_switcher()
+        switcher.add_source("a")
+        switcher.add_source("b")
+        out = step(switcher, clock, {"a": 0.5, "b": -0.5})
+
+        assert switcher.active == "a"
+        assert out.shape == (BLOCK, 2)
+        np.testing.assert_allclose(out, 0.5)
+
+    def test_hard_cut_at_block_boundary(self):
+        switcher, clock = make_switcher(crossfade_ms=0)
+        switcher.add_source("a")
+        switcher.add_source("b")
+        step(switcher, clock, {"a": 0.5, "b": -0.5})
+
+        switcher.switch("b")
+        out = step(switcher, clock, {"a": 0.5, "b": -0.5})
+        np.testing.assert_allclose(out, -0.5)
+
+    def test_equal_power_crossfade(self):
+        switcher, clock = make_switcher(crossfade_ms=20)  # 960 frames = 2 blocks
+        switcher.add_source("a")
+        switcher.add_source("b")
+        step(switcher, clock, {"a": 1.0, "b": 0.0})
+
+        switcher.switch("b")
+        first = step(switcher, clock, {"a": 1.0, "b": 0.0})
+        gains = switcher.stats["gains"]
+        # Halfway through: cos(pi/4) for a
+        assert gains["a"] == pytest.approx(np.cos(np.pi / 4), abs=1e-3)
+        assert gains["a"] ** 2 + gains["b"] ** 2 == pytest.approx(1.0, abs=1e-3)
+        # Fade starts at full level and decreases smoothly
+        assert first[0, 0] == pytest.approx(1.0, abs=1e-3)
+        assert np.all(np.diff(first[:, 0]) <= 0)
+
+        second = step(switcher, clock, {"a": 1.0, "b": 0.0})
+        assert second[-1, 0] == pytest.approx(0.0, abs=1e-6)
+        third = step(switcher, clock, {"a": 1.0, "b": 0.0})
+        np.testing.assert_allclose(third, 0.0)
+
+    def test_linear_crossfade_is_continuous(self):
+        switcher, clock = make_switcher(crossfade_ms=20, curve='linear')
+        switcher.add_source("a")
+        switcher.add_source("b")
+        outputs = [step(switcher, clock, {"a": 1.0, "b": -1.0})]
+        switcher.switch("b")
+        outputs += [step(switcher, clock, {"a": 1.0, "b": -1.0}) for _ in range(3)]
+
+        signal = np.concatenate(outputs)[:, 0]
+        assert np.abs(np.diff(signal)).max() < 2.0 / 960 + 1e-6
+        assert signal[-1] == pytest.approx(-1.0)
+
+    def test_switch_during_fade_is_continuous(self):
+        switcher, clock = make_switcher(crossfade_ms=20, curve='linear')
+        for name in ("a", "b", "c"):
+            switcher.add_source(name)
+        values = {"a": 1.0, "b": -1.0, "c": 0.5}
+        outputs = [step(switcher, clock, values)]
+        switcher.switch("b")
+        outputs.append(step(switcher, clock, values))
+        switcher.switch("c")
+        outputs += [step(switcher, clock, values) for _ in range(3)]
+
+        signal = np.concatenate(outputs)[:, 0]
+        assert np.abs(np.diff(signal)).max() < 0.01
+        assert signal[-1] == pytest.approx(0.5)
+        assert switcher.stats["gains"] == {"a": 0.0, "b": 0.0, "c": 1.0}
+
+    def test_switch_to_active_is_noop(self):
+        switcher, clock = make_switcher()
+        switcher.add_source("a")
+        switcher.switch("a")
+        assert switcher.stats["switches"] == 0
+
+    def test_unknown_source(self):
+        switcher, _ = make_switcher()
+        with pytest.raises(KeyError):
+            switcher.switch("missing")
+
+    def test_remove_active_source(self):
+        switcher, _ = make_switcher()
+        switcher.add_source("a")
+        switcher.add_source("b")
+        with pytest.raises(ValueError):
+            switcher.remove_source("a")
+        switcher.remove_source("b")
+        assert switcher.sources == ["a"]
+        assert "b" not in switcher.grid.streams
+
+    def test_invalid_curve(self):
+        with pytest.raises(ValueError):
+            SourceSwitcher(curve='cubic')
+
+
+class TestLatencyMatching:
+    """Test that sources are delayed to a common latency."""
+
+    def test_faster_source_is_delayed(self):
+        switcher, clock = make_switcher(crossfade_ms=0)
+        switcher.add_source("a", latency_ms=0)
+        switcher.add_source("b", latency_ms=10)
+        assert switcher.stats["delays"] == {"a": BLOCK, "b": 0}
+
+        # a is delayed by one block: its first output block is silence
+        first = step(switcher, clock, {"a": 0.5, "b": -0.5})
+        np.testing.assert_allclose(first, 0.0)
+        second = step(switcher, clock, {"a": 0.5, "b": -0.5})
+        np.testing.assert_allclose(second, 0.5)
+
+    def test_latency_from_capture(self):
+        switcher, _ = make_switcher(crossfade_ms=0)
+        switcher.add_source("a", FakeCapture(1, latency_ms=10))
+        switcher.add_source("b", FakeCapture(2, latency_ms=30))
+        switcher.add_source("c", FakeCapture(3, latency_ms=30), latency_ms=0)  # Explicit value wins
+        assert switcher.stats["delays"] == {"a": 2 * BLOCK, "b": 0, "c": 3 * BLOCK}
+
+    def test_delay_of_audible_source_is_deferred(self):
+        switcher, clock = make_switcher(crossfade_ms=0)
+        switcher.add_source("a")
+        step(switcher, clock, {"a": 0.5})
+
+        switcher.add_source("b", latency_ms=10)
+        assert switcher.stats["delays"] == {"a": 0, "b": 0}
+
+        switcher.switch("b")
+        step(switcher, clock, {"a": 0.5, "b": -0.5})
+        assert switcher.stats["delays"] == {"a": BLOCK, "b": 0}
+
+
+class TestPauseInactive:
+    """Test pausing captures of inactive sources."""
+
+    def test_inactive_sources_are_paused_and_resumed(self):
+        switcher, clock = make_switcher(crossfade_ms=0, pause_inactive=True)
+        a, b = FakeCapture(1), FakeCapture(2)
+        switcher.add_source("a", a)
+        switcher.add_source("b", b)
+        assert not a.is_paused
+        assert b.is_paused
+
+        switcher.switch("b")
+        assert not b.is_paused
+
+        # Switch waits for b's audio to arrive before cutting over
+        clock.now += BLOCK / 48000
+        a.deliver(0.5)
+        out = switcher.tick()
+        np.testing.assert_allclose(out, 0.5)
+        assert switcher.active == "a"
+
+        clock.now += BLOCK / 48000
+        a.deliver(0.5)
+        b.deliver(-0.5)
+        out = switcher.tick()
+        np.testing.assert_allclose(out, -0.5)
+        assert switcher.active == "b"
+        assert a.is_paused
+
+    def test_resume_timeout(self):
+        switcher, clock = make_switcher(crossfade_ms=0, pause_inactive=True, resume_timeout_ms=20)
+        switcher.add_source("a", FakeCapture(1))
+        switcher.add_source("b", FakeCapture(2))
+        switcher.switch("b")
+
+        clock.now += 2 * BLOCK / 48000
+        switcher.tick()
+        switcher.tick()
+        assert switcher.active == "b"
+
+
+class TestPushMode:
+    """Test output on the grid thread."""
+
+    def test_read_blocks(self):
+        switcher = SourceSwitcher(block_frames=BLOCK)
+        stream = switcher.add_source("a")
+        stream.push(np.full((BLOCK * 4, 2), 0.25, dtype=np.float32))
+        switcher.start()
+        try:
+            data = switcher.read(timeout=1.0)
+        finally:
+            switcher.stop()
+
+        assert data is not None
+        assert len(data) == BLOCK * 2 * 4
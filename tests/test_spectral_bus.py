@@ -0,0 +1,220 @@
+"""
+Tests for the shared STFT analysis bus.
+
+Driven by SyntheticBackend signals so expected spectra are known.
+"""
+
+import time
+
+import numpy as np
+import pytest
+
+from proctap.backends.synthetic import SyntheticBackend
+from proctap.core import ProcessAudioCapture
+from proctap.spectral import SpectralBus, make_window
+
+
+def synthetic_chunks(duration=0.5, frequency=1000.0, chunk_ms=10.0):
+    """Standard-format (48kHz stereo float32) chunks from a sine."""
+    backend = SyntheticBackend(frequency=frequency, chunk_ms=chunk_ms, realtime=False, duration=duration)
+    backend.start()
+    chunks = []
+    while (data := backend.read()) is not None:
+        chunks.append(data)
+    return chunks
+
+
+def feed_all(bus, chunks):
+    for chunk in chunks:
+        bus.on_data(chunk, -1)
+
+
+class TestLazyActivation:
+    """Nothing is computed without subscribers."""
+
+    def test_inactive_bus_only_counts(self):
+        bus = SpectralBus()
+        feed_all(bus, synthetic_chunks(0.1))
+        assert not bus.active
+        assert bus.position == 4800
+        assert bus.stats()['analyses'] == []
+
+    def test_last_unsubscribe_deactivates(self):
+        bus = SpectralBus()
+        a = bus.subscribe(1024, 256, callback=lambda f: None)
+        b = bus.subscribe(1024, 256, callback=lambda f: None)
+        a.close()
+        assert bus.active
+        b.close()
+        b.close()  # Idempotent
+        assert not bus.active
+
+    def test_new_configuration_starts_at_current_position(self):
+        bus = SpectralBus()
+        feed_all(bus, synthetic_chunks(0.1))
+        positions = []
+        bus.subscribe(1024, 512, callback=lambda f: positions.append(f.position))
+        feed_all(bus, synthetic_chunks(0.1))
+        assert positions[0] == 4800
+        assert np.all(np.diff(positions) == 512)
+
+
+class TestSharedComputation:
+    """Subscribers of one configuration share frames."""
+
+    def test_one_computation_for_many_subscribers(self):
+        bus = SpectralBus()
+        seen = [[], [], []]
+        for frames in seen:
+            bus.subscribe(2048, 512, callback=lambda f, frames=frames: frames.append(f))
+        other = []
+        bus.subscribe(1024, 1024, callback=other.append)
+
+        feed_all(bus, synthetic_chunks(0.5))
+
+        stats = {(a['size'], a['hop']): a for a in bus.stats()['analyses']}
+        assert len(stats) == 2
+        assert stats[(2048, 512)]['subscribers'] == 3
+        expected = 1 + (24000 - 2048) // 512
+        assert stats[(2048, 512)]['frames'] == expected
+        assert stats[(1024, 1024)]['frames'] == 24000 // 1024
+
+        # Same frame objects, not copies
+        assert len(seen[0]) == expected
+        assert all(a is b is c for a, b, c in zip(*seen))
+        assert len(other) == 24000 // 1024
+
+    def test_frames_match_reference_stft_across_chunks(self):
+        bus = SpectralBus()
+        sub = bus.subscribe(1024, 300, window='hann')
+        # Odd chunk sizes so frames straddle chunk boundaries
+        chunks = synthetic_chunks(0.2, frequency=1500.0, chunk_ms=7.3)
+        feed_all(bus, chunks)
+        signal = np.frombuffer(b"".join(chunks), dtype=np.float32).reshape(-1, 2).mean(axis=1)
+
+        frame = sub.get(timeout=0)
+        index = 0
+        while frame is not None:
+            start = frame.position
+            reference = np.fft.rfft(signal[start:start + 1024] * make_window('hann', 1024))
+            np.testing.assert_allclose(frame.spectrum, reference, rtol=1e-4, atol=1e-4)
+            assert frame.index == index
+            frame.release()
+            frame = sub.get(timeout=0)
+            index += 1
+        assert index == 1 + (len(signal) - 1024) // 300
+
+    def test_peak_at_signal_frequency(self):
+        bus = SpectralBus()
+        sub = bus.subscribe(4096, 4096)
+        feed_all(bus, synthetic_chunks(0.2, frequency=1000.0))
+        with sub.get(timeout=0) as frame:
+            peak = frame.freqs()[np.argmax(frame.magnitude)]
+        assert peak == pytest.approx(1000.0, abs=48000 / 4096)
+
+    def test_per_channel_configuration(self):
+        bus = SpectralBus()
+        sub = bus.subscribe(512, mix=False)
+        feed_all(bus, synthetic_chunks(0.05))
+        with sub.get(timeout=0) as frame:
+            assert frame.spectrum.shape == (2, 257)
+            np.testing.assert_allclose(frame.spectrum[0], frame.spectrum[1])
+
+    def test_invalid_configuration(self):
+        bus = SpectralBus()
+        with pytest.raises(ValueError):
+            bus.subscribe(1024, 2048)
+        with pytest.raises(ValueError):
+            bus.subscribe(1024, window='kaiser')  # type: ignore[arg-type]
+
+
+class TestReferenceCounting:
+    """Frame lifetime follows its references."""
+
+    def test_callback_frame_is_borrowed(self):
+        bus = SpectralBus()
+        borrowed, kept = [], []
+        bus.subscribe(512, 512, callback=borrowed.append)
+        bus.subscribe(512, 512, callback=lambda f: kept.append(f.retain()))
+        feed_all(bus, synthetic_chunks(0.02))
+
+        frame = borrowed[0]
+        assert frame is kept[0]
+        assert frame.refcount == 1  # Only the retained reference is left
+        assert frame.magnitude.shape == (257,)
+        frame.release()
+        assert frame.refcount == 0
+        with pytest.raises(RuntimeError, match="released"):
+            _ = frame.spectrum
+        with pytest.raises(RuntimeError):
+            frame.retain()
+
+    def test_shared_lazy_magnitude(self):
+        bus = SpectralBus()
+        mags = []
+        bus.subscribe(512, 512, callback=lambda f: mags.append(f.magnitude))
+        bus.subscribe(512, 512, callback=lambda f: mags.append(f.magnitude))
+        feed_all(bus, synthetic_chunks(0.011))
+        assert mags[0] is mags[1]
+        assert not mags[0].flags.writeable
+
+    def test_queue_overflow_drops_oldest(self):
+        bus = SpectralBus()
+        sub = bus.subscribe(480, 480, max_queue=4)
+        feed_all(bus, synthetic_chunks(0.1))  # 10 frames
+        assert sub.dropped == 6
+        frame = sub.get(timeout=0)
+        assert frame is not None and frame.index == 6
+        frame.release()
+
+    def test_close_releases_queued_frames(self):
+        bus = SpectralBus()
+        keep = []
+        sub = bus.subscribe(480, 480)
+        bus.subscribe(480, 480, callback=lambda f: keep.append(f.retain()))
+        feed_all(bus, synthetic_chunks(0.05))
+        assert keep[0].refcount == 2  # Queue + callback reference
+        sub.close()
+        assert keep[0].refcount == 1
+
+    def test_get_requires_queue_mode(self):
+        bus = SpectralBus()
+        sub = bus.subscribe(512, callback=lambda f: None)
+        with pytest.raises(RuntimeError):
+            sub.get()
+
+
+class TestConsumers:
+    """Bus attached to a capture and shared with AudioAnalyzer."""
+
+    def test_capture_feeds_bus(self):
+        bus = SpectralBus()
+        frames = []
+        bus.subscribe(1024, 512, callback=lambda f: frames.append(f.index))
+        backend = SyntheticBackend(realtime=False, duration=0.2)
+        tap = ProcessAudioCapture(pid=0, on_data=bus.on_data, backend=backend)
+        tap.start()
+        deadline = time.monotonic() + 5.0
+        while bus.position < 9600 and time.monotonic() < deadline:
+            time.sleep(0.01)
+        tap.close()
+        assert bus.position == 9600
+        assert frames == list(range(1 + (9600 - 1024) // 512))
+
+    def test_audio_analyzer_uses_shared_frames(self):
+        from proctap.contrib.analysis import AudioAnalyzer
+
+        bus = SpectralBus()
+        analyzer = AudioAnalyzer(fft_size=2048, update_interval=0.0, bus=bus)
+        assert bus.stats()['analyses'][0]['subscribers'] == 1
+
+        for chunk in synthetic_chunks(0.2, frequency=2000.0):
+            bus.on_data(chunk, -1)
+            analyzer.process_audio(chunk)
+
+        peak = analyzer.freqs[np.argmax(analyzer.spectrum)]
+        assert peak == pytest.approx(2000.0, abs=48000 / 2048)
+        assert analyzer.rms_db == pytest.approx(-9.03, abs=0.1)
+
+        analyzer.close()
+        assert not bus.active
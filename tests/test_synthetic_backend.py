@@ -0,0 +1,131 @@
+"""
+Tests for the synthetic backend and backend injection into ProcessAudioCapture.
+"""
+
+import time
+
+import numpy as np
+import pytest
+
+from proctap import ProcessAudioCapture
+from proctap.backends.synthetic import SyntheticBackend
+
+
+def read_all(backend, max_chunks=1000):
+    chunks = []
+    for _ in range(max_chunks):
+        data = backend.read()
+        if data is None:
+            break
+        chunks.append(data)
+    return np.frombuffer(b"".join(chunks), dtype=np.float32).reshape(-1, 2)
+
+
+class TestSyntheticBackend:
+    """Test signal generation."""
+
+    def test_standard_format(self):
+        backend = SyntheticBackend()
+        assert backend.get_format() == {
+            'sample_rate': 48000,
+            'channels': 2,
+            'bits_per_sample': 32,
+            'sample_format': 'float32',
+        }
+
+    def test_read_before_start(self):
+        assert SyntheticBackend().read() is None
+
+    def test_sine_chunks_are_continuous(self):
+        backend = SyntheticBackend(signal='sine', frequency=1000.0, amplitude=0.5,
+                                   realtime=False, duration=0.1)
+        backend.start()
+        samples = read_all(backend)
+
+        assert samples.shape == (4800, 2)
+        expected = 0.5 * np.sin(2 * np.pi * 1000.0 * np.arange(4800) / 48000)
+        np.testing.assert_allclose(samples[:, 0], expected, atol=1e-6)
+        np.testing.assert_array_equal(samples[:, 0], samples[:, 1])
+
+    def test_impulse_positions(self):
+        backend = SyntheticBackend(signal='impulse', amplitude=1.0, impulse_interval=0.025,
+                                   realtime=False, duration=0.1)
+        backend.start()
+        samples = read_all(backend)
+
+        assert list(np.flatnonzero(samples[:, 0])) == [0, 1200, 2400, 3600]
+
+    def test_noise_is_reproducible(self):
+        runs = []
+        for _ in range(2):
+            backend = SyntheticBackend(signal='noise', realtime=False, duration=0.02, seed=7)
+            backend.start()
+            runs.append(read_all(backend))
+        np.testing.assert_array_equal(runs[0], runs[1])
+        assert np.abs(runs[0]).max() <= 0.5
+
+    def test_native_format_is_converted(self):
+        backend = SyntheticBackend(signal='sine', realtime=False, duration=0.1,
+                                   source_rate=44100, source_channels=1, source_format='int16')
+        backend.start()
+        samples = read_all(backend)
+
+        assert backend.frames_generated == 4410
+        assert abs(samples.shape[0] - 4800) <= 16
+        assert 0.4 < np.abs(samples).max() < 0.6
+
+    def test_int32_full_scale_does_not_wrap(self):
+        backend = SyntheticBackend(signal='impulse', amplitude=1.0, realtime=False,
+                                   source_format='int32', source_channels=1)
+        pcm = np.frombuffer(backend._encode(np.array([1.0, -1.0, 0.5], dtype=np.float32)), dtype=np.int32)
+        assert list(pcm) == [2147483647, -2147483647, 1073741824]
+
+    def test_realtime_pacing(self):
+        backend = SyntheticBackend(chunk_ms=10, realtime=True, duration=0.1)
+        backend.start()
+        start = time.monotonic()
+        read_all(backend)
+        assert time.monotonic() - start >= 0.09
+
+    def test_stop(self):
+        backend = SyntheticBackend(realtime=False)
+        backend.start()
+        assert backend.read() is not None
+        backend.stop()
+        assert backend.read() is None
+
+    def test_invalid_signal(self):
+        with pytest.raises(ValueError):
+            SyntheticBackend(signal='square')
+
+
+class TestBackendInjection:
+    """Test ProcessAudioCapture with an injected backend."""
+
+    def test_capture_with_synthetic_backend(self):
+        received = []
+        backend = SyntheticBackend(realtime=True, chunk_ms=10)
+        with ProcessAudioCapture(pid=0, on_data=lambda pcm, _n: received.append(pcm), backend=backend) as tap:
+            chunk = tap.read(timeout=1.0)
+
+        assert chunk is not None
+        assert len(chunk) == 480 * 2 * 4
+        assert received
+
+    def test_pause_and_resume(self):
+        received = []
+        backend = SyntheticBackend(realtime=True, chunk_ms=5)
+        tap = ProcessAudioCapture(pid=0, on_data=lambda pcm, _n: received.append(pcm), backend=backend)
+        tap.pause()
+        tap.start()
+        try:
+            time.sleep(0.05)
+            assert tap.is_paused
+            assert received == []
+            assert backend.frames_generated > 0  # Backend keeps running
+
+            tap.resume()
+            assert tap.read(timeout=1.0) is not None
+            assert received
+        finally:
+            tap.stop()
@@ -0,0 +1,162 @@
+"""
+Tests for high channel count conversion (channel maps, channel-group
+parallel conversion and the interleave/deinterleave kernels).
+"""
+
+import numpy as np
+import pytest
+
+from proctap.backends.converter import (
+    AudioConverter,
+    SampleFormat,
+    deinterleave,
+    frames_view,
+    interleave,
+)
+
+WIDTHS = {
+    SampleFormat.INT16: 2,
+    SampleFormat.INT24: 3,
+    SampleFormat.INT24_32: 4,
+    SampleFormat.INT32: 4,
+    SampleFormat.FLOAT32: 4,
+}
+
+
+def make(src_channels=64, dst_channels=64, src_rate=96000, dst_rate=96000,
+         src_format=SampleFormat.FLOAT32, dst_format=SampleFormat.FLOAT32, **kwargs):
+    return AudioConverter(
+        src_rate=src_rate, src_channels=src_channels, src_width=WIDTHS[src_format],
+        dst_rate=dst_rate, dst_channels=dst_channels, dst_width=WIDTHS[dst_format],
+        src_format=src_format, dst_format=dst_format, auto_detect_format=False, **kwargs,
+    )
+
+
+def wide_audio(frames=960, channels=64):
+    """Each channel a sine at its own frequency, so channels are distinguishable."""
+    t = np.arange(frames) / 96000
+    freqs = 100.0 + 50.0 * np.arange(channels)
+    return (0.5 * np.sin(2 * np.pi * t[:, None] * freqs)).astype(np.float32)
+
+
+class TestChannelCounts:
+    """Arbitrary channel counts and explicit channel maps."""
+
+    def test_wide_passthrough(self):
+        audio = wide_audio()
+        out = make(workers=1).convert(audio.tobytes())
+        np.testing.assert_array_equal(np.frombuffer(out, dtype=np.float32).reshape(-1, 64), audio)
+
+    def test_channel_map_picks_sources(self):
+        audio = wide_audio()
+        converter = make(dst_channels=2, channel_map=[9, 8])
+        assert converter.needs_channel_conversion
+        out = np.frombuffer(converter.convert(audio.tobytes()), dtype=np.float32).reshape(-1, 2)
+        np.testing.assert_array_equal(out, audio[:, [9, 8]])
+
+    def test_channel_map_to_mono(self):
+        audio = wide_audio(channels=16)
+        out = make(src_channels=16, dst_channels=1, channel_map=[5]).convert(audio.tobytes())
+        np.testing.assert_array_equal(np.frombuffer(out, dtype=np.float32), audio[:, 5])
+
+    def test_identity_map_is_no_conversion(self):
+        assert not make(src_channels=4, dst_channels=4, channel_map=[0, 1, 2, 3]).needs_channel_conversion
+
+    @pytest.mark.parametrize("kwargs", [
+        {'src_channels': 0},
+        {'dst_channels': 0},
+        {'dst_channels': 2, 'channel_map': [0]},
+        {'dst_channels': 2, 'channel_map': [0, 64]},
+        {'dst_channels': 2, 'channel_map': [-1, 0]},
+        {'workers': 0},
+    ])
+    def test_invalid(self, kwargs):
+        with pytest.raises(ValueError):
+            make(**kwargs)
+
+
+class TestKernels:
+    """Cache-blocked interleave/deinterleave against plain numpy."""
+
+    @pytest.mark.parametrize("fmt", list(WIDTHS))
+    def test_roundtrip_matches_serial_path(self, fmt):
+        audio = wide_audio(frames=3000) * 1.5  # Also exercises clipping
+        converter = make(src_format=fmt, dst_format=fmt, workers=1)
+        pcm = converter._float_to_bytes(audio, fmt)
+
+        frames = frames_view(pcm, fmt, 64)
+        decoded = deinterleave(frames, slice(16, 48), fmt)
+        np.testing.assert_array_equal(decoded, converter._bytes_to_float(pcm, fmt, 64)[:, 16:48])
+
+        out = np.zeros_like(frames)
+        interleave(decoded, out, 16, fmt)
+        assert out[:, 16:48].copy().tobytes() == converter._float_to_bytes(decoded, fmt)
+        assert not out[:, :16].any()
+
+    def test_gather_index(self):
+        audio = wide_audio(frames=100)
+        frames = frames_view(audio.tobytes(), SampleFormat.FLOAT32, 64)
+        picked = deinterleave(frames, np.array([63, 0, 0]), SampleFormat.FLOAT32)
+        np.testing.assert_array_equal(picked, audio[:, [63, 0, 0]])
+
+    def test_float_non_finite_replaced(self):
+        audio = wide_audio(frames=100, channels=16)
+        audio[10, 3] = np.nan
+        audio[20, 4] = np.inf
+        decoded = deinterleave(frames_view(audio.tobytes(), SampleFormat.FLOAT32, 16), slice(0, 16), SampleFormat.FLOAT32)
+        assert decoded[10, 3] == 0.0 and decoded[20, 4] == 0.0
+
+    def test_partial_frames_rejected(self):
+        with pytest.raises(ValueError):
+            frames_view(bytes(10), SampleFormat.INT16, 4)
+
+
+class TestChannelGroups:
+    """Parallel channel-group conversion matches the serial path exactly."""
+
+    def test_groups_planned_for_wide_streams(self):
+        assert len(make(workers=4)._groups) == 4
+        assert make(workers=1)._groups == []
+        assert make(src_channels=8, dst_channels=8, workers=4)._groups == []
+        assert len(make(src_channels=16, dst_channels=16, workers=64)._groups) == 4  # >= 4 channels each
+        assert make(dst_channels=32, workers=4)._groups == []  # Downmix mixes across groups
+
+    @pytest.mark.parametrize("src_fmt,dst_fmt", [
+        (SampleFormat.INT24, SampleFormat.FLOAT32),
+        (SampleFormat.INT32, SampleFormat.INT16),
+        (SampleFormat.FLOAT32, SampleFormat.INT24),
+    ])
+    @pytest.mark.parametrize("rates", [(96000, 96000), (96000, 48000), (44100, 48000)])
+    def test_parallel_matches_serial(self, src_fmt, dst_fmt, rates):
+        serial = make(src_format=src_fmt, dst_format=dst_fmt, src_rate=rates[0], dst_rate=rates[1], workers=1)
+        parallel = make(src_format=src_fmt, dst_format=dst_fmt, src_rate=rates[0], dst_rate=rates[1], workers=4)
+        pcm = serial._float_to_bytes(wide_audio(), src_fmt)
+        assert parallel.convert(pcm) == serial.convert(pcm)
+
+    def test_upmix_and_map_in_groups(self):
+        audio = wide_audio(channels=16)
+        upmix = make(src_channels=16, dst_channels=32, workers=4)
+        assert len(upmix._groups) == 4
+        out = np.frombuffer(upmix.convert(audio.tobytes()), dtype=np.float32).reshape(-1, 32)
+        np.testing.assert_array_equal(out[:, :16], audio)
+        np.testing.assert_array_equal(out[:, 16:], np.repeat(audio[:, -1:], 16, axis=1))
+
+        reverse = list(range(15, -1, -1))
+        mapped = make(src_channels=16, dst_channels=16, channel_map=reverse, workers=2)
+        out = np.frombuffer(mapped.convert(audio.tobytes()), dtype=np.float32).reshape(-1, 16)
+        np.testing.assert_array_equal(out, audio[:, reverse])
+
+    def test_short_chunks_converted_serially(self):
+        audio = wide_audio(frames=100)
+        converter = make(dst_rate=48000, workers=4)
+        serial = make(dst_rate=48000, workers=1)
+        assert converter.convert(audio.tobytes()) == serial.convert(audio.tobytes())
+
+    def test_resampled_content(self):
+        audio = wide_audio(frames=9600)
+        out = make(dst_rate=48000, workers=4).convert(audio.tobytes())
+        resampled = np.frombuffer(out, dtype=np.float32).reshape(-1, 64)
+        assert resampled.shape[0] == 4800
+        # Channel 40 keeps its frequency (2100 Hz) after resampling
+        spectrum = np.abs(np.fft.rfft(resampled[:, 40]))
+        assert np.fft.rfftfreq(4800, 1 / 48000)[spectrum.argmax()] == pytest.approx(2100.0, abs=10.0)